@@ -34,6 +34,8 @@ public:
 
     virtual void handleBeforDestroy();
 
+    virtual void prefetch(const QList<QUrl> &urls); /*urls may be previewed next, such as the neighbours in the list*/
+
 Q_SIGNALS:
     void titleChanged();
 };
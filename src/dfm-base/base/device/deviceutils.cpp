@@ -611,9 +611,8 @@ bool DeviceUtils::isLowSpeedDevice(const QUrl &url)
         return false;
 
     const QString &path = url.toLocalFile();
-    static const QString lowSpeedMountpoint { "(^/run/user/\\d+/gvfs/|^/root/.gvfs/|^/media/[\\s\\S]*/smbmounts)" };
     // TODO(xust) /media/$USER/smbmounts might be changed in the future.
-    QRegularExpression re { lowSpeedMountpoint };
+    static const QRegularExpression re { "(^/run/user/\\d+/gvfs/|^/root/.gvfs/|^/media/[\\s\\S]*/smbmounts)" };
     QRegularExpressionMatch match { re.match(path) };
     return match.hasMatch();
 }
@@ -15,6 +15,14 @@
 #include <QDebug>
 #include <QStorageInfo>
 #include <QtConcurrent>
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QSet>
+
+#include <algorithm>
+#include <thread>
+
+#include <sys/statvfs.h>
 
 #include <dfm-mount/dmount.h>
 #include <dfm-burn/dopticaldiscinfo.h>
@@ -48,16 +56,127 @@ void DeviceWatcher::stopPollingUsage()
     disconnect(&d->pollingTimer);
 }
 
+/*!
+ * \brief DeviceWatcherPrivate::queryUsageAsync
+ * query the usage of the mounted devices which are due, each device is polled on its own interval,
+ * see DeviceWatcherPrivate::onUsageQueried.
+ */
 void DeviceWatcherPrivate::queryUsageAsync()
 {
-    QtConcurrent::run([this] {
-        auto blocks = allBlockInfos;
-        auto protocols = allProtocolInfos;
-        std::for_each(blocks.cbegin(), blocks.cend(),
-                      [this](const QVariantMap &item) { queryUsageOfItem(item, DeviceType::kBlockDevice); });
-        std::for_each(protocols.cbegin(), protocols.cend(),
-                      [this](const QVariantMap &item) { queryUsageOfItem(item, DeviceType::kProtocolDevice); });
+    QSet<QString> mounted;
+    auto query = [&](const QHash<QString, QVariantMap> &infos, DeviceType type) {
+        for (auto iter = infos.cbegin(); iter != infos.cend(); ++iter) {
+            if (iter.value().value(DeviceProperty::kMountPoint).toString().isEmpty())
+                continue;
+            mounted.insert(iter.key());
+            queryUsageOfDevice(iter.key(), iter.value(), type, false);
+        }
+    };
+    query(allBlockInfos, DeviceType::kBlockDevice);
+    query(allProtocolInfos, DeviceType::kProtocolDevice);
+
+    // the query running is kept, a hung one must not be started again once remounted
+    for (auto iter = usagePollings.begin(); iter != usagePollings.end();) {
+        if (!mounted.contains(iter.key()) && iter.value().serial == 0)
+            iter = usagePollings.erase(iter);
+        else
+            ++iter;
+    }
+}
+
+void DeviceWatcherPrivate::queryUsageOfDevice(const QString &id, const QVariantMap &itemData, DFMMOUNT::DeviceType type, bool force)
+{
+    UsagePolling &polling = usagePollings[id];
+    if (polling.serial != 0)
+        return;
+    if (!force && pollingClock.elapsed() < polling.nextQuery)
+        return;
+
+    const bool isNetwork = (type == DeviceType::kProtocolDevice);
+    if (isNetwork && stalledQueryCount() >= kMaxStalledQueries)
+        return;
+
+    polling.serial = ++querySerial;
+    const quint64 serial = polling.serial;
+    auto watcher = new QFutureWatcher<DevStorage>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, id, serial]() {
+        onUsageQueried(id, serial, watcher->result());
+        watcher->deleteLater();
     });
+
+    if (!isNetwork) {
+        // query info async avoid blocking main thread when disks' IO load is too high.
+        watcher->setFuture(QtConcurrent::run(&localQueryPool, &DeviceWatcherPrivate::queryUsageOfItem, itemData, type));
+        return;
+    }
+
+    // a dead server hangs statfs for good, the query gets a thread of its own so that
+    // it never takes a worker of a pool from the local disks or the views.
+    QFutureInterface<DevStorage> promise;
+    promise.reportStarted();
+    watcher->setFuture(promise.future());
+    std::thread([promise, itemData, type]() mutable {
+        promise.reportResult(queryUsageOfItem(itemData, type));
+        promise.reportFinished();
+    }).detach();
+    QTimer::singleShot(kNetworkQueryTimeout, this, [this, id, serial]() { onUsageQueryTimeout(id, serial); });
+}
+
+/*!
+ * \brief DeviceWatcherPrivate::onUsageQueried
+ * the size is emitted only if it is changed. A device whose usage keeps the same is polled less and less,
+ * up to kMaxPollingInterval, and a device which does not answer in time is polled at that interval.
+ */
+void DeviceWatcherPrivate::onUsageQueried(const QString &id, quint64 serial, const DevStorage &storage)
+{
+    auto iter = usagePollings.find(id);
+    if (iter == usagePollings.end() || iter.value().serial != serial)
+        return;
+
+    UsagePolling &polling = iter.value();
+    polling.serial = 0;
+    if (storage.isValid() && storage != polling.lastStorage) {
+        polling.lastStorage = storage;
+        polling.interval = kPollingInterval;
+        emit DevMngIns->devSizeChanged(id, storage.total, storage.avai);
+    } else {
+        polling.interval = qBound(kPollingInterval, polling.interval * 2, kMaxPollingInterval);
+    }
+
+    if (polling.stalled) {
+        polling.stalled = false;
+        polling.interval = kMaxPollingInterval;
+    }
+    polling.nextQuery = pollingClock.elapsed() + polling.interval;
+}
+
+void DeviceWatcherPrivate::onUsageQueryTimeout(const QString &id, quint64 serial)
+{
+    auto iter = usagePollings.find(id);
+    if (iter == usagePollings.end() || iter.value().serial != serial)
+        return;
+
+    iter.value().stalled = true;
+    qCWarning(logDFMBase) << "usage query is not answered in" << kNetworkQueryTimeout << "ms:" << id;
+}
+
+int DeviceWatcherPrivate::stalledQueryCount() const
+{
+    return static_cast<int>(std::count_if(usagePollings.cbegin(), usagePollings.cend(),
+                                          [](const UsagePolling &polling) { return polling.stalled; }));
+}
+
+void DeviceWatcherPrivate::resetUsagePolling(const QString &id)
+{
+    auto iter = usagePollings.find(id);
+    if (iter == usagePollings.end())
+        return;
+
+    // the usage of the new mount is emitted once queried
+    if (iter.value().serial == 0)
+        usagePollings.erase(iter);
+    else
+        iter.value().lastStorage = {};
 }
 
 void DeviceWatcherPrivate::updateStorage(const QString &id, quint64 total, quint64 avai)
@@ -80,29 +199,17 @@ void DeviceWatcherPrivate::updateStorage(const QString &id, quint64 total, quint
         update(allProtocolInfos);
 }
 
-void DeviceWatcherPrivate::queryUsageOfItem(const QVariantMap &itemData, dfmmount::DeviceType type)
+DevStorage DeviceWatcherPrivate::queryUsageOfItem(const QVariantMap &itemData, dfmmount::DeviceType type)
 {
     const QString &mpt = itemData.value(DeviceProperty::kMountPoint).toString();
     if (mpt.isEmpty())
-        return;
-
-    DevStorage old { itemData.value(DeviceProperty::kSizeTotal).toULongLong(),
-                     itemData.value(DeviceProperty::kSizeFree).toULongLong(),
-                     itemData.value(DeviceProperty::kSizeUsed).toULongLong() };
-
-    if (type == DFMMOUNT::DeviceType::kAllDevice)
-        return;
-
-    DevStorage newStorage = (type == dfmmount::DeviceType::kBlockDevice)
-            ? queryUsageOfBlock(itemData)
-            : queryUsageOfProtocol(itemData);
+        return {};
 
-    if (/*old != newStorage && */ newStorage.isValid()) {
-        const QString &devId = itemData.value(DeviceProperty::kId).toString();
-        emit DevMngIns->devSizeChanged(devId,
-                                       itemData.value(DeviceProperty::kSizeTotal).toULongLong(),
-                                       newStorage.avai);
-    }
+    if (type == DFMMOUNT::DeviceType::kBlockDevice)
+        return queryUsageOfBlock(itemData);
+    if (type == DFMMOUNT::DeviceType::kProtocolDevice)
+        return queryUsageOfProtocol(itemData);
+    return {};
 }
 
 DevStorage DeviceWatcherPrivate::queryUsageOfBlock(const QVariantMap &itemData)
@@ -135,6 +242,15 @@ DevStorage DeviceWatcherPrivate::queryUsageOfProtocol(const QVariantMap &itemDat
     if (devId.isEmpty())
         return {};
 
+    // statfs of the mount point is answered by the mount, gvfs or the kernel, without creating the device
+    struct statvfs fs;
+    const QByteArray &mpt = itemData.value(DeviceProperty::kMountPoint).toString().toLocal8Bit();
+    if (::statvfs(mpt.constData(), &fs) == 0 && fs.f_blocks > 0) {
+        const quint64 total = static_cast<quint64>(fs.f_blocks) * fs.f_frsize;
+        const quint64 freeSize = static_cast<quint64>(fs.f_bfree) * fs.f_frsize;
+        return { total, static_cast<quint64>(fs.f_bavail) * fs.f_frsize, total - freeSize };
+    }
+
     auto dev = DeviceHelper::createProtocolDevice(devId);
     if (!dev)
         return {};
@@ -310,9 +426,12 @@ void DeviceWatcher::onBlkDevRemoved(const QString &id)
 
 void DeviceWatcher::onBlkDevMounted(const QString &id, const QString &mpt)
 {
-    const QVariantMap &info = d->allBlockInfos.value(id);
-    // query info async avoid blocking main thread when disks' IO load is too high.
-    QtConcurrent::run(d.data(), &DeviceWatcherPrivate::queryUsageOfItem, info, DFMMOUNT::DeviceType::kBlockDevice);
+    QVariantMap info = d->allBlockInfos.value(id);
+    if (info.value(DeviceProperty::kMountPoint).toString().isEmpty())
+        info[DeviceProperty::kMountPoint] = mpt;
+    d->resetUsagePolling(id);
+    if (!mpt.isEmpty())
+        d->queryUsageOfDevice(id, info, DFMMOUNT::DeviceType::kBlockDevice, true);
     emit DevMngIns->blockDevMounted(id, mpt);
 }
 
@@ -414,6 +533,7 @@ void DeviceWatcher::onProtoDevRemoved(const QString &id)
 void DeviceWatcher::onProtoDevMounted(const QString &id, const QString &mpt)
 {
     d->allProtocolInfos.insert(id, DeviceHelper::loadProtocolInfo(id));
+    d->resetUsagePolling(id);
 
     emit DevMngIns->protocolDevMounted(id, mpt);
 }
@@ -494,5 +614,7 @@ QStringList DeviceWatcher::getSiblings(const QString &id)
 DeviceWatcherPrivate::DeviceWatcherPrivate(DeviceWatcher *qq)
     : QObject(qq), q(qq)
 {
+    pollingClock.start();
+    localQueryPool.setMaxThreadCount(2);
     connect(DevProxyMng, &DeviceProxyManager::devSizeChanged, this, &DeviceWatcherPrivate::updateStorage, Qt::QueuedConnection);
 }
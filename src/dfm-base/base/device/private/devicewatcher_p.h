@@ -8,6 +8,8 @@
 #include <QTimer>
 #include <QMutex>
 #include <QHash>
+#include <QElapsedTimer>
+#include <QThreadPool>
 #include <QtCore/qobjectdefs.h>
 
 #include <dfm-mount/base/dmount_global.h>
@@ -20,20 +22,29 @@ struct DevStorage
     quint64 avai { 0 };
     quint64 used { 0 };
 
-    inline bool operator==(const DevStorage &other)
+    inline bool operator==(const DevStorage &other) const
     {
         return total == other.total && avai == other.avai && used == other.used;
     }
-    inline bool operator!=(const DevStorage &other)
+    inline bool operator!=(const DevStorage &other) const
     {
         return !(this->operator==(other));
     }
-    inline bool isValid()
+    inline bool isValid() const
     {
         return this->operator!=({});
     }
 };
 
+struct UsagePolling
+{
+    DevStorage lastStorage;   // the last one emitted
+    int interval { 0 };   // msecs
+    qint64 nextQuery { 0 };   // msecs of the polling clock
+    quint64 serial { 0 };   // the query running, 0 if none
+    bool stalled { false };   // the query is not answered in time
+};
+
 class DeviceWatcher;
 class DeviceWatcherPrivate : public QObject
 {
@@ -48,15 +59,28 @@ private Q_SLOTS:
     void updateStorage(const QString &id, quint64 total, quint64 avai);
 
 private:
-    void queryUsageOfItem(const QVariantMap &itemData, DFMMOUNT::DeviceType type);
-    DevStorage queryUsageOfBlock(const QVariantMap &itemData);
-    DevStorage queryUsageOfProtocol(const QVariantMap &itemData);
+    void queryUsageOfDevice(const QString &id, const QVariantMap &itemData, DFMMOUNT::DeviceType type, bool force);
+    void onUsageQueried(const QString &id, quint64 serial, const DevStorage &storage);
+    void onUsageQueryTimeout(const QString &id, quint64 serial);
+    int stalledQueryCount() const;
+    void resetUsagePolling(const QString &id);
+    static DevStorage queryUsageOfItem(const QVariantMap &itemData, DFMMOUNT::DeviceType type);
+    static DevStorage queryUsageOfBlock(const QVariantMap &itemData);
+    static DevStorage queryUsageOfProtocol(const QVariantMap &itemData);
 
 private:
     DeviceWatcher *q { nullptr };
 
     QTimer pollingTimer;
     const int kPollingInterval = 10000;
+    const int kMaxPollingInterval = 160000;
+    const int kNetworkQueryTimeout = 5000;
+    const int kMaxStalledQueries = 4;
+
+    QHash<QString, UsagePolling> usagePollings;
+    QElapsedTimer pollingClock;
+    QThreadPool localQueryPool;   // not the global pool the views use
+    quint64 querySerial { 0 };
 
     QHash<QString, QVariantMap> allBlockInfos;
     QHash<QString, QVariantMap> allProtocolInfos;
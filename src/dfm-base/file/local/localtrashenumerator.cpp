@@ -0,0 +1,327 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "localtrashenumerator.h"
+
+#include <dfm-base/dfm_global_defines.h>
+#include <dfm-base/base/standardpaths.h>
+#include <dfm-base/base/device/deviceutils.h>
+#include <dfm-base/utils/finallyutil.h>
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QtConcurrent>
+
+#include <libmount.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace dfmbase;
+
+namespace {
+
+struct TrashInfo
+{
+    qint64 modifyTime { 0 };   // of the .trashinfo file, in nanoseconds
+    QString originalPath;
+    QDateTime deletionDate;
+};
+
+// parsed .trashinfo files of each trash directory, keyed by the item name
+struct TrashInfoCache
+{
+    QMutex mutex;
+    QHash<QString, QHash<QByteArray, TrashInfo>> infos;
+};
+
+Q_GLOBAL_STATIC(TrashInfoCache, trashInfoCache)
+
+struct ParseTask
+{
+    QByteArray name;
+    QString infoPath;
+    TrashInfo info;
+    int itemIndex { -1 };
+};
+
+qint64 modifyTimeOf(const struct stat &st)
+{
+    return static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+bool isDirectory(const QString &path, struct stat *st)
+{
+    return ::lstat(QFile::encodeName(path).constData(), st) == 0 && S_ISDIR(st->st_mode);
+}
+
+// the relative paths in .Trash-$uid and .Trash/$uid are relative to the top directory of the mount
+QString topDirectoryOf(const QString &trashDir)
+{
+    const QString &uid = QString::number(::getuid());
+    QString topDir = trashDir.left(trashDir.lastIndexOf('/'));
+    if (trashDir.endsWith("/.Trash/" + uid))
+        topDir = topDir.left(topDir.lastIndexOf('/'));
+    // empty but not null for the root file system
+    return topDir.isNull() ? QString("") : topDir;
+}
+
+// topDir is null for the home trash, whose paths are absolute
+void parseTrashInfo(const QString &topDir, ParseTask *task)
+{
+    QFile file(task->infoPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    bool inGroup = false;
+    while (!file.atEnd()) {
+        const QByteArray &line = file.readLine().trimmed();
+        if (line.startsWith('[')) {
+            inGroup = line == "[Trash Info]";
+            continue;
+        }
+        if (!inGroup)
+            continue;
+
+        if (line.startsWith("Path=")) {
+            QString path = QFile::decodeName(QByteArray::fromPercentEncoding(line.mid(5)));
+            if (!path.startsWith('/') && !topDir.isNull())
+                path = topDir + "/" + path;
+            task->info.originalPath = path;
+        } else if (line.startsWith("DeletionDate=")) {
+            task->info.deletionDate = QDateTime::fromString(QString::fromLatin1(line.mid(13)), Qt::ISODate);
+        }
+    }
+}
+
+// size, info modify time (seconds) of the directories listed in the home trash
+QHash<QByteArray, QPair<qint64, qint64>> readDirectorySizes(const QString &trashDir)
+{
+    QHash<QByteArray, QPair<qint64, qint64>> sizes;
+    QFile file(trashDir + "/directorysizes");
+    if (!file.open(QIODevice::ReadOnly))
+        return sizes;
+
+    while (!file.atEnd()) {
+        const QList<QByteArray> &fields = file.readLine().trimmed().split(' ');
+        if (fields.size() != 3)
+            continue;
+        sizes.insert(QByteArray::fromPercentEncoding(fields.at(2)),
+                     qMakePair(fields.at(0).toLongLong(), fields.at(1).toLongLong()));
+    }
+    return sizes;
+}
+
+void scanTrashDirectory(const QString &trashDir, bool inHomeTrash, QList<LocalTrashEnumerator::TrashItem> *items)
+{
+    const QString &filesPath = trashDir + "/files";
+    DIR *filesDir = ::opendir(QFile::encodeName(filesPath).constData());
+    if (!filesDir)
+        return;
+    const int infoFd = ::open(QFile::encodeName(trashDir + "/info").constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    FinallyUtil release([&] {
+        ::closedir(filesDir);
+        if (infoFd >= 0)
+            ::close(infoFd);
+    });
+
+    const auto &directorySizes = readDirectorySizes(trashDir);
+    QHash<QByteArray, TrashInfo> cached;
+    {
+        QMutexLocker locker(&trashInfoCache->mutex);
+        cached = trashInfoCache->infos.value(trashDir);
+    }
+
+    QHash<QByteArray, TrashInfo> seen;
+    QList<ParseTask> tasks;
+    const int filesFd = ::dirfd(filesDir);
+    while (struct dirent *entry = ::readdir(filesDir)) {
+        const QByteArray name(entry->d_name);
+        if (name == "." || name == "..")
+            continue;
+
+        struct stat st;
+        if (::fstatat(filesFd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+            continue;
+
+        LocalTrashEnumerator::TrashItem item;
+        item.filePath = filesPath + "/" + QFile::decodeName(name);
+        item.url = LocalTrashEnumerator::trashUrl(item.filePath, inHomeTrash);
+        item.isDir = S_ISDIR(st.st_mode);
+        item.size = item.isDir ? -1 : static_cast<qint64>(st.st_size);
+
+        struct stat infoSt;
+        const QByteArray &infoName = name + ".trashinfo";
+        if (infoFd >= 0 && ::fstatat(infoFd, infoName.constData(), &infoSt, 0) == 0) {
+            const qint64 infoModifyTime = modifyTimeOf(infoSt);
+            if (item.isDir) {
+                auto size = directorySizes.constFind(name);
+                if (size != directorySizes.constEnd() && size->second == infoSt.st_mtim.tv_sec)
+                    item.size = size->first;
+            }
+
+            auto info = cached.constFind(name);
+            if (info != cached.constEnd() && info->modifyTime == infoModifyTime) {
+                item.originalPath = info->originalPath;
+                item.deletionDate = info->deletionDate;
+                seen.insert(name, info.value());
+            } else {
+                ParseTask task;
+                task.name = name;
+                task.infoPath = trashDir + "/info/" + QFile::decodeName(infoName);
+                task.info.modifyTime = infoModifyTime;
+                task.itemIndex = items->size();
+                tasks.append(task);
+            }
+        }
+        items->append(item);
+    }
+
+    if (!tasks.isEmpty()) {
+        const QString &topDir = inHomeTrash ? QString() : topDirectoryOf(trashDir);
+        QtConcurrent::blockingMap(tasks, [&topDir](ParseTask &task) {
+            parseTrashInfo(topDir, &task);
+        });
+        for (const ParseTask &task : tasks) {
+            LocalTrashEnumerator::TrashItem &item = (*items)[task.itemIndex];
+            item.originalPath = task.info.originalPath;
+            item.deletionDate = task.info.deletionDate;
+            seen.insert(task.name, task.info);
+        }
+    }
+
+    // drop the entries of the removed items
+    QMutexLocker locker(&trashInfoCache->mutex);
+    trashInfoCache->infos.insert(trashDir, seen);
+}
+
+}   // namespace
+
+LocalTrashEnumerator::LocalTrashEnumerator()
+    : LocalTrashEnumerator(homeTrashDirectory(), mountTrashDirectories())
+{
+}
+
+LocalTrashEnumerator::LocalTrashEnumerator(const QString &homeTrashDir, const QStringList &mountTrashDirs)
+    : homeTrashDir(homeTrashDir),
+      mountTrashDirs(mountTrashDirs)
+{
+}
+
+QList<LocalTrashEnumerator::TrashItem> LocalTrashEnumerator::items() const
+{
+    QList<TrashItem> result;
+    if (!homeTrashDir.isEmpty())
+        scanTrashDirectory(homeTrashDir, true, &result);
+    for (const QString &dir : mountTrashDirs)
+        scanTrashDirectory(dir, false, &result);
+    return result;
+}
+
+QString LocalTrashEnumerator::homeTrashDirectory()
+{
+    return StandardPaths::location(StandardPaths::kTrashLocalPath);
+}
+
+/*!
+ * \brief LocalTrashEnumerator::mountTrashDirectories the trash directories of the current user
+ * on the mounted file systems, each directory is listed once even if it is mounted several times.
+ * The sources of the bind mounts in fstab are skipped as before, their items are shown
+ * through the bind targets.
+ */
+QStringList LocalTrashEnumerator::mountTrashDirectories()
+{
+    QStringList dirs;
+    libmnt_table *tab { mnt_new_table() };
+    libmnt_iter *iter { mnt_new_iter(MNT_ITER_FORWARD) };
+    FinallyUtil release([&] {
+        if (tab) mnt_free_table(tab);
+        if (iter) mnt_free_iter(iter);
+    });
+
+    if (mnt_table_parse_mtab(tab, nullptr) != 0) {
+        qCWarning(logDFMBase) << "trash: cannot parse mtab";
+        return dirs;
+    }
+
+    const QString &uid = QString::number(::getuid());
+    const QStringList &bindSources = DeviceUtils::fstabBindInfo().keys();
+    QSet<QPair<quint64, quint64>> inodes;
+    auto addDir = [&](const QString &dir) {
+        struct stat st;
+        if (!isDirectory(dir, &st))
+            return;
+        if (std::any_of(bindSources.cbegin(), bindSources.cend(), [&dir](const QString &source) { return dir.startsWith(source); }))
+            return;
+        const auto &inode = qMakePair(static_cast<quint64>(st.st_dev), static_cast<quint64>(st.st_ino));
+        if (inodes.contains(inode))
+            return;
+        inodes.insert(inode);
+        dirs.append(dir);
+    };
+
+    struct stat homeSt;
+    if (isDirectory(homeTrashDirectory(), &homeSt))
+        inodes.insert(qMakePair(static_cast<quint64>(homeSt.st_dev), static_cast<quint64>(homeSt.st_ino)));
+
+    libmnt_fs *fs = nullptr;
+    while (mnt_table_next_fs(tab, iter, &fs) == 0) {
+        if (!fs || mnt_fs_is_pseudofs(fs) || mnt_fs_is_netfs(fs))
+            continue;
+
+        QString target = QFile::decodeName(mnt_fs_get_target(fs));
+        if (target == "/")
+            target.clear();
+
+        // the shared .Trash must be a sticky directory, not a link
+        struct stat st;
+        const QString &sharedTrash = target + "/.Trash";
+        if (isDirectory(sharedTrash, &st) && (st.st_mode & S_ISVTX))
+            addDir(sharedTrash + "/" + uid);
+        addDir(target + "/.Trash-" + uid);
+    }
+
+    return dirs;
+}
+
+/*!
+ * \brief LocalTrashEnumerator::trashUrl the url of an item as named by the gvfs trash backend.
+ * Items of the home trash use their name, a leading '\' or '`' is escaped by '`'.
+ * Other items use the full path with '\' escaped as "`\", '`' as "``" and '/' replaced by '\'.
+ */
+QUrl LocalTrashEnumerator::trashUrl(const QString &filePath, bool inHomeTrash)
+{
+    QString name;
+    if (inHomeTrash) {
+        name = filePath.mid(filePath.lastIndexOf('/') + 1);
+        if (name.startsWith('\\') || name.startsWith('`'))
+            name.prepend('`');
+    } else {
+        name.reserve(filePath.size() + 8);
+        for (const QChar &c : filePath) {
+            if (c == '/')
+                name.append('\\');
+            else if (c == '\\')
+                name.append("`\\");
+            else if (c == '`')
+                name.append("``");
+            else
+                name.append(c);
+        }
+    }
+
+    QUrl url;
+    url.setScheme(Global::Scheme::kTrash);
+    url.setPath("/" + name);
+    return url;
+}
+
+void LocalTrashEnumerator::clearCache()
+{
+    QMutexLocker locker(&trashInfoCache->mutex);
+    trashInfoCache->infos.clear();
+}
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LOCALTRASHENUMERATOR_H
+#define LOCALTRASHENUMERATOR_H
+
+#include <dfm-base/dfm_base_global.h>
+
+#include <QDateTime>
+#include <QList>
+#include <QStringList>
+#include <QUrl>
+
+namespace dfmbase {
+
+/*!
+ * \brief The LocalTrashEnumerator class lists the top level items of the trash without gvfsd.
+ * It reads the files and info directories of the home trash and of the .Trash/$uid and
+ * .Trash-$uid directories on the mounted file systems directly. The .trashinfo files are
+ * parsed in parallel and kept in a process wide cache keyed by name and modify time, so
+ * listing the trash again only parses the new ones.
+ * The urls of the items follow the naming of the gvfs trash backend.
+ */
+class LocalTrashEnumerator
+{
+public:
+    struct TrashItem
+    {
+        QUrl url;   // trash:///...
+        QString filePath;   // the item in the files directory
+        QString originalPath;
+        QDateTime deletionDate;
+        qint64 size { -1 };   // -1 if the size of a directory is unknown
+        bool isDir { false };
+    };
+
+    LocalTrashEnumerator();
+    LocalTrashEnumerator(const QString &homeTrashDir, const QStringList &mountTrashDirs);
+
+    QList<TrashItem> items() const;
+
+    static QString homeTrashDirectory();
+    static QStringList mountTrashDirectories();
+    static QUrl trashUrl(const QString &filePath, bool inHomeTrash);
+    static void clearCache();
+
+private:
+    QString homeTrashDir;
+    QStringList mountTrashDirs;
+};
+
+}
+
+#endif   // LOCALTRASHENUMERATOR_H
@@ -50,3 +50,8 @@ void AbstractBasePreview::stop()
 void AbstractBasePreview::handleBeforDestroy()
 {
 }
+
+void AbstractBasePreview::prefetch(const QList<QUrl> &urls)
+{
+    Q_UNUSED(urls)
+}
@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "desktopfileindex.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+
+#include <sys/stat.h>
+
+using namespace dfmbase;
+
+static constexpr quint32 kIndexMagic { 0x44464449 };   // "DFDI"
+static constexpr quint32 kIndexVersion { 1 };
+
+static bool modifyTimeOf(const QString &path, qint64 *modifyTime)
+{
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+
+    *modifyTime = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+DesktopFileIndex::DesktopFileIndex(const QString &indexFile)
+    : indexFile(indexFile)
+{
+}
+
+bool DesktopFileIndex::load()
+{
+    QFile file(indexFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 size = file.size();
+    uchar *data = size > 0 ? file.map(0, size) : nullptr;
+    if (!data)
+        return false;
+
+    const QByteArray &raw = QByteArray::fromRawData(reinterpret_cast<const char *>(data), static_cast<int>(size));
+    QDataStream in(raw);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString locale;
+    in >> magic >> version >> locale;
+    // the localized names depend on the system locale
+    if (magic != kIndexMagic || version != kIndexVersion || locale != QLocale::system().name()) {
+        file.unmap(data);
+        return false;
+    }
+
+    quint32 count = 0;
+    in >> count;
+    QStringList paths;
+    QHash<QString, Entry> loaded;
+    loaded.reserve(static_cast<int>(count));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Entry entry;
+        in >> path >> entry.modifyTime >> entry.createTime >> entry.file;
+        paths.append(path);
+        loaded.insert(path, entry);
+    }
+
+    const bool ok = in.status() == QDataStream::Ok;
+    file.unmap(data);
+    if (!ok) {
+        qCWarning(logDFMBase) << "broken desktop file index:" << indexFile;
+        return false;
+    }
+
+    entryPaths = paths;
+    entries.swap(loaded);
+    return true;
+}
+
+bool DesktopFileIndex::save() const
+{
+    QDir().mkpath(QFileInfo(indexFile).absolutePath());
+
+    // readers must never see a half written index
+    QSaveFile file(indexFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(logDFMBase) << "failed to write desktop file index:" << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << kIndexMagic << kIndexVersion << QLocale::system().name();
+    out << static_cast<quint32>(entryPaths.size());
+    for (const QString &path : entryPaths) {
+        const Entry &entry = *entries.constFind(path);
+        out << path << entry.modifyTime << entry.createTime << entry.file;
+    }
+
+    return file.commit();
+}
+
+bool DesktopFileIndex::refresh(const QStringList &folders)
+{
+    QStringList paths;
+    QHash<QString, Entry> refreshed;
+    refreshed.reserve(entries.size());
+    bool changed = false;
+
+    for (const QString &folder : folders) {
+        QDirIterator it(folder, QStringList("*.desktop"), QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const QString &path = it.next();
+            qint64 modifyTime = 0;
+            if (refreshed.contains(path) || !modifyTimeOf(path, &modifyTime))
+                continue;
+
+            auto old = entries.constFind(path);
+            if (old != entries.constEnd() && old->modifyTime == modifyTime) {
+                refreshed.insert(path, old.value());
+            } else {
+                Entry entry;
+                entry.modifyTime = modifyTime;
+                entry.createTime = QFileInfo(path).created().toMSecsSinceEpoch();
+                entry.file = DesktopFile(path);
+                refreshed.insert(path, entry);
+                changed = true;
+            }
+            paths.append(path);
+        }
+    }
+
+    // every refreshed path was found unchanged in the old index, so equal sizes mean nothing was removed
+    changed = changed || refreshed.size() != entries.size();
+    if (!changed)
+        return false;
+
+    entryPaths = paths;
+    entries.swap(refreshed);
+    return true;
+}
+
+QStringList DesktopFileIndex::paths() const
+{
+    return entryPaths;
+}
+
+const DesktopFileIndex::Entry *DesktopFileIndex::entry(const QString &path) const
+{
+    auto it = entries.constFind(path);
+    return it == entries.constEnd() ? nullptr : &it.value();
+}
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DESKTOPFILEINDEX_H
+#define DESKTOPFILEINDEX_H
+
+#include <dfm-base/dfm_base_global.h>
+#include <dfm-base/utils/desktopfile.h>
+
+#include <QHash>
+#include <QStringList>
+
+namespace dfmbase {
+
+/*!
+ * \brief The DesktopFileIndex class keeps the parsed desktop entries of the applications folders.
+ * Entries are keyed by the file path and remember the modify time of the file, a refresh only
+ * stats the folders and parses the desktop files which were added or changed.
+ * The index is stored in one binary file which is mapped and read in one pass on load.
+ * It is not thread safe.
+ */
+class DesktopFileIndex
+{
+public:
+    struct Entry
+    {
+        qint64 modifyTime { 0 };   // in nanoseconds
+        qint64 createTime { 0 };   // in milliseconds, orders the apps of a mimetype
+        DesktopFile file;
+    };
+
+    explicit DesktopFileIndex(const QString &indexFile);
+
+    bool load();
+    bool save() const;
+    bool refresh(const QStringList &folders);
+
+    QStringList paths() const;
+    const Entry *entry(const QString &path) const;
+
+private:
+    QString indexFile;
+    QStringList entryPaths;   // in scan order
+    QHash<QString, Entry> entries;
+};
+
+}
+
+#endif   // DESKTOPFILEINDEX_H
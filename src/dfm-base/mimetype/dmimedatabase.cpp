@@ -7,11 +7,16 @@
 #include <dfm-base/utils/fileutils.h>
 #include <dfm-base/base/schemefactory.h>
 #include <dfm-base/base/device/deviceutils.h>
+#include <dfm-base/mimetype/mimetypecache.h>
 
 #include <QUrl>
+#include <QFile>
 #include <QFileInfo>
 #include <QRegularExpression>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 using namespace dfmbase;
 
 static QStringList wrongMimeTypeNames {
@@ -35,8 +40,6 @@ QMimeType DMimeDatabase::mimeTypeForFile(const QUrl &url, QMimeDatabase::MatchMo
 QMimeType DMimeDatabase::mimeTypeForFile(const FileInfoPointer &fileInfo, QMimeDatabase::MatchMode mode) const
 {
     // 如果是低速设备，则先从扩展名去获取mime信息；对于本地文件，保持默认的获取策略
-    QMimeType result;
-
     if (!fileInfo)
         return QMimeType();
 
@@ -46,15 +49,7 @@ QMimeType DMimeDatabase::mimeTypeForFile(const FileInfoPointer &fileInfo, QMimeD
         //fix bug 35448 【文件管理器】【5.1.2.2-1】【sp2】预览ftp路径下某个文件夹后，文管卡死,访问特殊系统文件卡死
         if (fileInfo->nameOf(NameInfoType::kFileName).endsWith(".pid") || path.endsWith("msg.lock")
             || fileInfo->nameOf(NameInfoType::kFileName).endsWith(".lock") || fileInfo->nameOf(NameInfoType::kFileName).endsWith("lockfile")) {
-            QRegularExpression regExp("^/run/user/\\d+/gvfs/(?<scheme>\\w+(-?)\\w+):\\S*",
-                                      QRegularExpression::DotMatchesEverythingOption
-                                              | QRegularExpression::DontCaptureOption
-                                              | QRegularExpression::OptimizeOnFirstUsageOption);
-
-            const QRegularExpressionMatch &match = regExp.match(path, 0, QRegularExpression::NormalMatch,
-                                                                QRegularExpression::DontCheckSubjectStringMatchOption);
-
-            isMatchExtension = match.hasMatch();
+            isMatchExtension = isGvfsPath(path);
         } else {
             // filemanger will be blocked when blacklist contais the filepath.
             QString filePath = fileInfo->pathOf(PathInfoType::kAbsoluteFilePath);
@@ -65,49 +60,85 @@ QMimeType DMimeDatabase::mimeTypeForFile(const FileInfoPointer &fileInfo, QMimeD
         }
     }
 
-    if (isMatchExtension || DeviceUtils::isLowSpeedDevice(QUrl::fromLocalFile(path))) {
-        result = QMimeDatabase::mimeTypeForFile(fileInfo->pathOf(PathInfoType::kFilePath), QMimeDatabase::MatchExtension);
-    } else {
-        result = QMimeDatabase::mimeTypeForFile(fileInfo->pathOf(PathInfoType::kFilePath), mode);
-    }
+    const QString &filePath = fileInfo->pathOf(PathInfoType::kFilePath);
+    if (isMatchExtension || DeviceUtils::isLowSpeedDevice(QUrl::fromLocalFile(path)))
+        return fixOfficeMimeType(QMimeDatabase::mimeTypeForFile(filePath, QMimeDatabase::MatchExtension),
+                                 fileInfo->nameOf(NameInfoType::kSuffix), fileInfo->nameOf(NameInfoType::kFileName));
 
-    // temporary dirty fix, once WPS get installed, the whole mimetype database thing get fscked up.
-    // we used to patch our Qt to fix this issue but the patch no longer works, we don't have time to
-    // look into this issue ATM.
-    // https://bugreports.qt.io/browse/QTBUG-71640
-    // https://codereview.qt-project.org/c/qt/qtbase/+/244887
-    // `file` command works but libmagic didn't even comes with any pkg-config support..
+    MimeTypeCache::Key key;
+    const bool canCache = MimeTypeCache::makeKey(filePath, mode, &key);
+    QMimeType result;
+    if (canCache && MimeTypeCache::instance()->find(key, &result))
+        return result;
+
+    result = fixOfficeMimeType(QMimeDatabase::mimeTypeForFile(filePath, mode),
+                               fileInfo->nameOf(NameInfoType::kSuffix), fileInfo->nameOf(NameInfoType::kFileName));
+    if (canCache)
+        MimeTypeCache::instance()->insert(key, result);
 
-    if (officeSuffixList.contains(fileInfo->nameOf(NameInfoType::kSuffix))
-        && wrongMimeTypeNames.contains(result.name())) {
-        QList<QMimeType> results = QMimeDatabase::mimeTypesForFileName(fileInfo->nameOf(NameInfoType::kFileName));
-        if (!results.isEmpty()) {
-            return results.first();
-        }
-    }
     return result;
 }
 
 QMimeType DMimeDatabase::mimeTypeForFile(const QString &fileName, QMimeDatabase::MatchMode mode, const QString &inod, const bool isGvfs) const
 {
-    if (!inod.isEmpty() && inodMimetypeCache.contains(inod)) {
-        return inodMimetypeCache.value(inod);
-    }
     return mimeTypeForFile(QFileInfo(fileName), mode, inod, isGvfs);
 }
 
+/*!
+ * \brief DMimeDatabase::mimeTypesForFiles, the mimetypes of urls in the same order,
+ * the files in the same directory are looked up in the cache through one directory fd,
+ * call it once for all the files of a directory to fill the cache before they are used one by one.
+ */
+QList<QMimeType> DMimeDatabase::mimeTypesForFiles(const QList<QUrl> &urls, QMimeDatabase::MatchMode mode) const
+{
+    QList<QMimeType> results;
+    results.reserve(urls.size());
+
+    QString dirPath;
+    int dirFd = -1;
+    bool isLowSpeed = false;
+    for (const QUrl &url : urls) {
+        if (!url.isLocalFile()) {
+            results.append(mimeTypeForFile(url, mode));
+            continue;
+        }
+
+        const QFileInfo info(url.toLocalFile());
+        if (info.path() != dirPath) {
+            if (dirFd >= 0)
+                ::close(dirFd);
+            dirPath = info.path();
+            dirFd = ::open(QFile::encodeName(dirPath).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            isLowSpeed = DeviceUtils::isLowSpeedDevice(QUrl::fromLocalFile(dirPath));
+        }
+
+        // the files on low speed devices are matched by extension, they are not cached
+        MimeTypeCache::Key key;
+        QMimeType result;
+        if (!isLowSpeed && mode != QMimeDatabase::MatchExtension && dirFd >= 0
+            && MimeTypeCache::makeKey(dirFd, QFile::encodeName(info.fileName()), mode, &key)
+            && MimeTypeCache::instance()->find(key, &result)) {
+            results.append(result);
+            continue;
+        }
+
+        results.append(mimeTypeForFile(info, mode, QString()));
+    }
+
+    if (dirFd >= 0)
+        ::close(dirFd);
+
+    return results;
+}
+
 QMimeType DMimeDatabase::mimeTypeForFile(const QFileInfo &fileInfo, QMimeDatabase::MatchMode mode, const QString &inod, const bool isGvfs) const
 {
+    Q_UNUSED(inod)
     Q_UNUSED(isGvfs)
     // 如果是低速设备，则先从扩展名去获取mime信息；对于本地文件，保持默认的获取策略
-    bool canCache = !inod.isEmpty();
-    if (!inod.isEmpty() && inodMimetypeCache.contains(inod)) {
-        return inodMimetypeCache.value(inod);
-    }
     if (fileInfo.isDir()) {
         return QMimeDatabase::mimeTypeForFile(QFileInfo("/home"), mode);
     }
-    QMimeType result;
     QString path = fileInfo.path();
 
     bool isMatchExtension = mode == QMimeDatabase::MatchExtension;
@@ -116,15 +147,7 @@ QMimeType DMimeDatabase::mimeTypeForFile(const QFileInfo &fileInfo, QMimeDatabas
     if (!isMatchExtension) {
         if (fileInfo.fileName().endsWith(".pid") || path.endsWith("msg.lock")
             || fileInfo.fileName().endsWith(".lock") || fileInfo.fileName().endsWith("lockfile")) {
-            QRegularExpression regExp("^/run/user/\\d+/gvfs/(?<scheme>\\w+(-?)\\w+):\\S*",
-                                      QRegularExpression::DotMatchesEverythingOption
-                                              | QRegularExpression::DontCaptureOption
-                                              | QRegularExpression::OptimizeOnFirstUsageOption);
-
-            const QRegularExpressionMatch &match = regExp.match(path, 0, QRegularExpression::NormalMatch,
-                                                                QRegularExpression::DontCheckSubjectStringMatchOption);
-
-            isMatchExtension = match.hasMatch();
+            isMatchExtension = isGvfsPath(path);
         } else {
             // filemanger will be blocked when blacklist contais the filepath.
             // fix task #29124, bug #108805
@@ -135,12 +158,37 @@ QMimeType DMimeDatabase::mimeTypeForFile(const QFileInfo &fileInfo, QMimeDatabas
             isMatchExtension = blackList.contains(filePath);
         }
     }
-    if (isMatchExtension || DeviceUtils::isLowSpeedDevice(QUrl::fromLocalFile(path))) {
-        result = QMimeDatabase::mimeTypeForFile(fileInfo, QMimeDatabase::MatchExtension);
-    } else {
-        result = QMimeDatabase::mimeTypeForFile(fileInfo, mode);
-    }
+    if (isMatchExtension || DeviceUtils::isLowSpeedDevice(QUrl::fromLocalFile(path)))
+        return fixOfficeMimeType(QMimeDatabase::mimeTypeForFile(fileInfo, QMimeDatabase::MatchExtension),
+                                 fileInfo.suffix(), fileInfo.fileName());
 
+    MimeTypeCache::Key key;
+    const bool canCache = MimeTypeCache::makeKey(fileInfo.absoluteFilePath(), mode, &key);
+    QMimeType result;
+    if (canCache && MimeTypeCache::instance()->find(key, &result))
+        return result;
+
+    result = fixOfficeMimeType(QMimeDatabase::mimeTypeForFile(fileInfo, mode), fileInfo.suffix(), fileInfo.fileName());
+    if (canCache)
+        MimeTypeCache::instance()->insert(key, result);
+
+    return result;
+}
+
+bool DMimeDatabase::isGvfsPath(const QString &path)
+{
+    static const QRegularExpression regExp("^/run/user/\\d+/gvfs/(?<scheme>\\w+(-?)\\w+):\\S*",
+                                           QRegularExpression::DotMatchesEverythingOption
+                                                   | QRegularExpression::DontCaptureOption
+                                                   | QRegularExpression::OptimizeOnFirstUsageOption);
+
+    const QRegularExpressionMatch &match = regExp.match(path, 0, QRegularExpression::NormalMatch,
+                                                        QRegularExpression::DontCheckSubjectStringMatchOption);
+    return match.hasMatch();
+}
+
+QMimeType DMimeDatabase::fixOfficeMimeType(const QMimeType &result, const QString &suffix, const QString &fileName) const
+{
     // temporary dirty fix, once WPS get installed, the whole mimetype database thing get fscked up.
     // we used to patch our Qt to fix this issue but the patch no longer works, we don't have time to
     // look into this issue ATM.
@@ -148,18 +196,12 @@ QMimeType DMimeDatabase::mimeTypeForFile(const QFileInfo &fileInfo, QMimeDatabas
     // https://codereview.qt-project.org/c/qt/qtbase/+/244887
     // `file` command works but libmagic didn't even comes with any pkg-config support..
 
-    if (officeSuffixList.contains(fileInfo.suffix()) && wrongMimeTypeNames.contains(result.name())) {
-        QList<QMimeType> results = QMimeDatabase::mimeTypesForFileName(fileInfo.fileName());
+    if (officeSuffixList.contains(suffix) && wrongMimeTypeNames.contains(result.name())) {
+        QList<QMimeType> results = QMimeDatabase::mimeTypesForFileName(fileName);
         if (!results.isEmpty()) {
-            if (canCache) {
-                const_cast<DMimeDatabase *>(this)->inodMimetypeCache.insert(inod, results.first());
-            }
             return results.first();
         }
     }
-    if (canCache) {
-        const_cast<DMimeDatabase *>(this)->inodMimetypeCache.insert(inod, result);
-    }
     return result;
 }
 
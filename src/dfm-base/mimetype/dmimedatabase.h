@@ -23,12 +23,12 @@ public:
     QMimeType mimeTypeForFile(const FileInfoPointer &fileInfo, MatchMode mode = MatchDefault) const;
     QMimeType mimeTypeForFile(const QString &fileName, MatchMode mode, const QString &inod, const bool isGvfs = false) const;
     QMimeType mimeTypeForUrl(const QUrl &url) const;
+    QList<QMimeType> mimeTypesForFiles(const QList<QUrl> &urls, MatchMode mode = MatchDefault) const;
 
 private:
     QMimeType mimeTypeForFile(const QFileInfo &fileInfo, MatchMode mode, const QString &inod, const bool isGvfs = false) const;
-
-private:
-    QHash<QString, QMimeType> inodMimetypeCache;
+    QMimeType fixOfficeMimeType(const QMimeType &result, const QString &suffix, const QString &fileName) const;
+    static bool isGvfsPath(const QString &path);
 };
 
 }
@@ -6,6 +6,7 @@
 
 #include <dfm-base/mimetype/dmimedatabase.h>
 #include <dfm-base/mimetype/mimetypedisplaymanager.h>
+#include <dfm-base/mimetype/desktopfileindex.h>
 #include <dfm-base/base/standardpaths.h>
 
 #include <QDir>
@@ -22,6 +23,9 @@
 #include <QDebug>
 #include <QUrl>
 #include <QStandardPaths>
+#include <QMutex>
+
+#include <sys/stat.h>
 
 #undef signals
 extern "C" {
@@ -34,7 +38,7 @@ extern "C" {
 using namespace dfmbase;
 
 QStringList MimesAppsManager::DesktopFiles = {};
-QMap<QString, QStringList> MimesAppsManager::MimeApps = {};
+QHash<QString, QStringList> MimesAppsManager::MimeApps = {};
 QMap<QString, QStringList> MimesAppsManager::DDE_MimeTypes = {};
 QMap<QString, DesktopFile> MimesAppsManager::VideoMimeApps = {};
 QMap<QString, DesktopFile> MimesAppsManager::ImageMimeApps = {};
@@ -298,6 +302,8 @@ QStringList MimesAppsManager::getRecommendedApps(const QUrl &url)
 QStringList MimesAppsManager::getRecommendedAppsByQio(const QMimeType &mimeType)
 {
     QStringList recommendApps;
+    // exec and local name of the recommended apps, the same app may be installed in several folders
+    QSet<QPair<QString, QString>> recommendKeys;
     QList<QMimeType> mimeTypeList;
     DFMBASE_NAMESPACE::DMimeDatabase mimeDatabase;
 
@@ -310,19 +316,17 @@ QStringList MimesAppsManager::getRecommendedAppsByQio(const QMimeType &mimeType)
             typeNameList.append(type.name());
             typeNameList.append(type.aliases());
 
-            foreach (const QString &name, typeNameList) {
-                foreach (const QString &app, MimesAppsManager::MimeApps.value(name)) {
-                    bool appExist = false;
-
-                    for (const QString &other : recommendApps) {
-                        const DesktopFile &appDesktop = MimesAppsManager::DesktopObjs.value(app);
-                        const DesktopFile &otherDesktop = MimesAppsManager::DesktopObjs.value(other);
+            for (const QString &name : typeNameList) {
+                auto apps = MimesAppsManager::MimeApps.constFind(name);
+                if (apps == MimesAppsManager::MimeApps.constEnd())
+                    continue;
 
-                        if (appDesktop.desktopExec() == otherDesktop.desktopExec() && appDesktop.desktopLocalName() == otherDesktop.desktopLocalName()) {
-                            appExist = true;
-                            break;
-                        }
-                    }
+                for (const QString &app : apps.value()) {
+                    auto desktop = MimesAppsManager::DesktopObjs.constFind(app);
+                    const QPair<QString, QString> key = desktop == MimesAppsManager::DesktopObjs.constEnd()
+                            ? qMakePair(QString(), QString())
+                            : qMakePair(desktop->desktopExec(), desktop->desktopLocalName());
+                    const bool appExist = recommendKeys.contains(key);
 
                     // if desktop file was not existed do not recommend!!
                     if (!QFileInfo::exists(app)) {
@@ -330,8 +334,10 @@ QStringList MimesAppsManager::getRecommendedAppsByQio(const QMimeType &mimeType)
                         continue;
                     }
 
-                    if (!appExist)
+                    if (!appExist) {
                         recommendApps.append(app);
+                        recommendKeys.insert(key);
+                    }
                 }
             }
         }
@@ -454,6 +460,11 @@ QString MimesAppsManager::getDesktopIconsCacheFile()
     return QString("%1/%2").arg(StandardPaths::location(StandardPaths::kCachePath), "DesktopIcons.json");
 }
 
+QString MimesAppsManager::getDesktopEntriesIndexFile()
+{
+    return QString("%1/%2").arg(StandardPaths::location(StandardPaths::kCachePath), "DesktopEntries.index");
+}
+
 QString MimesAppsManager::getDDEMimeTypeFile()
 {
     return QString("%1/%2/%3").arg(getMimeInfoCacheFileRootPath(), "deepin", "dde-mimetype.list");
@@ -471,63 +482,69 @@ QMap<QString, DesktopFile> MimesAppsManager::getDesktopObjs()
 void MimesAppsManager::initMimeTypeApps()
 {
     qCDebug(logDFMBase) << "getMimeTypeApps in" << QThread::currentThread() << qApp->thread();
-    DesktopFiles.clear();
-    DesktopObjs.clear();
-    DDE_MimeTypes.clear();
 
-    QMap<QString, QSet<QString>> mimeAppsSet;
+    // called by the worker and by the menus in the main thread
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+
+    static DesktopFileIndex index(getDesktopEntriesIndexFile());
+    static bool built = false;
+    static qint64 mimeInfoModifyTime = -1;
+    if (!built)
+        index.load();
+
+    const QMap<QString, QStringList> oldDDEMimeTypes = DDE_MimeTypes;
+    DDE_MimeTypes.clear();
     loadDDEMimeTypes();
-    for (const QString &desktopFolder : getApplicationsFolders()) {
-        QDirIterator it(desktopFolder, QStringList("*.desktop"), QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
-        while (it.hasNext()) {
-            it.next();
-            const QString &filePath = it.filePath();
-            DesktopFile desktopFile(filePath);
-            if (desktopFile.isNoShow())
-                continue;
 
-            DesktopFiles.append(filePath);
-            DesktopObjs.insert(filePath, desktopFile);
-            QStringList mimeTypes = desktopFile.desktopMimeType();
-            QString fileName = QFileInfo(filePath).fileName();
-            if (DDE_MimeTypes.contains(fileName)) {
-                mimeTypes.append(DDE_MimeTypes.value(fileName));
-            }
+    const bool indexChanged = index.refresh(getApplicationsFolders());
+    if (indexChanged)
+        index.save();
 
-            for (const QString &mimeType : mimeTypes) {
-                if (!mimeType.isEmpty()) {
-                    QSet<QString> apps;
-                    if (mimeAppsSet.contains(mimeType)) {
-                        apps = mimeAppsSet.value(mimeType);
-                        apps.insert(filePath);
-                    } else {
-                        apps.insert(filePath);
-                    }
-                    mimeAppsSet.insert(mimeType, apps);
-                }
-            }
-        }
-    }
+    struct stat st;
+    const qint64 modifyTime = ::stat(QFile::encodeName(getMimeInfoCacheFilePath()).constData(), &st) == 0
+            ? static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec
+            : 0;
+    if (built && !indexChanged && oldDDEMimeTypes == DDE_MimeTypes && mimeInfoModifyTime == modifyTime)
+        return;
 
-    for (const QString &key : mimeAppsSet.keys()) {
-        QSet<QString> apps = mimeAppsSet.value(key);
-        QStringList orderApps;
-        if (apps.count() > 1) {
-            QFileInfoList fileInfos;
-            for (const QString &app : apps) {
-                QFileInfo info(app);
-                fileInfos.append(info);
-            }
+    built = true;
+    mimeInfoModifyTime = modifyTime;
+    DesktopFiles.clear();
+    DesktopObjs.clear();
+    MimeApps.clear();
 
-            std::sort(fileInfos.begin(), fileInfos.end(), MimesAppsManager::lessByDateTime);
+    QHash<QString, QSet<QString>> mimeAppsSet;
+    for (const QString &filePath : index.paths()) {
+        const DesktopFile &desktopFile = index.entry(filePath)->file;
+        if (desktopFile.isNoShow())
+            continue;
 
-            for (const QFileInfo &info : fileInfos) {
-                orderApps.append(info.absoluteFilePath());
-            }
-        } else {
-            orderApps.append(apps.toList());
+        DesktopFiles.append(filePath);
+        DesktopObjs.insert(filePath, desktopFile);
+        QStringList mimeTypes = desktopFile.desktopMimeType();
+        const QString &fileName = filePath.mid(filePath.lastIndexOf('/') + 1);
+        auto ddeMimeTypes = DDE_MimeTypes.constFind(fileName);
+        if (ddeMimeTypes != DDE_MimeTypes.constEnd())
+            mimeTypes.append(ddeMimeTypes.value());
+
+        for (const QString &mimeType : mimeTypes) {
+            if (!mimeType.isEmpty())
+                mimeAppsSet[mimeType].insert(filePath);
+        }
+    }
+
+    // the create time is kept in the index, no need to stat the apps again
+    for (auto it = mimeAppsSet.cbegin(); it != mimeAppsSet.cend(); ++it) {
+        QStringList orderApps = it.value().values();
+        if (orderApps.count() > 1) {
+            std::sort(orderApps.begin(), orderApps.end(), [](const QString &app1, const QString &app2) {
+                const qint64 time1 = index.entry(app1)->createTime;
+                const qint64 time2 = index.entry(app2)->createTime;
+                return time1 == time2 ? app1 < app2 : time1 < time2;
+            });
         }
-        MimeApps.insert(key, orderApps);
+        MimeApps.insert(it.key(), orderApps);
     }
 
     //check mime apps from cache
@@ -570,37 +587,25 @@ void MimesAppsManager::initMimeTypeApps()
     f.close();
 
     const QString &mimeInfoCacheRootPath = getMimeInfoCacheFileRootPath();
-    for (const QString &desktop : audioDesktopList) {
-        const QString path = QString("%1/%2").arg(mimeInfoCacheRootPath, desktop);
-        if (!QFile::exists(path))
-            continue;
-        DesktopFile df(path);
-        AudioMimeApps.insert(path, df);
-    }
-
-    for (const QString &desktop : imageDeksopList) {
-        const QString path = QString("%1/%2").arg(mimeInfoCacheRootPath, desktop);
-        if (!QFile::exists(path))
-            continue;
-        DesktopFile df(path);
-        ImageMimeApps.insert(path, df);
-    }
-
-    for (const QString &desktop : textDekstopList) {
-        const QString path = QString("%1/%2").arg(mimeInfoCacheRootPath, desktop);
-        if (!QFile::exists(path))
-            continue;
-        DesktopFile df(path);
-        TextMimeApps.insert(path, df);
-    }
-
-    for (const QString &desktop : videoDesktopList) {
-        const QString path = QString("%1/%2").arg(mimeInfoCacheRootPath, desktop);
-        if (!QFile::exists(path))
-            continue;
-        DesktopFile df(path);
-        VideoMimeApps.insert(path, df);
-    }
+    auto fillApps = [&mimeInfoCacheRootPath](const QStringList &desktops, QMap<QString, DesktopFile> *apps) {
+        apps->clear();
+        for (const QString &desktop : desktops) {
+            const QString path = QString("%1/%2").arg(mimeInfoCacheRootPath, desktop);
+            // most of them are parsed in the index already
+            if (const DesktopFileIndex::Entry *entry = index.entry(path)) {
+                apps->insert(path, entry->file);
+                continue;
+            }
+            if (!QFile::exists(path))
+                continue;
+            DesktopFile df(path);
+            apps->insert(path, df);
+        }
+    };
+    fillApps(audioDesktopList, &AudioMimeApps);
+    fillApps(imageDeksopList, &ImageMimeApps);
+    fillApps(textDekstopList, &TextMimeApps);
+    fillApps(videoDesktopList, &VideoMimeApps);
 
     return;
 }
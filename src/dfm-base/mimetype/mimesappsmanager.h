@@ -14,6 +14,7 @@
 #include <QSet>
 #include <QMimeType>
 #include <QMap>
+#include <QHash>
 #include <QFileInfo>
 #include <QTimer>
 #include <QIcon>
@@ -54,7 +55,7 @@ public:
     ~MimesAppsManager();
 
     static QStringList DesktopFiles;
-    static QMap<QString, QStringList> MimeApps;
+    static QHash<QString, QStringList> MimeApps;
     static QMap<QString, QStringList> DDE_MimeTypes;
     //specially cache for video, image, text and audio
     static QMap<QString, DesktopFile> VideoMimeApps;
@@ -85,6 +86,7 @@ public:
     static QString getMimeInfoCacheFileRootPath();
     static QString getDesktopFilesCacheFile();
     static QString getDesktopIconsCacheFile();
+    static QString getDesktopEntriesIndexFile();
     static QString getDDEMimeTypeFile();
     static QMap<QString, DesktopFile> getDesktopObjs();
     static void initMimeTypeApps();
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mimetypecache.h"
+
+#include <QFile>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+using namespace dfmbase;
+
+static bool keyOfStat(const struct stat &st, QMimeDatabase::MatchMode mode, MimeTypeCache::Key *key)
+{
+    // only the regular files are sniffed by content
+    if (!S_ISREG(st.st_mode))
+        return false;
+
+    key->device = static_cast<quint64>(st.st_dev);
+    key->inode = static_cast<quint64>(st.st_ino);
+    key->modifyTime = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    key->mode = static_cast<int>(mode);
+    return true;
+}
+
+uint dfmbase::qHash(const MimeTypeCache::Key &key, uint seed)
+{
+    return ::qHash(key.inode, seed) ^ ::qHash(key.device) ^ ::qHash(key.modifyTime) ^ static_cast<uint>(key.mode);
+}
+
+MimeTypeCache::MimeTypeCache()
+{
+    for (Shard &shard : shards)
+        shard.cache.setMaxCost(kMaxEntriesPerShard);
+}
+
+MimeTypeCache *MimeTypeCache::instance()
+{
+    static MimeTypeCache ins;
+    return &ins;
+}
+
+/*!
+ * \brief MimeTypeCache::makeKey, the key of the file which filePath points to
+ * \return false if the file can not be cached, such as the directories and the missing files
+ */
+bool MimeTypeCache::makeKey(const QString &filePath, QMimeDatabase::MatchMode mode, Key *key)
+{
+    struct stat st;
+    if (::stat(QFile::encodeName(filePath).constData(), &st) != 0)
+        return false;
+
+    return keyOfStat(st, mode, key);
+}
+
+bool MimeTypeCache::makeKey(int dirFd, const QByteArray &fileName, QMimeDatabase::MatchMode mode, Key *key)
+{
+    struct stat st;
+    if (::fstatat(dirFd, fileName.constData(), &st, 0) != 0)
+        return false;
+
+    return keyOfStat(st, mode, key);
+}
+
+bool MimeTypeCache::find(const Key &key, QMimeType *type)
+{
+    Shard &shard = shardOf(key);
+    QMutexLocker lk(&shard.mutex);
+    // touching the entry makes it the most recently used one
+    QMimeType *cached = shard.cache.object(key);
+    if (!cached)
+        return false;
+
+    *type = *cached;
+    return true;
+}
+
+void MimeTypeCache::insert(const Key &key, const QMimeType &type)
+{
+    if (!type.isValid())
+        return;
+
+    Shard &shard = shardOf(key);
+    QMutexLocker lk(&shard.mutex);
+    shard.cache.insert(key, new QMimeType(type));
+}
+
+void MimeTypeCache::clear()
+{
+    for (Shard &shard : shards) {
+        QMutexLocker lk(&shard.mutex);
+        shard.cache.clear();
+    }
+}
+
+MimeTypeCache::Shard &MimeTypeCache::shardOf(const Key &key)
+{
+    return shards[key.inode % kShardCount];
+}
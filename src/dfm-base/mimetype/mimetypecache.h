@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MIMETYPECACHE_H
+#define MIMETYPECACHE_H
+
+#include <dfm-base/dfm_base_global.h>
+
+#include <QCache>
+#include <QMimeDatabase>
+#include <QMimeType>
+#include <QMutex>
+
+namespace dfmbase {
+
+/*!
+ * \brief The MimeTypeCache class keeps the detected mimetypes of local files for the whole process.
+ * Entries are keyed by the device, the inode and the modify time of a file, a changed file gets
+ * a new key and the stale entry is evicted as the least recently used one.
+ * It is split into locked shards, so it may be used from any thread.
+ */
+class MimeTypeCache
+{
+    Q_DISABLE_COPY(MimeTypeCache)
+
+public:
+    struct Key
+    {
+        quint64 device { 0 };
+        quint64 inode { 0 };
+        qint64 modifyTime { 0 };   // in nanoseconds
+        int mode { 0 };
+
+        bool operator==(const Key &other) const
+        {
+            return device == other.device && inode == other.inode
+                    && modifyTime == other.modifyTime && mode == other.mode;
+        }
+    };
+
+    static MimeTypeCache *instance();
+
+    static bool makeKey(const QString &filePath, QMimeDatabase::MatchMode mode, Key *key);
+    static bool makeKey(int dirFd, const QByteArray &fileName, QMimeDatabase::MatchMode mode, Key *key);
+
+    bool find(const Key &key, QMimeType *type);
+    void insert(const Key &key, const QMimeType &type);
+    void clear();
+
+private:
+    MimeTypeCache();
+
+    struct Shard
+    {
+        QMutex mutex;
+        QCache<Key, QMimeType> cache;
+    };
+
+    static constexpr int kShardCount { 16 };
+    static constexpr int kMaxEntriesPerShard { 1024 };
+
+    Shard &shardOf(const Key &key);
+    Shard shards[kShardCount];
+};
+
+uint qHash(const MimeTypeCache::Key &key, uint seed = 0);
+
+}
+
+#endif   // MIMETYPECACHE_H
@@ -9,6 +9,8 @@
 
 #include <QStringList>
 
+class QDataStream;
+
 /**
  * @class DesktopFile
  * @brief Represents a linux desktop file
@@ -36,6 +38,9 @@ public:
     QStringList desktopCategories() const;
     QStringList desktopMimeType() const;
 
+    friend QDataStream &operator<<(QDataStream &out, const DesktopFile &file);
+    friend QDataStream &operator>>(QDataStream &in, DesktopFile &file);
+
 private:
     QString fileName;
     QString name;
@@ -52,6 +57,9 @@ private:
     bool hidden = false;
 };
 
+QDataStream &operator<<(QDataStream &out, const DesktopFile &file);
+QDataStream &operator>>(QDataStream &in, DesktopFile &file);
+
 }
 
 #endif   // DESKTOPFILE_H
@@ -10,19 +10,134 @@
 #include <QTextDocument>
 #include <QTextLayout>
 #include <QTextBlock>
+#include <QGlyphRun>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QCache>
+#include <QMutex>
 #include <QDebug>
 
 #include <dfm-base/dfm_base_global.h>
 
 using namespace dfmbase;
 
-ElideTextLayout::ElideTextLayout(const QString &text)
-    : document(new QTextDocument)
+namespace {
+
+struct LayoutKey
+{
+    QString text;
+    QString font;
+    qreal width { 0 };
+    qreal height { 0 };
+    int lineHeight { 0 };
+    int elideMode { 0 };
+    uint wrapMode { 0 };
+    uint alignment { 0 };
+    int direction { 0 };
+    qreal devicePixelRatio { 0 };
+    int dpi { 0 };
+    qreal leadingWidth { 0 };
+    QString leadingKey;
+
+    bool operator==(const LayoutKey &other) const
+    {
+        return text == other.text && font == other.font
+                && leadingWidth == other.leadingWidth && leadingKey == other.leadingKey
+                && width == other.width && height == other.height
+                && lineHeight == other.lineHeight && elideMode == other.elideMode
+                && wrapMode == other.wrapMode && alignment == other.alignment
+                && direction == other.direction && devicePixelRatio == other.devicePixelRatio
+                && dpi == other.dpi;
+    }
+};
+
+uint qHash(const LayoutKey &key, uint seed = 0)
+{
+    uint h = ::qHash(key.text, seed) ^ (::qHash(key.font, seed) << 1) ^ ::qHash(key.leadingKey, seed);
+    h ^= ::qHash(qRound(key.width * 64)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= ::qHash(qRound(key.height * 64)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= uint(key.lineHeight) | uint(key.elideMode) << 16 | key.wrapMode << 20 | key.direction << 24;
+    return h ^ key.alignment;
+}
+
+struct ShapedLine
+{
+    QRectF rect;   // relative to the top left of the layout rect
+    QString text;
+    QList<QGlyphRun> glyphRuns;
+};
+using ShapedLines = QVector<ShapedLine>;
+
+/*!
+ * \brief The LayoutCache class keeps the shaped lines of the recently laid out texts,
+ * views repaint the same names while scrolling and hovering, shaping them once is enough.
+ * It is dropped when the fonts or the dpi of screens are changed.
+ */
+class LayoutCache
 {
-    document->setPlainText(text);
+public:
+    static LayoutCache *instance()
+    {
+        static LayoutCache ins;
+        return &ins;
+    }
+
+    bool find(const LayoutKey &key, ShapedLines *lines)
+    {
+        QMutexLocker lk(&mutex);
+        ShapedLines *cached = cache.object(key);
+        if (!cached)
+            return false;
+        *lines = *cached;
+        return true;
+    }
+
+    void insert(const LayoutKey &key, const ShapedLines &lines)
+    {
+        QMutexLocker lk(&mutex);
+        cache.insert(key, new ShapedLines(lines));
+    }
+
+    void clear()
+    {
+        QMutexLocker lk(&mutex);
+        cache.clear();
+    }
 
-    attributes.insert(kFont, document->defaultFont());
-    attributes.insert(kLineHeight, QFontMetrics(document->defaultFont()).height());
+private:
+    LayoutCache()
+        : cache(kMaxCachedLayouts)
+    {
+        if (!qGuiApp)
+            return;
+
+        auto clearCache = [this]() { clear(); };
+        auto watchScreen = [clearCache](QScreen *screen) {
+            QObject::connect(screen, &QScreen::logicalDotsPerInchChanged, screen, clearCache);
+            QObject::connect(screen, &QScreen::physicalDotsPerInchChanged, screen, clearCache);
+        };
+
+        QObject::connect(qGuiApp, &QGuiApplication::fontDatabaseChanged, qGuiApp, clearCache);
+        QObject::connect(qGuiApp, &QGuiApplication::fontChanged, qGuiApp, clearCache);
+        QObject::connect(qGuiApp, &QGuiApplication::screenAdded, qGuiApp, watchScreen);
+        for (QScreen *screen : qGuiApp->screens())
+            watchScreen(screen);
+    }
+
+    static constexpr int kMaxCachedLayouts { 4096 };
+    QMutex mutex;
+    QCache<LayoutKey, ShapedLines> cache;
+};
+
+}   // namespace
+
+ElideTextLayout::ElideTextLayout(const QString &text)
+    : plainText(text)
+{
+    // same as the default font of QTextDocument
+    const QFont font;
+    attributes.insert(kFont, font);
+    attributes.insert(kLineHeight, QFontMetrics(font).height());
     attributes.insert(kBackgroundRadius, 0);
     attributes.insert(kAlignment, Qt::AlignHCenter);
     attributes.insert(kWrapMode, (uint)QTextOption::WrapAtWordBoundaryOrAnywhere);
@@ -37,15 +152,53 @@ ElideTextLayout::~ElideTextLayout()
 
 void ElideTextLayout::setText(const QString &text)
 {
-    document->setPlainText(text);
+    plainText = text;
+    if (document)
+        document->setPlainText(text);
 }
 
 QString ElideTextLayout::text() const
 {
-    return document->toPlainText();
+    return document ? document->toPlainText() : plainText;
+}
+
+/*!
+ * \brief ElideTextLayout::setLeadingObject, the first line is laid out in the width left by the object,
+ * and the object is drawn by \a painter at the left of the line, the same as an inline object at the beginning
+ * of the text whatever the alignment is. The object is drawn over the cached lines, not kept in the cache.
+ */
+void ElideTextLayout::setLeadingObject(const QSizeF &size, const QString &key, const ObjectPainter &painter)
+{
+    leadingSize = size;
+    leadingKey = key;
+    leadingPainter = painter;
+}
+
+QTextDocument *ElideTextLayout::documentHandle()
+{
+    if (!document) {
+        document = new QTextDocument;
+        document->setPlainText(plainText);
+    }
+
+    documentDetached = true;
+    return document;
 }
 
 QList<QRectF> ElideTextLayout::layout(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines)
+{
+    if (documentDetached)
+        return layoutDocument(rect, elideMode, painter, background, textLines);
+
+    return layoutCached(rect, elideMode, painter, background, textLines);
+}
+
+void ElideTextLayout::clearLayoutCache()
+{
+    LayoutCache::instance()->clear();
+}
+
+QList<QRectF> ElideTextLayout::layoutDocument(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines)
 {
     QList<QRectF> ret;
     QTextLayout *lay = document->firstBlock().layout();
@@ -143,6 +296,125 @@ QList<QRectF> ElideTextLayout::layout(const QRectF &rect, Qt::TextElideMode elid
     return ret;
 }
 
+QList<QRectF> ElideTextLayout::layoutCached(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines)
+{
+    const int textLineHeight = attribute<int>(kLineHeight);
+    const QSizeF size = rect.size();
+    const QPaintDevice *device = painter ? painter->device() : nullptr;
+
+    LayoutKey key;
+    key.text = plainText;
+    key.font = attribute<QFont>(kFont).key();
+    key.width = size.width();
+    key.height = size.height();
+    key.lineHeight = textLineHeight;
+    key.elideMode = elideMode;
+    key.wrapMode = attribute<uint>(kWrapMode);
+    key.alignment = attribute<uint>(kAlignment);
+    key.direction = attribute<Qt::LayoutDirection>(kTextDirection);
+    key.devicePixelRatio = device ? device->devicePixelRatioF() : 0;
+    key.dpi = device ? device->logicalDpiY() : 0;
+    const qreal leadingWidth = leadingPainter ? leadingSize.width() : 0;
+    key.leadingWidth = leadingWidth;
+    key.leadingKey = leadingPainter ? leadingKey : QString();
+
+    ShapedLines lines;
+    if (!LayoutCache::instance()->find(key, &lines)) {
+        auto appendLine = [&lines, textLineHeight, leadingWidth](const QTextLine &line, const QString &text) {
+            ShapedLine shaped;
+            shaped.rect = line.naturalTextRect();
+            // the first line takes the leading object in
+            if (lines.isEmpty())
+                shaped.rect.setLeft(shaped.rect.left() - leadingWidth);
+            shaped.rect.setHeight(textLineHeight);
+            shaped.text = text.mid(line.textStart(), line.textLength());
+            shaped.glyphRuns = line.glyphRuns();
+            lines.append(shaped);
+        };
+
+        // only the first paragraph is shown, as the first block of the document
+        QTextLayout lay(plainText.left(plainText.indexOf('\n')));
+        initLayoutOption(&lay);
+
+        QPointF offset(0, 0);
+        qreal curHeight = 0;
+        QString elideText;
+        lay.beginLayout();
+        QTextLine line = lay.createLine();
+        while (line.isValid()) {
+            // the leading object is at the left of the first line
+            const qreal indent = lines.isEmpty() ? leadingWidth : 0;
+            curHeight += textLineHeight;
+            line.setLineWidth(size.width() - indent);
+            line.setPosition(offset + QPointF(indent, 0));
+
+            // check next line is out or not.
+            if (curHeight + textLineHeight > size.height()) {
+                auto nextLine = lay.createLine();
+                if (nextLine.isValid()) {
+                    // elide current line.
+                    QFontMetrics fm(lay.font());
+                    elideText = fm.elidedText(plainText.mid(line.textStart()), elideMode, qRound(size.width() - indent));
+                    break;
+                }
+                // next line is empty.
+            }
+
+            appendLine(line, plainText);
+            line = lay.createLine();
+            offset.setY(offset.y() + textLineHeight);
+        }
+        lay.endLayout();
+
+        // process last elided line.
+        if (!elideText.isEmpty()) {
+            QTextLayout elideLay;
+            auto oldWrap = static_cast<QTextOption::WrapMode>(attribute<uint>(kWrapMode));
+            setAttribute(kWrapMode, static_cast<uint>(QTextOption::NoWrap));
+            initLayoutOption(&elideLay);
+            setAttribute(kWrapMode, oldWrap);
+
+            elideLay.setText(elideText);
+            elideLay.beginLayout();
+            const qreal indent = lines.isEmpty() ? leadingWidth : 0;
+            auto elideLine = elideLay.createLine();
+            elideLine.setLineWidth(size.width() - indent - 1);
+            elideLine.setPosition(offset + QPointF(indent, 0));
+            appendLine(elideLine, elideText);
+            elideLay.endLayout();
+        }
+
+        LayoutCache::instance()->insert(key, lines);
+    }
+
+    QList<QRectF> ret;
+    QRectF lastLineRect;
+    const QPointF origin = rect.topLeft();
+    for (const ShapedLine &line : lines) {
+        const QRectF lRect = line.rect.translated(origin);
+        ret.append(lRect);
+        if (textLines)
+            textLines->append(line.text);
+
+        if (painter) {
+            if (background.style() != Qt::NoBrush)
+                lastLineRect = drawLineBackground(painter, lRect, lastLineRect, background);
+
+            for (const QGlyphRun &run : line.glyphRuns)
+                painter->drawGlyphRun(origin, run);
+        }
+    }
+
+    if (painter && leadingPainter && !ret.isEmpty()) {
+        const QRectF &firstLine = ret.first();
+        QRectF objectRect(QPointF(0, 0), leadingSize);
+        objectRect.moveTopLeft(QPointF(firstLine.left(), firstLine.top() + (firstLine.height() - leadingSize.height()) / 2));
+        leadingPainter(painter, objectRect);
+    }
+
+    return ret;
+}
+
 QRectF ElideTextLayout::drawLineBackground(QPainter *painter, const QRectF &curLineRect, QRectF lastLineRect, const QBrush &brush) const
 {
     const qreal backgroundRadius = attribute<qreal>(kBackgroundRadius);
@@ -9,6 +9,8 @@
 #include <QBrush>
 #include <QVariant>
 
+#include <functional>
+
 class QPainter;
 class QTextDocument;
 class QTextLayout;
@@ -32,10 +34,15 @@ public:
     void setText(const QString &text);
     QString text() const;
     QList<QRectF> layout(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter = nullptr, const QBrush &background = Qt::NoBrush, QStringList *textLines = nullptr);
+    static void clearLayoutCache();
 public:
-    inline QTextDocument *documentHandle() {
-        return document;
-    }
+    using ObjectPainter = std::function<void(QPainter *painter, const QRectF &rect)>;
+    // an object placed before the text in the first line, such as the tags of a file, the text is still laid out from the cache.
+    // the key tells the objects apart, the objects of the same key and size share the cached lines
+    void setLeadingObject(const QSizeF &size, const QString &key, const ObjectPainter &painter);
+
+    // the document may be changed by the caller, it is not laid out from the cache any more
+    QTextDocument *documentHandle();
 
     inline void setAttribute(Attribute attr, const QVariant &value) {
         attributes.insert(attr, value);
@@ -49,9 +56,16 @@ public:
 protected:
     QRectF drawLineBackground(QPainter *painter, const QRectF &curLineRect, QRectF lastLineRect, const QBrush &brush) const;
     virtual void initLayoutOption(QTextLayout *lay);
+    QList<QRectF> layoutDocument(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines);
+    QList<QRectF> layoutCached(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines);
 protected:
-    QTextDocument *document = nullptr;
+    QTextDocument *document = nullptr;   // created on demand
+    QString plainText;
     QMap<Attribute, QVariant> attributes;
+    bool documentDetached = false;
+    QSizeF leadingSize;
+    QString leadingKey;
+    ObjectPainter leadingPainter;
 };
 }
 
@@ -5,6 +5,7 @@
 #include "fileoperations.h"
 #include "fileoperationsevent/fileoperationseventreceiver.h"
 #include "fileoperationsevent/trashfileeventreceiver.h"
+#include "fileoperations/cleantrash/trashgraveyard.h"
 
 #include <dfm-base/base/urlroute.h>
 #include <dfm-base/base/schemefactory.h>
@@ -13,11 +14,16 @@
 #include <dfm-base/interfaces/abstractjobhandler.h>
 #include <dfm-base/base/configs/dconfig/dconfigmanager.h>
 
+#include <QCoreApplication>
+#include <QTimer>
+
 Q_DECLARE_METATYPE(bool *)
 
 DFMBASE_USE_NAMESPACE
 DFMGLOBAL_USE_NAMESPACE
 
+static constexpr char kDesktopAppName[] { "dde-desktop" };
+
 namespace dfmplugin_fileoperations {
 DFM_LOG_REISGER_CATEGORY(DPFILEOPERATIONS_NAMESPACE)
 
@@ -34,6 +40,14 @@ bool FileOperations::start()
     if (!ret)
         fmWarning() << "create dconfig failed: " << err;
 
+    // reclaim the trash graveyards left by the last session once the window is up,
+    // dde-desktop lives through the session, the file manager only reaps what it buries
+    if (qApp->applicationName() == kDesktopAppName) {
+        QTimer::singleShot(10 * 1000, TrashReaper::instance(), [] {
+            TrashReaper::instance()->reap();
+        });
+    }
+
     return true;
 }
 
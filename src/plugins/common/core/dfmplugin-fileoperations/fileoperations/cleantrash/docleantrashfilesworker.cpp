@@ -3,14 +3,16 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "docleantrashfilesworker.h"
+#include "trashgraveyard.h"
+
 #include <dfm-base/base/schemefactory.h>
 #include <dfm-base/base/standardpaths.h>
 #include <dfm-base/utils/universalutils.h>
 #include <dfm-base/file/local/localfilehandler.h>
-
-#include <dfm-io/denumerator.h>
+#include <dfm-base/file/local/localtrashenumerator.h>
 
 #include <QUrl>
+#include <QSet>
 #include <QDebug>
 
 DFMBASE_USE_NAMESPACE
@@ -31,7 +33,10 @@ bool DoCleanTrashFilesWorker::doWork()
     if (!AbstractWorker::doWork())
         return false;
 
-    cleanAllTrashFiles();
+    if (emptyWholeTrash)
+        emptyTrashDirectories();
+    else
+        cleanAllTrashFiles();
 
     endWork();
 
@@ -52,14 +57,9 @@ bool DoCleanTrashFilesWorker::statisticsFilesSize()
 
     if (sourceUrls.size() == 1) {
         const QUrl &urlSource = sourceUrls[0];
-        if (UniversalUtils::urlEquals(urlSource, FileUtils::trashRootUrl())) {
-            DFMIO::DEnumerator enumerator(urlSource);
-            while (enumerator.hasNext()) {
-                auto url = FileUtils::bindUrlTransform(enumerator.next());
-                if (!allFilesList.contains(url))
-                    allFilesList.append(url);
-            }
-        }
+        // the items are not listed, the trash directories are emptied at once
+        if (UniversalUtils::urlEquals(urlSource, FileUtils::trashRootUrl()))
+            emptyWholeTrash = true;
     }
 
     return true;
@@ -70,6 +70,50 @@ bool DoCleanTrashFilesWorker::initArgs()
     return AbstractWorker::initArgs();
 }
 
+/*!
+ * \brief DoCleanTrashFilesWorker::emptyTrashDirectories empty the whole trash
+ * The content of every trash directory is moved to its graveyard and reclaimed by the
+ * TrashReaper in the background, the items of the directories which cannot be buried
+ * are deleted one by one.
+ * \return delete all files success
+ */
+bool DoCleanTrashFilesWorker::emptyTrashDirectories()
+{
+    const QString &homeTrash = LocalTrashEnumerator::homeTrashDirectory();
+    QString failedHomeTrash;
+    QStringList buried;
+    QStringList failed;
+    if (TrashGraveyard::bury(homeTrash))
+        buried.append(homeTrash);
+    else
+        failedHomeTrash = homeTrash;
+    for (const QString &dir : LocalTrashEnumerator::mountTrashDirectories()) {
+        if (TrashGraveyard::bury(dir))
+            buried.append(dir);
+        else
+            failed.append(dir);
+    }
+
+    if (!buried.isEmpty())
+        TrashReaper::instance()->reap(buried);
+
+    if (failedHomeTrash.isEmpty() && failed.isEmpty())
+        return true;
+
+    fmWarning() << "cannot empty the trash directories at once, delete their items:" << failedHomeTrash << failed;
+    const auto &items = LocalTrashEnumerator(failedHomeTrash, failed).items();
+    QSet<QUrl> added;
+    for (const auto &item : items) {
+        const QUrl &url = FileUtils::bindUrlTransform(item.url);
+        if (added.contains(url))
+            continue;
+        added.insert(url);
+        allFilesList.append(url);
+    }
+
+    return allFilesList.isEmpty() || cleanAllTrashFiles();
+}
+
 /*!
  * \brief DoCleanTrashFilesWorker::deleteAllFiles delete All files
  * \return delete all files success
@@ -33,6 +33,7 @@ protected:
 
 protected:
     bool cleanAllTrashFiles();
+    bool emptyTrashDirectories();
     bool clearTrashFile(const FileInfoPointer &trashInfo);
     AbstractJobHandler::SupportAction doHandleErrorAndWait(const QUrl &from,
                                                            const AbstractJobHandler::JobErrorType &error,
@@ -44,6 +45,7 @@ private:
 
 private:
     QAtomicInteger<qint64> cleanTrashFilesCount { 0 };
+    bool emptyWholeTrash { false };
     QString trashInfoPath;
     QString trashFilePath;
 };
@@ -0,0 +1,387 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "trashgraveyard.h"
+
+#include <dfm-base/file/local/localtrashenumerator.h>
+#include <dfm-base/utils/finallyutil.h>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#include <cstring>
+
+#ifndef RENAME_EXCHANGE
+#    define RENAME_EXCHANGE (1 << 1)
+#endif
+
+static constexpr int kIoprioWhoProcess { 1 };
+static constexpr int kIoprioClassIdle { 3 };
+static constexpr int kIoprioClassShift { 13 };
+static constexpr int kUnlinkBatch { 512 };
+static constexpr unsigned long kBatchPauseMs { 10 };
+static constexpr unsigned long kLockRetryMs { 200 };
+static constexpr int kMaxGraveAttempts { 16 };
+static constexpr char kTrashInfoSuffix[] { ".trashinfo" };
+
+DFMBASE_USE_NAMESPACE
+DPFILEOPERATIONS_USE_NAMESPACE
+
+static bool isEmptyDir(int parentFd, const char *name)
+{
+    const int fd = ::openat(parentFd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return true;
+    DIR *dir = ::fdopendir(fd);
+    if (!dir) {
+        ::close(fd);
+        return false;
+    }
+
+    bool empty = true;
+    while (struct dirent *entry = ::readdir(dir)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+            empty = false;
+            break;
+        }
+    }
+    ::closedir(dir);
+    return empty;
+}
+
+static QList<QByteArray> entriesOf(int parentFd, const char *name)
+{
+    QList<QByteArray> entries;
+    const int fd = ::openat(parentFd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR *dir = fd >= 0 ? ::fdopendir(fd) : nullptr;
+    if (!dir) {
+        if (fd >= 0)
+            ::close(fd);
+        return entries;
+    }
+
+    while (struct dirent *entry = ::readdir(dir)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+            entries.append(entry->d_name);
+    }
+    ::closedir(dir);
+    return entries;
+}
+
+static bool existsAt(int parentFd, const QByteArray &path)
+{
+    struct stat st;
+    return ::fstatat(parentFd, path.constData(), &st, AT_SYMLINK_NOFOLLOW) == 0;
+}
+
+/*!
+ * \brief TrashGraveyard::bury move the content of a trash directory to its graveyard
+ * \param trashDir the trash directory holding files and info
+ * \return false if the trash directory could not be emptied this way, its items are left in place
+ */
+bool TrashGraveyard::bury(const QString &trashDir)
+{
+    const int trashFd = ::open(QFile::encodeName(trashDir).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (trashFd < 0)
+        return errno == ENOENT;
+    FinallyUtil release([trashFd] { ::close(trashFd); });
+
+    if (isEmptyDir(trashFd, "files") && isEmptyDir(trashFd, "info"))
+        return true;
+
+    const int graveFd = createGrave(trashFd);
+    if (graveFd < 0) {
+        fmWarning() << "cannot create trash grave in" << trashDir << strerror(errno);
+        return false;
+    }
+    // closing the grave unlocks it for the reaper
+    FinallyUtil unlock([graveFd] { ::close(graveFd); });
+
+    // info goes first: moving to trash writes the info before the file
+    for (const char *name : { "info", "files" }) {
+        if (::mkdirat(graveFd, name, 0700) == 0) {
+            // the trash never misses its directories while they are exchanged
+            if (::syscall(SYS_renameat2, trashFd, name, graveFd, name, RENAME_EXCHANGE) == 0)
+                continue;
+
+            const int error = errno;
+            // the trash has no such directory, nothing to bury
+            if (error == ENOENT && !existsAt(trashFd, name)) {
+                ::unlinkat(graveFd, name, AT_REMOVEDIR);
+                continue;
+            }
+
+            if (error == EINVAL || error == ENOSYS) {
+                ::unlinkat(graveFd, name, AT_REMOVEDIR);
+                if (::renameat(trashFd, name, graveFd, name) == 0) {
+                    ::mkdirat(trashFd, name, 0700);
+                    continue;
+                }
+            }
+            errno = error;
+        }
+
+        fmWarning() << "cannot bury" << name << "of" << trashDir << strerror(errno);
+        // the info buried before is moved back, its files are still in the trash
+        restoreSplitItems(trashFd, graveFd);
+        return false;
+    }
+
+    restoreSplitItems(trashFd, graveFd);
+
+    // the sizes of the buried directories
+    ::unlinkat(trashFd, "directorysizes", 0);
+    return true;
+}
+
+QString TrashGraveyard::graveyardOf(const QString &trashDir)
+{
+    return trashDir + "/" + kGraveyardName;
+}
+
+/*!
+ * \brief TrashGraveyard::createGrave create a new grave in the graveyard of a trash directory
+ * \return the fd of the grave, locked, or -1. The graveyard may be reaped meanwhile, it is created again then
+ */
+int TrashGraveyard::createGrave(int trashFd)
+{
+    const QByteArray &stamp = QByteArray::number(QDateTime::currentMSecsSinceEpoch());
+    for (int i = 0; i < kMaxGraveAttempts; ++i) {
+        if (::mkdirat(trashFd, kGraveyardName, 0700) != 0 && errno != EEXIST)
+            return -1;
+        const int graveyardFd = ::openat(trashFd, kGraveyardName, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (graveyardFd < 0) {
+            if (errno == ENOENT)
+                continue;
+            return -1;
+        }
+        FinallyUtil release([graveyardFd] { ::close(graveyardFd); });
+
+        const QByteArray &name = i == 0 ? stamp : stamp + "-" + QByteArray::number(i);
+        if (::mkdirat(graveyardFd, name.constData(), 0700) != 0) {
+            if (errno == ENOENT || errno == EEXIST)
+                continue;
+            return -1;
+        }
+
+        const int graveFd = ::openat(graveyardFd, name.constData(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (graveFd < 0)
+            continue;
+
+        // the reaper may remove the empty grave before it is locked
+        struct stat st;
+        if (::flock(graveFd, LOCK_EX) == 0 && ::fstat(graveFd, &st) == 0 && st.st_nlink > 0)
+            return graveFd;
+        ::close(graveFd);
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+/*!
+ * \brief TrashGraveyard::restoreSplitItems move back the halves of the items trashed between
+ * the two exchanges, the info of such an item is in the trash and its file in the grave, or the
+ * other way round if the file was moved after its info was buried
+ */
+void TrashGraveyard::restoreSplitItems(int trashFd, int graveFd)
+{
+    auto moveBack = [trashFd, graveFd](const QByteArray &path) {
+        if (existsAt(graveFd, path) && !existsAt(trashFd, path)
+            && ::renameat(graveFd, path.constData(), trashFd, path.constData()) != 0)
+            fmWarning() << "cannot restore the trashed item" << path << strerror(errno);
+    };
+
+    for (const QByteArray &info : entriesOf(trashFd, "info")) {
+        if (info.endsWith(kTrashInfoSuffix))
+            moveBack("files/" + info.left(info.size() - int(strlen(kTrashInfoSuffix))));
+    }
+    for (const QByteArray &file : entriesOf(trashFd, "files"))
+        moveBack("info/" + file + kTrashInfoSuffix);
+}
+
+TrashReaper::TrashReaper(QObject *parent)
+    : QThread(parent)
+{
+    // a request may come while the last round is about to return
+    connect(this, &QThread::finished, this, [this] {
+        QMutexLocker locker(&mutex);
+        if (!stopped && (pendingAll || !pendingDirs.isEmpty()))
+            start(QThread::IdlePriority);
+    });
+}
+
+TrashReaper::~TrashReaper()
+{
+    stop();
+    wait();
+}
+
+TrashReaper *TrashReaper::instance()
+{
+    static TrashReaper reaper;
+    return &reaper;
+}
+
+void TrashReaper::reap(const QStringList &trashDirs)
+{
+    QMutexLocker locker(&mutex);
+    if (trashDirs.isEmpty())
+        pendingAll = true;
+    for (const QString &dir : trashDirs) {
+        if (!pendingDirs.contains(dir))
+            pendingDirs.append(dir);
+    }
+
+    stopped = false;
+    if (!isRunning())
+        start(QThread::IdlePriority);
+}
+
+void TrashReaper::stop()
+{
+    stopped = true;
+}
+
+void TrashReaper::run()
+{
+    // idle io class of this thread only, the disk is left to everything else first
+    ::syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, kIoprioClassIdle << kIoprioClassShift);
+
+    forever {
+        QStringList dirs;
+        {
+            QMutexLocker locker(&mutex);
+            if (pendingAll) {
+                pendingDirs.append(LocalTrashEnumerator::homeTrashDirectory());
+                pendingDirs.append(LocalTrashEnumerator::mountTrashDirectories());
+                pendingAll = false;
+            }
+            dirs.swap(pendingDirs);
+        }
+        if (dirs.isEmpty() || stopped)
+            return;
+
+        dirs.removeDuplicates();
+        for (const QString &dir : dirs) {
+            if (stopped)
+                return;
+            const qint64 bytes = reapGraveyard(dir);
+            if (bytes > 0) {
+                fmInfo() << "reclaimed" << bytes << "bytes from the trash graveyard of" << dir;
+                Q_EMIT reclaimed(dir, bytes);
+            }
+        }
+    }
+}
+
+qint64 TrashReaper::reapGraveyard(const QString &trashDir)
+{
+    const int trashFd = ::open(QFile::encodeName(trashDir).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (trashFd < 0)
+        return 0;
+    FinallyUtil release([trashFd] { ::close(trashFd); });
+
+    const int graveyardFd = ::openat(trashFd, TrashGraveyard::kGraveyardName, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (graveyardFd < 0)
+        return 0;
+    FinallyUtil unlock([graveyardFd] { ::close(graveyardFd); });
+
+    // both dde-desktop and dde-file-manager may empty the trash and reap it
+    if (!lockGraveyard(graveyardFd))
+        return 0;
+
+    qint64 bytes = 0;
+    for (const QByteArray &grave : entriesOf(graveyardFd, ".")) {
+        if (stopped)
+            return bytes;
+        bytes += reapGrave(graveyardFd, grave);
+    }
+
+    // a grave being filled keeps the graveyard
+    ::unlinkat(trashFd, TrashGraveyard::kGraveyardName, AT_REMOVEDIR);
+    return bytes;
+}
+
+/*!
+ * \brief TrashReaper::reapGrave remove a grave of the graveyard, unless bury is filling it
+ */
+qint64 TrashReaper::reapGrave(int graveyardFd, const QByteArray &name)
+{
+    const int fd = ::openat(graveyardFd, name.constData(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0)
+        return errno == ENOTDIR || errno == ELOOP ? removeTree(graveyardFd, name.constData()) : 0;
+    FinallyUtil release([fd] { ::close(fd); });
+
+    if (::flock(fd, LOCK_EX | LOCK_NB) != 0)
+        return 0;
+    return removeTree(graveyardFd, name.constData());
+}
+
+bool TrashReaper::lockGraveyard(int fd)
+{
+    while (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        if ((errno != EWOULDBLOCK && errno != EINTR) || stopped)
+            return false;
+        QThread::msleep(kLockRetryMs);
+    }
+    return true;
+}
+
+/*!
+ * \brief TrashReaper::removeTree remove a tree relative to a directory fd
+ * \return the bytes of the disk space given back
+ */
+qint64 TrashReaper::removeTree(int parentFd, const char *name)
+{
+    struct stat st;
+    if (::fstatat(parentFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+        return 0;
+
+    qint64 bytes = 0;
+    if (S_ISDIR(st.st_mode)) {
+        // read only directories of the trashed trees
+        if ((st.st_mode & S_IRWXU) != S_IRWXU)
+            ::fchmodat(parentFd, name, (st.st_mode | S_IRWXU) & 07777, 0);
+        const int fd = ::openat(parentFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        DIR *dir = fd >= 0 ? ::fdopendir(fd) : nullptr;
+        if (dir) {
+            while (struct dirent *entry = ::readdir(dir)) {
+                if (stopped)
+                    break;
+                if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+                    continue;
+                bytes += removeTree(fd, entry->d_name);
+            }
+            ::closedir(dir);
+        } else if (fd >= 0) {
+            ::close(fd);
+        }
+
+        if (stopped || ::unlinkat(parentFd, name, AT_REMOVEDIR) != 0)
+            return bytes;
+    } else {
+        if (::unlinkat(parentFd, name, 0) != 0)
+            return bytes;
+        // the space of a hard linked file is still in use
+        if (st.st_nlink > 1)
+            return bytes;
+    }
+
+    throttle();
+    return bytes + static_cast<qint64>(st.st_blocks) * 512;
+}
+
+void TrashReaper::throttle()
+{
+    if (++unlinkCount % kUnlinkBatch == 0)
+        QThread::msleep(kBatchPauseMs);
+}
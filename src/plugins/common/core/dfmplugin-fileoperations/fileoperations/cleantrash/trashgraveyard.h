@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TRASHGRAVEYARD_H
+#define TRASHGRAVEYARD_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+
+#include <atomic>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+
+/*!
+ * \brief The TrashGraveyard class empties a trash directory at once.
+ * The files and info directories are exchanged with empty ones, the old ones are kept in a
+ * hidden graveyard inside the trash directory, on the same file system, and are removed
+ * later by the TrashReaper.
+ * An item trashed while the two directories are exchanged may have its file and its info
+ * on different sides, such halves are moved back to the trash after the exchange.
+ * A grave is locked until it is filled, the reaper skips the locked graves.
+ */
+class TrashGraveyard
+{
+public:
+    static constexpr char kGraveyardName[] { ".dfm-graveyard" };
+
+    static bool bury(const QString &trashDir);
+    static QString graveyardOf(const QString &trashDir);
+
+private:
+    static int createGrave(int trashFd);
+    static void restoreSplitItems(int trashFd, int graveFd);
+};
+
+/*!
+ * \brief The TrashReaper class removes the graveyards of the trash directories in the background.
+ * It runs in one thread with the idle io priority and pauses between batches of unlinks.
+ * Graveyards left by a previous run are reaped the next time the reaper runs.
+ * A graveyard is locked while it is reaped, the reapers of the other processes wait for it,
+ * and each grave is locked while it is removed, so a grave being filled is left to the next run.
+ */
+class TrashReaper : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit TrashReaper(QObject *parent = nullptr);
+    ~TrashReaper() override;
+
+    static TrashReaper *instance();
+
+    // all the trash directories are checked if trashDirs is empty
+    void reap(const QStringList &trashDirs = QStringList());
+    void stop();
+
+Q_SIGNALS:
+    void reclaimed(const QString &trashDir, qint64 bytes);
+
+protected:
+    void run() override;
+
+private:
+    qint64 reapGraveyard(const QString &trashDir);
+    bool lockGraveyard(int fd);
+    qint64 reapGrave(int graveyardFd, const QByteArray &name);
+    qint64 removeTree(int parentFd, const char *name);
+    void throttle();
+
+private:
+    QMutex mutex;
+    QStringList pendingDirs;
+    bool pendingAll { false };
+    std::atomic_bool stopped { false };
+    int unlinkCount { 0 };
+};
+
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // TRASHGRAVEYARD_H
@@ -7,6 +7,7 @@
 
 #include <dfm-base/base/schemefactory.h>
 #include <dfm-base/utils/fileutils.h>
+#include <dfm-base/base/device/deviceutils.h>
 
 #include <dfm-io/dfmio_utils.h>
 
@@ -22,6 +23,10 @@
 #include <sys/stat.h>
 #include <syscall.h>
 
+#ifndef RENAME_NOREPLACE
+#    define RENAME_NOREPLACE (1 << 0)
+#endif
+
 DPFILEOPERATIONS_USE_NAMESPACE
 DoCutFilesWorker::DoCutFilesWorker(QObject *parent)
     : FileOperateBaseWorker(parent)
@@ -104,7 +109,22 @@ bool DoCutFilesWorker::initArgs()
 
 bool DoCutFilesWorker::cutFiles()
 {
+    // check hierarchy of all the items first, nothing is moved if a dir is cut into itself
     for (const auto &url : sourceUrls) {
+        const bool higher = FileUtils::isHigherHierarchy(url, targetUrl) || url == targetUrl
+                || FileUtils::isHigherHierarchy(url, targetOrgUrl) || url == targetOrgUrl;
+        if (higher) {
+            emit requestShowTipsDialog(DFMBASE_NAMESPACE::AbstractJobHandler::ShowDialogType::kCopyMoveToSelf, {});
+            return false;
+        }
+    }
+
+    // items on the same device are renamed in batch, the rest are cut one by one
+    QList<QUrl> restUrls;
+    if (!renameFilesInBatch(&restUrls))
+        return false;
+
+    for (const auto &url : restUrls) {
         if (!stateCheck()) {
             return false;
         }
@@ -123,15 +143,6 @@ bool DoCutFilesWorker::cutFiles()
         if (checkSelf(fileInfo))
             continue;
 
-        // check hierarchy
-        if (fileInfo->isAttributes(OptInfoType::kIsDir)) {
-            const bool higher = FileUtils::isHigherHierarchy(url, targetUrl) || url == targetUrl;
-            if (higher) {
-                emit requestShowTipsDialog(DFMBASE_NAMESPACE::AbstractJobHandler::ShowDialogType::kCopyMoveToSelf, {});
-                return false;
-            }
-        }
-
         // check link
         if (fileInfo->isAttributes(OptInfoType::kIsSymLink)) {
             const bool ok = checkSymLink(fileInfo);
@@ -149,6 +160,120 @@ bool DoCutFilesWorker::cutFiles()
     return true;
 }
 
+/*!
+ * \brief DoCutFilesWorker::renameFilesInBatch rename the source files on the same device as the
+ * target dir by renameat2 without replacing, no FileInfo is created for them. Items which
+ * are not on the device, need special handling (symlink, trash file) or failed to
+ * rename (conflict or any other error) are returned in restUrls, they are resolved by doCutFile.
+ * The dirs cut into themselves are refused by cutFiles before any item is renamed.
+ * \param restUrls the urls to be cut one by one
+ * \return false if the job is stopped
+ */
+bool DoCutFilesWorker::renameFilesInBatch(QList<QUrl> *restUrls)
+{
+    Q_ASSERT(restUrls);
+    restUrls->clear();
+
+    // the watcher of remote mounts is notified by hand in rename
+    if (!targetOrgUrl.isLocalFile() || DeviceUtils::isSamba(targetOrgUrl) || DeviceUtils::isFtp(targetOrgUrl)) {
+        *restUrls = sourceUrls;
+        return true;
+    }
+
+    const int targetFd = ::open(targetOrgUrl.toLocalFile().toLocal8Bit().constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    struct stat targetStat;
+    if (targetFd < 0 || ::fstat(targetFd, &targetStat) != 0) {
+        if (targetFd >= 0)
+            ::close(targetFd);
+        *restUrls = sourceUrls;
+        return true;
+    }
+
+    QString targetPath = targetUrl.path();
+    if (!targetPath.endsWith('/'))
+        targetPath.append('/');
+
+    QHash<QByteArray, bool> parentIsTarget;
+    QUrl lastSourceUrl;
+    QUrl lastTargetUrl;
+    int renamedCount = 0;
+    for (int i = 0; i < sourceUrls.count(); ++i) {
+        const QUrl &url = sourceUrls.at(i);
+        if (!stateCheck()) {
+            ::close(targetFd);
+            return false;
+        }
+
+        if (!url.isLocalFile() || FileUtils::isTrashFile(url)) {
+            restUrls->append(url);
+            continue;
+        }
+
+        const QByteArray &sourcePath = url.toLocalFile().toLocal8Bit();
+        struct stat sourceStat;
+        if (::lstat(sourcePath.constData(), &sourceStat) != 0
+            || sourceStat.st_dev != targetStat.st_dev
+            || S_ISLNK(sourceStat.st_mode)) {
+            restUrls->append(url);
+            continue;
+        }
+
+        const bool isDir = S_ISDIR(sourceStat.st_mode);
+
+        // check self, the parent dirs are checked once
+        const int index = sourcePath.lastIndexOf('/');
+        const QByteArray &parentPath = index <= 0 ? QByteArray("/") : sourcePath.left(index);
+        auto parent = parentIsTarget.find(parentPath);
+        if (parent == parentIsTarget.end()) {
+            struct stat parentStat;
+            const bool same = ::stat(parentPath.constData(), &parentStat) == 0
+                    && parentStat.st_dev == targetStat.st_dev && parentStat.st_ino == targetStat.st_ino;
+            parent = parentIsTarget.insert(parentPath, same);
+        }
+        if (parent.value())
+            continue;
+
+        const QByteArray &name = sourcePath.mid(index + 1);
+        if (::syscall(SYS_renameat2, AT_FDCWD, sourcePath.constData(), targetFd, name.constData(), RENAME_NOREPLACE) != 0) {
+            restUrls->append(url);
+            continue;
+        }
+
+        lastSourceUrl = url;
+        lastTargetUrl = targetUrl;
+        lastTargetUrl.setPath(targetPath + QString::fromLocal8Bit(name));
+        completeSourceFiles.append(lastSourceUrl);
+        completeTargetFiles.append(lastTargetUrl);
+        ++renamedCount;
+
+        if (isDir) {
+            // the same as doCutFile, the renamed dir counts its content as written
+            SizeInfoPointer sizeInfo(new FileUtils::FilesSizeInfo);
+            FileOperationsUtils::statisticFilesSize(lastTargetUrl, sizeInfo);
+            workData->blockRenameWriteSize += sizeInfo->totalSize;
+            workData->currentWriteSize += sizeInfo->totalSize;
+            if (sizeInfo->totalSize <= 0)
+                workData->zeroOrlinkOrDirWriteSize += workData->dirSize;
+        } else {
+            workData->blockRenameWriteSize += sourceStat.st_size;
+            workData->currentWriteSize += (sourceStat.st_size > 0 ? sourceStat.st_size : FileUtils::getMemoryPageSize());
+            if (sourceStat.st_size <= 0)
+                workData->zeroOrlinkOrDirWriteSize += FileUtils::getMemoryPageSize();
+        }
+    }
+    ::close(targetFd);
+
+    if (renamedCount > 0) {
+        fmInfo() << "renamed in batch: " << renamedCount << " items, to: " << targetOrgUrl;
+        emitCurrentTaskNotify(lastSourceUrl, lastTargetUrl);
+        // all the files are moved, the progress is done
+        if (restUrls->isEmpty())
+            workData->currentWriteSize = qMax<qint64>(workData->currentWriteSize.load(), sourceFilesTotalSize.load());
+    }
+
+    return true;
+}
+
 bool DoCutFilesWorker::doCutFile(const FileInfoPointer &fromInfo, const FileInfoPointer &targetPathInfo)
 {
     // try rename
@@ -36,6 +36,7 @@ protected:
     void endWork() override;
 
     bool cutFiles();
+    bool renameFilesInBatch(QList<QUrl> *restUrls);
     bool doCutFile(const FileInfoPointer &fromInfo, const FileInfoPointer &targetPathInfo);
     bool doRenameFile(const FileInfoPointer &sourceInfo, const FileInfoPointer &targetPathInfo, FileInfoPointer &toInfo, const QString fileName, bool *ok);
     bool renameFileByHandler(const FileInfoPointer &sourceInfo, const FileInfoPointer &targetInfo);
@@ -3,7 +3,11 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "dodeletefilesworker.h"
+#include "localdeleteengine.h"
+
 #include <dfm-base/base/schemefactory.h>
+#include <dfm-base/base/device/deviceutils.h>
+#include <dfm-base/utils/fileutils.h>
 
 #include <QUrl>
 #include <QDebug>
@@ -39,11 +43,41 @@ void DoDeleteFilesWorker::stop()
     AbstractWorker::stop();
 }
 
+/*!
+ * \brief DoDeleteFilesWorker::statisticsFilesSize the local engine counts the files while deleting,
+ * the tree is not walked before
+ */
+bool DoDeleteFilesWorker::statisticsFilesSize()
+{
+    useLocalEngine = canDeleteByLocalEngine();
+    if (useLocalEngine)
+        return true;
+
+    return AbstractWorker::statisticsFilesSize();
+}
+
 void DoDeleteFilesWorker::onUpdateProgress()
 {
     emitProgressChangedNotify(deleteFilesCount);
 }
 
+void DoDeleteFilesWorker::emitProgressChangedNotify(const qint64 &writSize)
+{
+    if (!useLocalEngine)
+        return AbstractWorker::emitProgressChangedNotify(writSize);
+
+    // the total grows while the engine reads the tree
+    JobInfoPointer info(new QMap<quint8, QVariant>);
+    info->insert(AbstractJobHandler::NotifyInfoKey::kJobtypeKey, QVariant::fromValue(jobType));
+    info->insert(AbstractJobHandler::NotifyInfoKey::kTotalSizeKey, QVariant::fromValue(qint64(foundFilesCount)));
+    const auto state = localEngineFinished ? AbstractJobHandler::StatisticState::kStopState
+                                           : AbstractJobHandler::StatisticState::kRunningState;
+    info->insert(AbstractJobHandler::NotifyInfoKey::kStatisticStateKey, QVariant::fromValue(state));
+    info->insert(AbstractJobHandler::NotifyInfoKey::kCurrentProgressKey, QVariant::fromValue(writSize));
+
+    emit progressChangedNotify(info);
+}
+
 /*!
  * \brief DoDeleteFilesWorker::deleteAllFiles delete All files
  * \return delete all files success
@@ -51,12 +85,94 @@ void DoDeleteFilesWorker::onUpdateProgress()
 bool DoDeleteFilesWorker::deleteAllFiles()
 {
     // sources file list is checked
+    // delete local files by dir fds
+    if (useLocalEngine)
+        return deleteFilesOnLocalDevice();
+
     // delete files on can't remove device
     if (isSourceFileLocal) {
         return deleteFilesOnCanNotRemoveDevice();
     }
     return deleteFilesOnOtherDevice();
 }
+/*!
+ * \brief DoDeleteFilesWorker::canDeleteByLocalEngine all source files are on local file systems,
+ * gvfs, smb and mtp mounts still go through dfm-io
+ * \return can be deleted by LocalDeleteEngine
+ */
+bool DoDeleteFilesWorker::canDeleteByLocalEngine()
+{
+    if (sourceUrls.isEmpty())
+        return false;
+
+    for (const auto &url : sourceUrls) {
+        if (!url.isLocalFile() || DeviceUtils::isLowSpeedDevice(url) || FileUtils::isMtpFile(url))
+            return false;
+    }
+    return true;
+}
+/*!
+ * \brief DoDeleteFilesWorker::deleteFilesOnLocalDevice Delete files by LocalDeleteEngine,
+ * errors of the engine threads are handled in this thread one by one
+ * \return delete file success
+ */
+bool DoDeleteFilesWorker::deleteFilesOnLocalDevice()
+{
+    if (sourceUrls.count() == 1 && isConvert) {
+        auto info = InfoFactory::create<FileInfo>(sourceUrls.first(), Global::CreateFileInfoType::kCreateFileInfoSync);
+        if (info)
+            deleteFirstFileSize = info->size();
+    }
+
+    LocalDeleteEngine engine(&deleteFilesCount, &foundFilesCount);
+    engine.setThreadCount(LocalDeleteEngine::threadCountOfPath(sourceUrls.first().toLocalFile()));
+    engine.start(sourceUrls);
+
+    QUrl currentUrl;
+    while (!engine.isFinished()) {
+        if (currentState == AbstractJobHandler::JobState::kPauseState) {
+            engine.setPaused(true);
+            const bool running = stateCheck();
+            engine.setPaused(false);
+            if (!running) {
+                engine.stop();
+                break;
+            }
+        }
+
+        if (isStopped()) {
+            engine.stop();
+            break;
+        }
+
+        const QUrl &url = engine.currentUrl();
+        if (url.isValid() && url != currentUrl) {
+            currentUrl = url;
+            emitCurrentTaskNotify(url, QUrl());
+        }
+
+        const auto &error = engine.takeError(100);
+        if (!error)
+            continue;
+
+        engine.setPaused(true);
+        const auto action = doHandleErrorAndWait(error->url, AbstractJobHandler::JobErrorType::kDeleteFileError, error->errorMsg);
+        engine.setPaused(false);
+        engine.resolveError(error, isStopped() ? AbstractJobHandler::SupportAction::kCancelAction : action);
+    }
+    engine.waitForFinished();
+    localEngineFinished = true;
+
+    const QSet<QUrl> &deletedUrls = engine.deletedUrls();
+    for (const auto &url : sourceUrls) {
+        if (deletedUrls.contains(url)) {
+            completeSourceFiles.append(url);
+            completeTargetFiles.append(url);
+        }
+    }
+
+    return !engine.isStopped();
+}
 /*!
  * \brief DoDeleteFilesWorker::deleteFilesOnCanNotRemoveDevice Delete files on non removable devices
  * \return delete file success
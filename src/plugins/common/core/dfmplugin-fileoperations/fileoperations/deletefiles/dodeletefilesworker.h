@@ -13,6 +13,8 @@
 
 #include <QObject>
 
+#include <atomic>
+
 DPFILEOPERATIONS_BEGIN_NAMESPACE
 DFMBASE_USE_NAMESPACE
 class DoDeleteFilesWorker : public AbstractWorker
@@ -27,10 +29,14 @@ public:
 protected:
     bool doWork() override;
     void stop() override;
+    bool statisticsFilesSize() override;
     void onUpdateProgress() override;
+    void emitProgressChangedNotify(const qint64 &writSize) override;
 
 protected:
     bool deleteAllFiles();
+    bool canDeleteByLocalEngine();
+    bool deleteFilesOnLocalDevice();
     bool deleteFilesOnCanNotRemoveDevice();
     bool deleteFilesOnOtherDevice();
     bool deleteFileOnOtherDevice(const QUrl &url);
@@ -41,6 +47,9 @@ protected:
 
 private:
     QAtomicInteger<qint64> deleteFilesCount { 0 };
+    QAtomicInteger<qint64> foundFilesCount { 0 };   // entries read by the local engine
+    bool useLocalEngine { false };
+    std::atomic_bool localEngineFinished { false };
 };
 DPFILEOPERATIONS_END_NAMESPACE
 
@@ -0,0 +1,445 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "localdeleteengine.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <cerrno>
+#include <cstring>
+
+static constexpr int kMaxDeleteThreadCount { 8 };
+static constexpr int kDirentBufferSize { 32 * 1024 };
+
+namespace {
+struct LinuxDirent64
+{
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+QByteArray joinPath(const QByteArray &dir, const char *name)
+{
+    if (dir.endsWith('/'))
+        return dir + name;
+    return dir + '/' + name;
+}
+}   // namespace
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+LocalDeleteEngine::LocalDeleteEngine(QAtomicInteger<qint64> *deletedCount, QAtomicInteger<qint64> *foundCount)
+    : deletedCount(deletedCount), foundCount(foundCount)
+{
+}
+
+LocalDeleteEngine::~LocalDeleteEngine()
+{
+    stop();
+    waitForFinished();
+}
+
+/*!
+ * \brief LocalDeleteEngine::threadCountOfPath parallel delete only helps on SSD,
+ * rotational disks and usb devices are deleted serially
+ * \param path path on the device
+ * \return thread count for the device
+ */
+int LocalDeleteEngine::threadCountOfPath(const QString &path)
+{
+    struct stat statBuffer;
+    if (::stat(path.toLocal8Bit().constData(), &statBuffer) != 0)
+        return 1;
+
+    const QString &sysPath = QFileInfo(QString("/sys/dev/block/%1:%2")
+                                               .arg(major(statBuffer.st_dev))
+                                               .arg(minor(statBuffer.st_dev)))
+                                     .canonicalFilePath();
+    if (sysPath.isEmpty() || sysPath.contains("/usb"))
+        return 1;
+
+    // partitions have no queue, use the one of the whole disk
+    QFile rotational(sysPath + "/queue/rotational");
+    if (!rotational.exists())
+        rotational.setFileName(sysPath + "/../queue/rotational");
+    if (!rotational.open(QIODevice::ReadOnly) || rotational.readAll().trimmed() != "0")
+        return 1;
+
+    return qBound(1, QThread::idealThreadCount(), kMaxDeleteThreadCount);
+}
+
+void LocalDeleteEngine::setThreadCount(int count)
+{
+    threadCount = qMax(1, count);
+}
+
+/*!
+ * \brief LocalDeleteEngine::start delete the urls in the thread pool, returns immediately
+ * \param urls local urls
+ */
+void LocalDeleteEngine::start(const QList<QUrl> &urls)
+{
+    stopped = false;
+    runners.clear();
+    for (int i = 0; i < threadCount; ++i)
+        runners.append(QSharedPointer<Runner>(new Runner));
+
+    int index = 0;
+    for (const auto &url : urls) {
+        DirNode *node = new DirNode;
+        node->path = url.toLocalFile().toLocal8Bit();
+        node->rootUrl = url;
+
+        // unlink reports the error if lstat failed
+        struct stat statBuffer;
+        if (::lstat(node->path.constData(), &statBuffer) == 0) {
+            node->device = statBuffer.st_dev;
+            node->isDir = S_ISDIR(statBuffer.st_mode);
+        } else {
+            node->isDir = false;
+        }
+
+        if (foundCount)
+            foundCount->ref();
+        activeRoots++;
+        push(index++ % threadCount, node);
+    }
+
+    pool.setMaxThreadCount(threadCount);
+    for (int i = 0; i < threadCount; ++i)
+        QtConcurrent::run(&pool, [this, i]() { run(i); });
+}
+
+bool LocalDeleteEngine::isFinished() const
+{
+    return activeRoots == 0 || (stopped && pool.activeThreadCount() == 0);
+}
+
+void LocalDeleteEngine::waitForFinished()
+{
+    pool.waitForDone();
+
+    // release the nodes left after stop
+    for (const auto &runner : runners) {
+        while (!runner->nodes.empty()) {
+            DirNode *node = runner->nodes.back();
+            runner->nodes.pop_back();
+            finishNode(node);
+        }
+    }
+}
+
+void LocalDeleteEngine::stop()
+{
+    stopped = true;
+    idleCondition.wakeAll();
+    errorResolved.wakeAll();
+    errorQueued.wakeAll();
+}
+
+bool LocalDeleteEngine::isStopped() const
+{
+    return stopped;
+}
+
+void LocalDeleteEngine::setPaused(bool paused)
+{
+    this->paused = paused;
+    if (!paused)
+        idleCondition.wakeAll();
+}
+
+/*!
+ * \brief LocalDeleteEngine::takeError called in the job thread, wait for an error of engine threads
+ * \param msecs max time to wait
+ * \return the error, null if no error occurred in time
+ */
+LocalDeleteEngine::ErrorInfoPointer LocalDeleteEngine::takeError(int msecs)
+{
+    QMutexLocker locker(&errorMutex);
+    if (errors.isEmpty() && !isFinished())
+        errorQueued.wait(&errorMutex, static_cast<unsigned long>(msecs));
+
+    return errors.isEmpty() ? ErrorInfoPointer() : errors.takeFirst();
+}
+
+/*!
+ * \brief LocalDeleteEngine::resolveError wake up the engine thread waiting for the action of the error
+ * \param error the error from takeError
+ * \param action retry or skip continue the deleting, the others stop the engine
+ */
+void LocalDeleteEngine::resolveError(const ErrorInfoPointer &error, AbstractJobHandler::SupportAction action)
+{
+    if (action != AbstractJobHandler::SupportAction::kRetryAction
+        && action != AbstractJobHandler::SupportAction::kSkipAction
+        && action != AbstractJobHandler::SupportAction::kNoAction)
+        stop();
+
+    QMutexLocker locker(&errorMutex);
+    error->action = action;
+    error->resolved = true;
+    errorResolved.wakeAll();
+}
+
+QUrl LocalDeleteEngine::currentUrl()
+{
+    QMutexLocker locker(&resultMutex);
+    return current;
+}
+
+QSet<QUrl> LocalDeleteEngine::deletedUrls()
+{
+    QMutexLocker locker(&resultMutex);
+    return deleted;
+}
+
+void LocalDeleteEngine::run(int index)
+{
+    while (!isStopped() && activeRoots > 0) {
+        waitIfPaused();
+
+        DirNode *node = popOrSteal(index);
+        if (!node) {
+            QMutexLocker locker(&idleMutex);
+            idleCondition.wait(&idleMutex, 10);
+            continue;
+        }
+
+        processNode(index, node);
+    }
+}
+
+void LocalDeleteEngine::waitIfPaused()
+{
+    while (paused && !isStopped()) {
+        QMutexLocker locker(&idleMutex);
+        idleCondition.wait(&idleMutex, 50);
+    }
+}
+
+void LocalDeleteEngine::push(int index, DirNode *node)
+{
+    {
+        QMutexLocker locker(&runners.at(index)->mutex);
+        runners.at(index)->nodes.push_back(node);
+    }
+    idleCondition.wakeOne();
+}
+
+/*!
+ * \brief LocalDeleteEngine::popOrSteal the newest node of own queue keeps deleting depth first,
+ * idle threads steal the oldest node of the others, which is the biggest sub tree in general
+ */
+LocalDeleteEngine::DirNode *LocalDeleteEngine::popOrSteal(int index)
+{
+    {
+        Runner *own = runners.at(index).data();
+        QMutexLocker locker(&own->mutex);
+        if (!own->nodes.empty()) {
+            DirNode *node = own->nodes.back();
+            own->nodes.pop_back();
+            return node;
+        }
+    }
+
+    for (int i = 1; i < runners.size(); ++i) {
+        Runner *victim = runners.at((index + i) % runners.size()).data();
+        QMutexLocker locker(&victim->mutex);
+        if (!victim->nodes.empty()) {
+            DirNode *node = victim->nodes.front();
+            victim->nodes.pop_front();
+            return node;
+        }
+    }
+
+    return nullptr;
+}
+
+void LocalDeleteEngine::processNode(int index, DirNode *node)
+{
+    {
+        QMutexLocker locker(&resultMutex);
+        current = QUrl::fromLocalFile(QString::fromLocal8Bit(node->path));
+    }
+
+    if (node->isDir) {
+        if (!scanDir(index, node))
+            node->incomplete = true;
+    } else {
+        node->removed = removeEntry(AT_FDCWD, QByteArray(), node->path.constData(), 0);
+    }
+
+    finishNode(node);
+}
+
+/*!
+ * \brief LocalDeleteEngine::scanDir remove all non-directory entries of the dir,
+ * sub directories are pushed to the queue
+ * \return all entries are handled
+ */
+bool LocalDeleteEngine::scanDir(int index, DirNode *node)
+{
+    int fd = -1;
+    AbstractJobHandler::SupportAction action = AbstractJobHandler::SupportAction::kNoAction;
+    do {
+        action = AbstractJobHandler::SupportAction::kNoAction;
+        fd = ::open(node->path.constData(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0)
+            action = reportError(node->path, errno);
+    } while (action == AbstractJobHandler::SupportAction::kRetryAction && !isStopped());
+
+    if (fd < 0)
+        return false;
+
+    // mounted after it was read, the other file system is not deleted and the dir is kept
+    struct stat statBuffer;
+    if (::fstat(fd, &statBuffer) != 0 || statBuffer.st_dev != node->device) {
+        ::close(fd);
+        return false;
+    }
+
+    bool ok = true;
+    QByteArray buffer(kDirentBufferSize, Qt::Uninitialized);
+    while (!isStopped()) {
+        waitIfPaused();
+
+        const long count = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            action = reportError(node->path, errno);
+            if (action == AbstractJobHandler::SupportAction::kRetryAction)
+                continue;
+            ok = false;
+            break;
+        }
+        if (count == 0)
+            break;
+
+        for (long offset = 0; offset < count && !isStopped();) {
+            const auto entry = reinterpret_cast<LinuxDirent64 *>(buffer.data() + offset);
+            offset += entry->d_reclen;
+
+            const char *name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                continue;
+
+            if (foundCount)
+                foundCount->ref();
+
+            // d_type tells no device, the sub directories are stated to stop at the mounts
+            struct stat entryStat;
+            bool isDir = entry->d_type == DT_DIR;
+            bool hasStat = false;
+            if (isDir || entry->d_type == DT_UNKNOWN) {
+                hasStat = ::fstatat(fd, name, &entryStat, AT_SYMLINK_NOFOLLOW) == 0;
+                if (hasStat)
+                    isDir = S_ISDIR(entryStat.st_mode);
+            }
+
+            if (isDir && hasStat && entryStat.st_dev != statBuffer.st_dev) {
+                fmInfo() << "skip the mount point in the deleted tree:" << joinPath(node->path, name);
+                node->incomplete = true;
+                continue;
+            }
+
+            if (isDir) {
+                DirNode *child = new DirNode;
+                child->path = joinPath(node->path, name);
+                child->parent = node;
+                child->device = statBuffer.st_dev;
+                node->pending++;
+                push(index, child);
+                continue;
+            }
+
+            if (!removeEntry(fd, node->path, name, 0))
+                ok = false;
+        }
+    }
+
+    ::close(fd);
+    return ok && !isStopped();
+}
+
+/*!
+ * \brief LocalDeleteEngine::finishNode release one pending count of the node, the dir is removed
+ * when its scan and all sub directories are done, then the parent is notified
+ */
+void LocalDeleteEngine::finishNode(DirNode *node)
+{
+    if (--node->pending > 0)
+        return;
+
+    if (node->isDir && !node->incomplete && !isStopped())
+        node->removed = removeEntry(AT_FDCWD, QByteArray(), node->path.constData(), AT_REMOVEDIR);
+
+    DirNode *parent = node->parent;
+    const bool removed = node->removed;
+    const QUrl rootUrl = node->rootUrl;
+    delete node;
+
+    if (parent) {
+        if (!removed)
+            parent->incomplete = true;
+        finishNode(parent);
+        return;
+    }
+
+    if (removed) {
+        QMutexLocker locker(&resultMutex);
+        deleted.insert(rootUrl);
+    }
+
+    if (--activeRoots == 0) {
+        idleCondition.wakeAll();
+        errorQueued.wakeAll();
+    }
+}
+
+bool LocalDeleteEngine::removeEntry(int dirFd, const QByteArray &dirPath, const char *name, int flags)
+{
+    AbstractJobHandler::SupportAction action = AbstractJobHandler::SupportAction::kNoAction;
+    do {
+        if (::unlinkat(dirFd, name, flags) == 0 || errno == ENOENT) {
+            if (deletedCount)
+                deletedCount->ref();
+            return true;
+        }
+        action = reportError(dirPath.isEmpty() ? QByteArray(name) : joinPath(dirPath, name), errno);
+    } while (action == AbstractJobHandler::SupportAction::kRetryAction && !isStopped());
+
+    return false;
+}
+
+/*!
+ * \brief LocalDeleteEngine::reportError queue the error and block the engine thread until
+ * the job thread resolves it
+ * \return the action of the user
+ */
+AbstractJobHandler::SupportAction LocalDeleteEngine::reportError(const QByteArray &path, int errnum)
+{
+    ErrorInfoPointer error(new ErrorInfo);
+    error->url = QUrl::fromLocalFile(QString::fromLocal8Bit(path));
+    error->errorMsg = QString::fromLocal8Bit(strerror(errnum));
+
+    QMutexLocker locker(&errorMutex);
+    errors.append(error);
+    errorQueued.wakeAll();
+    while (!error->resolved && !isStopped())
+        errorResolved.wait(&errorMutex, 100);
+
+    return error->resolved ? error->action : AbstractJobHandler::SupportAction::kCancelAction;
+}
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LOCALDELETEENGINE_H
+#define LOCALDELETEENGINE_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <dfm-base/interfaces/abstractjobhandler.h>
+
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QUrl>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <deque>
+
+#include <sys/types.h>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+DFMBASE_USE_NAMESPACE
+
+/*!
+ * \brief The LocalDeleteEngine class deletes trees on local file systems with directory fds.
+ * Directories are read by getdents64 and entries are removed by unlinkat relative to the
+ * directory fd, no FileInfo is created. Sub directories are fanned out to a work stealing
+ * pool whose size depends on the device type.
+ * Engine threads never touch the job state, errors are queued and resolved by the job thread
+ * through takeError/resolveError.
+ * The tree is not walked before deleting, the entries are counted in foundCount as they are read,
+ * and the mounts inside the tree are kept with their parents.
+ */
+class LocalDeleteEngine
+{
+    Q_DISABLE_COPY(LocalDeleteEngine)
+
+public:
+    struct ErrorInfo
+    {
+        QUrl url;
+        QString errorMsg;
+        AbstractJobHandler::SupportAction action { AbstractJobHandler::SupportAction::kNoAction };
+        bool resolved { false };
+    };
+    using ErrorInfoPointer = QSharedPointer<ErrorInfo>;
+
+    explicit LocalDeleteEngine(QAtomicInteger<qint64> *deletedCount, QAtomicInteger<qint64> *foundCount = nullptr);
+    ~LocalDeleteEngine();
+
+    static int threadCountOfPath(const QString &path);
+
+    void setThreadCount(int count);
+    void start(const QList<QUrl> &urls);
+    bool isFinished() const;
+    void waitForFinished();
+    void stop();
+    bool isStopped() const;
+    void setPaused(bool paused);
+
+    ErrorInfoPointer takeError(int msecs);
+    void resolveError(const ErrorInfoPointer &error, AbstractJobHandler::SupportAction action);
+
+    QUrl currentUrl();
+    QSet<QUrl> deletedUrls();
+
+private:
+    struct DirNode
+    {
+        QByteArray path;
+        DirNode *parent { nullptr };
+        QUrl rootUrl;   // valid for the source urls
+        dev_t device { 0 };
+        bool isDir { true };
+        bool removed { false };
+        std::atomic_int pending { 1 };   // own scan and the unfinished children
+        std::atomic_bool incomplete { false };   // some children were skipped, keep this dir
+    };
+
+    struct Runner
+    {
+        QMutex mutex;
+        std::deque<DirNode *> nodes;
+    };
+
+    void run(int index);
+    void waitIfPaused();
+    void push(int index, DirNode *node);
+    DirNode *popOrSteal(int index);
+    void processNode(int index, DirNode *node);
+    bool scanDir(int index, DirNode *node);
+    void finishNode(DirNode *node);
+    bool removeEntry(int dirFd, const QByteArray &dirPath, const char *name, int flags);
+    AbstractJobHandler::SupportAction reportError(const QByteArray &path, int errnum);
+
+private:
+    QAtomicInteger<qint64> *deletedCount { nullptr };
+    QAtomicInteger<qint64> *foundCount { nullptr };
+    int threadCount { 1 };
+    QThreadPool pool;
+    QList<QSharedPointer<Runner>> runners;
+    std::atomic_int activeRoots { 0 };
+    std::atomic_bool stopped { false };
+    std::atomic_bool paused { false };
+
+    QMutex idleMutex;
+    QWaitCondition idleCondition;
+
+    QMutex errorMutex;
+    QWaitCondition errorQueued;
+    QWaitCondition errorResolved;
+    QList<ErrorInfoPointer> errors;
+
+    QMutex resultMutex;
+    QSet<QUrl> deleted;
+    QUrl current;
+};
+
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // LOCALDELETEENGINE_H
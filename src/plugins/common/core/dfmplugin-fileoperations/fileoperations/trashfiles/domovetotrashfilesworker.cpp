@@ -16,10 +16,21 @@
 #include <QtGlobal>
 #include <QCryptographicHash>
 #include <QStorageInfo>
+#include <QDateTime>
 
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+
+#ifndef RENAME_NOREPLACE
+#    define RENAME_NOREPLACE (1 << 0)
+#endif
+
+static constexpr int kTrashBatchSize { 500 };
+static constexpr int kMaxTrashNameIndex { 1000 };
 
 USING_IO_NAMESPACE
 DPFILEOPERATIONS_USE_NAMESPACE
@@ -33,6 +44,7 @@ DoMoveToTrashFilesWorker::DoMoveToTrashFilesWorker(QObject *parent)
 DoMoveToTrashFilesWorker::~DoMoveToTrashFilesWorker()
 {
     stop();
+    closeLocalTrashDirs();
 }
 /*!
  * \brief DoMoveToTrashFilesWorker::doWork the thread move to trash work function
@@ -44,6 +56,7 @@ bool DoMoveToTrashFilesWorker::doWork()
         return false;
 
     doMoveToTrash();
+    closeLocalTrashDirs();
 
     endWork();
 
@@ -66,24 +79,17 @@ void DoMoveToTrashFilesWorker::onUpdateProgress()
 }
 /*!
  * \brief DoMoveToTrashFilesWorker::doMoveToTrash do move to trash
+ * Files on the same device as the home trash are collected into batches and moved by
+ * flushTrashBatch, the others go through doMoveToTrashFile one by one
  * \return move to trash success
  */
 bool DoMoveToTrashFilesWorker::doMoveToTrash()
 {
-    bool result = false;
-    DFMBASE_NAMESPACE::LocalFileHandler fileHandler;
-    static QString homeTrashFileDir = dfmbase::StandardPaths::location(StandardPaths::StandardLocation::kTrashLocalFilesPath);
+    initLocalTrashDirs();
+
     // 总大小使用源文件个数
     for (const auto &url : sourceUrls) {
-        QUrl urlSource = url;
-        if (!fstabMap.empty()) {
-            for (const auto &device : fstabMap.keys()) {
-                if (urlSource.path().startsWith(device)) {
-                    urlSource.setPath(urlSource.path().replace(0, device.size(), fstabMap[device]));
-                    break;
-                }
-            }
-        }
+        const QUrl &urlSource = bindMappedUrl(url);
 
         if (!stateCheck())
             return false;
@@ -94,65 +100,92 @@ bool DoMoveToTrashFilesWorker::doMoveToTrash()
             continue;
         }
 
-        // url是否可以删除 canrename
-        if (!isCanMoveToTrash(urlSource, &result)) {
-            if (result) {
-                completeFilesCount++;
-                completeSourceFiles.append(urlSource);
-                continue;
-            }
-            return false;
-        }
-
-        const auto &fileInfo = InfoFactory::create<FileInfo>(urlSource, Global::CreateFileInfoType::kCreateFileInfoSync);
-        if (!fileInfo) {
-            // pause and emit error msg
-            if (AbstractJobHandler::SupportAction::kSkipAction != doHandleErrorAndWait(urlSource, targetUrl, AbstractJobHandler::JobErrorType::kProrogramError)) {
+        if (canBatchMoveToTrash(url, urlSource)) {
+            trashBatch.append({ url, urlSource, QString() });
+            if (trashBatch.size() >= kTrashBatchSize && !flushTrashBatch())
                 return false;
-            } else {
-                completeFilesCount++;
-                continue;
-            }
+            continue;
         }
 
-        emitCurrentTaskNotify(urlSource, targetUrl);
+        // keep the order of the source urls, the pending batch goes first
+        if (!flushTrashBatch())
+            return false;
 
-        AbstractJobHandler::SupportAction action = AbstractJobHandler::SupportAction::kNoAction;
-        do {
-            action = AbstractJobHandler::SupportAction::kNoAction;
-            QString trashTime = fileHandler.trashFile(urlSource);
-            if (!trashTime.isEmpty()) {
-                QUrl trashUrl = urlSource;
-                trashUrl.setUserInfo(trashTime);
+        if (!doMoveToTrashFile(url, urlSource))
+            return false;
+    }
 
-                completeTargetFiles.append(trashUrl);
-                emitProgressChangedNotify(completeFilesCount);
-                completeSourceFiles.append(urlSource);
-                continue;
-            } else {
-                // pause and emit error msg
-                auto errmsg = QString("Unknown error");
-                if (fileHandler.errorCode() == DFMIOErrorCode::DFM_IO_ERROR_NOT_SUPPORTED) {
-                    errmsg = QString("The file can't be put into trash, you can use \"Shift+Del\" to delete the file completely.");
-                } else if (fileHandler.errorCode() != DFMIOErrorCode::DFM_IO_ERROR_NONE) {
-                    errmsg = fileHandler.errorString();
-                }
-                action = doHandleErrorAndWait(url, QUrl(),
-                                              AbstractJobHandler::JobErrorType::kFileMoveToTrashError, false,
-                                              fileHandler.errorCode() == DFMIOErrorCode::DFM_IO_ERROR_NONE ? "Unknown error"
-                                                                                                           : fileHandler.errorString());
-            }
-        } while (action == AbstractJobHandler::SupportAction::kRetryAction && !isStopped());
+    return flushTrashBatch();
+}
+
+/*!
+ * \brief DoMoveToTrashFilesWorker::doMoveToTrashFile move one file to trash by dfm-io
+ * \param url the source url
+ * \param urlSource the source url after fstab bind mapping
+ * \return false if the job should stop
+ */
+bool DoMoveToTrashFilesWorker::doMoveToTrashFile(const QUrl &url, const QUrl &urlSource)
+{
+    bool result = false;
+    DFMBASE_NAMESPACE::LocalFileHandler fileHandler;
 
-        if (action == AbstractJobHandler::SupportAction::kNoAction
-            || action == AbstractJobHandler::SupportAction::kSkipAction) {
+    // url是否可以删除 canrename
+    if (!isCanMoveToTrash(urlSource, &result)) {
+        if (result) {
             completeFilesCount++;
+            completeSourceFiles.append(urlSource);
+            return true;
+        }
+        return false;
+    }
+
+    const auto &fileInfo = InfoFactory::create<FileInfo>(urlSource, Global::CreateFileInfoType::kCreateFileInfoSync);
+    if (!fileInfo) {
+        // pause and emit error msg
+        if (AbstractJobHandler::SupportAction::kSkipAction != doHandleErrorAndWait(urlSource, targetUrl, AbstractJobHandler::JobErrorType::kProrogramError)) {
+            return false;
+        } else {
+            completeFilesCount++;
+            return true;
+        }
+    }
+
+    emitCurrentTaskNotify(urlSource, targetUrl);
+
+    AbstractJobHandler::SupportAction action = AbstractJobHandler::SupportAction::kNoAction;
+    do {
+        action = AbstractJobHandler::SupportAction::kNoAction;
+        QString trashTime = fileHandler.trashFile(urlSource);
+        if (!trashTime.isEmpty()) {
+            QUrl trashUrl = urlSource;
+            trashUrl.setUserInfo(trashTime);
+
+            completeTargetFiles.append(trashUrl);
+            emitProgressChangedNotify(completeFilesCount);
+            completeSourceFiles.append(urlSource);
             continue;
+        } else {
+            // pause and emit error msg
+            auto errmsg = QString("Unknown error");
+            if (fileHandler.errorCode() == DFMIOErrorCode::DFM_IO_ERROR_NOT_SUPPORTED) {
+                errmsg = QString("The file can't be put into trash, you can use \"Shift+Del\" to delete the file completely.");
+            } else if (fileHandler.errorCode() != DFMIOErrorCode::DFM_IO_ERROR_NONE) {
+                errmsg = fileHandler.errorString();
+            }
+            action = doHandleErrorAndWait(url, QUrl(),
+                                          AbstractJobHandler::JobErrorType::kFileMoveToTrashError, false,
+                                          fileHandler.errorCode() == DFMIOErrorCode::DFM_IO_ERROR_NONE ? "Unknown error"
+                                                                                                       : fileHandler.errorString());
         }
+    } while (action == AbstractJobHandler::SupportAction::kRetryAction && !isStopped());
 
-        return false;
+    if (action == AbstractJobHandler::SupportAction::kNoAction
+        || action == AbstractJobHandler::SupportAction::kSkipAction) {
+        completeFilesCount++;
+        return true;
     }
-    return true;
+
+    return false;
 }
 
 /*!
@@ -184,3 +217,285 @@ bool DoMoveToTrashFilesWorker::isCanMoveToTrash(const QUrl &url, bool *result)
 
     return true;
 }
+
+/*!
+ * \brief DoMoveToTrashFilesWorker::parentDirState get the cached fstab mapping and batch
+ * eligibility of a parent dir, so the checks run once for all files in the same dir
+ * \param parentPath the parent path before fstab bind mapping
+ * \return state of the parent dir
+ */
+const DoMoveToTrashFilesWorker::ParentDirState &DoMoveToTrashFilesWorker::parentDirState(const QString &parentPath)
+{
+    auto it = parentDirStates.find(parentPath);
+    if (it != parentDirStates.end())
+        return it.value();
+
+    ParentDirState state;
+    state.mappedPath = parentPath;
+    const QString &parentPrefix = parentPath.endsWith('/') ? parentPath : parentPath + '/';
+    for (auto device = fstabMap.cbegin(); device != fstabMap.cend(); ++device) {
+        if (parentPath.startsWith(device.key())) {
+            state.mappedPath = QString(parentPath).replace(0, device.key().size(), device.value());
+            break;
+        }
+        if (device.key().startsWith(parentPrefix))
+            state.checkFullPath = true;
+    }
+
+    struct stat statBuffer;
+    const QByteArray &mappedPath = state.mappedPath.toLocal8Bit();
+    if (trashDevice >= 0 && ::stat(mappedPath.constData(), &statBuffer) == 0
+        && static_cast<qint64>(statBuffer.st_dev) == trashDevice
+        && ::access(mappedPath.constData(), W_OK | X_OK) == 0) {
+        state.batchable = true;
+        state.sticky = (statBuffer.st_mode & S_ISVTX) == S_ISVTX;
+    }
+
+    return parentDirStates.insert(parentPath, state).value();
+}
+
+/*!
+ * \brief DoMoveToTrashFilesWorker::bindMappedUrl replace the fstab bind source of the url path
+ * \param url the source url
+ * \return the url after mapping
+ */
+QUrl DoMoveToTrashFilesWorker::bindMappedUrl(const QUrl &url)
+{
+    if (fstabMap.isEmpty())
+        return url;
+
+    QUrl urlSource = url;
+    const QString &path = url.path();
+    const int index = path.lastIndexOf('/');
+    if (index >= 0) {
+        const auto &state = parentDirState(index == 0 ? QString("/") : path.left(index));
+        if (!state.checkFullPath) {
+            const QString &parent = state.mappedPath.endsWith('/') ? state.mappedPath : state.mappedPath + '/';
+            urlSource.setPath(parent + path.mid(index + 1));
+            return urlSource;
+        }
+    }
+
+    for (auto device = fstabMap.cbegin(); device != fstabMap.cend(); ++device) {
+        if (path.startsWith(device.key())) {
+            urlSource.setPath(QString(path).replace(0, device.key().size(), device.value()));
+            break;
+        }
+    }
+    return urlSource;
+}
+
+/*!
+ * \brief DoMoveToTrashFilesWorker::canBatchMoveToTrash the file is a local file on the home trash
+ * device and can be removed by current user, it can be renamed into the home trash directly
+ * \param url the source url
+ * \param urlSource the source url after fstab bind mapping
+ * \return can be moved in batch
+ */
+bool DoMoveToTrashFilesWorker::canBatchMoveToTrash(const QUrl &url, const QUrl &urlSource)
+{
+    if (trashDevice < 0 || !url.isLocalFile() || !urlSource.isLocalFile())
+        return false;
+
+    const QString &path = url.path();
+    const int index = path.lastIndexOf('/');
+    if (index < 0 || index == path.length() - 1)
+        return false;
+
+    const auto &state = parentDirState(index == 0 ? QString("/") : path.left(index));
+    if (!state.batchable)
+        return false;
+
+    // the file itself is a bind source
+    const QString &sourcePath = urlSource.path();
+    const QString &parent = state.mappedPath.endsWith('/') ? state.mappedPath : state.mappedPath + '/';
+    if (sourcePath != parent + path.mid(index + 1))
+        return false;
+
+    struct stat statBuffer;
+    if (::lstat(sourcePath.toLocal8Bit().constData(), &statBuffer) != 0)
+        return false;
+
+    // mount point
+    if (static_cast<qint64>(statBuffer.st_dev) != trashDevice)
+        return false;
+
+    if (state.sticky && getuid() != 0 && statBuffer.st_uid != getuid())
+        return false;
+
+    return true;
+}
+
+/*!
+ * \brief DoMoveToTrashFilesWorker::initLocalTrashDirs open the home trash dirs for batch mode
+ * \return batch mode is available
+ */
+bool DoMoveToTrashFilesWorker::initLocalTrashDirs()
+{
+    if (trashDevice >= 0)
+        return true;
+
+    const QString &trashPath = StandardPaths::location(StandardPaths::StandardLocation::kTrashLocalPath);
+    const QString &filesPath = StandardPaths::location(StandardPaths::StandardLocation::kTrashLocalFilesPath);
+    const QString &infoPath = StandardPaths::location(StandardPaths::StandardLocation::kTrashLocalInfoPath);
+    for (const auto &path : { trashPath, filesPath, infoPath }) {
+        if (::mkdir(path.toLocal8Bit().constData(), 0700) != 0 && errno != EEXIST) {
+            fmWarning() << "create trash dir failed, batch mode disabled: " << path << strerror(errno);
+            return false;
+        }
+    }
+
+    trashFilesDirFd = ::open(filesPath.toLocal8Bit().constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    trashInfoDirFd = ::open(infoPath.toLocal8Bit().constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    struct stat filesStat;
+    struct stat infoStat;
+    if (trashFilesDirFd < 0 || trashInfoDirFd < 0
+        || ::fstat(trashFilesDirFd, &filesStat) != 0 || ::fstat(trashInfoDirFd, &infoStat) != 0
+        || filesStat.st_dev != infoStat.st_dev) {
+        fmWarning() << "open trash dir failed, batch mode disabled: " << trashPath;
+        closeLocalTrashDirs();
+        return false;
+    }
+
+    trashDevice = static_cast<qint64>(filesStat.st_dev);
+    return true;
+}
+
+void DoMoveToTrashFilesWorker::closeLocalTrashDirs()
+{
+    if (trashFilesDirFd >= 0)
+        ::close(trashFilesDirFd);
+    if (trashInfoDirFd >= 0)
+        ::close(trashInfoDirFd);
+    trashFilesDirFd = -1;
+    trashInfoDirFd = -1;
+    trashDevice = -1;
+}
+
+/*!
+ * \brief DoMoveToTrashFilesWorker::reserveTrashInfo create the .trashinfo file exclusively,
+ * the name of it is reserved for the file moved later. The content is not synced here.
+ * \param fileName name of the source file
+ * \param content content of the .trashinfo file
+ * \return the reserved name in trash, empty if failed
+ */
+QString DoMoveToTrashFilesWorker::reserveTrashInfo(const QString &fileName, const QByteArray &content)
+{
+    const QByteArray &baseName = fileName.toLocal8Bit();
+    for (int i = 1; i < kMaxTrashNameIndex; ++i) {
+        const QByteArray &trashName = i == 1 ? baseName : baseName + "." + QByteArray::number(i);
+        struct stat statBuffer;
+        if (::fstatat(trashFilesDirFd, trashName.constData(), &statBuffer, AT_SYMLINK_NOFOLLOW) == 0)
+            continue;
+
+        const QByteArray &infoName = trashName + ".trashinfo";
+        int fd = ::openat(trashInfoDirFd, infoName.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            if (errno == EEXIST)
+                continue;
+            return QString();
+        }
+
+        qint64 written = 0;
+        while (written < content.size()) {
+            ssize_t ret = ::write(fd, content.constData() + written, static_cast<size_t>(content.size() - written));
+            if (ret < 0 && errno == EINTR)
+                continue;
+            if (ret <= 0)
+                break;
+            written += ret;
+        }
+        ::close(fd);
+
+        if (written != content.size()) {
+            ::unlinkat(trashInfoDirFd, infoName.constData(), 0);
+            return QString();
+        }
+        return QString::fromLocal8Bit(trashName);
+    }
+
+    return QString();
+}
+
+/*!
+ * \brief DoMoveToTrashFilesWorker::flushTrashBatch move the pending batch into the home trash.
+ * All .trashinfo files of the batch are written first and synced to disk once, then the files are
+ * moved by renameat2 without replacing. Files failed in batch mode fall back to doMoveToTrashFile,
+ * which keeps the error handling of every single file.
+ * \return false if the job should stop
+ */
+bool DoMoveToTrashFilesWorker::flushTrashBatch()
+{
+    if (trashBatch.isEmpty())
+        return true;
+
+    QList<TrashBatchItem> batch;
+    batch.swap(trashBatch);
+
+    emitCurrentTaskNotify(batch.first().urlSource, targetUrl);
+
+    const QDateTime &deletionTime = QDateTime::currentDateTime();
+    const QByteArray &deletionDate = deletionTime.toString("yyyy-MM-dd'T'hh:mm:ss").toLatin1();
+    for (auto &item : batch) {
+        const QByteArray &content = QByteArray("[Trash Info]\nPath=")
+                + QUrl::toPercentEncoding(item.urlSource.path(), "/")
+                + "\nDeletionDate=" + deletionDate + "\n";
+        item.trashName = reserveTrashInfo(item.urlSource.fileName(), content);
+    }
+    ::syncfs(trashInfoDirFd);
+
+    QList<QUrl> movedUrls;
+    auto commitMoved = [this, &movedUrls, &deletionTime]() {
+        if (movedUrls.isEmpty())
+            return;
+        const QString &trashTime = QString("%1-%2").arg(deletionTime.toSecsSinceEpoch()).arg(QDateTime::currentSecsSinceEpoch());
+        for (const auto &urlSource : movedUrls) {
+            QUrl trashUrl = urlSource;
+            trashUrl.setUserInfo(trashTime);
+            completeTargetFiles.append(trashUrl);
+            completeSourceFiles.append(urlSource);
+        }
+        movedUrls.clear();
+        ::fsync(trashFilesDirFd);
+        emitProgressChangedNotify(completeFilesCount);
+    };
+    auto dropReserved = [this, &batch](int from) {
+        for (int i = from; i < batch.size(); ++i) {
+            if (!batch.at(i).trashName.isEmpty())
+                ::unlinkat(trashInfoDirFd, (batch.at(i).trashName.toLocal8Bit() + ".trashinfo").constData(), 0);
+        }
+    };
+
+    for (int i = 0; i < batch.size(); ++i) {
+        const auto &item = batch.at(i);
+        if (!stateCheck()) {
+            dropReserved(i);
+            commitMoved();
+            return false;
+        }
+
+        if (!item.trashName.isEmpty()) {
+            const QByteArray &trashName = item.trashName.toLocal8Bit();
+            if (::syscall(SYS_renameat2, AT_FDCWD, item.urlSource.path().toLocal8Bit().constData(),
+                          trashFilesDirFd, trashName.constData(), RENAME_NOREPLACE)
+                == 0) {
+                completeFilesCount++;
+                movedUrls.append(item.urlSource);
+                continue;
+            }
+
+            fmWarning() << "batch move to trash failed, fall back to single file mode: " << item.urlSource << strerror(errno);
+            ::unlinkat(trashInfoDirFd, (trashName + ".trashinfo").constData(), 0);
+        }
+
+        // report what is done before the file may wait for user action
+        commitMoved();
+        if (!doMoveToTrashFile(item.url, item.urlSource)) {
+            dropReserved(i + 1);
+            return false;
+        }
+    }
+
+    commitMoved();
+    return true;
+}
@@ -35,8 +35,34 @@ protected:
 
 protected:
     bool doMoveToTrash();
+    bool doMoveToTrashFile(const QUrl &url, const QUrl &urlSource);
     bool isCanMoveToTrash(const QUrl &url, bool *result);
 
+private:
+    struct ParentDirState
+    {
+        QString mappedPath;   // parent path after fstab bind mapping
+        bool checkFullPath { false };   // a bind source is nested in this dir, map the file path itself
+        bool batchable { false };   // on the home trash device and writable
+        bool sticky { false };   // the dir has the sticky bit, owner must be checked per file
+    };
+
+    struct TrashBatchItem
+    {
+        QUrl url;   // url in source urls
+        QUrl urlSource;   // url after fstab bind mapping
+        QString trashName;   // reserved name in the trash files dir
+    };
+
+    // batch move to home trash
+    const ParentDirState &parentDirState(const QString &parentPath);
+    QUrl bindMappedUrl(const QUrl &url);
+    bool canBatchMoveToTrash(const QUrl &url, const QUrl &urlSource);
+    bool initLocalTrashDirs();
+    void closeLocalTrashDirs();
+    QString reserveTrashInfo(const QString &fileName, const QByteArray &content);
+    bool flushTrashBatch();
+
 private:
     FileInfoPointer targetFileInfo { nullptr };   // target file information
     QAtomicInteger<qint64> completeFilesCount { 0 };   // move to trash success file count
@@ -44,6 +70,11 @@ private:
     QString trashLocalDir;   // the trash file locak dir
     QSharedPointer<StorageInfo> trashStorageInfo { nullptr };   // target file's device infor
     QMap<QString, QString> fstabMap;
+    QHash<QString, ParentDirState> parentDirStates;   // eligibility cache, grouped by parent dir
+    QList<TrashBatchItem> trashBatch;   // pending files of the next batch
+    int trashFilesDirFd { -1 };   // home trash files dir fd
+    int trashInfoDirFd { -1 };   // home trash info dir fd
+    qint64 trashDevice { -1 };   // st_dev of home trash, -1 means batch mode is unavailable
 };
 DPFILEOPERATIONS_END_NAMESPACE
 
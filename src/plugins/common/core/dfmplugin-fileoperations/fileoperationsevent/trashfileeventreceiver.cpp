@@ -9,6 +9,7 @@
 #include <dfm-base/utils/hidefilehelper.h>
 #include <dfm-base/base/urlroute.h>
 #include <dfm-base/file/local/localfilehandler.h>
+#include <dfm-base/file/local/localtrashenumerator.h>
 #include <dfm-base/utils/windowutils.h>
 #include <dfm-base/dfm_event_defines.h>
 #include <dfm-base/base/standardpaths.h>
@@ -27,6 +28,7 @@
 
 #include <QDebug>
 #include <QtConcurrent>
+#include <QSet>
 #include <QCoreApplication>
 
 Q_DECLARE_METATYPE(QList<QUrl> *)
@@ -163,8 +165,9 @@ JobHandlePointer TrashFileEventReceiver::doCleanTrash(const quint64 windowId, co
     DDesktopServices::playSystemSoundEffect(DDesktopServices::SSE_EmptyTrash);
 
     QList<QUrl> urls = std::move(sources);
-    if (urls.isEmpty())
-        urls.push_back(FileUtils::trashRootUrl());
+    // emptying the trash is done on the trash directories, not on the counted items
+    if (urls.isEmpty() || !showDelet)
+        urls = { FileUtils::trashRootUrl() };
 
     JobHandlePointer handle = copyMoveJob->cleanTrash(urls);
     FileOperationsEventHandler::instance()->handleJobResult(AbstractJobHandler::JobType::kCleanTrashType, handle);
@@ -178,14 +181,17 @@ void TrashFileEventReceiver::countTrashFile(const quint64 windowId, const DFMBAS
 {
     if (stoped)
         return;
-    DFMIO::DEnumerator enumerator(FileUtils::trashRootUrl());
+    const auto &items = LocalTrashEnumerator().items();
     QList<QUrl> allFilesList;
-    while (enumerator.hasNext()) {
+    QSet<QUrl> added;
+    for (const auto &item : items) {
         if (stoped)
             return;
-        auto url = FileUtils::bindUrlTransform(enumerator.next());
-        if (!allFilesList.contains(url))
-            allFilesList.append(url);
+        const QUrl &url = FileUtils::bindUrlTransform(item.url);
+        if (added.contains(url))
+            continue;
+        added.insert(url);
+        allFilesList.append(url);
     }
 
     if (stoped)
@@ -7,6 +7,7 @@
 #include "dialogs/dumpisooptdialog.h"
 #include "utils/burnhelper.h"
 #include "utils/burnjobmanager.h"
+#include "utils/burnstagingmanifest.h"
 #include "events/burneventcaller.h"
 
 #include <dfm-base/dfm_global_defines.h>
@@ -115,7 +116,63 @@ void BurnEventReceiver::handlePasteTo(const QList<QUrl> &urls, const QUrl &dest,
         tmpDest = UrlRoute::urlParent(tmpDest);
     QDir().mkpath(tmpDest.toLocalFile());
 
-    BurnEventCaller::sendPasteFiles(urls, tmpDest, isCopy);
+    if (isCopy)
+        graftToStaging(urls, tmpDest);
+    else
+        BurnEventCaller::sendPasteFiles(urls, tmpDest, isCopy);
+}
+
+/*!
+ * \brief BurnEventReceiver::graftToStaging clone or link the local files into the staging directory
+ * instead of copying them, in a worker since a tree is walked, the files which are not grafted
+ * are sent to the copy job then
+ */
+void BurnEventReceiver::graftToStaging(const QList<QUrl> &urls, const QUrl &stagingDir)
+{
+    struct GraftResult
+    {
+        QSharedPointer<BurnStagingManifest> grafted;
+        QList<QUrl> copyUrls, graftedUrls, stagedUrls;
+    };
+
+    QList<QUrl> localUrls, copyUrls;
+    for (const QUrl &url : urls) {
+        if (!url.isLocalFile() || DevProxyMng->isFileFromOptical(url.toLocalFile()))
+            copyUrls.append(url);
+        else
+            localUrls.append(url);
+    }
+
+    auto watcher = new QFutureWatcher<GraftResult>(this);
+    connect(watcher, &QFutureWatcher<GraftResult>::finished, this, [watcher, stagingDir]() {
+        watcher->deleteLater();
+        const GraftResult &result { watcher->result() };
+        if (!result.graftedUrls.isEmpty()) {
+            fmInfo() << "Grafted to staging: " << result.graftedUrls.size() << "files, copy the others: " << result.copyUrls.size();
+            // the manifest may be saved by the other grafts since, it is loaded here
+            BurnStagingManifest manifest { stagingDir.toLocalFile() };
+            manifest.load();
+            manifest.merge(*result.grafted);
+            manifest.save();
+            BurnHelper::mapStagingFilesPath(result.graftedUrls, result.stagedUrls);
+        }
+        if (!result.copyUrls.isEmpty())
+            BurnEventCaller::sendPasteFiles(result.copyUrls, stagingDir, true);
+    });
+
+    watcher->setFuture(QtConcurrent::run([localUrls, copyUrls, stagingDir]() {
+        GraftResult result { QSharedPointer<BurnStagingManifest>::create(stagingDir.toLocalFile()), copyUrls, {}, {} };
+        for (const QUrl &url : localUrls) {
+            QString stagedPath;
+            if (!result.grafted->graft(url.toLocalFile(), stagingDir.toLocalFile(), &stagedPath)) {
+                result.copyUrls.append(url);
+                continue;
+            }
+            result.graftedUrls.append(url);
+            result.stagedUrls.append(QUrl::fromLocalFile(stagedPath));
+        }
+        return result;
+    }));
 }
 
 void BurnEventReceiver::handleCopyFilesResult(const QList<QUrl> &srcUrls, const QList<QUrl> &destUrls, bool ok, const QString &errMsg)
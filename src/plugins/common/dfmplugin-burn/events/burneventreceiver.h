@@ -43,6 +43,7 @@ public slots:
 
 private:
     explicit BurnEventReceiver(QObject *parent = nullptr);
+    void graftToStaging(const QList<QUrl> &urls, const QUrl &stagingDir);
 };
 
 }
@@ -4,6 +4,7 @@
 
 #include "burncheckstrategy.h"
 #include "burnhelper.h"
+#include "burnstagingmanifest.h"
 
 #include <QDebug>
 
@@ -23,6 +24,15 @@ BurnCheckStrategy::BurnCheckStrategy(const QString &path, QObject *parent)
 {
 }
 
+/*!
+ * \brief BurnCheckStrategy::setManifest the files grafted in the manifest are checked by their
+ * paths in it, without walking the staged tree
+ */
+void BurnCheckStrategy::setManifest(const BurnStagingManifest *manifest)
+{
+    stagingManifest = manifest;
+}
+
 bool BurnCheckStrategy::check()
 {
     Q_ASSERT(!currentStagePath.isEmpty());
@@ -31,22 +41,7 @@ bool BurnCheckStrategy::check()
     if (!info.isDir())
         return true;
 
-    const QFileInfoList &rootFileInfoGroup { BurnHelper::localFileInfoList(currentStagePath) };
-    for (const QFileInfo &info : rootFileInfoGroup) {
-        if (!validFile(info))
-            return false;
-        if (info.isDir()) {
-            const auto &filters { QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks };
-            const QFileInfoList &subFileInfoGroup { BurnHelper::localFileInfoListRecursive(info.absoluteFilePath(), filters) };
-            if (!std::all_of(subFileInfoGroup.cbegin(), subFileInfoGroup.cend(), [this](const QFileInfo &info) {
-                    return validFile(info);
-                })) {
-                return false;
-            }
-        }
-    }
-
-    return true;
+    return checkDir(currentStagePath);
 }
 
 QString BurnCheckStrategy::lastError() const
@@ -59,6 +54,31 @@ QString BurnCheckStrategy::lastInvalidName() const
     return autoFeed(invalidName);
 }
 
+bool BurnCheckStrategy::checkDir(const QString &path)
+{
+    const QFileInfoList &fileInfoGroup { BurnHelper::localFileInfoList(path) };
+    for (const QFileInfo &info : fileInfoGroup) {
+        const QString &discPath { info.absoluteFilePath().mid(QDir::cleanPath(currentStagePath).length()) };
+        if (stagingManifest && stagingManifest->isGraftedRoot(discPath)) {
+            const QStringList &discPaths { stagingManifest->discPaths(discPath) };
+            if (!std::all_of(discPaths.cbegin(), discPaths.cend(), [this](const QString &grafted) {
+                    // measured as validFile measures the staged files
+                    return validPath(grafted.mid(grafted.lastIndexOf('/') + 1), QDir::separator() + grafted);
+                })) {
+                return false;
+            }
+            continue;
+        }
+
+        if (!validFile(info))
+            return false;
+        if (info.isDir() && !checkDir(info.absoluteFilePath()))
+            return false;
+    }
+
+    return true;
+}
+
 bool BurnCheckStrategy::validFile(const QFileInfo &info)
 {
     if (!info.exists())
@@ -67,6 +87,11 @@ bool BurnCheckStrategy::validFile(const QFileInfo &info)
     QString absoluteFilePathWithStagePath { info.absoluteFilePath() };
     const QString &fileName { info.fileName() };
     const QString &absoluteFilePath { QDir::separator() + absoluteFilePathWithStagePath.remove(currentStagePath) };
+    return validPath(fileName, absoluteFilePath);
+}
+
+bool BurnCheckStrategy::validPath(const QString &fileName, const QString &absoluteFilePath)
+{
     invalidName = fileName;
 
     if (!validFileNameCharacters(fileName)) {
@@ -10,18 +10,22 @@
 
 namespace dfmplugin_burn {
 
+class BurnStagingManifest;
 class BurnCheckStrategy : public QObject
 {
     Q_OBJECT
 
 public:
     explicit BurnCheckStrategy(const QString &path, QObject *parent = nullptr);
+    void setManifest(const BurnStagingManifest *manifest);
     bool check();
     QString lastError() const;
     QString lastInvalidName() const;
 
 private:
+    bool checkDir(const QString &path);
     bool validFile(const QFileInfo &info);
+    bool validPath(const QString &fileName, const QString &filePath);
     QString autoFeed(const QString &text) const;
 
 protected:
@@ -39,6 +43,7 @@ protected:
     QString invalidName;
     QString errorMsg;
     QString currentStagePath;
+    const BurnStagingManifest *stagingManifest { nullptr };
 };
 
 class ISO9660CheckStrategy final : public BurnCheckStrategy
@@ -6,6 +6,7 @@
 #include "utils/burnhelper.h"
 #include "utils/burnsignalmanager.h"
 #include "utils/burncheckstrategy.h"
+#include "utils/burnstagingmanifest.h"
 #include "events/burneventcaller.h"
 
 #include <dfm-base/base/application/application.h>
@@ -79,6 +80,24 @@ bool AbstractBurnJob::fileSystemLimitsValid()
     return true;
 }
 
+/*!
+ * \brief AbstractBurnJob::loadStagingManifest load the files grafted into the staging directory,
+ * without the ones changed in the staging view since, for the filesystem limit checks.
+ * The linked sources changed since they were staged are copied before the burn starts
+ */
+void AbstractBurnJob::loadStagingManifest(BurnStagingManifest *manifest)
+{
+    Q_ASSERT(manifest);
+    if (!manifest->load())
+        return;
+
+    int dropped { manifest->dropChanged() };
+    int copied { manifest->detachChanged() };
+    fmInfo() << "Staging manifest loaded, dropped the entries changed in the staging view: " << dropped
+             << ", copied the changed sources: " << copied;
+    manifest->save();
+}
+
 void AbstractBurnJob::updateMessage(JobInfoPointer ptr)
 {
     Q_ASSERT(ptr);
@@ -406,6 +425,8 @@ bool BurnISOFilesJob::fileSystemLimitsValid()
 {
     auto stagingurl { curProperty[PropertyType::KStagingUrl].toUrl() };
     auto opts { qvariant_cast<DFMBURN::BurnOptions>(curProperty[PropertyType::kBurnOpts]) };
+    BurnStagingManifest manifest { stagingurl.toLocalFile() };
+    loadStagingManifest(&manifest);
 
     // filesystem limits check
     QScopedPointer<BurnCheckStrategy> checkStrategy { nullptr };
@@ -416,6 +437,8 @@ bool BurnISOFilesJob::fileSystemLimitsValid()
     else
         checkStrategy.reset(new RockRidgeCheckStrategy(stagingurl.path()));
 
+    if (checkStrategy)
+        checkStrategy->setManifest(&manifest);
     if (checkStrategy && !checkStrategy->check()) {
         fmWarning() << "Check Failed: " << checkStrategy->lastError();
         emit requestErrorMessageDialog(tr("The file name or the path is too long. Please shorten the file name or the path and try again."),
@@ -510,9 +533,12 @@ BurnUDFFilesJob::BurnUDFFilesJob(const QString &dev, const JobHandlePointer hand
 bool BurnUDFFilesJob::fileSystemLimitsValid()
 {
     auto stagingurl { curProperty[PropertyType::KStagingUrl].toUrl() };
+    BurnStagingManifest manifest { stagingurl.toLocalFile() };
+    loadStagingManifest(&manifest);
 
     // filesystem limits check
     QScopedPointer<BurnCheckStrategy> checkStrategy { new UDFCheckStrategy(stagingurl.path()) };
+    checkStrategy->setManifest(&manifest);
     if (!checkStrategy->check()) {
         fmWarning() << "Check Failed: " << checkStrategy->lastError();
         emit requestErrorMessageDialog(tr("The file name or the path is too long. Please shorten the file name or the path and try again."),
@@ -14,6 +14,7 @@
 
 namespace dfmplugin_burn {
 
+class BurnStagingManifest;
 class AbstractBurnJob : public QThread
 {
     Q_OBJECT
@@ -63,6 +64,7 @@ protected:
 
     void run() override;
     bool readyToWork();
+    void loadStagingManifest(BurnStagingManifest *manifest);
     void workingInSubProcess();
     [[nodiscard]] DFMBURN::DOpticalDiscManager *createManager(int fd);
     QByteArray updatedInSubProcess(DFMBURN::JobStatus status, int progress, const QString &speed, const QStringList &message);
@@ -6,6 +6,7 @@
 #include "utils/burnjob.h"
 #include "utils/auditlogjob.h"
 #include "utils/packetwritingjob.h"
+#include "utils/burnstagingmanifest.h"
 
 #include <dfm-base/file/local/localfilehandler.h>
 #include <dfm-base/utils/dialogmanager.h>
@@ -209,6 +210,7 @@ bool BurnJobManager::deleteStagingDir(const QUrl &url)
         return false;
     }
 
+    BurnStagingManifest(path).clear();
     fmInfo() << "Delete cache folder: " << url << "success";
     return true;
 }
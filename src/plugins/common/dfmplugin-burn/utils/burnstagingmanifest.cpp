@@ -0,0 +1,364 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "burnstagingmanifest.h"
+
+#include <dfm-base/base/application/application.h>
+#include <dfm-base/base/application/settings.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <climits>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace dfmplugin_burn;
+DFMBASE_USE_NAMESPACE
+
+static constexpr char kManifestGroup[] { "StagingManifest" };
+static constexpr char kRootsKey[] { "roots" };
+static constexpr char kEntriesKey[] { "entries" };
+
+static qint64 modifyTimeOf(const struct stat &st)
+{
+    return static_cast<qint64>(st.st_mtim.tv_sec) * 1000 + st.st_mtim.tv_nsec / 1000000;
+}
+
+BurnStagingManifest::BurnStagingManifest(const QString &stagingPath)
+{
+    static QRegularExpression reg("^(.*/_dev_sr[0-9]*)(/.*)?$");
+    QRegularExpressionMatch match { reg.match(QDir::cleanPath(stagingPath)) };
+    if (!match.hasMatch()) {
+        fmWarning() << "Not a staging path: " << stagingPath;
+        return;
+    }
+
+    stagingRoot = match.captured(1);
+    device = stagingRoot.mid(stagingRoot.lastIndexOf('/') + 1).replace('_', '/');
+}
+
+/*!
+ * \brief BurnStagingManifest::graft clone or link a source file or directory into the staging directory
+ * \param destDir the staging directory to graft into
+ * \return false if nothing is grafted, the source must be copied then, it happens if a file of the
+ * source can be neither cloned nor linked to the staging directory or if the target exists
+ */
+bool BurnStagingManifest::graft(const QString &source, const QString &destDir, QString *stagedPath)
+{
+    if (stagingRoot.isEmpty())
+        return false;
+
+    const QString &staged { QDir::cleanPath(destDir) + "/" + QFileInfo(source).fileName() };
+    if (!QDir::cleanPath(staged).startsWith(stagingRoot + "/"))
+        return false;
+
+    struct stat st;
+    if (::lstat(staged.toLocal8Bit().constData(), &st) == 0)
+        return false;
+
+    QMap<QString, Entry> grafted;
+    if (!graftTree(source, staged, &grafted)) {
+        // nothing is half grafted, the staged names are removed, not the sources
+        QFileInfo info(staged);
+        if (info.isDir() && !info.isSymLink())
+            QDir(staged).removeRecursively();
+        else
+            QFile::remove(staged);
+        return false;
+    }
+
+    roots.insert(discPathOf(staged));
+    for (auto iter = grafted.cbegin(); iter != grafted.cend(); ++iter)
+        entries.insert(iter.key(), iter.value());
+    if (stagedPath)
+        *stagedPath = staged;
+    return true;
+}
+
+/*!
+ * \brief BurnStagingManifest::merge add the files grafted by another manifest of the same disc,
+ * the grafts are made aside and merged into the manifest saved
+ */
+void BurnStagingManifest::merge(const BurnStagingManifest &grafted)
+{
+    roots.unite(grafted.roots);
+    for (auto iter = grafted.entries.cbegin(); iter != grafted.entries.cend(); ++iter)
+        entries.insert(iter.key(), iter.value());
+}
+
+/*!
+ * \brief BurnStagingManifest::dropChanged drop the entries removed and the roots changed in the
+ * staging view, the trees of those roots are walked again by the checks
+ * \return the count of the entries dropped
+ */
+int BurnStagingManifest::dropChanged()
+{
+    int dropped { 0 };
+    for (auto iter = entries.begin(); iter != entries.end();) {
+        struct stat stagedSt;
+        if (::lstat((stagingRoot + iter.key()).toLocal8Bit().constData(), &stagedSt) != 0) {
+            // removed or renamed in the staging view
+            dropRootOf(iter.key());
+            iter = entries.erase(iter);
+            ++dropped;
+            continue;
+        }
+
+        // a file is added, removed or renamed in the staging view, the manifest misses it
+        if (iter->isDir() && modifyTimeOf(stagedSt) != iter->modifyTime)
+            dropRootOf(iter.key());
+        ++iter;
+    }
+    return dropped;
+}
+
+/*!
+ * \brief BurnStagingManifest::detachChanged copy the linked sources changed since they were grafted,
+ * the staged file is replaced by a copy of the current source and is no more linked to it. The sources
+ * unchanged stay linked, they are written from the source inodes.
+ * The entries removed in the staging view are dropped by dropChanged before
+ * \return the count of the files copied
+ */
+int BurnStagingManifest::detachChanged()
+{
+    int copied { 0 };
+    for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+        if (!iter->isLinked())
+            continue;
+
+        const QString &staged { stagingRoot + iter.key() };
+        struct stat stagedSt;
+        struct stat sourceSt;
+        if (::lstat(staged.toLocal8Bit().constData(), &stagedSt) != 0
+            || ::stat(iter->source.toLocal8Bit().constData(), &sourceSt) != 0)
+            continue;   // the link keeps the content of a removed source
+
+        const bool linked { sourceSt.st_ino == stagedSt.st_ino && sourceSt.st_dev == stagedSt.st_dev };
+        const bool stagedKept { stagedSt.st_size == iter->size && modifyTimeOf(stagedSt) == iter->modifyTime };
+        if (linked && stagedKept)
+            continue;
+        if (!linked && !stagedKept) {
+            // replaced in the staging view, the staged file is burnt as it is
+            iter->source.clear();
+            continue;
+        }
+
+        // changed through the link, or the source is replaced since
+        const QString &tmp { staged + ".dfm-staging" };
+        QFile::remove(tmp);
+        if (!QFile::copy(iter->source, tmp) || ::rename(tmp.toLocal8Bit().constData(), staged.toLocal8Bit().constData()) != 0) {
+            fmWarning() << "Copy changed source failed: " << iter->source;
+            QFile::remove(tmp);
+            continue;
+        }
+
+        fmInfo() << "Source changed after staged, copied: " << iter->source;
+        touchParentOf(iter.key());
+        iter->source.clear();
+        ++copied;
+    }
+    return copied;
+}
+
+bool BurnStagingManifest::isGraftedRoot(const QString &discPath) const
+{
+    return roots.contains(discPath);
+}
+
+/*!
+ * \brief BurnStagingManifest::discPaths the disc paths of a grafted root and all of its children
+ */
+QStringList BurnStagingManifest::discPaths(const QString &rootDiscPath) const
+{
+    QStringList paths;
+    const QString &prefix { rootDiscPath + "/" };
+    for (auto iter = entries.lowerBound(rootDiscPath); iter != entries.cend(); ++iter) {
+        if (iter.key() != rootDiscPath && !iter.key().startsWith(prefix)) {
+            // '/a b' sorts between '/a' and '/a/b'
+            if (iter.key().startsWith(rootDiscPath))
+                continue;
+            break;
+        }
+        paths.append(iter.key());
+    }
+    return paths;
+}
+
+BurnStagingManifest::Entry BurnStagingManifest::entry(const QString &discPath) const
+{
+    return entries.value(discPath);
+}
+
+bool BurnStagingManifest::load()
+{
+    if (device.isEmpty())
+        return false;
+
+    const QVariantMap &map { Application::dataPersistence()->value(kManifestGroup, device).toMap() };
+    if (map.isEmpty())
+        return false;
+
+    const QStringList &rootList { map.value(kRootsKey).toStringList() };
+    roots = rootList.toSet();
+    entries.clear();
+    const QVariantMap &entryMap { map.value(kEntriesKey).toMap() };
+    for (auto iter = entryMap.cbegin(); iter != entryMap.cend(); ++iter) {
+        const QVariantList &values { iter.value().toList() };
+        if (values.size() != 3)
+            continue;
+        Entry entry;
+        entry.source = values.at(0).toString();
+        entry.size = values.at(1).toLongLong();
+        entry.modifyTime = values.at(2).toLongLong();
+        entries.insert(iter.key(), entry);
+    }
+    return true;
+}
+
+void BurnStagingManifest::save() const
+{
+    if (device.isEmpty())
+        return;
+
+    QVariantMap entryMap;
+    for (auto iter = entries.cbegin(); iter != entries.cend(); ++iter)
+        entryMap.insert(iter.key(), QVariantList { iter->source, iter->size, iter->modifyTime });
+
+    QVariantMap map;
+    map.insert(kRootsKey, QStringList(roots.values()));
+    map.insert(kEntriesKey, entryMap);
+    Application::dataPersistence()->setValue(kManifestGroup, device, map);
+    Application::dataPersistence()->sync();
+}
+
+void BurnStagingManifest::clear()
+{
+    roots.clear();
+    entries.clear();
+    if (device.isEmpty())
+        return;
+
+    Application::dataPersistence()->remove(kManifestGroup, device);
+    Application::dataPersistence()->sync();
+}
+
+void BurnStagingManifest::dropRootOf(const QString &discPath)
+{
+    for (auto iter = roots.begin(); iter != roots.end(); ++iter) {
+        if (discPath == *iter || discPath.startsWith(*iter + "/")) {
+            roots.erase(iter);
+            return;
+        }
+    }
+}
+
+QString BurnStagingManifest::discPathOf(const QString &stagedPath) const
+{
+    return stagedPath.mid(stagingRoot.length());
+}
+
+bool BurnStagingManifest::graftTree(const QString &source, const QString &staged, QMap<QString, Entry> *grafted)
+{
+    struct stat st;
+    const QByteArray &sourcePath { source.toLocal8Bit() };
+    const QByteArray &stagedPath { staged.toLocal8Bit() };
+    if (::lstat(sourcePath.constData(), &st) != 0)
+        return false;
+
+    Entry entry;
+    if (S_ISDIR(st.st_mode)) {
+        if (::mkdir(stagedPath.constData(), (st.st_mode & 07777) | S_IRWXU) != 0)
+            return false;
+
+        const QStringList &names { QDir(source).entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System) };
+        bool ok = std::all_of(names.cbegin(), names.cend(), [&](const QString &name) {
+            return graftTree(source + "/" + name, staged + "/" + name, grafted);
+        });
+
+        // the modify time of the staged directory tells if it is changed in the staging view later
+        if (!ok || ::lstat(stagedPath.constData(), &st) != 0)
+            return false;
+        entry.modifyTime = modifyTimeOf(st);
+        grafted->insert(discPathOf(staged), entry);
+        return true;
+    }
+
+    if (S_ISLNK(st.st_mode)) {
+        char target[PATH_MAX] { 0 };
+        const ssize_t len { ::readlink(sourcePath.constData(), target, sizeof(target) - 1) };
+        if (len <= 0 || ::symlink(target, stagedPath.constData()) != 0)
+            return false;
+        entry.size = 0;
+        grafted->insert(discPathOf(staged), entry);
+        return true;
+    }
+
+    if (!S_ISREG(st.st_mode))
+        return false;
+
+    entry.size = static_cast<qint64>(st.st_size);
+    if (!cloneFile(source, staged)) {
+        // EXDEV across filesystems, EPERM for the files of the others with protected_hardlinks
+        if (::link(sourcePath.constData(), stagedPath.constData()) != 0)
+            return false;
+        entry.source = source;
+        entry.modifyTime = modifyTimeOf(st);
+    }
+
+    grafted->insert(discPathOf(staged), entry);
+    return true;
+}
+
+/*!
+ * \brief BurnStagingManifest::touchParentOf record the modify time of the parent directory again,
+ * replacing a staged file is not a change made in the staging view
+ */
+void BurnStagingManifest::touchParentOf(const QString &discPath)
+{
+    const QString &parent { discPath.left(discPath.lastIndexOf('/')) };
+    auto iter = entries.find(parent);
+    struct stat st;
+    if (iter != entries.end() && ::lstat((stagingRoot + parent).toLocal8Bit().constData(), &st) == 0)
+        iter->modifyTime = modifyTimeOf(st);
+}
+
+/*!
+ * \brief BurnStagingManifest::cloneFile create staged as a reflink clone of source, with its mode and times
+ * \return false if the filesystem cannot share the blocks, e.g. ext4, or across filesystems, the source
+ * is linked then
+ */
+bool BurnStagingManifest::cloneFile(const QString &source, const QString &staged)
+{
+    const int in { ::open(source.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC) };
+    if (in < 0)
+        return false;
+
+    struct stat st;
+    int out { -1 };
+    if (::fstat(in, &st) == 0)
+        out = ::open(staged.toLocal8Bit().constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, (st.st_mode & 07777) | S_IRUSR | S_IWUSR);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+
+    bool ok { ::ioctl(out, FICLONE, in) == 0 };
+    if (ok) {
+        const struct timespec times[2] { st.st_atim, st.st_mtim };
+        ::futimens(out, times);
+    }
+    ::close(out);
+    ::close(in);
+    if (!ok)
+        ::unlink(staged.toLocal8Bit().constData());
+    return ok;
+}
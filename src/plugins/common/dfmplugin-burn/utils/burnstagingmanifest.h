@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BURNSTAGINGMANIFEST_H
+#define BURNSTAGINGMANIFEST_H
+
+#include "dfmplugin_burn_global.h"
+
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+namespace dfmplugin_burn {
+
+/*!
+ * \brief The BurnStagingManifest class records the files grafted into the staging directory of a disc.
+ * A grafted file is a reflink clone of its source where the filesystem shares blocks, otherwise a hard
+ * link to it, so staging a file costs no space. A clone is a copy, the edits of either side stay there.
+ * A link is the source itself: the sources changed since they were grafted are copied when the burn
+ * starts, and an edit of a linked file in the staging view reaches its source. The sources which can
+ * be neither cloned nor linked, e.g. on another filesystem, are left to the copy job.
+ */
+class BurnStagingManifest
+{
+public:
+    struct Entry
+    {
+        QString source;   // the linked source, empty for the clones, the symlinks and the files detached
+        qint64 size { -1 };   // -1 for the directories
+        qint64 modifyTime { 0 };   // msecs since epoch, of the linked source when grafted, of the staged directory for the directories
+        bool isDir() const { return size < 0; }
+        bool isLinked() const { return !source.isEmpty(); }
+    };
+
+    explicit BurnStagingManifest(const QString &stagingPath);
+
+    bool graft(const QString &source, const QString &destDir, QString *stagedPath = nullptr);
+    void merge(const BurnStagingManifest &grafted);
+    int dropChanged();
+    int detachChanged();
+
+    bool isGraftedRoot(const QString &discPath) const;
+    QStringList discPaths(const QString &rootDiscPath) const;
+    Entry entry(const QString &discPath) const;
+
+    bool load();
+    void save() const;
+    void clear();
+
+private:
+    void dropRootOf(const QString &discPath);
+    QString discPathOf(const QString &stagedPath) const;
+    bool graftTree(const QString &source, const QString &staged, QMap<QString, Entry> *grafted);
+    void touchParentOf(const QString &discPath);
+    static bool cloneFile(const QString &source, const QString &staged);
+
+private:
+    QString stagingRoot;
+    QString device;
+    QSet<QString> roots;   // the disc paths of the grafted sources, dropped once changed in the staging view
+    QMap<QString, Entry> entries;   // disc path, which starts with '/', to entry
+};
+
+}   // namespace dfmplugin_burn
+
+#endif   // BURNSTAGINGMANIFEST_H
@@ -285,6 +285,7 @@ void FilePreviewDialog::switchToPage(int index)
                 setFixedSize(newPerviewWidth, newPerviewHeight + statusBar->height());
                 playCurrentPreviewFile();
                 moveToCenter();
+                prefetchNeighbours();
                 return;
             }
         }
@@ -349,6 +350,21 @@ void FilePreviewDialog::switchToPage(int index)
     setFixedSize(newPerviewWidth, newPerviewHeight + statusBar->height());
     updateTitle();
     moveToCenter();
+    prefetchNeighbours();
+}
+
+void FilePreviewDialog::prefetchNeighbours()
+{
+    if (!preview)
+        return;
+
+    QList<QUrl> urls;
+    if (currentPageIndex + 1 < fileList.count())
+        urls.append(fileList.at(currentPageIndex + 1));
+    if (currentPageIndex > 0)
+        urls.append(fileList.at(currentPageIndex - 1));
+
+    preview->prefetch(urls);
 }
 
 void FilePreviewDialog::previousPage()
@@ -48,6 +48,7 @@ private:
 
     void initUI();
     void switchToPage(int index);
+    void prefetchNeighbours();
     void previousPage();
     void nextPage();
     void updateTitle();
@@ -0,0 +1,224 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "imagedecoder.h"
+
+#include <QImageReader>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QPointer>
+#include <QRunnable>
+#include <QThreadPool>
+
+using namespace plugin_filepreview;
+
+// images up to this size are decoded at once, an empty frame before them costs more than the decoding
+static constexpr qint64 kSyncDecodePixels { 2 * 1024 * 1024 };
+// in KB, a few screen sized images
+static constexpr int kMaxCacheCost { 128 * 1024 };
+static constexpr int kMaxDecodeThreads { 2 };
+
+Q_GLOBAL_STATIC(QThreadPool, decodePool)
+
+struct ImageDecoder::DecodeState
+{
+    QMutex mutex;
+    QSet<QString> wantedKeys;
+
+    bool isWanted(const QString &key)
+    {
+        QMutexLocker lk(&mutex);
+        return wantedKeys.contains(key);
+    }
+};
+
+namespace {
+class DecodeTask : public QRunnable
+{
+public:
+    using Callback = std::function<void(const QImage &image, bool skipped)>;
+
+    DecodeTask(const QSharedPointer<ImageDecoder::DecodeState> &state, const QString &key, const QString &fileName,
+               const QByteArray &format, const QSize &boundSize, bool stillOnly, Callback callback)
+        : state(state), key(key), fileName(fileName), format(format), boundSize(boundSize), stillOnly(stillOnly), callback(callback)
+    {
+    }
+
+    void run() override
+    {
+        // the user has moved on before the decoding started
+        if (!state->isWanted(key)) {
+            callback(QImage(), true);
+            return;
+        }
+
+        callback(ImageDecoder::decode(fileName, format, boundSize, stillOnly), false);
+    }
+
+private:
+    QSharedPointer<ImageDecoder::DecodeState> state;
+    QString key;
+    QString fileName;
+    QByteArray format;
+    QSize boundSize;
+    bool stillOnly { false };
+    Callback callback;
+};
+}   // namespace
+
+ImageDecoder::ImageDecoder(QObject *parent)
+    : QObject(parent), state(new DecodeState), cache(kMaxCacheCost)
+{
+    if (decodePool->maxThreadCount() != kMaxDecodeThreads)
+        decodePool->setMaxThreadCount(kMaxDecodeThreads);
+}
+
+ImageDecoder::~ImageDecoder()
+{
+    // the started tasks run to the end, their results are dropped
+    QMutexLocker lk(&state->mutex);
+    state->wantedKeys.clear();
+}
+
+/*!
+ * \brief ImageDecoder::scaledSize, the size of the image which fits in boundSize, images are never enlarged
+ */
+QSize ImageDecoder::scaledSize(const QSize &sourceSize, const QSize &boundSize)
+{
+    return sourceSize.scaled(QSize(qMin(boundSize.width(), sourceSize.width()),
+                                   qMin(boundSize.height(), sourceSize.height())),
+                             Qt::KeepAspectRatio);
+}
+
+/*!
+ * \brief ImageDecoder::decode, read the image fitting in boundSize, it is safe to be called in any thread
+ * \param stillOnly skip the animations, they are played by QMovie
+ */
+QImage ImageDecoder::decode(const QString &fileName, const QByteArray &format, const QSize &boundSize, bool stillOnly)
+{
+    QImageReader reader(fileName, format);
+    const QSize &sourceSize = reader.size();
+    if (!sourceSize.isValid())
+        return QImage();
+
+    if (stillOnly && reader.supportsAnimation())
+        return QImage();
+
+    const QSize &targetSize = scaledSize(sourceSize, boundSize);
+    // the readers without scaled reading would scale roughly, they are scaled smoothly below
+    if (targetSize != sourceSize && reader.supportsOption(QImageIOHandler::ScaledSize))
+        reader.setScaledSize(targetSize);
+
+    QImage image = reader.read();
+    if (!image.isNull() && image.size() != targetSize)
+        image = image.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    return image;
+}
+
+/*!
+ * \brief ImageDecoder::request, show fileName, the previous request is cancelled
+ * \return true if image is ready, otherwise decoded is emitted when it is decoded
+ */
+bool ImageDecoder::request(const QString &fileName, const QByteArray &format, const QSize &boundSize, QImage *image)
+{
+    const QString &key = cacheKey(fileName, boundSize);
+    currentKey = key;
+    updateWanted();
+
+    if (QImage *cached = cache.object(key)) {
+        *image = *cached;
+        return true;
+    }
+
+    const QSize &sourceSize = QImageReader(fileName, format).size();
+    if (qint64(sourceSize.width()) * sourceSize.height() <= kSyncDecodePixels) {
+        *image = decode(fileName, format, boundSize);
+        return true;
+    }
+
+    // a pending prefetch decodes still images only, it is decoded again when it skips an animation, see onDecodeFinished
+    if (!pendingKeys.contains(key))
+        enqueue(key, fileName, format, boundSize, false);
+
+    return false;
+}
+
+/*!
+ * \brief ImageDecoder::prefetch, decode the images which may be shown next, the previous prefetching is cancelled
+ */
+void ImageDecoder::prefetch(const QStringList &fileNames, const QSize &boundSize)
+{
+    prefetchKeys.clear();
+    QList<QPair<QString, QString>> toDecode;
+    for (const QString &fileName : fileNames) {
+        const QString &key = cacheKey(fileName, boundSize);
+        prefetchKeys.insert(key);
+        if (!cache.contains(key) && !pendingKeys.contains(key))
+            toDecode.append({ key, fileName });
+    }
+
+    updateWanted();
+    for (const auto &item : toDecode)
+        enqueue(item.first, item.second, QByteArray(), boundSize, true);
+}
+
+QString ImageDecoder::cacheKey(const QString &fileName, const QSize &boundSize) const
+{
+    const QFileInfo info(fileName);
+    return QString("%1|%2|%3x%4").arg(fileName).arg(info.lastModified().toMSecsSinceEpoch()).arg(boundSize.width()).arg(boundSize.height());
+}
+
+void ImageDecoder::updateWanted()
+{
+    QSet<QString> wanted = prefetchKeys;
+    if (!currentKey.isEmpty())
+        wanted.insert(currentKey);
+
+    QMutexLocker lk(&state->mutex);
+    state->wantedKeys = wanted;
+}
+
+void ImageDecoder::enqueue(const QString &key, const QString &fileName, const QByteArray &format, const QSize &boundSize, bool stillOnly)
+{
+    pendingKeys.insert(key, stillOnly);
+
+    QPointer<ImageDecoder> self(this);
+    auto callback = [self, key, fileName, format, boundSize, stillOnly](const QImage &image, bool skipped) {
+        // back to the main thread, where the decoder lives
+        QMetaObject::invokeMethod(qApp, [=]() {
+            if (self)
+                self->onDecodeFinished(key, fileName, format, boundSize, stillOnly, image, skipped);
+        }, Qt::QueuedConnection);
+    };
+
+    decodePool->start(new DecodeTask(state, key, fileName, format, boundSize, stillOnly, callback));
+}
+
+void ImageDecoder::onDecodeFinished(const QString &key, const QString &fileName, const QByteArray &format,
+                                    const QSize &boundSize, bool stillOnly, const QImage &image, bool skipped)
+{
+    pendingKeys.remove(key);
+
+    if (skipped) {
+        // wanted again after the task had been skipped
+        if (state->isWanted(key))
+            enqueue(key, fileName, format, boundSize, stillOnly && key != currentKey);
+        return;
+    }
+
+    // the animations are skipped by the prefetching, the first frame is decoded for the request
+    if (image.isNull() && stillOnly && key == currentKey) {
+        enqueue(key, fileName, format, boundSize, false);
+        return;
+    }
+
+    if (!image.isNull())
+        cache.insert(key, new QImage(image), qMax(1, int(image.sizeInBytes() / 1024)));
+
+    if (key == currentKey)
+        Q_EMIT decoded(fileName, image);
+}
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IMAGEDECODER_H
+#define IMAGEDECODER_H
+
+#include "preview_plugin_global.h"
+
+#include <QObject>
+#include <QImage>
+#include <QCache>
+#include <QSet>
+#include <QHash>
+#include <QSharedPointer>
+
+namespace plugin_filepreview {
+
+/*!
+ * \brief The ImageDecoder class decodes images for the preview in worker threads.
+ * The images are decoded to the size which is shown, the readers which support
+ * scaled reading, such as jpeg, never produce the full resolution image.
+ * The images which are not wanted any more are skipped if their decoding is not started.
+ */
+class ImageDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    struct DecodeState;
+
+    explicit ImageDecoder(QObject *parent = nullptr);
+    ~ImageDecoder() override;
+
+    static QSize scaledSize(const QSize &sourceSize, const QSize &boundSize);
+    static QImage decode(const QString &fileName, const QByteArray &format, const QSize &boundSize, bool stillOnly = false);
+
+    bool request(const QString &fileName, const QByteArray &format, const QSize &boundSize, QImage *image);
+    void prefetch(const QStringList &fileNames, const QSize &boundSize);
+
+Q_SIGNALS:
+    void decoded(const QString &fileName, const QImage &image);
+
+private:
+    QString cacheKey(const QString &fileName, const QSize &boundSize) const;
+    void updateWanted();
+    void enqueue(const QString &key, const QString &fileName, const QByteArray &format, const QSize &boundSize, bool stillOnly);
+    void onDecodeFinished(const QString &key, const QString &fileName, const QByteArray &format,
+                          const QSize &boundSize, bool stillOnly, const QImage &image, bool skipped);
+
+    QSharedPointer<DecodeState> state;
+    QCache<QString, QImage> cache;
+    QHash<QString, bool> pendingKeys;   // key -> decoded still only
+    QString currentKey;
+    QSet<QString> prefetchKeys;
+};
+
+}   // namespace plugin_filepreview
+
+#endif   // IMAGEDECODER_H
@@ -131,3 +131,24 @@ QString ImagePreview::title() const
 {
     return imageTitle;
 }
+
+void ImagePreview::prefetch(const QList<QUrl> &urls)
+{
+    if (!imageView)
+        return;
+
+    QStringList fileNames;
+    for (const QUrl &url : urls) {
+        QUrl localUrl = url;
+        if (!url.isLocalFile()) {
+            FileInfoPointer info = InfoFactory::create<FileInfo>(url);
+            if (info && info->canAttributes(CanableInfoType::kCanRedirectionFileUrl))
+                localUrl = info->urlOf(UrlInfoType::kRedirectedFileUrl);
+        }
+
+        if (dfmbase::FileUtils::isLocalFile(localUrl))
+            fileNames.append(localUrl.toLocalFile());
+    }
+
+    imageView->prefetch(fileNames);
+}
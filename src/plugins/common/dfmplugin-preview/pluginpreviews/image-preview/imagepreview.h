@@ -34,6 +34,8 @@ public:
 
     QString title() const override;
 
+    void prefetch(const QList<QUrl> &urls) override;
+
 private:
     QUrl currentFileUrl;
     QPointer<QLabel> messageStatusBar;
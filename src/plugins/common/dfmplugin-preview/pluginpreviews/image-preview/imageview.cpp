@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "imageview.h"
+#include "imagedecoder.h"
 
 #include <dfm-base/utils/windowutils.h>
 
@@ -23,8 +24,9 @@ using namespace plugin_filepreview;
 #define MIN_SIZE QSize(400, 300)
 
 ImageView::ImageView(const QString &fileName, const QByteArray &format, QWidget *parent)
-    : QLabel(parent)
+    : QLabel(parent), decoder(new ImageDecoder(this))
 {
+    connect(decoder, &ImageDecoder::decoded, this, &ImageView::onImageDecoded);
     setFile(fileName, format);
     setMinimumSize(MIN_SIZE);
     setAlignment(Qt::AlignCenter);
@@ -34,6 +36,7 @@ void ImageView::setFile(const QString &fileName, const QByteArray &format)
 {
     const QSize &dsize = DFMBASE_NAMESPACE::WindowUtils::cursorScreen()->geometry().size();
     qreal device_pixel_ratio = this->devicePixelRatioF();
+    currentFile = fileName;
 
     if (format == QByteArrayLiteral("gif")) {
         if (movie) {
@@ -69,14 +72,48 @@ void ImageView::setFile(const QString &fileName, const QByteArray &format)
         return;
     }
 
-    QPixmap pixmap = QPixmap::fromImageReader(&reader).scaled(QSize(qMin(static_cast<int>(dsize.width() * 0.7 * device_pixel_ratio), sourceImageSize.width()),
-                                                                    qMin(static_cast<int>(dsize.height() * 0.7 * device_pixel_ratio), sourceImageSize.height())),
-                                                              Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    pixmap.setDevicePixelRatio(device_pixel_ratio);
-    setPixmap(pixmap);
+    QImage image;
+    if (decoder->request(fileName, format, boundSize(), &image)) {
+        showImage(image);
+        return;
+    }
+
+    // keep the size of the view until the image is decoded
+    QPixmap placeholder(ImageDecoder::scaledSize(sourceImageSize, boundSize()));
+    placeholder.fill(Qt::transparent);
+    placeholder.setDevicePixelRatio(device_pixel_ratio);
+    setPixmap(placeholder);
+}
+
+void ImageView::prefetch(const QStringList &fileNames)
+{
+    decoder->prefetch(fileNames, boundSize());
 }
 
 QSize ImageView::sourceSize() const
 {
     return sourceImageSize;
 }
+
+void ImageView::onImageDecoded(const QString &fileName, const QImage &image)
+{
+    if (fileName != currentFile || movie)
+        return;
+
+    showImage(image);
+}
+
+QSize ImageView::boundSize() const
+{
+    const QSize &dsize = DFMBASE_NAMESPACE::WindowUtils::cursorScreen()->geometry().size();
+    qreal device_pixel_ratio = this->devicePixelRatioF();
+    return QSize(static_cast<int>(dsize.width() * 0.7 * device_pixel_ratio),
+                 static_cast<int>(dsize.height() * 0.7 * device_pixel_ratio));
+}
+
+void ImageView::showImage(const QImage &image)
+{
+    QPixmap pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(this->devicePixelRatioF());
+    setPixmap(pixmap);
+}
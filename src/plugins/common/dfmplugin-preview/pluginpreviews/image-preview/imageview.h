@@ -8,6 +8,7 @@
 #include "preview_plugin_global.h"
 #include <QLabel>
 namespace plugin_filepreview {
+class ImageDecoder;
 class ImageView : public QLabel
 {
     Q_OBJECT
@@ -15,11 +16,20 @@ public:
     explicit ImageView(const QString &fileName, const QByteArray &format, QWidget *parent = nullptr);
 
     void setFile(const QString &fileName, const QByteArray &format);
+    void prefetch(const QStringList &fileNames);
     QSize sourceSize() const;
 
+private Q_SLOTS:
+    void onImageDecoded(const QString &fileName, const QImage &image);
+
 private:
+    QSize boundSize() const;
+    void showImage(const QImage &image);
+
     QSize sourceImageSize;
     QMovie *movie { nullptr };
+    ImageDecoder *decoder { nullptr };
+    QString currentFile;
 };
 }
 #endif   // IMAGEVIEW_H
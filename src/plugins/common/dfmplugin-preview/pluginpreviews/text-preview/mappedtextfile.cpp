@@ -0,0 +1,266 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mappedtextfile.h"
+
+#include <dfm-base/utils/fileutils.h>
+
+#include <QTextCodec>
+#include <QtConcurrent>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+DFMBASE_USE_NAMESPACE
+using namespace plugin_filepreview;
+
+static constexpr qint64 kLinesPerCheckpoint { 1024 };
+static constexpr int kCharsetSampleSize { 64 * 1024 };
+// the views are told about the new lines after every this many bytes are indexed
+static constexpr qint64 kIndexNotifyBytes { 8 * 1024 * 1024 };
+// longer lines are cut, a file without line feeds is not decoded at once
+static constexpr qint64 kMaxLineBytes { 16 * 1024 };
+static constexpr qint64 kReadWindowSize { 256 * 1024 };
+
+namespace {
+/*!
+ * \brief The LineReader class reads the lines from an offset of the file in windows,
+ * a read which returns less than asked is the end of the file
+ */
+class LineReader
+{
+public:
+    LineReader(int fd, qint64 pos, qint64 end)
+        : fd(fd), windowStart(pos), end(end)
+    {
+    }
+
+    /*!
+     * \brief next, read a line without its line feed, the bytes after maxBytes are skipped
+     * \param line the line, nullptr to skip it
+     * \return false at the end of the file
+     */
+    bool next(QByteArray *line, qint64 maxBytes)
+    {
+        if (line)
+            line->clear();
+
+        bool hasData = false;
+        while (true) {
+            if (windowPos >= window.size() && !readWindow())
+                return hasData;
+
+            hasData = true;
+            const char *begin = window.constData() + windowPos;
+            const void *hit = std::memchr(begin, '\n', static_cast<size_t>(window.size() - windowPos));
+            const int length = hit ? static_cast<int>(static_cast<const char *>(hit) - begin) : window.size() - windowPos;
+            if (line && line->size() < maxBytes)
+                line->append(begin, static_cast<int>(qMin<qint64>(length, maxBytes - line->size())));
+
+            windowPos += hit ? length + 1 : length;
+            if (hit)
+                return true;
+        }
+    }
+
+    // the offset of the next line
+    qint64 position() const
+    {
+        return windowStart + windowPos;
+    }
+
+private:
+    bool readWindow()
+    {
+        windowStart += window.size();
+        windowPos = 0;
+        window.resize(static_cast<int>(qMin(kReadWindowSize, end - windowStart)));
+        if (window.isEmpty())
+            return false;
+
+        ssize_t size = -1;
+        do {
+            size = ::pread(fd, window.data(), static_cast<size_t>(window.size()), windowStart);
+        } while (size < 0 && errno == EINTR);
+
+        window.resize(size > 0 ? static_cast<int>(size) : 0);
+        // truncated, the file ends here
+        if (window.size() < qMin(kReadWindowSize, end - windowStart))
+            end = windowStart + window.size();
+        return !window.isEmpty();
+    }
+
+    int fd { -1 };
+    qint64 windowStart { 0 };
+    qint64 end { 0 };
+    QByteArray window;
+    int windowPos { 0 };
+};
+}   // namespace
+
+MappedTextFile::MappedTextFile(QObject *parent)
+    : QObject(parent)
+{
+}
+
+MappedTextFile::~MappedTextFile()
+{
+    close();
+}
+
+/*!
+ * \brief MappedTextFile::open, open fileName and start indexing its lines
+ * \return false if the file is empty, can not be read or its charset can not be split by line feeds,
+ * such as utf-16
+ */
+bool MappedTextFile::open(const QString &fileName)
+{
+    close();
+
+    fd = ::open(fileName.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fmWarning() << "Text Preview: open failed" << fileName << strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close();
+        return false;
+    }
+    dataSize = st.st_size;
+
+    QByteArray sample(static_cast<int>(qMin<qint64>(dataSize, kCharsetSampleSize)), Qt::Uninitialized);
+    const ssize_t sampleSize = ::pread(fd, sample.data(), static_cast<size_t>(sample.size()), 0);
+    if (sampleSize <= 0) {
+        close();
+        return false;
+    }
+    sample.resize(static_cast<int>(sampleSize));
+
+    codec = QTextCodec::codecForName(FileUtils::detectCharset(sample, fileName));
+    if (!codec)
+        codec = QTextCodec::codecForLocale();
+
+    // 1013 ~ 1019: utf-16 and utf-32, a line feed byte may be a part of other characters
+    if (codec->mibEnum() >= 1013 && codec->mibEnum() <= 1019) {
+        close();
+        return false;
+    }
+
+    checkpoints = { 0 };
+    indexedLines = 0;
+    indexFinished = false;
+    stopped = false;
+    indexFuture = QtConcurrent::run([this]() { buildIndex(); });
+
+    return true;
+}
+
+void MappedTextFile::close()
+{
+    stopped = true;
+    indexFuture.waitForFinished();
+
+    if (fd >= 0)
+        ::close(fd);
+
+    fd = -1;
+    dataSize = 0;
+    codec = nullptr;
+    indexedLines = 0;
+    indexFinished = false;
+
+    QMutexLocker lk(&indexMutex);
+    checkpoints.clear();
+}
+
+bool MappedTextFile::isOpen() const
+{
+    return fd >= 0;
+}
+
+/*!
+ * \brief MappedTextFile::lineCount, the lines indexed so far, it grows until the index is finished
+ */
+qint64 MappedTextFile::lineCount() const
+{
+    return indexedLines;
+}
+
+bool MappedTextFile::isIndexFinished() const
+{
+    return indexFinished;
+}
+
+QStringList MappedTextFile::lines(qint64 first, int count) const
+{
+    QStringList result;
+    const qint64 last = qMin(first + count, lineCount());
+    if (fd < 0 || first < 0 || first >= last)
+        return result;
+
+    LineReader reader(fd, lineOffset(first), dataSize);
+    QByteArray text;
+    for (qint64 line = first; line < last && reader.next(&text, kMaxLineBytes); ++line) {
+        if (text.endsWith('\r'))
+            text.chop(1);
+        result.append(codec->toUnicode(text));
+    }
+
+    return result;
+}
+
+void MappedTextFile::buildIndex()
+{
+    // read ahead while scanning, the pages may be dropped after they are scanned
+    ::posix_fadvise(fd, 0, dataSize, POSIX_FADV_SEQUENTIAL);
+
+    LineReader reader(fd, 0, dataSize);
+    qint64 lines = 0;
+    qint64 notifiedPos = 0;
+    // the last line without line feed is counted as well
+    while (!stopped && reader.next(nullptr, 0)) {
+        const qint64 pos = reader.position();
+        ++lines;
+        if (lines % kLinesPerCheckpoint == 0) {
+            QMutexLocker lk(&indexMutex);
+            checkpoints.append(pos);
+        }
+
+        if (pos - notifiedPos >= kIndexNotifyBytes) {
+            notifiedPos = pos;
+            indexedLines = lines;
+            Q_EMIT indexUpdated();
+        }
+    }
+
+    if (stopped)
+        return;
+
+    ::posix_fadvise(fd, 0, dataSize, POSIX_FADV_NORMAL);
+    indexedLines = lines;
+    indexFinished = true;
+    Q_EMIT indexUpdated();
+}
+
+qint64 MappedTextFile::lineOffset(qint64 line) const
+{
+    qint64 pos = 0;
+    {
+        QMutexLocker lk(&indexMutex);
+        const qint64 checkpoint = qMin(line / kLinesPerCheckpoint, static_cast<qint64>(checkpoints.size()) - 1);
+        pos = checkpoints.at(static_cast<int>(checkpoint));
+        line -= checkpoint * kLinesPerCheckpoint;
+    }
+
+    LineReader reader(fd, pos, dataSize);
+    for (; line > 0 && reader.next(nullptr, 0); --line) { }
+
+    return reader.position();
+}
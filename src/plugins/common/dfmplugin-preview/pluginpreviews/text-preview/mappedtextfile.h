@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MAPPEDTEXTFILE_H
+#define MAPPEDTEXTFILE_H
+
+#include "preview_plugin_global.h"
+
+#include <QObject>
+#include <QFuture>
+#include <QMutex>
+#include <QVector>
+
+#include <atomic>
+
+class QTextCodec;
+
+namespace plugin_filepreview {
+
+/*!
+ * \brief The MappedTextFile class indexes the lines of a text file in a worker thread.
+ * Only the offset of every kLinesPerCheckpoint-th line is kept, a line is located from the
+ * checkpoint before it, so the index stays small for huge logs and the pages of the file
+ * are left to the page cache.
+ * The file is read in windows by pread rather than mapped, a log truncated while it is shown
+ * ends the reading early instead of raising SIGBUS.
+ * The charset is detected on a sample at the beginning of the file.
+ */
+class MappedTextFile : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MappedTextFile(QObject *parent = nullptr);
+    ~MappedTextFile() override;
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+
+    qint64 lineCount() const;
+    bool isIndexFinished() const;
+    QStringList lines(qint64 first, int count) const;
+
+Q_SIGNALS:
+    void indexUpdated();
+
+private:
+    void buildIndex();
+    qint64 lineOffset(qint64 line) const;
+
+    int fd { -1 };
+    qint64 dataSize { 0 };   // the size when opened, the file may be shorter now
+    QTextCodec *codec { nullptr };
+
+    mutable QMutex indexMutex;
+    QVector<qint64> checkpoints;
+    std::atomic<qint64> indexedLines { 0 };
+    std::atomic_bool indexFinished { false };
+    std::atomic_bool stopped { false };
+    QFuture<void> indexFuture;
+};
+
+}   // namespace plugin_filepreview
+
+#endif   // MAPPEDTEXTFILE_H
@@ -4,6 +4,7 @@
 
 #include "textcontextwidget.h"
 #include "textbrowseredit.h"
+#include "textpagedview.h"
 
 #include <DPlainTextEdit>
 
@@ -15,7 +16,10 @@ DWIDGET_USE_NAMESPACE
 TextContextWidget::TextContextWidget(QWidget *parent)
     : QWidget(parent)
     , editWidget(new TextBrowserEdit(this))
+    , pagedView(new TextPagedView(this))
 {
+    pagedView->setVisible(false);
+
     DPlainTextEdit *titleWidget = new DPlainTextEdit(this);
     titleWidget->setFixedHeight(30);
     titleWidget->setFrameStyle(QFrame::NoFrame);
@@ -25,6 +29,7 @@ TextContextWidget::TextContextWidget(QWidget *parent)
     QVBoxLayout *mainLay = new QVBoxLayout(this);
     mainLay->addWidget(titleWidget);
     mainLay->addWidget(editWidget);
+    mainLay->addWidget(pagedView);
     mainLay->setContentsMargins(0, 0, 0, 0);
     mainLay->setSpacing(0);
 }
@@ -33,3 +38,22 @@ TextBrowserEdit *TextContextWidget::textBrowserEdit() const
 {
     return editWidget;
 }
+
+TextPagedView *TextContextWidget::textPagedView() const
+{
+    return pagedView;
+}
+
+/*!
+ * \brief TextContextWidget::setPagedMode, large files are shown by the paged view, the others by the text edit
+ */
+void TextContextWidget::setPagedMode(bool paged)
+{
+    if (paged)
+        editWidget->clear();
+    else
+        pagedView->clearFile();
+
+    editWidget->setVisible(!paged);
+    pagedView->setVisible(paged);
+}
@@ -9,15 +9,20 @@
 
 namespace plugin_filepreview {
 class TextBrowserEdit;
+class TextPagedView;
 class TextContextWidget : public QWidget
 {
     Q_OBJECT
 public:
     explicit TextContextWidget(QWidget *parent = nullptr);
     plugin_filepreview::TextBrowserEdit *textBrowserEdit() const;
+    plugin_filepreview::TextPagedView *textPagedView() const;
+
+    void setPagedMode(bool paged);
 
 private:
     plugin_filepreview::TextBrowserEdit *editWidget { nullptr };
+    plugin_filepreview::TextPagedView *pagedView { nullptr };
 };
 }
 #endif // TEXTCONTEXTWIDGET_H
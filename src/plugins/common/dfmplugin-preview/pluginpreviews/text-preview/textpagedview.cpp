@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "textpagedview.h"
+#include "mappedtextfile.h"
+
+#include <QPainter>
+#include <QScrollBar>
+
+using namespace plugin_filepreview;
+
+static constexpr int kTextMargin { 4 };
+
+TextPagedView::TextPagedView(QWidget *parent)
+    : QAbstractScrollArea(parent), textFile(new MappedTextFile(this))
+{
+    setFixedSize(800, 500);
+    setFrameStyle(QFrame::NoFrame);
+    setContextMenuPolicy(Qt::NoContextMenu);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+
+    connect(textFile, &MappedTextFile::indexUpdated, this, [this]() {
+        updateScrollBars();
+        viewport()->update();
+    });
+}
+
+bool TextPagedView::setFile(const QString &fileName)
+{
+    maxLineWidth = 0;
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+
+    const bool ret = textFile->open(fileName);
+    updateScrollBars();
+    viewport()->update();
+    return ret;
+}
+
+void TextPagedView::clearFile()
+{
+    textFile->close();
+    maxLineWidth = 0;
+    updateScrollBars();
+}
+
+void TextPagedView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(viewport());
+    painter.setPen(palette().color(QPalette::Text));
+
+    const int lineHeight = fontMetrics().height();
+    const QStringList &texts = textFile->lines(verticalScrollBar()->value(), pageLineCount() + 1);
+    const int flags = Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine | Qt::TextExpandTabs;
+
+    int widest = 0;
+    QRect lineRect(kTextMargin - horizontalScrollBar()->value(), 0, 0, lineHeight);
+    for (const QString &text : texts) {
+        const int width = fontMetrics().size(flags, text).width();
+        widest = qMax(widest, width);
+        lineRect.setWidth(width);
+        painter.drawText(lineRect, flags, text);
+        lineRect.translate(0, lineHeight);
+    }
+
+    // the width of the lines is known after they are shown
+    if (widest > maxLineWidth) {
+        maxLineWidth = widest;
+        QMetaObject::invokeMethod(this, "updateScrollBars", Qt::QueuedConnection);
+    }
+}
+
+void TextPagedView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void TextPagedView::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx)
+    Q_UNUSED(dy)
+
+    viewport()->update();
+}
+
+void TextPagedView::updateScrollBars()
+{
+    const int pageLines = pageLineCount();
+    const qint64 maxLine = qMax<qint64>(0, textFile->lineCount() - pageLines);
+
+    verticalScrollBar()->setPageStep(pageLines);
+    verticalScrollBar()->setRange(0, static_cast<int>(qMin<qint64>(maxLine, INT_MAX)));
+
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, qMax(0, maxLineWidth + kTextMargin * 2 - viewport()->width()));
+}
+
+int TextPagedView::pageLineCount() const
+{
+    return qMax(1, viewport()->height() / qMax(1, fontMetrics().height()));
+}
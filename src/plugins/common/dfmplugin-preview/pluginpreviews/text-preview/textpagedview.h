@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TEXTPAGEDVIEW_H
+#define TEXTPAGEDVIEW_H
+
+#include "preview_plugin_global.h"
+
+#include <QAbstractScrollArea>
+
+namespace plugin_filepreview {
+class MappedTextFile;
+/*!
+ * \brief The TextPagedView class shows large text files, only the lines in the viewport are
+ * read and decoded when painting, lines are not wrapped.
+ */
+class TextPagedView : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    explicit TextPagedView(QWidget *parent = nullptr);
+
+    bool setFile(const QString &fileName);
+    void clearFile();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private Q_SLOTS:
+    void updateScrollBars();
+
+private:
+    int pageLineCount() const;
+
+    MappedTextFile *textFile { nullptr };
+    int maxLineWidth { 0 };
+};
+}   // namespace plugin_filepreview
+
+#endif   // TEXTPAGEDVIEW_H
@@ -6,6 +6,7 @@
 #include "dfileservices.h"
 #include "textbrowseredit.h"
 #include "textcontextwidget.h"
+#include "textpagedview.h"
 
 #include <dfm-base/interfaces/fileinfo.h>
 
@@ -18,6 +19,8 @@ using namespace std;
 DFMBASE_USE_NAMESPACE
 using namespace plugin_filepreview;
 static constexpr int kReadTextSize { 1024 * 1024 * 5 };
+// larger files are mapped and shown page by page
+static constexpr qint64 kPagedTextSize { 1024 * 1024 };
 
 TextPreview::TextPreview(QObject *parent)
     : AbstractBasePreview(parent)
@@ -37,6 +40,19 @@ bool TextPreview::setFileUrl(const QUrl &url)
 
     selectUrl = url;
 
+    if (!textBrowser) {
+        textBrowser = new TextContextWidget;
+    }
+
+    const QString &filePath = url.path();
+    if (QFileInfo(filePath).size() > kPagedTextSize && textBrowser->textPagedView()->setFile(filePath)) {
+        textBrowser->setPagedMode(true);
+        titleStr = QFileInfo(url.toLocalFile()).fileName();
+        Q_EMIT titleChanged();
+        return true;
+    }
+
+    textBrowser->setPagedMode(false);
     device.open(url.path().toLocal8Bit().data(), ios::binary);
 
     if (!device.is_open()) {
@@ -44,10 +60,6 @@ bool TextPreview::setFileUrl(const QUrl &url)
         return false;
     }
 
-    if (!textBrowser) {
-        textBrowser = new TextContextWidget;
-    }
-
     titleStr = QFileInfo(url.toLocalFile()).fileName();
 
     long len = device.seekg(0, ios::end).tellg();
@@ -152,6 +152,18 @@ QVariantHash TagProxyHandle::getAllFileWithTags()
     return data.toHash();
 }
 
+QVariantHash TagProxyHandle::getFilesWithTagsOfDirs(const QStringList &value)
+{
+    auto &&reply = d->tagDBusInterface->Query(int(QueryOpts::kFilesWithTagsOfDirs), value);
+    reply.waitForFinished();
+    if (!reply.isValid()) {
+        fmWarning() << "getFilesWithTagsOfDirs failed :" << reply.error();
+        return {};
+    }
+    const auto &data = d->parseDBusVariant(reply.value());
+    return data.toHash();
+}
+
 bool TagProxyHandle::addTags(const QVariantMap &value)
 {
     auto &&reply = d->tagDBusInterface->Insert(int(InsertOpts::kTags), value);
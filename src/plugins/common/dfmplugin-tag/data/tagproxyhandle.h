@@ -26,6 +26,7 @@ public:
     QVariantMap getFilesThroughTag(const QStringList &value);
     QVariantMap getTagsColor(const QStringList &value);
     QVariantHash getAllFileWithTags();
+    QVariantHash getFilesWithTagsOfDirs(const QStringList &value);
 
     bool addTags(const QVariantMap &value);
     bool addTagsForFiles(const QVariantMap &value);
@@ -4,11 +4,13 @@
 
 #include "tageventreceiver.h"
 #include "utils/tagmanager.h"
+#include "utils/filetagcache.h"
 
 #include <dfm-base/dfm_event_defines.h>
 #include <dfm-base/base/application/application.h>
 #include <dfm-base/base/application/settings.h>
 #include <dfm-base/base/schemefactory.h>
+#include <dfm-base/utils/fileutils.h>
 
 #include <dfm-framework/dpf.h>
 
@@ -85,6 +87,17 @@ void TagEventReceiver::handleFileRenameResult(quint64 winId, const QMap<QUrl, QU
     if (!ok || renamedUrls.isEmpty())
         return;
 
+    // the renamed dirs are loaded again by their new paths
+    QStringList cachedPaths;
+    for (auto it = renamedUrls.constBegin(); it != renamedUrls.constEnd(); ++it) {
+        if (it.key().isLocalFile())
+            cachedPaths.append(FileUtils::bindPathTransform(it.key().toLocalFile(), false));
+        if (it.value().isLocalFile())
+            cachedPaths.append(FileUtils::bindPathTransform(it.value().toLocalFile(), false));
+    }
+    if (!cachedPaths.isEmpty())
+        FileTagCacheIns.removeCachedPaths(cachedPaths);
+
     auto iter = renamedUrls.constBegin();
     for (; iter != renamedUrls.constEnd(); ++iter) {
         const auto &tags = TagManager::instance()->getTagsByUrls({ iter.key() });
@@ -12,6 +12,8 @@
 #include <QDebug>
 #include <QSet>
 
+#include <algorithm>
+
 DPTAG_USE_NAMESPACE
 
 FileTagCacheWorker::FileTagCacheWorker(QObject *parent)
@@ -28,6 +30,16 @@ void FileTagCacheWorker::loadFileTagsFromDatabase()
     FileTagCache::instance().loadFileTagsFromDatabase();
 }
 
+void FileTagCacheWorker::loadPendingFiles()
+{
+    bool loadAgain = false;
+    const auto &fileAndTags = FileTagCache::instance().loadPendingFiles(&loadAgain);
+    if (!fileAndTags.isEmpty())
+        emit FileTagCacheIns.filesLoaded(fileAndTags);
+    if (loadAgain)
+        QMetaObject::invokeMethod(this, "loadPendingFiles", Qt::QueuedConnection);
+}
+
 void FileTagCacheWorker::onTagAdded(const QVariantMap &tags)
 {
     FileTagCache::instance().addTags(tags);
@@ -67,6 +79,12 @@ void FileTagCacheWorker::onFilesUntagged(const QVariantMap &fileAndTags)
     emit FileTagCacheIns.filesUntagged(fileAndTags);
 }
 
+static constexpr int kMaxLoadedDirs { 256 };
+static constexpr int kMaxKnownFiles { 8192 };
+// the pending files of a dir are loaded with the whole dir from this count on,
+// fewer files (search results spread over many dirs) are queried alone and do not evict the dirs
+static constexpr int kMinFilesToLoadDir { 4 };
+
 FileTagCachePrivate::FileTagCachePrivate(FileTagCache *qq)
     : q(qq)
 {
@@ -76,6 +94,274 @@ FileTagCachePrivate::~FileTagCachePrivate()
 {
 }
 
+QString FileTagCachePrivate::dirOfPath(const QString &path)
+{
+    int index = path.lastIndexOf('/');
+    if (index < 0)
+        return {};
+    return index == 0 ? QString("/") : path.left(index);
+}
+
+QString FileTagCachePrivate::prefixOfDir(const QString &dir)
+{
+    return dir.endsWith('/') ? dir : dir + '/';
+}
+
+QStringList FileTagCachePrivate::tagsOfFile(const QString &path) const
+{
+    return fileTagsCache.value(path);
+}
+
+/*!
+ * \brief FileTagCachePrivate::isDirLoaded, only touch the lru tick, so that it can be called under the read lock
+ */
+bool FileTagCachePrivate::isDirLoaded(const QString &dir)
+{
+    auto it = loadedDirs.constFind(dir);
+    if (it == loadedDirs.constEnd())
+        return false;
+    it.value()->lastUsed = ++lruTick;
+    return true;
+}
+
+/*!
+ * \brief FileTagCachePrivate::isDirCached, tell whether the changes of files in the dir should be applied to the cache,
+ * a dir being loaded is marked as stale, its query result may be older than the changes
+ */
+bool FileTagCachePrivate::isDirCached(const QString &dir)
+{
+    if (loadedDirs.contains(dir))
+        return true;
+
+    if (loadingDirs.contains(dir))
+        staleDirs.insert(dir);
+    return false;
+}
+
+/*!
+ * \brief FileTagCachePrivate::isFileCached, tell whether the tags of the file are in the cache,
+ * either by its loaded dir or by a query of the file alone
+ */
+bool FileTagCachePrivate::isFileCached(const QString &path)
+{
+    return knownFiles.contains(path) || isDirLoaded(dirOfPath(path));
+}
+
+QVariantHash FileTagCachePrivate::loadDirs(const QStringList &dirs)
+{
+    QStringList toLoad;
+    {
+        QWriteLocker wlk(&lock);
+        for (const QString &dir : dirs) {
+            if (loadedDirs.contains(dir) || loadingDirs.contains(dir))
+                continue;
+            loadingDirs.insert(dir);
+            toLoad.append(dir);
+        }
+    }
+
+    if (toLoad.isEmpty())
+        return {};
+
+    // the daemon is queried out of the lock, changes arrived meanwhile make the dir stale
+    bool valid = TagProxyHandle::instance()->isValid();
+    const auto &fileTags = valid ? TagProxyHandle::instance()->getFilesWithTagsOfDirs(toLoad) : QVariantHash();
+
+    QWriteLocker wlk(&lock);
+    for (auto it = fileTags.begin(); it != fileTags.end(); ++it) {
+        if (!staleDirs.contains(dirOfPath(it.key())))
+            fileTagsCache.insert(it.key(), it.value().toStringList());
+    }
+
+    for (const QString &dir : toLoad) {
+        loadingDirs.remove(dir);
+        if (staleDirs.remove(dir) || !valid)
+            continue;
+
+        QSharedPointer<LoadedDir> info(new LoadedDir);
+        info->lastUsed = ++lruTick;
+        loadedDirs.insert(dir, info);
+    }
+
+    evictColdDirs();
+    return fileTags;
+}
+
+/*!
+ * \brief FileTagCachePrivate::loadFiles, query the tags of the files alone, the result is dropped
+ * if any file tags changed while the query was in flight, the files are loaded again on the next lookup
+ * \return the tagged files of the result
+ */
+QVariantMap FileTagCachePrivate::loadFiles(const QStringList &files)
+{
+    if (files.isEmpty())
+        return {};
+
+    quint64 serial = 0;
+    {
+        QReadLocker rlk(&lock);
+        serial = changeSerial;
+    }
+
+    if (!TagProxyHandle::instance()->isValid())
+        return {};
+    const auto &fileTags = TagProxyHandle::instance()->getTagsThroughFile(files);
+
+    QWriteLocker wlk(&lock);
+    if (serial != changeSerial)
+        return {};
+
+    for (const QString &file : files) {
+        knownFiles.insert(file, ++lruTick);
+        const auto &tags = fileTags.value(file).toStringList();
+        if (!tags.isEmpty())
+            fileTagsCache.insert(file, tags);
+    }
+
+    evictKnownFiles();
+    return fileTags;
+}
+
+/*!
+ * \brief FileTagCachePrivate::evictColdDirs, drop the least recently used dirs down to 3/4 of the limit,
+ * so that the sort is not done on every load
+ */
+void FileTagCachePrivate::evictColdDirs()
+{
+    if (loadedDirs.size() <= kMaxLoadedDirs)
+        return;
+
+    QList<QPair<quint64, QString>> dirs;
+    dirs.reserve(loadedDirs.size());
+    for (auto it = loadedDirs.constBegin(); it != loadedDirs.constEnd(); ++it)
+        dirs.append({ it.value()->lastUsed.load(), it.key() });
+    std::sort(dirs.begin(), dirs.end());
+
+    int evictCount = loadedDirs.size() - kMaxLoadedDirs * 3 / 4;
+    for (int i = 0; i < evictCount; ++i) {
+        loadedDirs.remove(dirs.at(i).second);
+        removeFilesOfDir(dirs.at(i).second);
+    }
+}
+
+/*!
+ * \brief FileTagCachePrivate::evictKnownFiles, drop the files loaded first down to 3/4 of the limit
+ */
+void FileTagCachePrivate::evictKnownFiles()
+{
+    if (knownFiles.size() <= kMaxKnownFiles)
+        return;
+
+    QList<QPair<quint64, QString>> files;
+    files.reserve(knownFiles.size());
+    for (auto it = knownFiles.constBegin(); it != knownFiles.constEnd(); ++it)
+        files.append({ it.value(), it.key() });
+    std::sort(files.begin(), files.end());
+
+    int evictCount = knownFiles.size() - kMaxKnownFiles * 3 / 4;
+    for (int i = 0; i < evictCount; ++i) {
+        const QString &file = files.at(i).second;
+        knownFiles.remove(file);
+        if (!loadedDirs.contains(dirOfPath(file)))
+            fileTagsCache.remove(file);
+    }
+}
+
+void FileTagCachePrivate::removeFilesOfDir(const QString &dir)
+{
+    const QString &prefix = prefixOfDir(dir);
+    auto it = fileTagsCache.lowerBound(prefix);
+    while (it != fileTagsCache.end() && it.key().startsWith(prefix)) {
+        // the files of sub dirs belong to other cached dirs
+        if (it.key().indexOf('/', prefix.length()) == -1) {
+            // a tagged file loaded alone loses its tags with the dir
+            knownFiles.remove(it.key());
+            it = fileTagsCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/*!
+ * \brief FileTagCachePrivate::removePaths, drop the \a paths and everything under them from the cache,
+ * the renamed or moved dirs are loaded again by their new paths
+ */
+void FileTagCachePrivate::removePaths(const QStringList &paths)
+{
+    ++changeSerial;
+    for (const QString &path : paths) {
+        const QString &prefix = prefixOfDir(path);
+        auto underPath = [&path, &prefix](const QString &key) {
+            return key == path || key.startsWith(prefix);
+        };
+
+        auto dirIt = loadedDirs.begin();
+        while (dirIt != loadedDirs.end()) {
+            if (underPath(dirIt.key()))
+                dirIt = loadedDirs.erase(dirIt);
+            else
+                ++dirIt;
+        }
+        for (const QString &dir : loadingDirs) {
+            if (underPath(dir))
+                staleDirs.insert(dir);
+        }
+        auto fileIt = knownFiles.begin();
+        while (fileIt != knownFiles.end()) {
+            if (underPath(fileIt.key()))
+                fileIt = knownFiles.erase(fileIt);
+            else
+                ++fileIt;
+        }
+
+        // the path itself keeps its tags if its parent is loaded, they are moved by the tag signals
+        auto it = fileTagsCache.lowerBound(prefix);
+        while (it != fileTagsCache.end() && it.key().startsWith(prefix))
+            it = fileTagsCache.erase(it);
+    }
+}
+
+void FileTagCachePrivate::tagFiles(const QVariantMap &fileAndTags)
+{
+    ++changeSerial;
+    auto it = fileAndTags.begin();
+    for (; it != fileAndTags.end(); ++it) {
+        if (!isDirCached(dirOfPath(it.key())) && !knownFiles.contains(it.key()))
+            continue;
+
+        const auto &lst = it.value().toStringList();
+        if (lst.isEmpty())
+            continue;
+
+        auto &cacheLst = fileTagsCache[it.key()];
+        for (const QString &tag : lst)
+            if (!cacheLst.contains(tag))
+                cacheLst.append(tag);
+    }
+}
+
+void FileTagCachePrivate::untagFiles(const QVariantMap &fileAndTags)
+{
+    ++changeSerial;
+    auto it = fileAndTags.begin();
+    for (; it != fileAndTags.end(); ++it) {
+        if (!isDirCached(dirOfPath(it.key())) && !knownFiles.contains(it.key()))
+            continue;
+
+        auto cacheIt = fileTagsCache.find(it.key());
+        if (cacheIt == fileTagsCache.end())
+            continue;
+
+        const auto &lst = it.value().toStringList();
+        for (const QString &tag : lst)
+            cacheIt.value().removeOne(tag);
+
+        if (cacheIt.value().isEmpty())
+            fileTagsCache.erase(cacheIt);
+    }
+}
+
 FileTagCache::FileTagCache(QObject *parent)
     : QObject(parent), d(new FileTagCachePrivate(this))
 {
@@ -87,14 +373,25 @@ FileTagCache &FileTagCache::instance()
     return cache;
 }
 
+/*!
+ * \brief FileTagCache::loadFileTagsFromDatabase, only the tag properties are loaded,
+ * the tags of files are loaded by dir on demand, see getTagsByFiles
+ */
 void FileTagCache::loadFileTagsFromDatabase()
 {
     fmInfo() << "Start initilize FileTagCache";
-    // 加载数据库所有文件标记,和标记属性到缓存
     if (!TagProxyHandle::instance()->isValid())
         fmWarning() << "tagService is inValid";
-    d->fileTagsCache = TagProxyHandle::instance()->getAllFileWithTags();
     const auto &tagsColor = TagProxyHandle::instance()->getAllTags();
+
+    QWriteLocker wlk(&d->lock);
+    // the service may be restarted, drop the dirs loaded before
+    d->fileTagsCache.clear();
+    d->loadedDirs.clear();
+    d->knownFiles.clear();
+    d->staleDirs.unite(d->loadingDirs);
+    ++d->changeSerial;
+
     auto it = tagsColor.begin();
     for (; it != tagsColor.end(); ++it)
         d->tagProperty.insert(it.key(), QColor(it.value().toString()));
@@ -102,6 +399,7 @@ void FileTagCache::loadFileTagsFromDatabase()
 
 void FileTagCache::addTags(const QVariantMap &tags)
 {
+    QWriteLocker wlk(&d->lock);
     auto it = tags.begin();
     for (; it != tags.end(); ++it) {
         if (d->tagProperty.contains(it.key()))
@@ -112,13 +410,14 @@ void FileTagCache::addTags(const QVariantMap &tags)
 
 void FileTagCache::deleteTags(const QStringList &tags)
 {
+    QWriteLocker wlk(&d->lock);
     QVariantMap map {};
     for (const QString &tag : tags) {
         d->tagProperty.remove(tag);
 
         auto iter = d->fileTagsCache.begin();
         while (iter != d->fileTagsCache.end()) {
-            if (iter.value().toStringList().contains(tag)) {
+            if (iter.value().contains(tag)) {
                 QStringList fileTags = map[iter.key()].toStringList();
                 fileTags.append(tag);
                 map[iter.key()] = fileTags;
@@ -129,11 +428,12 @@ void FileTagCache::deleteTags(const QStringList &tags)
     }
 
     if (!map.isEmpty())
-        untaggeFiles(map);
+        d->untagFiles(map);
 }
 
 void FileTagCache::changeTagColor(const QVariantMap &tagAndColorName)
 {
+    QWriteLocker wlk(&d->lock);
     auto it = tagAndColorName.begin();
     for (; it != tagAndColorName.end(); ++it) {
         if (d->tagProperty.contains(it.key()))
@@ -143,6 +443,7 @@ void FileTagCache::changeTagColor(const QVariantMap &tagAndColorName)
 
 void FileTagCache::changeTagName(const QVariantMap &oldAndNew)
 {
+    QWriteLocker wlk(&d->lock);
     auto it = oldAndNew.begin();
     for (; it != oldAndNew.end(); ++it) {
         const QString &oldName { it.key() };
@@ -157,53 +458,27 @@ void FileTagCache::changeTagName(const QVariantMap &oldAndNew)
 
 void FileTagCache::changeFilesTagName(const QString &oldName, const QString &newName)
 {
-    std::for_each(d->fileTagsCache.begin(), d->fileTagsCache.end(), [oldName, newName](QVariant &var) {
-        QStringList tagNames { var.toStringList() };
+    QWriteLocker wlk(&d->lock);
+    ++d->changeSerial;
+    std::for_each(d->fileTagsCache.begin(), d->fileTagsCache.end(), [oldName, newName](QStringList &tagNames) {
         auto result { std::find(tagNames.begin(), tagNames.end(), oldName) };
         if (result != tagNames.end()) {
             int index { result - tagNames.begin() };
             tagNames.replace(index, newName);
-            var.setValue(tagNames);
         }
     });
 }
 
 void FileTagCache::taggeFiles(const QVariantMap &fileAndTags)
 {
-    auto it = fileAndTags.begin();
-    for (; it != fileAndTags.end(); ++it) {
-        if (!d->fileTagsCache.contains(it.key())) {
-            d->fileTagsCache.insert(it.key(), it.value().toStringList());
-        } else {
-            const auto &lst = it.value().toStringList();
-            auto cacheLst = d->fileTagsCache.value(it.key()).toStringList();
-            for (const QString &tag : lst)
-                if (!cacheLst.contains(tag))
-                    cacheLst.append(tag);
-
-            d->fileTagsCache[it.key()] = cacheLst;
-        }
-    }
+    QWriteLocker wlk(&d->lock);
+    d->tagFiles(fileAndTags);
 }
 
 void FileTagCache::untaggeFiles(const QVariantMap &fileAndTags)
 {
-    auto it = fileAndTags.begin();
-    for (; it != fileAndTags.end(); ++it) {
-        if (d->fileTagsCache.contains(it.key())) {
-            const auto &lst = it.value().toStringList();
-            auto cacheLst = d->fileTagsCache.value(it.key()).toStringList();
-            for (const QString &tag : lst)
-                if (cacheLst.contains(tag))
-                    cacheLst.removeOne(tag);
-
-            if (cacheLst.isEmpty()) {
-                d->fileTagsCache.remove(it.key());
-            } else {
-                d->fileTagsCache[it.key()] = cacheLst;
-            }
-        }
-    }
+    QWriteLocker wlk(&d->lock);
+    d->untagFiles(fileAndTags);
 }
 
 FileTagCache::~FileTagCache()
@@ -211,20 +486,33 @@ FileTagCache::~FileTagCache()
 }
 
 /**
- * @brief A single file gets its own tags, and multiple files are their intersection
+ * @brief A single file gets its own tags, and multiple files are their intersection,
+ * the parent dirs which are not cached are loaded from the tag service first
  * @param paths is a collection of file paths
  * @return QStringList intersectionTags
  */
-QStringList FileTagCache::getTagsByFiles(const QStringList &paths) const
+QStringList FileTagCache::getTagsByFiles(const QStringList &paths)
 {
     if (paths.isEmpty())
         return {};
 
-    QReadLocker wlk(&d->lock);
-    QStringList intersectionTags = d->fileTagsCache.value(paths.first()).toStringList();
+    QStringList dirsToLoad;
+    {
+        QReadLocker rlk(&d->lock);
+        for (const QString &path : paths) {
+            const QString &dir = FileTagCachePrivate::dirOfPath(path);
+            if (!dirsToLoad.contains(dir) && !d->isFileCached(path))
+                dirsToLoad.append(dir);
+        }
+    }
+    if (!dirsToLoad.isEmpty())
+        d->loadDirs(dirsToLoad);
+
+    QReadLocker rlk(&d->lock);
+    QStringList intersectionTags = d->tagsOfFile(paths.first());
 
     for (const QString &path : paths) {
-        QStringList tags = d->fileTagsCache.value(path).toStringList();
+        QStringList tags = d->tagsOfFile(path);
         intersectionTags = intersectionTags.toSet().intersect(tags.toSet()).values();
         if (intersectionTags.isEmpty())
             break;
@@ -232,6 +520,116 @@ QStringList FileTagCache::getTagsByFiles(const QStringList &paths) const
     return intersectionTags;
 }
 
+/*!
+ * \brief FileTagCache::getTagsOfDir
+ * \param dir
+ * \return the tags of the tagged files which are direct children of the dir
+ */
+QVariantMap FileTagCache::getTagsOfDir(const QString &dir)
+{
+    {
+        QReadLocker rlk(&d->lock);
+        if (!d->isDirLoaded(dir)) {
+            rlk.unlock();
+            d->loadDirs({ dir });
+        }
+    }
+
+    QReadLocker rlk(&d->lock);
+    const QString &prefix = FileTagCachePrivate::prefixOfDir(dir);
+    QVariantMap fileTags;
+    for (auto it = d->fileTagsCache.lowerBound(prefix); it != d->fileTagsCache.end() && it.key().startsWith(prefix); ++it) {
+        if (it.key().indexOf('/', prefix.length()) == -1)
+            fileTags.insert(it.key(), it.value());
+    }
+
+    return fileTags;
+}
+
+/*!
+ * \brief FileTagCache::getCachedTagsByFile, never wait for the tag service, so that it can be used in painting
+ * \param needLoad set if the tags of the file are not cached and the file is the first one added to the pending list,
+ * the caller should start loadPendingFiles in the worker thread
+ * \return the cached tags, empty if they are not loaded yet
+ */
+QStringList FileTagCache::getCachedTagsByFile(const QString &path, bool *needLoad)
+{
+    Q_ASSERT(needLoad);
+    *needLoad = false;
+    {
+        QReadLocker rlk(&d->lock);
+        if (d->isFileCached(path))
+            return d->tagsOfFile(path);
+    }
+
+    QMutexLocker mlk(&d->pendingMutex);
+    *needLoad = d->pendingFiles.isEmpty();
+    d->pendingFiles.insert(path);
+    return {};
+}
+
+/*!
+ * \brief FileTagCache::loadPendingFiles, load the files queued by getCachedTagsByFile,
+ * the dirs having several pending files are loaded as a whole, the rest files are queried alone
+ * \param loadAgain set if some files were changed while loading, they are queued again
+ * \return the tagged files loaded
+ */
+QVariantMap FileTagCache::loadPendingFiles(bool *loadAgain)
+{
+    Q_ASSERT(loadAgain);
+    *loadAgain = false;
+
+    QSet<QString> files;
+    {
+        QMutexLocker mlk(&d->pendingMutex);
+        files.swap(d->pendingFiles);
+    }
+
+    QHash<QString, QStringList> filesOfDir;
+    for (const QString &file : files)
+        filesOfDir[FileTagCachePrivate::dirOfPath(file)].append(file);
+
+    QStringList dirs;
+    QStringList aloneFiles;
+    for (auto it = filesOfDir.cbegin(); it != filesOfDir.cend(); ++it) {
+        if (it.value().size() >= kMinFilesToLoadDir)
+            dirs.append(it.key());
+        else
+            aloneFiles.append(it.value());
+    }
+
+    QVariantMap fileAndTags = d->loadFiles(aloneFiles);
+    const auto &dirFileTags = d->loadDirs(dirs);
+    for (auto it = dirFileTags.cbegin(); it != dirFileTags.cend(); ++it)
+        fileAndTags.insert(it.key(), it.value());
+
+    if (!TagProxyHandle::instance()->isValid())
+        return fileAndTags;
+
+    QStringList staleFiles;
+    {
+        QReadLocker rlk(&d->lock);
+        for (const QString &file : files) {
+            if (!d->isFileCached(file))
+                staleFiles.append(file);
+        }
+    }
+    if (!staleFiles.isEmpty()) {
+        QMutexLocker mlk(&d->pendingMutex);
+        // a painting found the list empty and has started the worker already
+        *loadAgain = d->pendingFiles.isEmpty();
+        for (const QString &file : staleFiles)
+            d->pendingFiles.insert(file);
+    }
+    return fileAndTags;
+}
+
+void FileTagCache::removeCachedPaths(const QStringList &paths)
+{
+    QWriteLocker wlk(&d->lock);
+    d->removePaths(paths);
+}
+
 FileTagCache::TagColorMap FileTagCache::getTagsColor(const QStringList &tags) const
 {
     if (tags.isEmpty())
@@ -263,6 +661,29 @@ QStringList FileTagCacheController::getTagsByFile(const QString &path)
     return FileTagCache::instance().getTagsByFiles({ path });
 }
 
+/*!
+ * \brief FileTagCacheController::getCachedTagsByFile, get the tags without waiting for the tag service,
+ * a file not loaded gets empty tags and filesLoaded is emitted once its tags are loaded in the worker thread
+ */
+QStringList FileTagCacheController::getCachedTagsByFile(const QString &path)
+{
+    bool needLoad = false;
+    const auto &tags = FileTagCache::instance().getCachedTagsByFile(path, &needLoad);
+    if (needLoad)
+        QMetaObject::invokeMethod(cacheWorker.data(), "loadPendingFiles", Qt::QueuedConnection);
+    return tags;
+}
+
+void FileTagCacheController::removeCachedPaths(const QStringList &paths)
+{
+    FileTagCache::instance().removeCachedPaths(paths);
+}
+
+QVariantMap FileTagCacheController::getTagsOfDir(const QString &dir)
+{
+    return FileTagCache::instance().getTagsOfDir(dir);
+}
+
 QMap<QString, QColor> FileTagCacheController::getCacheTagsColor(const QStringList &tags)
 {
     return FileTagCache::instance().getTagsColor(tags);
@@ -24,6 +24,7 @@ public:
 
 public Q_SLOTS:
     void loadFileTagsFromDatabase();
+    void loadPendingFiles();
     void onTagAdded(const QVariantMap &tags);
     void onTagDeleted(const QVariant &tags);
     void onTagsColorChanged(const QVariantMap &tagAndColorName);
@@ -48,13 +49,17 @@ public:
     virtual ~FileTagCache() override;
 
     //query
-    QStringList getTagsByFiles(const QStringList &paths) const;
+    QStringList getTagsByFiles(const QStringList &paths);
+    QVariantMap getTagsOfDir(const QString &dir);
     TagColorMap getTagsColor(const QStringList &tags) const;
+    QStringList getCachedTagsByFile(const QString &path, bool *needLoad);
 
 private:
     explicit FileTagCache(QObject *parent = nullptr);
     static FileTagCache &instance();
     void loadFileTagsFromDatabase();
+    QVariantMap loadPendingFiles(bool *loadAgain);
+    void removeCachedPaths(const QStringList &paths);
 
     void addTags(const QVariantMap &tags);
     void deleteTags(const QStringList &tags);
@@ -79,10 +84,14 @@ public:
     //query
     QStringList getTagsByFiles(const QStringList &paths);
     QStringList getTagsByFile(const QString &path);
+    QStringList getCachedTagsByFile(const QString &path);
+    QVariantMap getTagsOfDir(const QString &dir);
     QMap<QString, QColor> getCacheTagsColor(const QStringList &tags);
+    void removeCachedPaths(const QStringList &paths);
 
 Q_SIGNALS:
     void initLoadTagInfos();
+    void filesLoaded(const QVariantMap &fileAndTags);
 
     void filesTagged(const QVariantMap &fileAndTags);
     void filesUntagged(const QVariantMap &fileAndTags);
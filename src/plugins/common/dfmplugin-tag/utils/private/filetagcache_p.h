@@ -7,7 +7,11 @@
 
 #include "utils/filetagcache.h"
 #include <QReadWriteLock>
+#include <QVariant>
 #include <QMutex>
+#include <QSet>
+
+#include <atomic>
 
 namespace dfmplugin_tag {
 class FileTagCachePrivate
@@ -15,13 +19,42 @@ class FileTagCachePrivate
     friend class FileTagCache;
     FileTagCache *const q;
 
-    QHash<QString, QVariant> fileTagsCache;   // file path ->  tag name list
+    // a dir whose tagged children are all in fileTagsCache, an empty dir is cached as well
+    struct LoadedDir
+    {
+        std::atomic<quint64> lastUsed { 0 };
+    };
+
+    QMap<QString, QStringList> fileTagsCache;   // file path -> tag name list, ordered for prefix range queries
+    QHash<QString, QSharedPointer<LoadedDir>> loadedDirs;   // dir path -> lru info
+    QSet<QString> loadingDirs;   // dirs being queried from the daemon
+    QSet<QString> staleDirs;   // loading dirs which were changed before the query returned
+    QHash<QString, quint64> knownFiles;   // files queried alone out of the loaded dirs -> load tick, tagged or not
+    QSet<QString> pendingFiles;   // files waiting to be loaded by the worker, guarded by pendingMutex
+    QMutex pendingMutex;
+    quint64 changeSerial { 0 };   // bumped on every change of the file tags
+    std::atomic<quint64> lruTick { 0 };
     QHash<QString, QColor> tagProperty;   // tag name -> QColor
     QReadWriteLock lock;
 
 public:
     explicit FileTagCachePrivate(FileTagCache *qq);
     virtual ~FileTagCachePrivate();
+
+    static QString dirOfPath(const QString &path);
+    static QString prefixOfDir(const QString &dir);
+    QStringList tagsOfFile(const QString &path) const;
+    bool isDirLoaded(const QString &dir);
+    bool isDirCached(const QString &dir);
+    bool isFileCached(const QString &path);
+    QVariantHash loadDirs(const QStringList &dirs);
+    QVariantMap loadFiles(const QStringList &files);
+    void evictColdDirs();
+    void evictKnownFiles();
+    void removeFilesOfDir(const QString &dir);
+    void removePaths(const QStringList &paths);
+    void tagFiles(const QVariantMap &fileAndTags);
+    void untagFiles(const QVariantMap &fileAndTags);
 };
 }
 
@@ -59,6 +59,7 @@ void TagManager::initializeConnection()
     connect(&FileTagCacheIns, &FileTagCacheController::tagsNameChanged, this, &TagManager::onTagNameChanged);
     connect(&FileTagCacheIns, &FileTagCacheController::filesTagged, this, &TagManager::onFilesTagged);
     connect(&FileTagCacheIns, &FileTagCacheController::filesUntagged, this, &TagManager::onFilesUntagged);
+    connect(&FileTagCacheIns, &FileTagCacheController::filesLoaded, this, &TagManager::onFilesLoaded);
 }
 
 TagManager *TagManager::instance()
@@ -132,7 +133,8 @@ bool TagManager::paintListTagsHandle(int role, const FileInfoPointer &info, QPai
 
     QString path = info->pathOf(PathInfoType::kFilePath);
     path = FileUtils::bindPathTransform(path, false);
-    const auto &tags = FileTagCacheIns.getTagsByFile(path);
+    // the tags not loaded yet are painted when filesLoaded arrives
+    const auto &tags = FileTagCacheIns.getCachedTagsByFile(path);
     if (tags.isEmpty())
         return false;
 
@@ -157,22 +159,24 @@ bool TagManager::addIconTagsHandle(const FileInfoPointer &info, ElideTextLayout
 
     QString path = info->pathOf(PathInfoType::kFilePath);
     path = FileUtils::bindPathTransform(path, false);
-    const auto &fileTags = FileTagCacheIns.getTagsByFile(path);
+    const auto &fileTags = FileTagCacheIns.getCachedTagsByFile(path);
     if (fileTags.isEmpty())
         return false;
 
     const auto &tagsColor = FileTagCacheIns.getCacheTagsColor(fileTags);
 
     if (!tagsColor.isEmpty()) {
-        auto document = layout->documentHandle();
-        if (document) {
-            document->documentLayout()->registerHandler(textObjectType, tagPainter);
-            QTextCursor cursor(document);
-            TagTextFormat format(textObjectType, tagsColor.values(), Qt::white);
-
-            cursor.setPosition(0);
-            cursor.insertText(QString(QChar::ObjectReplacementCharacter), format);
-        }
+        // drawn over the cached lines of the name, the document of the layout is kept untouched
+        const TagTextFormat format(textObjectType, tagsColor.values(), Qt::white);
+        QStringList colorNames;
+        for (const QColor &color : tagsColor)
+            colorNames.append(color.name());
+
+        TagPainter *objectPainter = tagPainter;
+        layout->setLeadingObject(tagPainter->intrinsicSize(nullptr, 0, format), colorNames.join(','),
+                                 [objectPainter, format](QPainter *painter, const QRectF &rect) {
+                                     objectPainter->drawObject(painter, rect, nullptr, 0, format);
+                                 });
     }
 
     return false;
@@ -701,3 +705,10 @@ void TagManager::onFilesUntagged(const QVariantMap &fileAndTags)
 
     emit filesUntagged(fileAndTags);
 }
+
+void TagManager::onFilesLoaded(const QVariantMap &fileAndTags)
+{
+    // the files were painted without tags before they were loaded
+    for (auto it = fileAndTags.begin(); it != fileAndTags.end(); ++it)
+        TagEventCaller::sendFileUpdate(it.key());
+}
@@ -80,6 +80,7 @@ public Q_SLOTS:
     void onTagNameChanged(const QVariantMap &oldAndNew);
     void onFilesTagged(const QVariantMap &fileAndTags);
     void onFilesUntagged(const QVariantMap &fileAndTags);
+    void onFilesLoaded(const QVariantMap &fileAndTags);
 
 private:
     explicit TagManager(QObject *parent = nullptr);
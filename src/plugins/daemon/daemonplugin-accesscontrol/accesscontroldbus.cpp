@@ -4,6 +4,7 @@
 
 #include "accesscontroldbus.h"
 #include "utils.h"
+#include "diskpasswordrotator.h"
 #include "polkit/policykithelper.h"
 
 #include <dfm-base/base/device/deviceutils.h>
@@ -212,46 +213,31 @@ void AccessControlDBus::ChangeDiskPassword(const QString &oldPwd, const QString
         return;
     }
 
-    const QByteArray &tmpOldPwd = oldPwd.toLocal8Bit();
-    const QByteArray &tmpNewPwd = newPwd.toLocal8Bit();
-
-    int ret = kNoError;
-    QStringList successList;
-    for (int i = 0; i < devList.size(); ++i) {
-        struct crypt_device *cd = nullptr;
-        ret = Utils::checkDiskPassword(&cd, tmpOldPwd.data(), devList[i].toLocal8Bit().data());
-
-        if (ret == kPasswordWrong && i == 0) {
-            emit DiskPasswordChecked(kPasswordWrong);
-            return;
-        } else if (ret == kPasswordWrong) {
-            ret = kPasswordInconsistent;
-            break;
-        } else if (ret == kNoError) {
-            if (i == 0)
-                emit DiskPasswordChecked(kNoError);
-
-            ret = Utils::changeDiskPassword(cd, tmpOldPwd.data(), tmpNewPwd.data());
-        } else {
-            break;
-        }
-
-        if (ret != kNoError)
-            break;
-
-        successList << devList[i];
-    }
-
-    // restore password
-    if (ret != kNoError && !successList.isEmpty()) {
-        for (const auto &device : successList) {
-            struct crypt_device *cd = nullptr;
-            Utils::checkDiskPassword(&cd, tmpNewPwd.data(), device.toLocal8Bit().data());
-            Utils::changeDiskPassword(cd, tmpNewPwd.data(), tmpOldPwd.data());
-        }
+    // the disks of the running change are not touched twice
+    if (diskPasswordChanging) {
+        fmWarning() << "the disk password is being changed";
+        emit DiskPasswordChecked(kPasswordChanging);
+        return;
     }
+    diskPasswordChanging = true;
+
+    // the password is verified and changed on the disks in parallel, out of the dbus thread
+    auto rotator = new DiskPasswordRotator(devList, DiskPasswordRotator::defaultMemoryBudget());
+    connect(rotator, &DiskPasswordRotator::checked, this, &AccessControlDBus::DiskPasswordChecked);
+    connect(rotator, &DiskPasswordRotator::progress, this, &AccessControlDBus::DiskPasswordProgress);
+    connect(rotator, &DiskPasswordRotator::finished, this, [this, rotator](int code) {
+        // a failure of the check is already reported by DiskPasswordChecked
+        if (rotator->isPasswordChecked())
+            emit DiskPasswordChanged(code);
+        diskPasswordChanging = false;
+        rotator->deleteLater();
+    });
 
-    emit DiskPasswordChanged(ret);
+    const QByteArray &tmpOldPwd = oldPwd.toLocal8Bit();
+    const QByteArray &tmpNewPwd = newPwd.toLocal8Bit();
+    QtConcurrent::run([rotator, tmpOldPwd, tmpNewPwd] {
+        rotator->rotate(tmpOldPwd, tmpNewPwd);
+    });
 }
 
 bool AccessControlDBus::Chmod(const QString &path, uint mode)
@@ -56,6 +56,7 @@ signals:
     void AccessVaultPolicyNotify();
     void DiskPasswordChecked(int code);
     void DiskPasswordChanged(int code);
+    void DiskPasswordProgress(const QString &device, int stage, int code);
 
 private:
     void initConnect();
@@ -70,6 +71,7 @@ private:
     QMap<QString, int> globalVaultHidePolicies;
     QMap<int, QString> errMsg;
     QScopedPointer<DFMMOUNT::DBlockMonitor> monitor;
+    bool diskPasswordChanging { false };
 };
 
 #endif   // ACCESSCONTROLDBUS_H
@@ -47,6 +47,11 @@ class AccessControlManagerAdaptor: public QDBusAbstractAdaptor
 "    <signal name=\"DiskPasswordChanged\">\n"
 "      <arg direction=\"out\" type=\"i\" name=\"code\"/>\n"
 "    </signal>\n"
+"    <signal name=\"DiskPasswordProgress\">\n"
+"      <arg direction=\"out\" type=\"s\" name=\"device\"/>\n"
+"      <arg direction=\"out\" type=\"i\" name=\"stage\"/>\n"
+"      <arg direction=\"out\" type=\"i\" name=\"code\"/>\n"
+"    </signal>\n"
 "    <method name=\"SetAccessPolicy\">\n"
 "      <arg direction=\"out\" type=\"s\"/>\n"
 "      <arg direction=\"in\" type=\"a{sv}\" name=\"policy\"/>\n"
@@ -104,6 +109,7 @@ Q_SIGNALS: // SIGNALS
     void DeviceAccessPolicyChanged(const QVariantList &policy);
     void DiskPasswordChanged(int code);
     void DiskPasswordChecked(int code);
+    void DiskPasswordProgress(const QString &device, int stage, int code);
 };
 
 #endif
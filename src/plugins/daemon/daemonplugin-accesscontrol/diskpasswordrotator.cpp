@@ -0,0 +1,246 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "diskpasswordrotator.h"
+
+#include <QFile>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <libcryptsetup.h>
+
+DAEMONPAC_USE_NAMESPACE
+
+static constexpr qint64 kFallbackBudgetKib { 1024 * 1024 };
+static constexpr int kMaxParallelDisks { 8 };
+
+// the highest memory cost among the active keyslots, one of them is tried for the password
+static qint64 keyslotsMemoryCost(crypt_device *cd)
+{
+    qint64 cost = 0;
+    const int count = crypt_keyslot_max(CRYPT_LUKS2);
+    for (int slot = 0; slot < count; ++slot) {
+        const crypt_keyslot_info info = crypt_keyslot_status(cd, slot);
+        if (info != CRYPT_SLOT_ACTIVE && info != CRYPT_SLOT_ACTIVE_LAST)
+            continue;
+        struct crypt_pbkdf_type pbkdf;
+        if (crypt_keyslot_get_pbkdf(cd, slot, &pbkdf) == 0)
+            cost = qMax(cost, static_cast<qint64>(pbkdf.max_memory_kb));
+    }
+    return cost;
+}
+
+// the memory cost of the keyslot written with the new password
+static qint64 newKeyslotMemoryCost(crypt_device *cd)
+{
+    const struct crypt_pbkdf_type *pbkdf = crypt_get_pbkdf_type(cd);
+    return pbkdf ? static_cast<qint64>(pbkdf->max_memory_kb) : 0;
+}
+
+MemoryBudget::MemoryBudget(qint64 totalKib)
+    : totalKib(qMax<qint64>(totalKib, 1))
+{
+}
+
+/*!
+ * \brief MemoryBudget::acquire wait until the memory can be used
+ * \return the memory granted, which must be released
+ */
+qint64 MemoryBudget::acquire(qint64 kib)
+{
+    const qint64 granted = qBound<qint64>(0, kib, totalKib);
+    QMutexLocker locker(&mutex);
+    while (usedKib + granted > totalKib)
+        released.wait(&mutex);
+    usedKib += granted;
+    return granted;
+}
+
+void MemoryBudget::release(qint64 kib)
+{
+    QMutexLocker locker(&mutex);
+    usedKib -= kib;
+    released.wakeAll();
+}
+
+DiskPasswordRotator::DiskPasswordRotator(const QStringList &devices, qint64 memoryBudgetKib, QObject *parent)
+    : QObject(parent),
+      budget(memoryBudgetKib)
+{
+    for (const QString &device : devices) {
+        Disk disk;
+        disk.device = device;
+        disks.append(disk);
+    }
+}
+
+DiskPasswordRotator::~DiskPasswordRotator()
+{
+    for (Disk &disk : disks) {
+        if (disk.cd)
+            crypt_free(disk.cd);
+    }
+}
+
+/*!
+ * \brief DiskPasswordRotator::rotate change the password of all the disks
+ * \return kPasswordWrong if the first disk rejects the old password, kPasswordInconsistent
+ * if another disk rejects it, the first error of the disks otherwise.
+ * An error of the first disk is reported by checked as well
+ */
+DPCErrorCode DiskPasswordRotator::rotate(const QByteArray &oldPwd, const QByteArray &newPwd)
+{
+    if (disks.isEmpty()) {
+        passwordChecked = true;
+        emit checked(kNoError);
+        return finish(kAccessDiskFailed);
+    }
+
+    QVector<Disk *> all;
+    for (Disk &disk : disks)
+        all.append(&disk);
+
+    // 1. nothing is written before every disk accepts the old password
+    runOnDisks(all, [this, &oldPwd](Disk *disk) { checkDisk(disk, oldPwd); });
+    const DPCErrorCode firstCode = disks.first().code;
+    if (firstCode != kNoError) {
+        emit checked(firstCode);
+        return finish(firstCode);
+    }
+    passwordChecked = true;
+    emit checked(kNoError);
+
+    for (const Disk &disk : disks) {
+        if (disk.code != kNoError)
+            return finish(disk.code == kPasswordWrong ? kPasswordInconsistent : disk.code);
+    }
+
+    // 2. change the keyslots
+    runOnDisks(all, [&](Disk *disk) { changeDisk(disk, oldPwd, newPwd, kChanged); });
+
+    DPCErrorCode ret = kNoError;
+    QVector<Disk *> changed;
+    for (Disk &disk : disks) {
+        if (disk.changed)
+            changed.append(&disk);
+        else if (ret == kNoError)
+            ret = disk.code;
+    }
+    if (ret == kNoError)
+        return finish(kNoError);
+
+    // 3. give the old password back to the disks already changed
+    fmWarning() << "change disk password failed, restore" << changed.size() << "disks";
+    runOnDisks(changed, [&](Disk *disk) { changeDisk(disk, newPwd, oldPwd, kRestored); });
+    for (const Disk *disk : changed) {
+        if (disk->changed)
+            fmCritical() << "cannot restore the password of" << disk->device;
+    }
+    return finish(ret);
+}
+
+/*!
+ * \brief DiskPasswordRotator::isPasswordChecked whether checked(kNoError) is emitted,
+ * otherwise the failure is reported by checked already
+ */
+bool DiskPasswordRotator::isPasswordChecked() const
+{
+    return passwordChecked;
+}
+
+/*!
+ * \brief DiskPasswordRotator::defaultMemoryBudget half of the available memory
+ */
+qint64 DiskPasswordRotator::defaultMemoryBudget()
+{
+    QFile meminfo("/proc/meminfo");
+    if (!meminfo.open(QIODevice::ReadOnly))
+        return kFallbackBudgetKib;
+
+    while (!meminfo.atEnd()) {
+        const QByteArray &line = meminfo.readLine();
+        if (!line.startsWith("MemAvailable:"))
+            continue;
+        const QList<QByteArray> &fields = line.simplified().split(' ');
+        const qint64 available = fields.size() > 1 ? fields.at(1).toLongLong() : 0;
+        return available > 0 ? available / 2 : kFallbackBudgetKib;
+    }
+    return kFallbackBudgetKib;
+}
+
+void DiskPasswordRotator::runOnDisks(const QVector<Disk *> &targets, const std::function<void(Disk *)> &task)
+{
+    if (targets.size() == 1) {
+        task(targets.first());
+        return;
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qBound(1, targets.size(), kMaxParallelDisks));
+    QList<QFuture<void>> futures;
+    for (Disk *disk : targets)
+        futures.append(QtConcurrent::run(&pool, [&task, disk] { task(disk); }));
+    for (QFuture<void> &future : futures)
+        future.waitForFinished();
+}
+
+void DiskPasswordRotator::checkDisk(Disk *disk, const QByteArray &pwd)
+{
+    const QByteArray &device = disk->device.toLocal8Bit();
+    int r = crypt_init(&disk->cd, device.constData());
+    if (r < 0) {
+        fmInfo("crypt_init failed on device %s, code is:%d", device.constData(), r);
+        disk->cd = nullptr;
+        disk->code = kInitFailed;
+    } else if ((r = crypt_load(disk->cd, CRYPT_LUKS2, nullptr)) < 0) {
+        fmInfo("crypt_load failed on device %s, code is:%d", device.constData(), r);
+        disk->code = kDeviceLoadFailed;
+    } else {
+        disk->memoryKib = keyslotsMemoryCost(disk->cd);
+        const qint64 granted = budget.acquire(disk->memoryKib);
+        r = crypt_activate_by_passphrase(disk->cd, nullptr, CRYPT_ANY_SLOT,
+                                         pwd.constData(), static_cast<size_t>(pwd.size()),
+                                         CRYPT_ACTIVATE_ALLOW_UNBOUND_KEY);
+        budget.release(granted);
+        if (r < 0) {
+            fmInfo("crypt_activate_by_passphrase failed on device %s.", device.constData());
+            disk->code = kPasswordWrong;
+        } else {
+            // the keyslot of the password is changed, the others are not tried again
+            disk->keyslot = r;
+        }
+    }
+
+    emit progress(disk->device, kChecked, disk->code);
+}
+
+void DiskPasswordRotator::changeDisk(Disk *disk, const QByteArray &fromPwd, const QByteArray &toPwd, Stage stage)
+{
+    // the old keyslot is verified before the new one is derived
+    const qint64 granted = budget.acquire(qMax(disk->memoryKib, newKeyslotMemoryCost(disk->cd)));
+    const int r = crypt_keyslot_change_by_passphrase(disk->cd, disk->keyslot, CRYPT_ANY_SLOT,
+                                                     fromPwd.constData(), static_cast<size_t>(fromPwd.size()),
+                                                     toPwd.constData(), static_cast<size_t>(toPwd.size()));
+    budget.release(granted);
+
+    if (r < 0) {
+        fmInfo("crypt_keyslot_change_by_passphrase failed on device %s, code is:%d",
+               disk->device.toLocal8Bit().constData(), r);
+        if (stage == kChanged)
+            disk->code = kPasswordChangeFailed;
+    } else {
+        disk->keyslot = r;
+        disk->changed = stage == kChanged;
+        disk->memoryKib = qMax(disk->memoryKib, newKeyslotMemoryCost(disk->cd));
+    }
+
+    emit progress(disk->device, stage, r < 0 ? kPasswordChangeFailed : kNoError);
+}
+
+DPCErrorCode DiskPasswordRotator::finish(DPCErrorCode code)
+{
+    emit finished(code);
+    return code;
+}
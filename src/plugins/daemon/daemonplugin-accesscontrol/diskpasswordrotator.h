@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DISKPASSWORDROTATOR_H
+#define DISKPASSWORDROTATOR_H
+
+#include "daemonplugin_accesscontrol_global.h"
+
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <functional>
+
+struct crypt_device;
+
+DAEMONPAC_BEGIN_NAMESPACE
+
+/*!
+ * \brief The MemoryBudget class bounds the memory of the key derivations running at the same time.
+ * A request larger than the whole budget waits until it can run alone.
+ */
+class MemoryBudget
+{
+public:
+    explicit MemoryBudget(qint64 totalKib);
+
+    qint64 acquire(qint64 kib);
+    void release(qint64 kib);
+
+private:
+    QMutex mutex;
+    QWaitCondition released;
+    qint64 totalKib { 0 };
+    qint64 usedKib { 0 };
+};
+
+/*!
+ * \brief The DiskPasswordRotator class changes the password of several LUKS2 disks as one transaction.
+ * The old password is verified on all the disks in parallel before any keyslot is written,
+ * then the keyslots are changed in parallel. If a disk fails, the disks already changed are
+ * changed back to the old password, so either all the disks take the new password or none.
+ * rotate() blocks, it is meant to run in a worker thread.
+ */
+class DiskPasswordRotator : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Stage {
+        kChecked = 0,
+        kChanged,
+        kRestored
+    };
+
+    DiskPasswordRotator(const QStringList &devices, qint64 memoryBudgetKib, QObject *parent = nullptr);
+    ~DiskPasswordRotator() override;
+
+    DPCErrorCode rotate(const QByteArray &oldPwd, const QByteArray &newPwd);
+    bool isPasswordChecked() const;
+
+    static qint64 defaultMemoryBudget();
+
+Q_SIGNALS:
+    void checked(int code);
+    void progress(const QString &device, int stage, int code);
+    void finished(int code);
+
+private:
+    struct Disk
+    {
+        QString device;
+        crypt_device *cd { nullptr };
+        int keyslot { -1 };
+        qint64 memoryKib { 0 };
+        DPCErrorCode code { kNoError };
+        bool changed { false };
+    };
+
+    void runOnDisks(const QVector<Disk *> &targets, const std::function<void(Disk *)> &task);
+    void checkDisk(Disk *disk, const QByteArray &pwd);
+    void changeDisk(Disk *disk, const QByteArray &fromPwd, const QByteArray &toPwd, Stage stage);
+    DPCErrorCode finish(DPCErrorCode code);
+
+private:
+    QVector<Disk> disks;
+    MemoryBudget budget;
+    bool passwordChecked { false };
+};
+
+DAEMONPAC_END_NAMESPACE
+
+#endif   // DISKPASSWORDROTATOR_H
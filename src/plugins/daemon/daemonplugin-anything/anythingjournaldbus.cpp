@@ -0,0 +1,187 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "anythingjournaldbus.h"
+#include "fanotifymonitor.h"
+#include "dbusadaptor/anythingjournal_adaptor.h"
+
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QHash>
+
+#include <grp.h>
+#include <pwd.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/fsuid.h>
+#include <sys/syscall.h>
+#include <cerrno>
+
+static constexpr char kAnythingJournalObjPath[] { "/com/deepin/filemanager/daemon/AnythingJournal" };
+static constexpr int kMaxGroups { 256 };
+static constexpr int kMaxSearchResults { 10000 };
+
+// the same number on all the architectures, the headers of older systems miss it
+#ifndef SYS_faccessat2
+#    define SYS_faccessat2 439
+#endif
+
+DAEMONPANYTHING_USE_NAMESPACE
+
+namespace {
+
+/*!
+ * \brief The CallerCredentials class switches the file system credentials of the current thread
+ * to the ones of a user while it lives, the journal itself is built as root.
+ * The raw setgroups syscall is used, the glibc wrapper changes the groups of all the threads.
+ */
+class CallerCredentials
+{
+public:
+    explicit CallerCredentials(uid_t uid)
+    {
+        struct passwd *pw = ::getpwuid(uid);
+        if (!pw)
+            return;
+
+        int count = kMaxGroups;
+        gid_t list[kMaxGroups];
+        if (::getgrouplist(pw->pw_name, pw->pw_gid, list, &count) < 0)
+            count = 0;
+
+        const int savedCount = ::getgroups(kMaxGroups, savedGroups);
+        if (savedCount < 0)
+            return;
+        savedGroupCount = savedCount;
+
+        if (::syscall(SYS_setgroups, static_cast<size_t>(count), list) != 0)
+            return;
+        groupsChanged = true;
+
+        ::setfsgid(pw->pw_gid);
+        ::setfsuid(uid);
+        // setfsuid returns the current id without telling the failure
+        switched = static_cast<uid_t>(::setfsuid(static_cast<uid_t>(-1))) == uid
+                && static_cast<gid_t>(::setfsgid(static_cast<gid_t>(-1))) == pw->pw_gid;
+    }
+
+    ~CallerCredentials()
+    {
+        ::setfsuid(::geteuid());
+        ::setfsgid(::getegid());
+        if (groupsChanged)
+            ::syscall(SYS_setgroups, static_cast<size_t>(savedGroupCount), savedGroups);
+    }
+
+    bool isSwitched() const
+    {
+        return switched;
+    }
+
+private:
+    gid_t savedGroups[kMaxGroups];
+    int savedGroupCount { 0 };
+    bool groupsChanged { false };
+    bool switched { false };
+};
+
+// the files a user may find, checked with the credentials of the user
+class AccessChecker
+{
+public:
+    // the directories to the file may be entered, and its own directory may be listed
+    bool canReach(const QByteArray &path)
+    {
+        for (int pos = path.indexOf('/', 1); pos > 0; pos = path.indexOf('/', pos + 1)) {
+            if (!canAccess(path.left(pos), X_OK))
+                return false;
+        }
+
+        const int parentEnd = path.lastIndexOf('/');
+        return canAccess(parentEnd > 0 ? path.left(parentEnd) : QByteArrayLiteral("/"), R_OK | X_OK);
+    }
+
+private:
+    bool canAccess(const QByteArray &dir, int mode)
+    {
+        if (unsupported)
+            return false;
+
+        const QByteArray &key = QByteArray::number(mode) + dir;
+        auto it = checked.constFind(key);
+        if (it != checked.constEnd())
+            return it.value();
+
+        // with AT_EACCESS the kernel checks the file system ids of the thread, not the real ones,
+        // which are root. The glibc before 2.33 emulates the flag by the real ids, and faccessat
+        // of the kernel ignores it, so faccessat2 is called directly and nothing is allowed without it
+        bool ok = ::syscall(SYS_faccessat2, AT_FDCWD, dir.constData(), mode, AT_EACCESS) == 0;
+        if (!ok && errno == ENOSYS) {
+            fmWarning() << "faccessat2 is not supported, the journal is not searched for the users";
+            unsupported = true;
+            return false;
+        }
+
+        checked.insert(key, ok);
+        return ok;
+    }
+
+    QHash<QByteArray, bool> checked;
+    bool unsupported { false };
+};
+
+}   // namespace
+
+AnythingJournalDBus::AnythingJournalDBus(FanotifyMonitor *monitor, QObject *parent)
+    : QObject(parent), QDBusContext(), monitor(monitor)
+{
+    Q_UNUSED(new AnythingJournalAdaptor(this));
+}
+
+AnythingJournalDBus::~AnythingJournalDBus()
+{
+    QDBusConnection::systemBus().unregisterObject(kAnythingJournalObjPath);
+}
+
+bool AnythingJournalDBus::registerObject()
+{
+    if (!QDBusConnection::systemBus().registerObject(kAnythingJournalObjPath, this)) {
+        fmWarning() << "Cannot register the" << kAnythingJournalObjPath << "object.";
+        return false;
+    }
+    return true;
+}
+
+bool AnythingJournalDBus::IsReady()
+{
+    return monitor && monitor->isReady();
+}
+
+/*!
+ * \brief AnythingJournalDBus::Search the files under path whose names contain the keyword,
+ * only the files the caller may reach are returned, at most kMaxSearchResults of them
+ */
+QStringList AnythingJournalDBus::Search(const QString &path, const QString &keyword, int maxCount)
+{
+    if (!monitor || !calledFromDBus())
+        return {};
+
+    if (maxCount <= 0 || maxCount > kMaxSearchResults)
+        maxCount = kMaxSearchResults;
+
+    const uint uid = connection().interface()->serviceUid(message().service()).value();
+    if (uid == 0)
+        return monitor->search(path, keyword, maxCount);
+
+    CallerCredentials credentials(static_cast<uid_t>(uid));
+    if (!credentials.isSwitched()) {
+        fmWarning() << "cannot search the journal as the user" << uid;
+        return {};
+    }
+
+    AccessChecker checker;
+    return monitor->search(path, keyword, maxCount, [&checker](const QByteArray &file) {
+        return checker.canReach(file);
+    });
+}
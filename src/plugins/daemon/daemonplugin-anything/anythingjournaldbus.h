@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ANYTHINGJOURNALDBUS_H
+#define ANYTHINGJOURNALDBUS_H
+
+#include "daemonplugin_anything_global.h"
+
+#include <QObject>
+#include <QDBusContext>
+#include <QStringList>
+
+DAEMONPANYTHING_BEGIN_NAMESPACE
+class FanotifyMonitor;
+DAEMONPANYTHING_END_NAMESPACE
+
+class AnythingJournalDBus : public QObject, public QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.deepin.filemanager.daemon.AnythingJournal")
+
+public:
+    explicit AnythingJournalDBus(DAEMONPANYTHING_NAMESPACE::FanotifyMonitor *monitor, QObject *parent = nullptr);
+    ~AnythingJournalDBus();
+
+    bool registerObject();
+
+public slots:
+    bool IsReady();
+    QStringList Search(const QString &path, const QString &keyword, int maxCount);
+
+private:
+    DAEMONPANYTHING_NAMESPACE::FanotifyMonitor *monitor { nullptr };
+};
+
+#endif   // ANYTHINGJOURNALDBUS_H
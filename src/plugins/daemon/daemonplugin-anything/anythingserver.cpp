@@ -3,11 +3,14 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "anythingserver.h"
+
 #include <QStandardPaths>
 
 namespace daemonplugin_anything {
 DFM_LOG_REISGER_CATEGORY(DAEMONPANYTHING_NAMESPACE)
 
+static constexpr char kJournalSnapshotFile[] { "/var/cache/dde-file-manager/anything.journal" };
+
 static bool loadKernelModule()
 {
     QProcess process;
@@ -118,6 +121,9 @@ bool AnythingPlugin::start()
     connect(thread, &QThread::finished, thread, &QThread::deleteLater);
     if (!thread->waitStartResult())
         ret = startAnythingByLib();
+    // the kernel module cannot be loaded on some kernels
+    if (!ret)
+        ret = startAnythingByFanotify();
 
     stopped = !ret;
     return ret;
@@ -129,6 +135,10 @@ void AnythingPlugin::stop()
         return;
 
     stopped = true;
+    if (fanotifyMonitor) {
+        stopAnythingByFanotify();
+        return;
+    }
     unloadKernelModule();
     stopAnythingByLib();
 }
@@ -192,4 +202,33 @@ void AnythingPlugin::stopAnythingByLib()
     backendLib = nullptr;
 }
 
+bool AnythingPlugin::startAnythingByFanotify()
+{
+    if (!FanotifyMonitor::isSupported()) {
+        fmWarning() << "fanotify with directory and name reports is not supported by the kernel.";
+        return false;
+    }
+
+    fanotifyMonitor.reset(new FanotifyMonitor(kJournalSnapshotFile));
+    if (!fanotifyMonitor->startMonitor()) {
+        fanotifyMonitor.reset();
+        return false;
+    }
+
+    journalDBus.reset(new AnythingJournalDBus(fanotifyMonitor.data()));
+    if (!journalDBus->registerObject())
+        journalDBus.reset();
+
+    fmInfo() << "started the fanotify journal of file names.";
+    return true;
+}
+
+void AnythingPlugin::stopAnythingByFanotify()
+{
+    journalDBus.reset();
+    if (fanotifyMonitor)
+        fanotifyMonitor->stopMonitor();
+    fanotifyMonitor.reset();
+}
+
 }   // namespace daemonplugin_anythin
@@ -6,9 +6,12 @@
 #define ANYTHING_H
 
 #include "daemonplugin_anything_global.h"
+#include "anythingjournaldbus.h"
+#include "fanotifymonitor.h"
 
 #include <dfm-framework/dpf.h>
 #include <QProcess>
+#include <QScopedPointer>
 #include <QSemaphore>
 
 DAEMONPANYTHING_BEGIN_NAMESPACE
@@ -26,10 +29,14 @@ public:
 private:
     bool startAnythingByLib();
     void stopAnythingByLib();
+    bool startAnythingByFanotify();
+    void stopAnythingByFanotify();
 
 private:
     QLibrary *backendLib;
     bool stopped;
+    QScopedPointer<FanotifyMonitor> fanotifyMonitor;
+    QScopedPointer<AnythingJournalDBus> journalDBus;
 };
 
 class AnythingMonitorThread : public QThread
@@ -0,0 +1,46 @@
+/*
+ * This file was generated by qdbusxml2cpp version 0.8
+ * Command line was: qdbusxml2cpp -i ./anythingjournaldbus.h -c AnythingJournalAdaptor -l AnythingJournalDBus -a dbusadaptor/anythingjournal_adaptor anythingjournaldbus.xml
+ *
+ * qdbusxml2cpp is Copyright (C) 2020 The Qt Company Ltd.
+ *
+ * This is an auto-generated file.
+ * Do not edit! All changes made to it will be lost.
+ */
+
+#include "dbusadaptor/anythingjournal_adaptor.h"
+#include <QtCore/QMetaObject>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+
+/*
+ * Implementation of adaptor class AnythingJournalAdaptor
+ */
+
+AnythingJournalAdaptor::AnythingJournalAdaptor(AnythingJournalDBus *parent)
+    : QDBusAbstractAdaptor(parent)
+{
+    // constructor
+    setAutoRelaySignals(true);
+}
+
+AnythingJournalAdaptor::~AnythingJournalAdaptor()
+{
+    // destructor
+}
+
+bool AnythingJournalAdaptor::IsReady()
+{
+    // handle method call com.deepin.filemanager.daemon.AnythingJournal.IsReady
+    return parent()->IsReady();
+}
+
+QStringList AnythingJournalAdaptor::Search(const QString &path, const QString &keyword, int maxCount)
+{
+    // handle method call com.deepin.filemanager.daemon.AnythingJournal.Search
+    return parent()->Search(path, keyword, maxCount);
+}
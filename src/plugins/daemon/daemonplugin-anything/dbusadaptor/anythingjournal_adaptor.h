@@ -0,0 +1,61 @@
+/*
+ * This file was generated by qdbusxml2cpp version 0.8
+ * Command line was: qdbusxml2cpp -i ./anythingjournaldbus.h -c AnythingJournalAdaptor -l AnythingJournalDBus -a dbusadaptor/anythingjournal_adaptor anythingjournaldbus.xml
+ *
+ * qdbusxml2cpp is Copyright (C) 2020 The Qt Company Ltd.
+ *
+ * This is an auto-generated file.
+ * This file may have been hand-edited. Look for HAND-EDIT comments
+ * before re-generating it.
+ */
+
+#ifndef ANYTHINGJOURNAL_ADAPTOR_H
+#define ANYTHINGJOURNAL_ADAPTOR_H
+
+#include <QtCore/QObject>
+#include <QtDBus/QtDBus>
+#include "./anythingjournaldbus.h"
+QT_BEGIN_NAMESPACE
+class QByteArray;
+template<class T> class QList;
+template<class Key, class Value> class QMap;
+class QString;
+class QStringList;
+class QVariant;
+QT_END_NAMESPACE
+
+/*
+ * Adaptor class for interface com.deepin.filemanager.daemon.AnythingJournal
+ */
+class AnythingJournalAdaptor: public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.deepin.filemanager.daemon.AnythingJournal")
+    Q_CLASSINFO("D-Bus Introspection", ""
+"  <interface name=\"com.deepin.filemanager.daemon.AnythingJournal\">\n"
+"    <method name=\"IsReady\">\n"
+"      <arg direction=\"out\" type=\"b\"/>\n"
+"    </method>\n"
+"    <method name=\"Search\">\n"
+"      <arg direction=\"out\" type=\"as\"/>\n"
+"      <arg direction=\"in\" type=\"s\" name=\"path\"/>\n"
+"      <arg direction=\"in\" type=\"s\" name=\"keyword\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"maxCount\"/>\n"
+"    </method>\n"
+"  </interface>\n"
+        "")
+public:
+    AnythingJournalAdaptor(AnythingJournalDBus *parent);
+    virtual ~AnythingJournalAdaptor();
+
+    inline AnythingJournalDBus *parent() const
+    { return static_cast<AnythingJournalDBus *>(QObject::parent()); }
+
+public: // PROPERTIES
+public Q_SLOTS: // METHODS
+    bool IsReady();
+    QStringList Search(const QString &path, const QString &keyword, int maxCount);
+Q_SIGNALS: // SIGNALS
+};
+
+#endif
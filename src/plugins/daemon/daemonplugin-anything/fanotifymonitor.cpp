@@ -0,0 +1,581 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fanotifymonitor.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QVector>
+
+#include <utility>
+
+#include <libmount.h>
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/fanotify.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+// the flags of newer kernels, missing in older headers
+#ifndef FAN_REPORT_DIR_FID
+#    define FAN_REPORT_DIR_FID 0x00000400
+#endif
+#ifndef FAN_REPORT_NAME
+#    define FAN_REPORT_NAME 0x00000800
+#endif
+#ifndef FAN_MARK_FILESYSTEM
+#    define FAN_MARK_FILESYSTEM 0x00000100
+#endif
+#ifndef FAN_CREATE
+#    define FAN_CREATE 0x00000100
+#endif
+#ifndef FAN_DELETE
+#    define FAN_DELETE 0x00000200
+#endif
+#ifndef FAN_MOVED_FROM
+#    define FAN_MOVED_FROM 0x00000040
+#endif
+#ifndef FAN_MOVED_TO
+#    define FAN_MOVED_TO 0x00000080
+#endif
+#ifndef FAN_RENAME
+#    define FAN_RENAME 0x10000000
+#endif
+#ifndef FAN_ONDIR
+#    define FAN_ONDIR 0x40000000
+#endif
+
+static constexpr unsigned int kReportDirFidName { FAN_REPORT_DIR_FID | FAN_REPORT_NAME };
+static constexpr quint8 kInfoDirFidName { 2 };
+static constexpr quint8 kInfoOldDirFidName { 10 };
+static constexpr quint8 kInfoNewDirFidName { 12 };
+static constexpr int kInfoHeaderSize { 4 };
+static constexpr int kFsidSize { 8 };
+static constexpr int kEventBufferSize { 64 * 1024 };
+static constexpr int kMaxCachedDirectories { 64 * 1024 };
+static constexpr int kPollTimeout { 60 * 1000 };
+static constexpr qint64 kSnapshotInterval { 15 * 60 * 1000 };
+static constexpr int kSearchChunk { 64 * 1024 };   // nodes checked in one read lock
+
+DAEMONPANYTHING_USE_NAMESPACE
+
+namespace {
+
+struct DirFidName
+{
+    const char *fsid { nullptr };
+    const struct file_handle *handle { nullptr };
+    QByteArray name;
+};
+
+// one info record of an event: header, fsid, file handle and the name
+bool parseDirFidName(const char *record, const char *end, DirFidName *out)
+{
+    const char *handle = record + kInfoHeaderSize + kFsidSize;
+    if (handle + static_cast<int>(sizeof(struct file_handle)) > end)
+        return false;
+
+    const auto *fh = reinterpret_cast<const struct file_handle *>(handle);
+    const char *name = handle + sizeof(struct file_handle) + fh->handle_bytes;
+    if (name >= end)
+        return false;
+
+    out->fsid = record + kInfoHeaderSize;
+    out->handle = fh;
+    out->name = QByteArray(name, static_cast<int>(strnlen(name, static_cast<size_t>(end - name))));
+    return true;
+}
+
+QByteArray fsidOf(int fd)
+{
+    struct statfs st;
+    if (::fstatfs(fd, &st) != 0)
+        return QByteArray();
+    return QByteArray(reinterpret_cast<const char *>(&st.f_fsid), kFsidSize);
+}
+
+// "/" is the empty path, the other paths lose their trailing slash
+QByteArray trimmedPath(const QByteArray &path)
+{
+    return path.endsWith('/') ? path.left(path.size() - 1) : path;
+}
+
+// both paths are trimmed
+bool isUnder(const QByteArray &path, const QByteArray &dir)
+{
+    return path.startsWith(dir) && (path.size() == dir.size() || path.at(dir.size()) == '/');
+}
+
+}   // namespace
+
+FanotifyMonitor::FanotifyMonitor(const QString &snapshotFile, QObject *parent)
+    : QThread(parent),
+      snapshotFile(snapshotFile)
+{
+}
+
+FanotifyMonitor::~FanotifyMonitor()
+{
+    stopMonitor();
+}
+
+bool FanotifyMonitor::isSupported()
+{
+    const int fd = ::fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | kReportDirFidName, O_RDONLY);
+    if (fd < 0)
+        return false;
+    ::close(fd);
+    return true;
+}
+
+bool FanotifyMonitor::startMonitor()
+{
+    if (isRunning())
+        return true;
+
+    {
+        QWriteLocker locker(&lock);
+        if (journal.load(snapshotFile)) {
+            fmInfo() << "loaded the journal snapshot of" << journal.fileCount() << "files";
+            ready = true;
+        }
+    }
+
+    // the scan of the disks takes a while, the events of that time are kept
+    fanFd = ::fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_UNLIMITED_QUEUE | kReportDirFidName,
+                            O_RDONLY | O_LARGEFILE | O_CLOEXEC);
+    if (fanFd < 0) {
+        fmWarning() << "fanotify is not available:" << strerror(errno);
+        return false;
+    }
+
+    wakeFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd < 0 || !markFileSystems()) {
+        stopMonitor();
+        return false;
+    }
+
+    stopped = false;
+    needRescan = true;
+    start(QThread::LowPriority);
+    return true;
+}
+
+void FanotifyMonitor::stopMonitor()
+{
+    stopped = true;
+    if (wakeFd >= 0) {
+        const quint64 one = 1;
+        if (::write(wakeFd, &one, sizeof(one)) < 0)
+            fmWarning() << "cannot wake the fanotify monitor:" << strerror(errno);
+    }
+    wait();
+
+    for (const Mount &mount : mounts)
+        ::close(mount.fd);
+    mounts.clear();
+    directories.clear();
+    {
+        QWriteLocker locker(&lock);
+        aliases.clear();
+    }
+    if (fanFd >= 0)
+        ::close(fanFd);
+    if (wakeFd >= 0)
+        ::close(wakeFd);
+    fanFd = wakeFd = -1;
+}
+
+bool FanotifyMonitor::isReady() const
+{
+    return ready;
+}
+
+/*!
+ * \brief FanotifyMonitor::search the files under path whose names contain the keyword.
+ * The journal is read in chunks, the events are applied between them
+ * \param filter the paths, as seen under path, it rejects are skipped
+ */
+QStringList FanotifyMonitor::search(const QString &path, const QString &keyword, int maxCount,
+                                    const PathJournal::PathFilter &filter) const
+{
+    const QByteArray &query = trimmedPath(QFile::encodeName(QDir::cleanPath(path)));
+    MountAlias alias;
+    {
+        QReadLocker locker(&lock);
+        alias = aliasOf(query);
+    }
+
+    auto toQueryPath = [&alias](const QByteArray &journalPath) {
+        return alias.target + journalPath.mid(alias.journalPath.size());
+    };
+    PathJournal::PathFilter journalFilter;
+    if (filter)
+        journalFilter = [&filter, &toQueryPath](const QByteArray &journalPath) { return filter(toQueryPath(journalPath)); };
+
+    QByteArray journalPath = alias.journalPath + query.mid(alias.target.size());
+    if (journalPath.isEmpty())
+        journalPath = QByteArrayLiteral("/");
+
+    QList<QByteArray> found;
+    PathJournal::NodeId next = PathJournal::kFirstNode;
+    while (next != PathJournal::kNoNode && !stopped) {
+        QReadLocker locker(&lock);
+        next = journal.search(journalPath, keyword, maxCount, journalFilter, next, kSearchChunk, &found);
+    }
+
+    QStringList results;
+    results.reserve(found.size());
+    for (const QByteArray &file : found)
+        results.append(QFile::decodeName(toQueryPath(file)));
+    return results;
+}
+
+// called with the lock held, the innermost mount point holding path
+FanotifyMonitor::MountAlias FanotifyMonitor::aliasOf(const QByteArray &path) const
+{
+    MountAlias found;
+    for (const MountAlias &alias : aliases) {
+        if (isUnder(path, alias.target) && alias.target.size() > found.target.size())
+            found = alias;
+    }
+    return found;
+}
+
+void FanotifyMonitor::run()
+{
+    snapshotTimer.start();
+    while (!stopped) {
+        if (needRescan) {
+            needRescan = false;
+            rescan();
+            continue;
+        }
+
+        struct pollfd fds[2] = { { fanFd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+        const int ret = ::poll(fds, 2, kPollTimeout);
+        if (ret < 0 && errno != EINTR) {
+            fmWarning() << "poll fanotify failed:" << strerror(errno);
+            break;
+        }
+
+        if (fds[1].revents & POLLIN)
+            break;
+        if (fds[0].revents & POLLIN)
+            readEvents();
+
+        if (dirty && snapshotTimer.elapsed() > kSnapshotInterval)
+            saveSnapshot();
+    }
+
+    if (dirty)
+        saveSnapshot();
+}
+
+/*!
+ * \brief FanotifyMonitor::markFileSystems mark the local file systems, each file system once
+ * even if it is mounted several times, all its mount points are recorded to translate the paths
+ */
+bool FanotifyMonitor::markFileSystems()
+{
+    libmnt_table *tab { mnt_new_table() };
+    libmnt_iter *iter { mnt_new_iter(MNT_ITER_FORWARD) };
+    QList<QPair<QByteArray, QByteArray>> targets;   // target and root
+    if (tab && iter && mnt_table_parse_mtab(tab, nullptr) == 0) {
+        libmnt_fs *fs = nullptr;
+        while (mnt_table_next_fs(tab, iter, &fs) == 0) {
+            if (fs && !mnt_fs_is_pseudofs(fs) && !mnt_fs_is_netfs(fs) && !mnt_fs_is_swaparea(fs)) {
+                const char *root = mnt_fs_get_root(fs);
+                targets.append({ mnt_fs_get_target(fs), root ? root : "/" });
+            }
+        }
+    }
+    if (tab)
+        mnt_free_table(tab);
+    if (iter)
+        mnt_free_iter(iter);
+
+    // the shortest target mounting the whole file system is scanned
+    std::sort(targets.begin(), targets.end(), [](const QPair<QByteArray, QByteArray> &a, const QPair<QByteArray, QByteArray> &b) {
+        const bool aWhole = a.second == "/";
+        const bool bWhole = b.second == "/";
+        return aWhole != bWhole ? aWhole : a.first.size() < b.first.size();
+    });
+
+    quint64 mask = FAN_CREATE | FAN_DELETE | FAN_ONDIR;
+    renameSupported = true;
+    struct OtherMount
+    {
+        QByteArray fsid;
+        QByteArray target;
+        QByteArray root;
+    };
+    QList<OtherMount> others;
+    for (const auto &target : targets) {
+        const int fd = ::open(target.first.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+        const QByteArray &fsid = fsidOf(fd);
+        if (fsid.isEmpty() || mounts.contains(fsid)) {
+            if (!fsid.isEmpty())
+                others.append({ fsid, trimmedPath(target.first), trimmedPath(target.second) });
+            ::close(fd);
+            continue;
+        }
+
+        int ret = ::fanotify_mark(fanFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask | (renameSupported ? FAN_RENAME : FAN_MOVED_FROM | FAN_MOVED_TO), fd, nullptr);
+        if (ret != 0 && errno == EINVAL && renameSupported) {
+            // FAN_RENAME needs linux 5.17
+            renameSupported = false;
+            ret = ::fanotify_mark(fanFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask | FAN_MOVED_FROM | FAN_MOVED_TO, fd, nullptr);
+        }
+        if (ret != 0) {
+            fmDebug() << "cannot watch" << target.first << strerror(errno);
+            ::close(fd);
+            continue;
+        }
+
+        mounts.insert(fsid, Mount { target.first, target.second, fd });
+    }
+
+    // a file at root + x of the file system is journaled at path + x
+    QVector<MountAlias> all;
+    for (const Mount &mount : mounts)
+        all.append({ trimmedPath(mount.path), trimmedPath(mount.path) });
+    for (const OtherMount &other : others) {
+        auto mount = mounts.constFind(other.fsid);
+        if (mount == mounts.constEnd())
+            continue;
+        const QByteArray &scannedRoot = trimmedPath(mount->root);
+        if (isUnder(other.root, scannedRoot))
+            all.append({ other.target, trimmedPath(mount->path) + other.root.mid(scannedRoot.size()) });
+    }
+    {
+        QWriteLocker locker(&lock);
+        aliases = all;
+    }
+
+    fmInfo() << "fanotify watches" << mounts.size() << "file systems at" << all.size() << "mount points, rename events:" << renameSupported;
+    return !mounts.isEmpty();
+}
+
+void FanotifyMonitor::rescan()
+{
+    PathJournal fresh;
+    for (const Mount &mount : mounts) {
+        struct stat st;
+        if (::fstat(mount.fd, &st) != 0)
+            continue;
+        scanTree(&fresh, fresh.ensurePath(mount.path), mount.fd, st.st_dev, mount.path);
+        if (stopped)
+            return;
+    }
+
+    {
+        QWriteLocker locker(&lock);
+        journal = std::move(fresh);
+        directories.clear();
+        dirty = true;
+    }
+    ready = true;
+    fmInfo() << "the journal is scanned, files:" << journal.fileCount();
+}
+
+// the directories of other file systems are left to their own scan
+void FanotifyMonitor::scanTree(PathJournal *target, PathJournal::NodeId node, int dirFd, dev_t dev, const QByteArray &path)
+{
+    QVector<QPair<PathJournal::NodeId, QByteArray>> pending { { node, path } };
+    bool first = true;
+    while (!pending.isEmpty() && !stopped) {
+        const auto current = pending.takeLast();
+        const int fd = first ? ::dup(dirFd) : ::open(current.second.constData(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        first = false;
+        if (fd < 0)
+            continue;
+
+        struct stat st;
+        DIR *dir = ::fstat(fd, &st) == 0 && st.st_dev == dev ? ::fdopendir(fd) : nullptr;
+        if (!dir) {
+            ::close(fd);
+            continue;
+        }
+
+        const QByteArray &prefix = current.second.endsWith('/') ? current.second : current.second + '/';
+        while (struct dirent *entry = ::readdir(dir)) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+                continue;
+
+            bool isDir = entry->d_type == DT_DIR;
+            if (entry->d_type == DT_UNKNOWN) {
+                struct stat entrySt;
+                isDir = ::fstatat(fd, entry->d_name, &entrySt, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(entrySt.st_mode);
+            }
+
+            const QByteArray name(entry->d_name);
+            const PathJournal::NodeId child = target->addChild(current.first, name, isDir);
+            if (isDir && child != PathJournal::kNoNode)
+                pending.append({ child, prefix + name });
+        }
+        ::closedir(dir);
+    }
+}
+
+void FanotifyMonitor::readEvents()
+{
+    alignas(struct fanotify_event_metadata) char buffer[kEventBufferSize];
+    forever {
+        const ssize_t length = ::read(fanFd, buffer, sizeof(buffer));
+        if (length <= 0)
+            return;
+
+        // one lock for a whole buffer of events
+        QWriteLocker locker(&lock);
+        auto *meta = reinterpret_cast<struct fanotify_event_metadata *>(buffer);
+        ssize_t left = length;
+        while (FAN_EVENT_OK(meta, left)) {
+            if (meta->vers != FANOTIFY_METADATA_VERSION)
+                return;
+            if (meta->mask & FAN_Q_OVERFLOW) {
+                fmWarning() << "fanotify queue overflowed, scan the disks again";
+                needRescan = true;
+            } else {
+                const char *records = reinterpret_cast<const char *>(meta) + meta->metadata_len;
+                handleEvent(meta->mask, records, reinterpret_cast<const char *>(meta) + meta->event_len);
+            }
+            if (meta->fd >= 0)
+                ::close(meta->fd);
+            meta = FAN_EVENT_NEXT(meta, left);
+        }
+        dirty = true;
+    }
+}
+
+void FanotifyMonitor::handleEvent(quint64 mask, const char *records, const char *end)
+{
+    DirFidName entry, from, to;
+    bool hasEntry = false, hasFrom = false, hasTo = false;
+    for (const char *record = records; record + kInfoHeaderSize <= end;) {
+        const quint8 type = static_cast<quint8>(record[0]);
+        quint16 length = 0;
+        memcpy(&length, record + 2, sizeof(length));
+        if (length < kInfoHeaderSize || record + length > end)
+            break;
+
+        const char *recordEnd = record + length;
+        if (type == kInfoDirFidName)
+            hasEntry = parseDirFidName(record, recordEnd, &entry);
+        else if (type == kInfoOldDirFidName)
+            hasFrom = parseDirFidName(record, recordEnd, &from);
+        else if (type == kInfoNewDirFidName)
+            hasTo = parseDirFidName(record, recordEnd, &to);
+        record = recordEnd;
+    }
+
+    const bool isDir = mask & FAN_ONDIR;
+    if (hasFrom && hasTo) {
+        const PathJournal::NodeId fromDir = resolveDirectory(from.fsid, from.handle);
+        const PathJournal::NodeId toDir = resolveDirectory(to.fsid, to.handle);
+        if (toDir == PathJournal::kNoNode)
+            return;
+        if (fromDir != PathJournal::kNoNode && journal.findChild(fromDir, from.name) != PathJournal::kNoNode) {
+            journal.moveChild(fromDir, from.name, toDir, to.name);
+            return;
+        }
+        // moved in from an unknown place
+        entry = to;
+        hasEntry = true;
+        mask = FAN_MOVED_TO | (isDir ? FAN_ONDIR : 0);
+    }
+
+    if (!hasEntry || entry.name.isEmpty())
+        return;
+    const PathJournal::NodeId dir = resolveDirectory(entry.fsid, entry.handle);
+    if (dir == PathJournal::kNoNode)
+        return;
+
+    const bool added = mask & (FAN_CREATE | FAN_MOVED_TO);
+    const bool removed = mask & (FAN_DELETE | FAN_MOVED_FROM);
+    bool exists = added;
+    // merged events of the same name, such as a created and deleted temporary file
+    if (added && removed) {
+        struct stat st;
+        exists = ::lstat((journal.pathOf(dir) + '/' + entry.name).constData(), &st) == 0;
+    }
+
+    if (!exists) {
+        journal.removeChild(dir, entry.name);
+        return;
+    }
+
+    const PathJournal::NodeId child = journal.addChild(dir, entry.name, isDir);
+    // the tree of a moved directory comes without events
+    if (isDir && (mask & FAN_MOVED_TO) && child != PathJournal::kNoNode) {
+        const QByteArray &path = journal.pathOf(child);
+        const int fd = ::open(path.constData(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        struct stat st;
+        if (fd >= 0 && ::fstat(fd, &st) == 0)
+            scanTree(&journal, child, fd, st.st_dev, path);
+        if (fd >= 0)
+            ::close(fd);
+    }
+}
+
+/*!
+ * \brief FanotifyMonitor::resolveDirectory the journal node of a directory reported by its handle
+ */
+PathJournal::NodeId FanotifyMonitor::resolveDirectory(const void *fsid, const void *handle)
+{
+    const auto *fh = static_cast<const struct file_handle *>(handle);
+    const QByteArray fsidKey(static_cast<const char *>(fsid), kFsidSize);
+    const QByteArray &key = fsidKey + QByteArray(static_cast<const char *>(handle), static_cast<int>(sizeof(struct file_handle) + fh->handle_bytes));
+
+    auto cached = directories.constFind(key);
+    if (cached != directories.constEnd() && journal.isAlive(cached->first) && journal.generation(cached->first) == cached->second)
+        return cached->first;
+
+    auto mount = mounts.constFind(fsidKey);
+    if (mount == mounts.constEnd())
+        return PathJournal::kNoNode;
+
+    // an aligned copy of the handle for the kernel
+    QByteArray handleCopy(key.constData() + kFsidSize, key.size() - kFsidSize);
+    const int fd = ::open_by_handle_at(mount->fd, reinterpret_cast<struct file_handle *>(handleCopy.data()), O_PATH | O_CLOEXEC);
+    if (fd < 0)
+        return PathJournal::kNoNode;
+
+    char path[PATH_MAX];
+    const ssize_t length = ::readlink(QByteArray("/proc/self/fd/" + QByteArray::number(fd)).constData(), path, sizeof(path) - 1);
+    ::close(fd);
+    if (length <= 0)
+        return PathJournal::kNoNode;
+
+    const QByteArray resolved(path, static_cast<int>(length));
+    if (!resolved.startsWith('/') || resolved.endsWith(" (deleted)"))
+        return PathJournal::kNoNode;
+
+    const PathJournal::NodeId node = journal.ensurePath(resolved);
+    if (directories.size() >= kMaxCachedDirectories)
+        directories.clear();
+    directories.insert(key, qMakePair(node, journal.generation(node)));
+    return node;
+}
+
+void FanotifyMonitor::saveSnapshot()
+{
+    QDir().mkpath(QFileInfo(snapshotFile).absolutePath());
+    QWriteLocker locker(&lock);
+    if (journal.save(snapshotFile))
+        dirty = false;
+    else
+        fmWarning() << "cannot save the journal snapshot" << snapshotFile;
+    snapshotTimer.restart();
+}
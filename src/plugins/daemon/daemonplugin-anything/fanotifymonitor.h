@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FANOTIFYMONITOR_H
+#define FANOTIFYMONITOR_H
+
+#include "daemonplugin_anything_global.h"
+#include "pathjournal.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QThread>
+#include <QVector>
+
+#include <atomic>
+
+DAEMONPANYTHING_BEGIN_NAMESPACE
+
+/*!
+ * \brief The FanotifyMonitor class keeps a PathJournal of the local file systems up to date
+ * without the vfs_monitor kernel module.
+ * The file systems are marked with fanotify reporting the directory and the name of the
+ * created, deleted and moved files, the journal is built by one scan and then follows the
+ * events. Snapshots of the journal are saved periodically and loaded at start, so searches
+ * are answered before the scan ends.
+ * A file system is journaled under one of its mount points, the paths under its other mount
+ * points, such as bind mounts, are translated when searching.
+ */
+class FanotifyMonitor : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit FanotifyMonitor(const QString &snapshotFile, QObject *parent = nullptr);
+    ~FanotifyMonitor() override;
+
+    static bool isSupported();
+
+    bool startMonitor();
+    void stopMonitor();
+
+    bool isReady() const;
+    QStringList search(const QString &path, const QString &keyword, int maxCount,
+                       const PathJournal::PathFilter &filter = PathJournal::PathFilter()) const;
+
+protected:
+    void run() override;
+
+private:
+    struct Mount
+    {
+        QByteArray path;
+        QByteArray root;   // the directory of the file system mounted at path
+        int fd { -1 };
+    };
+
+    // a mount point and the journal path of its root
+    struct MountAlias
+    {
+        QByteArray target;
+        QByteArray journalPath;
+    };
+
+    bool markFileSystems();
+    void rescan();
+    void scanTree(PathJournal *journal, PathJournal::NodeId node, int dirFd, dev_t dev, const QByteArray &path);
+    void readEvents();
+    void handleEvent(quint64 mask, const char *records, const char *end);
+    PathJournal::NodeId resolveDirectory(const void *fsid, const void *handle);
+    MountAlias aliasOf(const QByteArray &path) const;
+    void saveSnapshot();
+
+private:
+    QString snapshotFile;
+    int fanFd { -1 };
+    int wakeFd { -1 };
+    bool renameSupported { false };
+    QHash<QByteArray, Mount> mounts;   // by fsid
+    QVector<MountAlias> aliases;   // all the mount points of the watched file systems, guarded by the lock
+    QHash<QByteArray, QPair<PathJournal::NodeId, quint32>> directories;   // node and its generation by handle
+
+    mutable QReadWriteLock lock;
+    PathJournal journal;
+    std::atomic_bool ready { false };
+    std::atomic_bool stopped { false };
+    bool needRescan { true };
+    bool dirty { false };
+    QElapsedTimer snapshotTimer;
+};
+
+DAEMONPANYTHING_END_NAMESPACE
+
+#endif   // FANOTIFYMONITOR_H
@@ -0,0 +1,443 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "pathjournal.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr quint32 kSnapshotMagic { 0x44464a4e };   // "DFJN"
+static constexpr quint32 kSnapshotVersion { 1 };
+static constexpr int kCompactThreshold { 1 << 20 };
+
+DAEMONPANYTHING_USE_NAMESPACE
+
+static char asciiLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+static bool containsAscii(const char *name, int length, const QByteArray &key)
+{
+    const int keyLength = key.size();
+    for (int i = 0; i + keyLength <= length; ++i) {
+        int j = 0;
+        while (j < keyLength && asciiLower(name[i + j]) == key.at(j))
+            ++j;
+        if (j == keyLength)
+            return true;
+    }
+    return false;
+}
+
+PathJournal::PathJournal()
+{
+    Node root;
+    root.flags = kAlive | kDir;
+    nodes.append(root);
+    aliveCount = 1;
+}
+
+/*!
+ * \brief PathJournal::ensurePath the node of an absolute path, the missing directories are added
+ */
+PathJournal::NodeId PathJournal::ensurePath(const QByteArray &path)
+{
+    NodeId node = kRootNode;
+    for (const QByteArray &name : path.split('/')) {
+        if (name.isEmpty())
+            continue;
+        node = addChild(node, name, true);
+    }
+    return node;
+}
+
+PathJournal::NodeId PathJournal::findPath(const QByteArray &path) const
+{
+    NodeId node = kRootNode;
+    for (const QByteArray &name : path.split('/')) {
+        if (name.isEmpty())
+            continue;
+        node = findChild(node, name);
+        if (node == kNoNode)
+            break;
+    }
+    return node;
+}
+
+PathJournal::NodeId PathJournal::addChild(NodeId parent, const QByteArray &name, bool isDir)
+{
+    if (!isAlive(parent) || name.isEmpty())
+        return kNoNode;
+
+    NodeId node = findChild(parent, name);
+    // a directory replaced by a file loses its tree
+    if (node != kNoNode && !isDir && (nodes.at(static_cast<int>(node)).flags & kDir)) {
+        removeChild(parent, name);
+        node = kNoNode;
+    }
+    if (node == kNoNode) {
+        node = allocNode();
+        linkNode(node, parent, name);
+    }
+
+    Node &n = nodes[static_cast<int>(node)];
+    n.flags = isDir ? (kAlive | kDir) : kAlive;
+    return node;
+}
+
+PathJournal::NodeId PathJournal::findChild(NodeId parent, const QByteArray &name) const
+{
+    const quint64 key = childKey(parent, name.constData(), name.size());
+    for (auto it = children.constFind(key); it != children.constEnd() && it.key() == key; ++it) {
+        const Node &n = nodes.at(static_cast<int>(it.value()));
+        if (n.parent == parent && n.nameLength == name.size()
+            && memcmp(names.constData() + n.nameOffset, name.constData(), static_cast<size_t>(name.size())) == 0)
+            return it.value();
+    }
+    return kNoNode;
+}
+
+void PathJournal::removeChild(NodeId parent, const QByteArray &name)
+{
+    const NodeId node = findChild(parent, name);
+    if (node == kNoNode)
+        return;
+
+    unlinkNode(node);
+    freeTree(node);
+    if (garbageNameBytes > kCompactThreshold && garbageNameBytes > names.size() / 2)
+        compactNames();
+}
+
+/*!
+ * \brief PathJournal::moveChild move a node with its whole tree, a node at the target is replaced
+ */
+void PathJournal::moveChild(NodeId fromParent, const QByteArray &fromName, NodeId toParent, const QByteArray &toName)
+{
+    const NodeId node = findChild(fromParent, fromName);
+    if (node == kNoNode || !isAlive(toParent) || toName.isEmpty())
+        return;
+    if (fromParent == toParent && fromName == toName)
+        return;
+
+    removeChild(toParent, toName);
+    unlinkNode(node);
+    garbageNameBytes += nodes.at(static_cast<int>(node)).nameLength;
+    linkNode(node, toParent, toName);
+}
+
+bool PathJournal::isAlive(NodeId node) const
+{
+    return node < static_cast<NodeId>(nodes.size()) && (nodes.at(static_cast<int>(node)).flags & kAlive);
+}
+
+quint32 PathJournal::generation(NodeId node) const
+{
+    return node < static_cast<NodeId>(nodes.size()) ? nodes.at(static_cast<int>(node)).generation : 0;
+}
+
+QByteArray PathJournal::pathOf(NodeId node) const
+{
+    if (!isAlive(node))
+        return QByteArray();
+    if (node == kRootNode)
+        return QByteArrayLiteral("/");
+
+    QVector<NodeId> chain;
+    for (NodeId n = node; n != kRootNode && n != kNoNode; n = nodes.at(static_cast<int>(n)).parent)
+        chain.append(n);
+
+    QByteArray path;
+    for (auto it = chain.crbegin(); it != chain.crend(); ++it)
+        path += '/' + nameOf(nodes.at(static_cast<int>(*it)));
+    return path;
+}
+
+int PathJournal::fileCount() const
+{
+    return aliveCount - 1;
+}
+
+/*!
+ * \brief PathJournal::search the paths under a directory whose names contain the keyword, case insensitive.
+ * The nodes are checked in chunks so the caller may release its lock between them, the results
+ * are appended to result
+ * \param maxCount no limit if it is not positive
+ * \param filter the paths it rejects are skipped, nothing is skipped if it is empty
+ * \param from the node to start from, kFirstNode or the node returned by the last chunk
+ * \param scanCount the number of nodes checked in this chunk
+ * \return the node the next chunk starts from, kNoNode if all the nodes are checked or maxCount is reached
+ */
+PathJournal::NodeId PathJournal::search(const QByteArray &path, const QString &keyword, int maxCount, const PathFilter &filter,
+                                        NodeId from, int scanCount, QList<QByteArray> *result) const
+{
+    const NodeId root = findPath(path);
+    if (root == kNoNode || (maxCount > 0 && result->size() >= maxCount))
+        return kNoNode;
+
+    const QString &foldedKey = keyword.toCaseFolded();
+    const bool asciiKey = std::all_of(foldedKey.cbegin(), foldedKey.cend(), [](const QChar &c) { return c.unicode() < 0x80; });
+    const QByteArray &asciiFoldedKey = asciiKey ? foldedKey.toLatin1() : QByteArray();
+
+    const int end = static_cast<int>(qMin<qint64>(nodes.size(), static_cast<qint64>(from) + scanCount));
+    for (int i = from == kRootNode ? 1 : static_cast<int>(from); i < end; ++i) {
+        const Node &n = nodes.at(i);
+        if (!(n.flags & kAlive))
+            continue;
+
+        const char *name = names.constData() + n.nameOffset;
+        bool matched = false;
+        if (asciiKey && std::all_of(name, name + n.nameLength, [](char c) { return static_cast<unsigned char>(c) < 0x80; }))
+            matched = containsAscii(name, n.nameLength, asciiFoldedKey);
+        else
+            matched = QFile::decodeName(nameOf(n)).toCaseFolded().contains(foldedKey);
+        if (!matched)
+            continue;
+
+        bool under = root == kRootNode;
+        for (NodeId p = n.parent; !under && p != kNoNode; p = nodes.at(static_cast<int>(p)).parent)
+            under = p == root;
+        if (!under)
+            continue;
+
+        const QByteArray &filePath = pathOf(static_cast<NodeId>(i));
+        if (filter && !filter(filePath))
+            continue;
+
+        result->append(filePath);
+        if (maxCount > 0 && result->size() >= maxCount)
+            return kNoNode;
+    }
+    return end < nodes.size() ? static_cast<NodeId>(end) : kNoNode;
+}
+
+bool PathJournal::save(const QString &fileName)
+{
+    if (garbageNameBytes > 0)
+        compactNames();
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_11);
+    out << kSnapshotMagic << kSnapshotVersion << static_cast<quint32>(sizeof(Node))
+        << static_cast<quint32>(nodes.size()) << names << freeNodes;
+    out.writeRawData(reinterpret_cast<const char *>(nodes.constData()), static_cast<int>(nodes.size() * sizeof(Node)));
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool PathJournal::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_11);
+    quint32 magic = 0, version = 0, nodeSize = 0, nodeCount = 0;
+    in >> magic >> version >> nodeSize;
+    if (magic != kSnapshotMagic || version != kSnapshotVersion || nodeSize != sizeof(Node))
+        return false;
+
+    QByteArray loadedNames;
+    QVector<NodeId> loadedFree;
+    in >> nodeCount >> loadedNames >> loadedFree;
+    if (in.status() != QDataStream::Ok || nodeCount == 0
+        || static_cast<qint64>(nodeCount) * static_cast<qint64>(sizeof(Node)) != file.size() - file.pos())
+        return false;
+
+    QVector<Node> loadedNodes(static_cast<int>(nodeCount));
+    const int bytes = static_cast<int>(nodeCount * sizeof(Node));
+    if (in.readRawData(reinterpret_cast<char *>(loadedNodes.data()), bytes) != bytes)
+        return false;
+
+    if (!isValid(&loadedNodes, loadedNames, loadedFree))
+        return false;
+
+    QMultiHash<quint64, NodeId> loadedChildren;
+    loadedChildren.reserve(static_cast<int>(nodeCount));
+    int alive = 0;
+    for (int i = 0; i < loadedNodes.size(); ++i) {
+        const Node &n = loadedNodes.at(i);
+        if (!(n.flags & kAlive))
+            continue;
+        ++alive;
+        if (static_cast<NodeId>(i) != kRootNode)
+            loadedChildren.insert(childKey(n.parent, loadedNames.constData() + n.nameOffset, n.nameLength), static_cast<NodeId>(i));
+    }
+
+    nodes.swap(loadedNodes);
+    names.swap(loadedNames);
+    freeNodes.swap(loadedFree);
+    children.swap(loadedChildren);
+    aliveCount = alive;
+    garbageNameBytes = 0;
+    return true;
+}
+
+/*!
+ * \brief PathJournal::isValid check a loaded snapshot, a broken one would corrupt the journal or hang it:
+ * the names are in the pool, every dead node is free once, the alive nodes hang under alive directories
+ * without cycles. The sibling links are not trusted, they are rebuilt from the parents.
+ */
+bool PathJournal::isValid(QVector<Node> *loadedNodes, const QByteArray &loadedNames, const QVector<NodeId> &loadedFree)
+{
+    QVector<Node> &all = *loadedNodes;
+    const NodeId count = static_cast<NodeId>(all.size());
+    if ((all.at(static_cast<int>(kRootNode)).flags & (kAlive | kDir)) != (kAlive | kDir))
+        return false;
+
+    QVector<bool> freed(all.size(), false);
+    for (NodeId node : loadedFree) {
+        if (node == kRootNode || node >= count || freed.at(static_cast<int>(node))
+            || (all.at(static_cast<int>(node)).flags & kAlive))
+            return false;
+        freed[static_cast<int>(node)] = true;
+    }
+
+    int dead = 0;
+    for (int i = 1; i < all.size(); ++i) {
+        const Node &n = all.at(i);
+        if (!(n.flags & kAlive)) {
+            ++dead;
+            continue;
+        }
+        if (n.nameLength == 0 || static_cast<qint64>(n.nameOffset) + n.nameLength > loadedNames.size()
+            || n.parent >= count || (all.at(static_cast<int>(n.parent)).flags & (kAlive | kDir)) != (kAlive | kDir))
+            return false;
+    }
+    if (dead != loadedFree.size())
+        return false;
+
+    // 0: not checked, 1: on the current chain, 2: reaches the root
+    QVector<quint8> state(all.size(), 0);
+    state[static_cast<int>(kRootNode)] = 2;
+    QVector<NodeId> chain;
+    for (int i = 1; i < all.size(); ++i) {
+        if (!(all.at(i).flags & kAlive))
+            continue;
+        chain.clear();
+        NodeId node = static_cast<NodeId>(i);
+        while (state.at(static_cast<int>(node)) == 0) {
+            state[static_cast<int>(node)] = 1;
+            chain.append(node);
+            node = all.at(static_cast<int>(node)).parent;
+        }
+        if (state.at(static_cast<int>(node)) == 1)
+            return false;
+        for (NodeId n : chain)
+            state[static_cast<int>(n)] = 2;
+    }
+
+    for (Node &n : all)
+        n.firstChild = n.prevSibling = n.nextSibling = kNoNode;
+    for (int i = all.size() - 1; i > 0; --i) {
+        Node &n = all[i];
+        if (!(n.flags & kAlive))
+            continue;
+        Node &p = all[static_cast<int>(n.parent)];
+        n.nextSibling = p.firstChild;
+        if (p.firstChild != kNoNode)
+            all[static_cast<int>(p.firstChild)].prevSibling = static_cast<NodeId>(i);
+        p.firstChild = static_cast<NodeId>(i);
+    }
+    return true;
+}
+
+quint64 PathJournal::childKey(NodeId parent, const char *name, int length)
+{
+    return (static_cast<quint64>(parent) << 32) | qHashBits(name, static_cast<size_t>(length));
+}
+
+QByteArray PathJournal::nameOf(const Node &node) const
+{
+    return names.mid(static_cast<int>(node.nameOffset), node.nameLength);
+}
+
+PathJournal::NodeId PathJournal::allocNode()
+{
+    ++aliveCount;
+    if (!freeNodes.isEmpty())
+        return freeNodes.takeLast();
+
+    nodes.append(Node());
+    return static_cast<NodeId>(nodes.size() - 1);
+}
+
+void PathJournal::linkNode(NodeId node, NodeId parent, const QByteArray &name)
+{
+    Node &n = nodes[static_cast<int>(node)];
+    n.parent = parent;
+    n.nameOffset = static_cast<quint32>(names.size());
+    n.nameLength = static_cast<quint16>(name.size());
+    n.prevSibling = kNoNode;
+    names.append(name);
+
+    Node &p = nodes[static_cast<int>(parent)];
+    n.nextSibling = p.firstChild;
+    if (p.firstChild != kNoNode)
+        nodes[static_cast<int>(p.firstChild)].prevSibling = node;
+    p.firstChild = node;
+
+    children.insert(childKey(parent, name.constData(), name.size()), node);
+}
+
+void PathJournal::unlinkNode(NodeId node)
+{
+    Node &n = nodes[static_cast<int>(node)];
+    children.remove(childKey(n.parent, names.constData() + n.nameOffset, n.nameLength), node);
+
+    if (n.prevSibling != kNoNode)
+        nodes[static_cast<int>(n.prevSibling)].nextSibling = n.nextSibling;
+    else
+        nodes[static_cast<int>(n.parent)].firstChild = n.nextSibling;
+    if (n.nextSibling != kNoNode)
+        nodes[static_cast<int>(n.nextSibling)].prevSibling = n.prevSibling;
+
+    n.prevSibling = n.nextSibling = kNoNode;
+}
+
+// the node is unlinked from its parent already
+void PathJournal::freeTree(NodeId node)
+{
+    QVector<NodeId> stack { node };
+    while (!stack.isEmpty()) {
+        const NodeId current = stack.takeLast();
+        Node &n = nodes[static_cast<int>(current)];
+        for (NodeId child = n.firstChild; child != kNoNode; child = nodes.at(static_cast<int>(child)).nextSibling) {
+            const Node &c = nodes.at(static_cast<int>(child));
+            children.remove(childKey(current, names.constData() + c.nameOffset, c.nameLength), child);
+            stack.append(child);
+        }
+
+        garbageNameBytes += n.nameLength;
+        const quint32 generation = n.generation + 1;
+        n = Node();
+        n.generation = generation;
+        freeNodes.append(current);
+        --aliveCount;
+    }
+}
+
+void PathJournal::compactNames()
+{
+    QByteArray compacted;
+    compacted.reserve(names.size() - garbageNameBytes);
+    for (Node &n : nodes) {
+        if (!(n.flags & kAlive) || n.nameLength == 0)
+            continue;
+        const quint32 offset = static_cast<quint32>(compacted.size());
+        compacted.append(names.constData() + n.nameOffset, n.nameLength);
+        n.nameOffset = offset;
+    }
+    names.swap(compacted);
+    garbageNameBytes = 0;
+}
@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PATHJOURNAL_H
+#define PATHJOURNAL_H
+
+#include "daemonplugin_anything_global.h"
+
+#include <QByteArray>
+#include <QMultiHash>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+DAEMONPANYTHING_BEGIN_NAMESPACE
+
+/*!
+ * \brief The PathJournal class is a compact in memory tree of the file names of the disks.
+ * Each file is a fixed size node linked to its parent and siblings, the names are stored
+ * in one pool of bytes and the children are found through a hash of the parent and the name.
+ * It is not thread safe, the FanotifyMonitor guards it.
+ */
+class PathJournal
+{
+public:
+    using NodeId = quint32;
+    using PathFilter = std::function<bool(const QByteArray &path)>;
+    static constexpr NodeId kNoNode { 0xffffffff };
+    static constexpr NodeId kRootNode { 0 };
+    static constexpr NodeId kFirstNode { 1 };
+
+    PathJournal();
+
+    NodeId ensurePath(const QByteArray &path);
+    NodeId findPath(const QByteArray &path) const;
+    NodeId addChild(NodeId parent, const QByteArray &name, bool isDir);
+    NodeId findChild(NodeId parent, const QByteArray &name) const;
+    void removeChild(NodeId parent, const QByteArray &name);
+    void moveChild(NodeId fromParent, const QByteArray &fromName, NodeId toParent, const QByteArray &toName);
+
+    bool isAlive(NodeId node) const;
+    quint32 generation(NodeId node) const;
+    QByteArray pathOf(NodeId node) const;
+    int fileCount() const;
+
+    NodeId search(const QByteArray &path, const QString &keyword, int maxCount, const PathFilter &filter,
+                  NodeId from, int scanCount, QList<QByteArray> *result) const;
+
+    bool save(const QString &fileName);
+    bool load(const QString &fileName);
+
+private:
+    enum NodeFlag : quint8 {
+        kAlive = 1,
+        kDir = 1 << 1
+    };
+
+    struct Node
+    {
+        NodeId parent { kNoNode };
+        NodeId firstChild { kNoNode };
+        NodeId prevSibling { kNoNode };
+        NodeId nextSibling { kNoNode };
+        quint32 nameOffset { 0 };
+        quint32 generation { 0 };   // changes when the node is reused
+        quint16 nameLength { 0 };
+        quint8 flags { 0 };
+        quint8 reserved { 0 };
+    };
+
+    static quint64 childKey(NodeId parent, const char *name, int length);
+    QByteArray nameOf(const Node &node) const;
+    NodeId allocNode();
+    void linkNode(NodeId node, NodeId parent, const QByteArray &name);
+    void unlinkNode(NodeId node);
+    void freeTree(NodeId node);
+    void compactNames();
+    static bool isValid(QVector<Node> *loadedNodes, const QByteArray &loadedNames, const QVector<NodeId> &loadedFree);
+
+private:
+    QVector<Node> nodes;
+    QByteArray names;
+    QVector<NodeId> freeNodes;
+    QMultiHash<quint64, NodeId> children;
+    int aliveCount { 0 };
+    int garbageNameBytes { 0 };
+};
+
+DAEMONPANYTHING_END_NAMESPACE
+
+#endif   // PATHJOURNAL_H
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "cifshostcache.h"
+
+#include <QDateTime>
+
+DAEMONPMOUNTCONTROL_USE_NAMESPACE
+
+CifsHostCache *CifsHostCache::instance()
+{
+    static CifsHostCache cache;
+    return &cache;
+}
+
+/*!
+ * \brief CifsHostCache::negotiate the entry of a host, probed only if it is not cached or expired
+ * \param probe resolves and negotiates with the host, it runs without the lock
+ */
+CifsHostEntry CifsHostCache::negotiate(const QString &host, int port, const Prober &probe)
+{
+    const QString &key = keyOf(host, port);
+    QMutexLocker locker(&mutex);
+    auto iter = entries.constFind(key);
+    if (iter != entries.constEnd() && iter->expireAt > QDateTime::currentMSecsSinceEpoch()) {
+        CifsHostEntry entry = iter.value();
+        entry.cached = true;
+        return entry;
+    }
+
+    // the mounts are served one by one, nobody waits for the same host meanwhile
+    locker.unlock();
+    CifsHostEntry entry = probe();
+    locker.relock();
+
+    entry.cached = false;
+    entry.expireAt = QDateTime::currentMSecsSinceEpoch() + timeToLive;
+    entries.insert(key, entry);
+    return entry;
+}
+
+/*!
+ * \brief CifsHostCache::recordSuccess remember the option set a mount succeeded with
+ */
+void CifsHostCache::recordSuccess(const QString &host, int port, int timeoutRung)
+{
+    QMutexLocker locker(&mutex);
+    auto iter = entries.find(keyOf(host, port));
+    if (iter == entries.end())
+        return;
+    iter->timeoutRung = timeoutRung;
+    iter->expireAt = QDateTime::currentMSecsSinceEpoch() + timeToLive;
+}
+
+void CifsHostCache::invalidate(const QString &host, int port)
+{
+    QMutexLocker locker(&mutex);
+    entries.remove(keyOf(host, port));
+}
+
+void CifsHostCache::setTimeToLive(qint64 msecs)
+{
+    QMutexLocker locker(&mutex);
+    timeToLive = msecs;
+}
+
+QString CifsHostCache::keyOf(const QString &host, int port)
+{
+    return host.toLower() + ":" + QString::number(port);
+}
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CIFSHOSTCACHE_H
+#define CIFSHOSTCACHE_H
+
+#include "daemonplugin_mountcontrol_global.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <functional>
+
+DAEMONPMOUNTCONTROL_BEGIN_NAMESPACE
+
+/*!
+ * \brief The CifsHostEntry struct is what a mount to a host has learned about it.
+ */
+struct CifsHostEntry
+{
+    enum TimeoutRung {
+        kWaitReconnect = 0,   // handletimeout and wait_reconnect_timeout
+        kHandleTimeout,   // handletimeout only
+        kNoTimeout,
+    };
+
+    QString ip;   // empty if the host is an address or cannot be resolved
+    QString version { "default" };
+    bool answered { false };   // the host answered the dialect negotiation
+    int timeoutRung { kWaitReconnect };   // the first option set to try with a timeout
+    qint64 expireAt { 0 };
+    bool cached { false };   // returned from the cache, not probed by this call
+};
+
+/*!
+ * \brief The CifsHostCache class keeps the address, dialect and options of the hosts mounted lately.
+ * The shares of a host remounted at login are negotiated once.
+ */
+class CifsHostCache
+{
+public:
+    using Prober = std::function<CifsHostEntry()>;
+
+    static CifsHostCache *instance();
+
+    CifsHostEntry negotiate(const QString &host, int port, const Prober &probe);
+    void recordSuccess(const QString &host, int port, int timeoutRung);
+    void invalidate(const QString &host, int port);
+    void setTimeToLive(qint64 msecs);
+
+private:
+    static QString keyOf(const QString &host, int port);
+
+private:
+    QMutex mutex;
+    QHash<QString, CifsHostEntry> entries;
+    qint64 timeToLive { 10 * 60 * 1000 };   // msecs
+};
+
+DAEMONPMOUNTCONTROL_END_NAMESPACE
+
+#endif   // CIFSHOSTCACHE_H
@@ -14,6 +14,7 @@
 #include <QProcess>
 #include <QRegularExpression>
 #include <QUrl>
+#include <QtConcurrent>
 
 #include <polkit-qt5-1/PolkitQt1/Authority>
 #include <sys/mount.h>
@@ -82,24 +83,80 @@ QVariantMap CifsMountHelper::mount(const QString &path, const QVariantMap &opts)
     if (port != -1)
         params.insert(MountOptionsField::kPort, port);
 
-    if (params.contains(MountOptionsField::kTimeout))
-        params.insert(MountOptionsField::kTryWaitReconn, true);
-
+    // the shares of a host are negotiated once, the cached entry is probed again if it fails
     static const QRegularExpression ipRegx(R"(^((25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\.){3}(25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)$)");
-    auto matchIp = ipRegx.match(host);
-    if (!matchIp.hasMatch()) {
-        const QString &ip = d->parseIP(host, port == -1 ? 0 : port);
-        if (!ip.isEmpty()) {
-            params.insert(MountOptionsField::kIp, ip);
-            fmInfo() << "mount: got ip" << ip << "of host" << host;
+    const bool resolve = !ipRegx.match(host).hasMatch();
+    const ushort hostPort = port == -1 ? 0 : static_cast<ushort>(port);
+    auto probe = [this, &host, hostPort, resolve] { return d->negotiate(host, hostPort, resolve); };
+    CifsHostEntry entry = CifsHostCache::instance()->negotiate(host, hostPort, probe);
+
+    int errNum = 0;
+    bool renegotiated = false;
+    forever {
+        if (!entry.ip.isEmpty()) {
+            params.insert(MountOptionsField::kIp, entry.ip);
+            fmInfo() << "mount: got ip" << entry.ip << "of host" << host;
+        } else {
+            params.remove(MountOptionsField::kIp);
+        }
+        params.insert(MountOptionsField::kVersion, entry.version);
+
+        int timeoutRung = entry.timeoutRung;
+        errNum = tryMount(aPath, mntPath, params, &timeoutRung);
+        if (errNum == 0) {
+            if (params.contains(MountOptionsField::kTimeout))
+                CifsHostCache::instance()->recordSuccess(host, hostPort, timeoutRung);
+            return { { kMountPoint, mntPath }, { kResult, true }, { kErrorCode, 0 } };
+        }
+
+        // a wrong password says nothing about the host
+        if (errNum == EACCES || !entry.cached || renegotiated)
+            break;
+
+        fmInfo() << "mount: negotiate with" << host << "again";
+        CifsHostCache::instance()->invalidate(host, hostPort);
+        const CifsHostEntry &fresh = CifsHostCache::instance()->negotiate(host, hostPort, probe);
+        renegotiated = true;
+
+        // a host which is down fails the ladder the same way, it is walked again only with news of the host
+        const bool ipChanged = !fresh.ip.isEmpty() && fresh.ip != entry.ip;
+        const bool versionChanged = fresh.answered && fresh.version != entry.version;
+        if (!ipChanged && !versionChanged) {
+            fmInfo() << "mount: nothing new about" << host << ", not tried again";
+            break;
         }
+        entry = fresh;
     }
 
-    const QString &version = d->probeVersion(host, port == -1 ? 0 : port);
-    params.insert(MountOptionsField::kVersion, version);
+    if (errNum != EACCES)
+        CifsHostCache::instance()->invalidate(host, hostPort);
+
+    const QString &errMsg = strerror(errNum);
+    fmWarning() << "mount: failed: " << path << errNum << errMsg;
+    fmInfo() << "mount: clean dir" << mntPath;
+    rmdir(mntPath);
+    return { { kMountPoint, "" }, { kResult, false }, { kErrorCode, errNum }, { kErrorMessage, errMsg } };
+}
+
+/*!
+ * \brief CifsMountHelper::tryMount mount with the option sets of the timeout from timeoutRung on
+ * \param timeoutRung the first option set to try, set to the one that succeeded
+ * \return errno of the last attempt, 0 if mounted
+ */
+int CifsMountHelper::tryMount(const QString &aPath, const QString &mntPath, QVariantMap params, int *timeoutRung)
+{
+    Q_ASSERT(timeoutRung);
+
+    // if params contains 'timeout', first try mount with `handletimeout` param,
+    // if failed, try with `wait_reconnect_timeout` again,
+    // if failed, try without any timeout param.
+    if (params.contains(MountOptionsField::kTimeout)) {
+        if (*timeoutRung == CifsHostEntry::kWaitReconnect)
+            params.insert(MountOptionsField::kTryWaitReconn, true);
+        else if (*timeoutRung == CifsHostEntry::kNoTimeout)
+            params.remove(MountOptionsField::kTimeout);
+    }
 
-    int errNum = 0;
-    QString errMsg;
     while (true) {
         auto arg = convertArgs(params);
 
@@ -108,37 +165,27 @@ QVariantMap CifsMountHelper::mount(const QString &path, const QVariantMap &opts)
         args.replace(regxCheckPasswd, ",pass=******,dom");
         fmInfo() << "mount: trying mount" << aPath << "on" << mntPath << "with opts:" << args;
 
-        ret = ::mount(aPath.toStdString().c_str(), mntPath.toStdString().c_str(), "cifs", 0,
-                      arg.c_str());
-
+        int ret = ::mount(aPath.toStdString().c_str(), mntPath.toStdString().c_str(), "cifs", 0,
+                          arg.c_str());
+        const int errNum = errno;
         if (ret == 0) {
             fmInfo() << "mount: mount cifs success, params are: " << args;
-            return { { kMountPoint, mntPath }, { kResult, true }, { kErrorCode, 0 } };
+            return 0;
+        }
+
+        if (!params.contains(MountOptionsField::kTimeout))
+            return errNum;
+
+        if (params.contains(MountOptionsField::kTryWaitReconn)) {
+            fmInfo() << "mount: try with handletimeout";
+            params.remove(MountOptionsField::kTryWaitReconn);
+            *timeoutRung = CifsHostEntry::kHandleTimeout;
         } else {
-            // if params contains 'timeout', first try mount with `handletimeout` param,
-            // if failed, try with `wait_reconnect_timeout` again,
-            // if failed, try without any timeout param.
-            if (params.contains(MountOptionsField::kTimeout)) {
-                if (params.contains(MountOptionsField::kTryWaitReconn)) {
-                    fmInfo() << "mount: try with handletimeout";
-                    params.remove(MountOptionsField::kTryWaitReconn);
-                } else {
-                    fmInfo() << "mount: try without timeout param";
-                    params.remove(MountOptionsField::kTimeout);
-                }
-                continue;
-            } else {
-                errNum = errno;
-                errMsg = strerror(errNum);
-                fmWarning() << "mount: failed: " << path << errNum << errMsg;
-                fmInfo() << "mount: clean dir" << mntPath;
-                rmdir(mntPath);
-                break;
-            }
+            fmInfo() << "mount: try without timeout param";
+            params.remove(MountOptionsField::kTimeout);
+            *timeoutRung = CifsHostEntry::kNoTimeout;
         }
     }
-
-    return { { kMountPoint, "" }, { kResult, false }, { kErrorCode, errNum }, { kErrorMessage, errMsg } };
 }
 
 QVariantMap CifsMountHelper::unmount(const QString &path, const QVariantMap &opts)
@@ -486,8 +533,30 @@ QMap<QString, QString> SmbcAPI::versionMapper()
     return mapper;
 }
 
-QString CifsMountHelperPrivate::probeVersion(const QString &host, ushort port)
+/*!
+ * \brief CifsMountHelperPrivate::negotiate resolve the host and negotiate the dialect at the same time.
+ * The libsmbclient context is not thread safe, so the host is resolved by getaddrinfo meanwhile,
+ * the names unknown to getaddrinfo (e.g. NetBIOS names) are resolved by libsmbclient afterwards
+ */
+CifsHostEntry CifsMountHelperPrivate::negotiate(const QString &host, ushort port, bool resolve)
+{
+    CifsHostEntry entry;
+    QFuture<QString> ip;
+    if (resolve)
+        ip = QtConcurrent::run([this, host] { return parseIP_old(host); });
+    entry.version = probeVersion(host, port, &entry.answered);
+    if (resolve) {
+        entry.ip = ip.result();
+        if (entry.ip.isEmpty())
+            entry.ip = parseIP(host, port);
+    }
+    return entry;
+}
+
+QString CifsMountHelperPrivate::probeVersion(const QString &host, ushort port, bool *answered)
 {
+    if (answered)
+        *answered = false;
     if (!smbcAPI.isInitialized() || !smbcAPI.getSmbcNegprot())
         return "default";
 
@@ -496,6 +565,8 @@ QString CifsMountHelperPrivate::probeVersion(const QString &host, ushort port)
                                                3000,
                                                "NT1",
                                                "SMB3_11");
+    if (answered)
+        *answered = !verName.isEmpty();
     return SmbcAPI::versionMapper().value(verName, "default");
 }
 
@@ -510,8 +581,10 @@ QString CifsMountHelperPrivate::parseIP(const QString &host, uint16_t port)
                                            3000,
                                            ip,
                                            sizeof(ip));
-    if (ret != 0)
+    if (ret != 0) {
         fmWarning() << "cannot resolve ip address for" << host;
+        return "";
+    }
     return QString(ip);
 }
 
@@ -30,6 +30,7 @@ public:
 
 private:
     MountStatus checkMount(const QString &path, QString &mpt);
+    int tryMount(const QString &aPath, const QString &mntPath, QVariantMap params, int *timeoutRung);
     QString generateMountPath(const QString &address);
     QString mountRoot();
     QString decryptPasswd(const QString &passwd);
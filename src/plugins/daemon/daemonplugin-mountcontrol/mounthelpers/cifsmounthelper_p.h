@@ -6,6 +6,7 @@
 #define CIFSMOUNTHELPER_P_H
 
 #include "daemonplugin_mountcontrol_global.h"
+#include "cifshostcache.h"
 
 #include <QLibrary>
 
@@ -57,7 +58,8 @@ class CifsMountHelperPrivate
     SmbcAPI smbcAPI;
 
 public:
-    QString probeVersion(const QString &host, ushort port);
+    CifsHostEntry negotiate(const QString &host, ushort port, bool resolve);
+    QString probeVersion(const QString &host, ushort port, bool *answered = nullptr);
     QString parseIP(const QString &host, uint16_t port);
     QString parseIP_old(const QString &host);
 };
@@ -10,12 +10,12 @@
 #include "backgroundmanager.h"
 #include "backgroundmanager_p.h"
 #include "backgrounddefault.h"
+#include "wallpaperrenderer.h"
 #include "desktoputils/ddpugin_eventinterface_helper.h"
 
 #include <dfm-base/dfm_desktop_defines.h>
 #include <dfm-base/utils/universalutils.h>
 
-#include <QImageReader>
 #include <QtConcurrent>
 
 DFMBASE_USE_NAMESPACE
@@ -378,16 +378,7 @@ QPixmap BackgroundBridge::getPixmap(const QString &path, const QPixmap &defalutP
     if (path.isEmpty())
         return defalutPixmap;
 
-    QString currentWallpaper = path.startsWith("file:") ? QUrl(path).toLocalFile() : path;
-    QPixmap backgroundPixmap(currentWallpaper);
-    // fix whiteboard shows when a jpeg file with filename xxx.png
-    // content formart not epual to extension
-    if (backgroundPixmap.isNull()) {
-        QImageReader reader(currentWallpaper);
-        reader.setDecideFormatFromContent(true);
-        backgroundPixmap = QPixmap::fromImage(reader.read());
-    }
-
+    QPixmap backgroundPixmap = QPixmap::fromImage(WallpaperRenderer::decode(path));
     return backgroundPixmap.isNull() ? defalutPixmap : backgroundPixmap;
 }
 
@@ -404,8 +395,9 @@ void BackgroundBridge::onFinished(void *pData)
         for (auto it = d->backgroundWidgets.begin(); it != d->backgroundWidgets.end(); ++it) {
             if (it.key() == req.screen) {
                 BackgroundWidgetPointer bw = it.value();
-                req.pixmap.setDevicePixelRatio(bw->devicePixelRatioF());
-                bw->setPixmap(req.pixmap);
+                QPixmap pixmap = QPixmap::fromImage(req.image);
+                pixmap.setDevicePixelRatio(bw->devicePixelRatioF());
+                bw->setPixmap(pixmap);
                 d->backgroundPaths.insert(req.screen, req.path);
                 break;
             }
@@ -424,7 +416,7 @@ void BackgroundBridge::onFinished(void *pData)
 void BackgroundBridge::runUpdate(BackgroundBridge *self, QList<Requestion> reqs)
 {
     fmInfo() << "getting background in work thread...." << QThread::currentThreadId();
-    QList<Requestion> recorder;
+    QMap<QString, QList<Requestion *>> pending;
     for (Requestion &req : reqs) {
         // check stop
         if (!self->getting)
@@ -433,35 +425,37 @@ void BackgroundBridge::runUpdate(BackgroundBridge *self, QList<Requestion> reqs)
         if (req.path.isEmpty())
             req.path = self->d->service->background(req.screen);
 
-        QPixmap backgroundPixmap = BackgroundBridge::getPixmap(req.path);
-        if (backgroundPixmap.isNull()) {
-            fmCritical() << "screen " << req.screen << "backfround path" << req.path
-                        << "can not read!";
-            continue;
-        }
+        req.image = WallpaperRenderer::cached(req.path, req.size);
+        if (req.image.isNull())
+            pending[req.path].append(&req);
+    }
 
-        // check stop
-        if (!self->getting)
-            return;
+    // the screens sharing a wallpaper are cropped from a single decoding
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+        QList<QSize> sizes;
+        for (const Requestion *req : it.value())
+            sizes.append(req->size);
 
-        QSize trueSize = req.size;
-        auto pix = backgroundPixmap.scaled(trueSize,
-                                           Qt::KeepAspectRatioByExpanding,
-                                           Qt::SmoothTransformation);
+        const QImage &decoded = WallpaperRenderer::decode(it.key(), sizes);
+        for (Requestion *req : it.value()) {
+            // check stop
+            if (!self->getting)
+                return;
 
-        // check stop
-        if (!self->getting)
-            return;
+            req->image = WallpaperRenderer::crop(decoded, req->size);
+            WallpaperRenderer::cache(req->path, req->size, req->image);
+        }
+    }
 
-        if (pix.width() > trueSize.width() || pix.height() > trueSize.height()) {
-            pix = pix.copy(QRect(static_cast<int>((pix.width() - trueSize.width()) / 2.0),
-                                 static_cast<int>((pix.height() - trueSize.height()) / 2.0),
-                                 trueSize.width(),
-                                 trueSize.height()));
+    QList<Requestion> recorder;
+    for (const Requestion &req : reqs) {
+        if (req.image.isNull()) {
+            fmCritical() << "screen " << req.screen << "backfround path" << req.path
+                        << "can not read!";
+            continue;
         }
 
-        fmDebug() << req.screen << "background path" << req.path << "truesize" << trueSize;
-        req.pixmap = pix;
+        fmDebug() << req.screen << "background path" << req.path << "truesize" << req.size;
         recorder.append(req);
     }
 
@@ -23,7 +23,7 @@ public:
         QString screen;
         QString path;
         QSize size;
-        QPixmap pixmap;
+        QImage image;   // rendered in the worker thread, QPixmap is not used there
     };
 public:
     explicit BackgroundBridge(class BackgroundManagerPrivate *ptr);
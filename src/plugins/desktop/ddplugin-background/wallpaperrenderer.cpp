@@ -0,0 +1,173 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "wallpaperrenderer.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+
+DDP_BACKGROUND_USE_NAMESPACE
+
+static constexpr char kCacheFormat[] { "png" };
+static constexpr int kCacheQuality { 80 };   // the fastest zlib level which still compresses
+static constexpr int kMaxCacheFiles { 8 };
+
+/*!
+ * \brief WallpaperRenderer::decode decode the wallpaper once for all the screens using it
+ * \param screenSizes the sizes of the screens, the image is decoded at the size the largest one
+ * needs, it is decoded at its own size if none is given
+ */
+QImage WallpaperRenderer::decode(const QString &path, const QList<QSize> &screenSizes)
+{
+    const QString &localPath = localPathOf(path);
+    if (localPath.isEmpty())
+        return QImage();
+
+    QImageReader reader(localPath);
+    // fix whiteboard shows when a jpeg file with filename xxx.png
+    // content formart not epual to extension
+    reader.setDecideFormatFromContent(true);
+
+    const QSize &sourceSize = reader.size();
+    QSize target;
+    for (const QSize &size : screenSizes) {
+        const QSize &expanded = sourceSize.scaled(size, Qt::KeepAspectRatioByExpanding);
+        if (expanded.width() > target.width())
+            target = expanded;
+    }
+
+    // the decoder skips the pixels no screen shows, it is never upscaled here
+    if (sourceSize.isValid() && target.isValid() && target.width() < sourceSize.width())
+        reader.setScaledSize(target);
+
+    QImage image = reader.read();
+    if (image.isNull())
+        fmWarning() << "can not read wallpaper" << localPath << reader.errorString();
+    return image;
+}
+
+/*!
+ * \brief WallpaperRenderer::crop the image of a screen, the decoded image is scaled to cover the
+ * screen and its center is kept
+ */
+QImage WallpaperRenderer::crop(const QImage &decoded, const QSize &screenSize)
+{
+    if (decoded.isNull() || screenSize.isEmpty())
+        return QImage();
+
+    QImage image = decoded;
+    if (decoded.size().scaled(screenSize, Qt::KeepAspectRatioByExpanding) != decoded.size())
+        image = decoded.scaled(screenSize, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+
+    if (image.width() > screenSize.width() || image.height() > screenSize.height()) {
+        image = image.copy(QRect(static_cast<int>((image.width() - screenSize.width()) / 2.0),
+                                 static_cast<int>((image.height() - screenSize.height()) / 2.0),
+                                 screenSize.width(),
+                                 screenSize.height()));
+    }
+
+    // the formats QPixmap takes without converting
+    return image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                         : QImage::Format_RGB32);
+}
+
+/*!
+ * \brief WallpaperRenderer::cached the image rendered for a screen of that size,
+ * a null image if the wallpaper is changed or never rendered for it
+ */
+QImage WallpaperRenderer::cached(const QString &path, const QSize &screenSize)
+{
+    const QString &cacheFile = cacheFileOf(path, screenSize);
+    if (cacheFile.isEmpty())
+        return QImage();
+
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return QImage();
+
+    QImageReader reader(&file, kCacheFormat);
+    if (reader.size() != screenSize)
+        return QImage();
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        fmWarning() << "the cached wallpaper is broken" << cacheFile << reader.errorString();
+        return QImage();
+    }
+
+    // the images used lately are kept by pruneCache
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    return image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                         : QImage::Format_RGB32);
+}
+
+/*!
+ * \brief WallpaperRenderer::cache keep the image of a screen as a png compressed for speed,
+ * a screen sized image is decoded much faster than the wallpaper, and is a fraction of the raw pixels
+ */
+void WallpaperRenderer::cache(const QString &path, const QSize &screenSize, const QImage &image)
+{
+    const QString &cacheFile = cacheFileOf(path, screenSize);
+    if (cacheFile.isEmpty() || image.size() != screenSize)
+        return;
+
+    const QString &dir = QFileInfo(cacheFile).absolutePath();
+    if (!QDir().mkpath(dir))
+        return;
+
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QImageWriter writer(&file, kCacheFormat);
+    writer.setQuality(kCacheQuality);
+    if (!writer.write(image) || !file.commit()) {
+        fmWarning() << "can not cache the wallpaper" << cacheFile << writer.errorString();
+        return;
+    }
+
+    pruneCache(dir);
+}
+
+QString WallpaperRenderer::localPathOf(const QString &path)
+{
+    if (path.isEmpty())
+        return QString();
+    return path.startsWith("file:") ? QUrl(path).toLocalFile() : path;
+}
+
+QString WallpaperRenderer::cacheFileOf(const QString &path, const QSize &screenSize)
+{
+    const QString &localPath = localPathOf(path);
+    const QFileInfo info(localPath);
+    if (!info.isFile() || screenSize.isEmpty())
+        return QString();
+
+    const QString &key = QString("%1\n%2\n%3\n%4x%5")
+                                 .arg(info.absoluteFilePath())
+                                 .arg(info.lastModified().toMSecsSinceEpoch())
+                                 .arg(info.size())
+                                 .arg(screenSize.width())
+                                 .arg(screenSize.height());
+    const QByteArray &hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + "/wallpapers/" + QString::fromLatin1(hash) + ".png";
+}
+
+// the screens come and go, only the images used lately are kept
+void WallpaperRenderer::pruneCache(const QString &dir)
+{
+    const QFileInfoList &files = QDir(dir).entryInfoList(QDir::Files, QDir::Time);
+    for (int i = kMaxCacheFiles; i < files.size(); ++i)
+        QFile::remove(files.at(i).absoluteFilePath());
+}
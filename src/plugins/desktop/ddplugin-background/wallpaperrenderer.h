@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef WALLPAPERRENDERER_H
+#define WALLPAPERRENDERER_H
+
+#include "ddplugin_background_global.h"
+
+#include <QImage>
+#include <QList>
+#include <QSize>
+#include <QString>
+
+DDP_BACKGROUND_BEGIN_NAMESPACE
+
+/*!
+ * \brief The WallpaperRenderer class renders the wallpaper of the screens.
+ * A wallpaper shared by several screens is decoded once, at the size of the largest screen,
+ * and every screen is cropped from it. The rendered images are cached as png by the path, modify time
+ * and screen size, so an unchanged setup reads one screen sized image instead of the wallpaper.
+ * It works on QImage and can be used in the worker threads.
+ */
+class WallpaperRenderer
+{
+public:
+    static QImage decode(const QString &path, const QList<QSize> &screenSizes = {});
+    static QImage crop(const QImage &decoded, const QSize &screenSize);
+    static QImage cached(const QString &path, const QSize &screenSize);
+    static void cache(const QString &path, const QSize &screenSize, const QImage &image);
+
+private:
+    static QString localPathOf(const QString &path);
+    static QString cacheFileOf(const QString &path, const QSize &screenSize);
+    static void pruneCache(const QString &dir);
+};
+
+DDP_BACKGROUND_END_NAMESPACE
+
+#endif   // WALLPAPERRENDERER_H
@@ -24,8 +24,7 @@ void CollectionViewBroker::setView(CollectionView *v)
 
 bool CollectionViewBroker::gridPoint(const QUrl &file, QPoint &pos) const
 {
-    auto items = view->d->provider->items(view->d->id);
-    int node = items.indexOf(file);
+    int node = view->d->provider->indexOf(view->d->id, file);
     if (node >= 0) {
         pos = view->d->nodeToPos(node);
         return true;
@@ -37,8 +36,7 @@ bool CollectionViewBroker::gridPoint(const QUrl &file, QPoint &pos) const
 QRect CollectionViewBroker::visualRect(const QUrl &file) const
 {
     QRect rect;
-    auto items = view->d->provider->items(view->d->id);
-    int node = items.indexOf(file);
+    int node = view->d->provider->indexOf(view->d->id, file);
     if (node >= 0) {
         auto pos = view->d->nodeToPos(node);
         rect = view->d->visualRect(pos);
@@ -22,12 +22,12 @@ CollectionDataProvider::~CollectionDataProvider()
 QString CollectionDataProvider::key(const QUrl &url) const
 {
     QString ret;
-    auto it = std::find_if(collections.begin(), collections.end(), [&url](const CollectionBaseDataPtr &ptr) {
-        return ptr->items.contains(url);
-    });
-
-    if (it != collections.end())
-        ret = (*it)->key;
+    for (auto it = collections.cbegin(); it != collections.cend(); ++it) {
+        if (indexOf(it.key(), url) >= 0) {
+            ret = (*it)->key;
+            break;
+        }
+    }
 
     return ret;
 }
@@ -56,12 +56,37 @@ QList<QUrl> CollectionDataProvider::items(const QString &key) const
 }
 
 bool CollectionDataProvider::contains(const QString &key, const QUrl &url) const
+{
+    return indexOf(key, url) >= 0;
+}
+
+/*!
+ * \brief CollectionDataProvider::indexOf the node of \a url in the collection \a key, -1 if not in it.
+ * The nodes are looked up in a hash built from the items, it is rebuilt once the items are changed.
+ * The index keeps a shallow copy of the items, changing them detaches the list so the change is seen
+ * by comparing the data the both lists point to.
+ */
+int CollectionDataProvider::indexOf(const QString &key, const QUrl &url) const
 {
     auto it = collections.find(key);
-    if (it == collections.end())
-        return false;
+    if (it == collections.end() || !(*it)) {
+        itemIndexes.remove(key);
+        return -1;
+    }
+
+    const QList<QUrl> &items = (*it)->items;
+    ItemIndex &index = itemIndexes[key];
+    if (index.items.size() != items.size()
+        || (!items.isEmpty() && index.items.constBegin() != items.constBegin())) {
+        index.items = items;
+        index.nodes.clear();
+        index.nodes.reserve(items.size());
+        // the first one is taken if the url is duplicated, as QList::indexOf does.
+        for (int node = items.size() - 1; node >= 0; --node)
+            index.nodes.insert(items.at(node), node);
+    }
 
-    return (*it)->items.contains(url);
+    return index.nodes.value(url, -1);
 }
 
 bool CollectionDataProvider::sorted(const QString &key, const QList<QUrl> &urls)
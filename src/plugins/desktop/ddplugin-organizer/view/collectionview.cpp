@@ -20,11 +20,13 @@
 #include <dfm-base/utils/sysinfoutils.h>
 #include <dfm-base/base/standardpaths.h>
 #include <dfm-base/utils/clipboard.h>
+#include <dfm-base/mimetype/dmimedatabase.h>
 
 #include <DApplication>
 #include <DFileDragClient>
 
 #include <QScrollBar>
+#include <QSet>
 #include <QUrl>
 #include <QDebug>
 #include <QPainter>
@@ -164,24 +166,36 @@ int CollectionViewPrivate::verticalScrollToValue(const QModelIndex &index, const
 QItemSelection CollectionViewPrivate::selection(const QRect &rect) const
 {
     QItemSelection selection;
+    if (Q_UNLIKELY(columnCount < 1 || cellWidth < 1 || cellHeight < 1))
+        return selection;
+
+    const QList<QUrl> &items = provider->items(id);
+    if (items.isEmpty())
+        return selection;
+
     const QRect actualRect(qMin(rect.left(), rect.right()), qMin(rect.top(), rect.bottom()), abs(rect.width()), abs(rect.height()));
-    const QPoint offset(q->horizontalOffset(), q->verticalOffset());
-    const QPoint iconOffset(kIconOffset, kIconOffset);
-
-    for (auto url : provider->items(id)) {
-        auto index = q->model()->index(url);
-        const QRect &&itRect = q->visualRect(index);
-        QRect realItemRect(itRect.topLeft() + offset + iconOffset, itRect.bottomRight() + offset - iconOffset);
-
-        // least 3 pixels
-        if (actualRect.left() > realItemRect.right() - kIconSelectMargin
-            || actualRect.top() > realItemRect.bottom() - kIconSelectMargin
-            || actualRect.right() < realItemRect.left() + kIconSelectMargin
-            || actualRect.bottom() < realItemRect.top() + kIconSelectMargin)
-            continue;
 
-        if (!selection.contains(index)) {
-            selection.push_back(QItemSelectionRange(index));
+    // the cells covered by the rect, an icon is selected only if the rect covers kIconSelectMargin pixels of it.
+    // the rect of the cell (c, r) is (c * cellWidth + viewMargins.left(), r * cellHeight + viewMargins.top(), cellWidth, cellHeight)
+    // in the content and its icon is the rect shrunk by kIconOffset.
+    auto floorDiv = [](int value, int divisor) {
+        return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+    };
+    const int inset = kIconOffset + kIconSelectMargin;
+    const int minColumn = qMax(0, floorDiv(actualRect.left() - viewMargins.left() + inset, cellWidth));
+    const int maxColumn = qMin(columnCount - 1, floorDiv(actualRect.right() - viewMargins.left() - inset, cellWidth));
+    const int minRow = qMax(0, floorDiv(actualRect.top() - viewMargins.top() + inset, cellHeight));
+    const int maxRow = qMin((items.count() - 1) / columnCount, floorDiv(actualRect.bottom() - viewMargins.top() - inset, cellHeight));
+
+    for (int row = minRow; row <= maxRow; ++row) {
+        for (int column = minColumn; column <= maxColumn; ++column) {
+            const int node = posToNode(QPoint(column, row));
+            if (node >= items.count())
+                break;
+
+            auto index = q->model()->index(items.at(node));
+            if (index.isValid())
+                selection.push_back(QItemSelectionRange(index));
         }
     }
 
@@ -231,12 +245,12 @@ void CollectionViewPrivate::toggleSelect() const
     if (currentSelected.isEmpty())
         return;
 
+    const QSet<QModelIndex> selected(currentSelected.cbegin(), currentSelected.cend());
     QItemSelection selections;
     bool contain = false;
-    for (int node = 0; node < provider->items(id).count(); ++node) {
-        auto &&fileUrl = provider->items(id).at(node);
+    for (const QUrl &fileUrl : provider->items(id)) {
         auto &&index = q->model()->index(fileUrl);
-        if (currentSelected.contains(index)) {
+        if (selected.contains(index)) {
             contain = true;
         } else {
             selections.push_back(QItemSelectionRange(index));
@@ -650,13 +664,9 @@ void CollectionViewPrivate::clearClipBoard()
 void CollectionViewPrivate::selectCollection()
 {
     QItemSelection selections;
-    for (int node = 0; node < provider->items(id).count(); ++node) {
-        auto &&fileUrl = provider->items(id).at(node);
-        auto &&index = q->model()->index(fileUrl);
-        if (!selections.contains(index)) {
-            selections.push_back(QItemSelectionRange(index));
-        }
-    }
+    // the urls in a collection are unique
+    for (const QUrl &fileUrl : provider->items(id))
+        selections.push_back(QItemSelectionRange(q->model()->index(fileUrl)));
     q->selectionModel()->select(selections, QItemSelectionModel::ClearAndSelect);
 }
 
@@ -936,7 +946,7 @@ void CollectionViewPrivate::continuousSelection(const QPersistentModelIndex &new
     q->selectionModel()->setCurrentIndex(newCurrent, QItemSelectionModel::NoUpdate);
 
     auto &&currentSelectionStartFile = q->model()->fileUrl(currentSelectionStartIndex);
-    auto &&currentSelectionStartNode = provider->items(id).indexOf(currentSelectionStartFile);
+    auto &&currentSelectionStartNode = provider->indexOf(id, currentSelectionStartFile);
     if (Q_UNLIKELY(-1 == currentSelectionStartNode)) {
         fmWarning() << "warning:can not find file:" << currentSelectionStartFile << " in collection:" << id
                    << ".Or no file is selected.So fix to 0.";
@@ -944,7 +954,7 @@ void CollectionViewPrivate::continuousSelection(const QPersistentModelIndex &new
     }
 
     auto &&currentSelectionEndFile = q->model()->fileUrl(newCurrent);
-    auto &&currentSelectionEndNode = provider->items(id).indexOf(currentSelectionEndFile);
+    auto &&currentSelectionEndNode = provider->indexOf(id, currentSelectionEndFile);
     if (Q_UNLIKELY(-1 == currentSelectionEndNode)) {
         fmWarning() << "warning:can not find file:" << currentSelectionEndFile << " in collection:" << id
                    << ".Give up switch selection!";
@@ -958,19 +968,15 @@ void CollectionViewPrivate::continuousSelection(const QPersistentModelIndex &new
         fmWarning() << "warning:minNode error:" << minNode << " and fix to 0";
         minNode = 0;
     }
-    if (Q_UNLIKELY(maxNode >= provider->items(id).count())) {
-        fmWarning() << "warning:maxNode error:" << maxNode << "and fix to " << provider->items(id).count() - 1;
-        maxNode = provider->items(id).count() - 1;
+    const QList<QUrl> &items = provider->items(id);
+    if (Q_UNLIKELY(maxNode >= items.count())) {
+        fmWarning() << "warning:maxNode error:" << maxNode << "and fix to " << items.count() - 1;
+        maxNode = items.count() - 1;
     }
 
     QItemSelection selections;
-    for (int node = minNode; node <= maxNode; ++node) {
-        auto &&fileUrl = provider->items(id).at(node);
-        auto &&index = q->model()->index(fileUrl);
-        if (!selections.contains(index)) {
-            selections.push_back(QItemSelectionRange(index));
-        }
-    }
+    for (int node = minNode; node <= maxNode; ++node)
+        selections.push_back(QItemSelectionRange(q->model()->index(items.at(node))));
     q->selectionModel()->select(selections, QItemSelectionModel::ClearAndSelect);
     return;
 }
@@ -981,7 +987,7 @@ QModelIndex CollectionViewPrivate::findIndex(const QString &key, bool matchStart
     auto itemList = provider->items(id);
     if (current.isValid()) {
         auto curUrl = q->model()->fileUrl(current);
-        start = itemList.indexOf(curUrl);
+        start = provider->indexOf(id, curUrl);
     }
 
     // current index is invalid.
@@ -1321,10 +1327,10 @@ QRect CollectionView::visualRect(const QModelIndex &index) const
         return QRect();
 
     QUrl url = model()->fileUrl(index);
-    if (!d->provider->items(d->id).contains(url))
+    int node = d->provider->indexOf(d->id, url);
+    if (node < 0)
         return QRect();
 
-    int node = d->provider->items(d->id).indexOf(url);
     const QPoint &&pos = d->nodeToPos(node);
 
     return d->visualRect(pos);
@@ -1417,7 +1423,7 @@ QModelIndex CollectionView::moveCursor(CursorAction cursorAction, Qt::KeyboardMo
     }
 
     auto currentUrl = model()->fileUrl(current);
-    auto node = d->provider->items(d->id).indexOf(currentUrl);
+    auto node = d->provider->indexOf(d->id, currentUrl);
     if (Q_UNLIKELY(-1 == node)) {
         fmWarning() << "current url not belong to me." << currentUrl << d->provider->items(d->id);
         return QModelIndex();
@@ -2209,6 +2215,10 @@ void CollectionView::sort(int role)
     if (items.isEmpty())
         return;
 
+    // fill the mimetype cache for the collection at once instead of one by one in lessThan
+    if (role == Global::ItemRoles::kItemFileMimeTypeRole)
+        DMimeDatabase().mimeTypesForFiles(items);
+
     std::sort(items.begin(), items.end(), [this](const QUrl &left, const QUrl &right) {
         return lessThan(left, right);
     });
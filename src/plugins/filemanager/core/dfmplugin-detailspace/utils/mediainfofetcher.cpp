@@ -0,0 +1,254 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mediainfofetcher.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+#include <sys/stat.h>
+
+USING_IO_NAMESPACE
+DFMBASE_USE_NAMESPACE
+using namespace dfmplugin_detailspace;
+
+static constexpr quint32 kCacheMagic { 0x444D4946 };   // DMIF
+static constexpr quint32 kCacheVersion { 1 };
+static constexpr int kMaxCacheEntries { 10000 };
+static constexpr int kTrimmedCacheEntries { kMaxCacheEntries * 9 / 10 };
+static constexpr int kSaveDelay { 3000 };   // msecs
+static constexpr int kMaxThreads { 2 };
+
+MediaInfoFetcher *MediaInfoFetcher::instance()
+{
+    static MediaInfoFetcher instance;
+    return &instance;
+}
+
+MediaInfoFetcher::MediaInfoFetcher(QObject *parent)
+    : QObject(parent)
+{
+    // the probes wait on the disk, they do not take the global pool from the views
+    pool.setMaxThreadCount(kMaxThreads);
+
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(kSaveDelay);
+    connect(&saveTimer, &QTimer::timeout, this, [this]() {
+        QtConcurrent::run(&pool, [this]() { saveCache(); });
+    });
+}
+
+MediaInfoFetcher::~MediaInfoFetcher()
+{
+    saveTimer.stop();
+    pool.waitForDone();
+    saveCache();
+}
+
+/*!
+ * \brief MediaInfoFetcher::fetch probe \a localPath in the thread pool, mediaInfoFetched is emitted for \a url
+ * with ok set if the attributes the \a type shows are all found
+ */
+void MediaInfoFetcher::fetch(const QUrl &url, const QString &localPath, FileInfo::FileType type)
+{
+    QtConcurrent::run(&pool, [this, url, localPath, type]() {
+        const MediaMetadata &meta = metadataOf(localPath, type);
+
+        bool ok = false;
+        if (type == FileInfo::FileType::kImages)
+            ok = meta.hasSize();
+        else if (type == FileInfo::FileType::kVideos)
+            ok = meta.hasSize() && meta.hasDuration();
+        else if (type == FileInfo::FileType::kAudios)
+            ok = meta.hasDuration();
+
+        Attributes attributes;
+        if (meta.hasSize()) {
+            attributes.insert(DFileInfo::AttributeExtendID::kExtendMediaWidth, meta.width);
+            attributes.insert(DFileInfo::AttributeExtendID::kExtendMediaHeight, meta.height);
+        }
+        if (meta.hasDuration())
+            attributes.insert(DFileInfo::AttributeExtendID::kExtendMediaDuration, meta.duration);
+
+        QMetaObject::invokeMethod(this, [this, url, ok, attributes]() {
+            emit mediaInfoFetched(url, ok, attributes);
+        }, Qt::QueuedConnection);
+    });
+}
+
+MediaMetadata MediaInfoFetcher::metadataOf(const QString &localPath, FileInfo::FileType type)
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    MediaCacheKey key;
+    const bool hasKey = keyOf(localPath, &key);
+    if (hasKey) {
+        QMutexLocker locker(&mutex);
+        if (!loaded) {
+            loaded = true;
+            loadCache();
+        }
+
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            it->lastUsed = now;
+            return it->meta;
+        }
+    }
+
+    MediaMetadata meta = MediaProbe::probe(localPath);
+    // the image formats the probe does not know are read by their plugins, still without decoding
+    if (type == FileInfo::FileType::kImages && !meta.hasSize()) {
+        QImageReader reader(localPath);
+        const QSize &size = reader.size();
+        if (size.isValid()) {
+            meta.width = size.width();
+            meta.height = size.height();
+        }
+    }
+
+    // the failures are kept as well, they are not probed again until changed
+    if (hasKey) {
+        QMutexLocker locker(&mutex);
+        cache.insert(key, { meta, now });
+        if (cache.size() > kMaxCacheEntries)
+            trimCache();
+        dirty = true;
+        QMetaObject::invokeMethod(&saveTimer, "start", Qt::QueuedConnection);
+    }
+    return meta;
+}
+
+bool MediaInfoFetcher::keyOf(const QString &localPath, MediaCacheKey *key)
+{
+    struct stat st;
+    if (localPath.isEmpty() || ::stat(QFile::encodeName(localPath).constData(), &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+
+    key->device = st.st_dev;
+    key->inode = st.st_ino;
+    key->size = st.st_size;
+    key->mtime = qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+QString MediaInfoFetcher::cacheFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + "/deepin/dde-file-manager/mediainfo.cache";
+}
+
+/*!
+ * \brief MediaInfoFetcher::trimCache drop the entries used least lately, down to kTrimmedCacheEntries,
+ * so the cache is not sorted again at every probe once it is full. Called with the mutex locked.
+ */
+void MediaInfoFetcher::trimCache()
+{
+    QVector<qint64> lastUsed;
+    lastUsed.reserve(cache.size());
+    for (auto it = cache.cbegin(); it != cache.cend(); ++it)
+        lastUsed.append(it->lastUsed);
+
+    // the entries used at the time of the threshold may be dropped or kept
+    const int dropCount = cache.size() - kTrimmedCacheEntries;
+    std::nth_element(lastUsed.begin(), lastUsed.begin() + dropCount, lastUsed.end());
+    const qint64 threshold = lastUsed.at(dropCount);
+    for (auto it = cache.begin(); it != cache.end() && cache.size() > kTrimmedCacheEntries;) {
+        if (it->lastUsed < threshold)
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = cache.begin(); it != cache.end() && cache.size() > kTrimmedCacheEntries;) {
+        if (it->lastUsed == threshold)
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+}
+
+// called with the mutex locked
+void MediaInfoFetcher::loadCache()
+{
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != kCacheMagic || version != kCacheVersion)
+        return;
+
+    for (qint32 i = 0; i < count && i < kMaxCacheEntries; ++i) {
+        MediaCacheKey key;
+        CacheEntry entry;
+        qint32 width = 0;
+        qint32 height = 0;
+        in >> key.device >> key.inode >> key.size >> key.mtime
+           >> width >> height >> entry.meta.duration >> entry.lastUsed;
+        if (in.status() != QDataStream::Ok) {
+            fmWarning() << "the media info cache is broken" << file.fileName();
+            break;
+        }
+        entry.meta.width = width;
+        entry.meta.height = height;
+        cache.insert(key, entry);
+    }
+}
+
+void MediaInfoFetcher::saveCache()
+{
+    QList<QPair<MediaCacheKey, CacheEntry>> entries;
+    {
+        QMutexLocker locker(&mutex);
+        if (!dirty)
+            return;
+        dirty = false;
+
+        entries.reserve(cache.size());
+        for (auto it = cache.cbegin(); it != cache.cend(); ++it)
+            entries.append({ it.key(), it.value() });
+    }
+
+    // the files used lately are kept
+    std::sort(entries.begin(), entries.end(), [](const QPair<MediaCacheKey, CacheEntry> &left, const QPair<MediaCacheKey, CacheEntry> &right) {
+        return left.second.lastUsed > right.second.lastUsed;
+    });
+    if (entries.size() > kMaxCacheEntries)
+        entries.erase(entries.begin() + kMaxCacheEntries, entries.end());
+
+    const QString &path = cacheFilePath();
+    if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+        return;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << kCacheMagic << kCacheVersion << static_cast<qint32>(entries.size());
+    for (const auto &entry : entries) {
+        const MediaCacheKey &key = entry.first;
+        const MediaMetadata &meta = entry.second.meta;
+        out << key.device << key.inode << key.size << key.mtime
+            << static_cast<qint32>(meta.width) << static_cast<qint32>(meta.height) << meta.duration
+            << entry.second.lastUsed;
+    }
+
+    if (out.status() != QDataStream::Ok || !file.commit())
+        fmWarning() << "can not save the media info cache" << path;
+}
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MEDIAINFOFETCHER_H
+#define MEDIAINFOFETCHER_H
+
+#include "dfmplugin_detailspace_global.h"
+#include "mediaprobe.h"
+
+#include <dfm-base/interfaces/fileinfo.h>
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <QTimer>
+
+namespace dfmplugin_detailspace {
+
+struct MediaCacheKey
+{
+    quint64 device { 0 };
+    quint64 inode { 0 };
+    qint64 size { 0 };
+    qint64 mtime { 0 };   // nsecs
+
+    bool operator==(const MediaCacheKey &other) const
+    {
+        return device == other.device && inode == other.inode && size == other.size && mtime == other.mtime;
+    }
+};
+
+inline uint qHash(const MediaCacheKey &key, uint seed = 0)
+{
+    return ::qHash(key.inode, seed) ^ ::qHash(key.mtime, seed) ^ ::qHash(key.size, seed);
+}
+
+/*!
+ * \brief The MediaInfoFetcher class gets the dimension and the duration of the local media files
+ * from their headers, in its own thread pool, and keeps them on the disk by the inode, the size and
+ * the modified time of the files, so a file is probed once until it is changed.
+ * The result is sent to the gui thread by mediaInfoFetched, in the attributes of the dfmio file info.
+ */
+class MediaInfoFetcher : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(MediaInfoFetcher)
+
+public:
+    using Attributes = QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant>;
+
+    static MediaInfoFetcher *instance();
+
+    void fetch(const QUrl &url, const QString &localPath, DFMBASE_NAMESPACE::FileInfo::FileType type);
+
+Q_SIGNALS:
+    void mediaInfoFetched(const QUrl &url, bool ok, const Attributes &attributes);
+
+private:
+    struct CacheEntry
+    {
+        MediaMetadata meta;
+        qint64 lastUsed { 0 };   // secs since epoch
+    };
+
+    explicit MediaInfoFetcher(QObject *parent = nullptr);
+    ~MediaInfoFetcher() override;
+
+    MediaMetadata metadataOf(const QString &localPath, DFMBASE_NAMESPACE::FileInfo::FileType type);
+    static bool keyOf(const QString &localPath, MediaCacheKey *key);
+    static QString cacheFilePath();
+    void trimCache();
+    void loadCache();
+    void saveCache();
+
+private:
+    QThreadPool pool;
+    QMutex mutex;   // guards the cache
+    QHash<MediaCacheKey, CacheEntry> cache;
+    bool loaded { false };
+    bool dirty { false };
+    QTimer saveTimer;
+};
+
+}
+
+#endif   // MEDIAINFOFETCHER_H
@@ -0,0 +1,606 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mediaprobe.h"
+
+#include <QFile>
+#include <QtEndian>
+
+#include <cstring>
+#include <functional>
+
+using namespace dfmplugin_detailspace;
+
+static constexpr int kMaxSegments { 256 };   // the boxes, segments or elements read before giving up
+static constexpr int kExifBytes { 4096 };   // the orientation is in the first IFD
+static constexpr int kMp3SearchBytes { 4096 };
+static constexpr int kOggPageBytes { 27 + 255 + 64 };
+
+static QByteArray readAt(QIODevice *device, qint64 pos, qint64 len)
+{
+    if (pos < 0 || len <= 0 || !device->seek(pos))
+        return QByteArray();
+    return device->read(len);
+}
+
+template<typename T>
+static T bigEndianAt(const QByteArray &data, int offset)
+{
+    return qFromBigEndian<T>(data.constData() + offset);
+}
+
+template<typename T>
+static T littleEndianAt(const QByteArray &data, int offset)
+{
+    return qFromLittleEndian<T>(data.constData() + offset);
+}
+
+static quint32 uint24At(const QByteArray &data, int offset)
+{
+    const uchar *u = reinterpret_cast<const uchar *>(data.constData()) + offset;
+    return quint32(u[0]) | quint32(u[1]) << 8 | quint32(u[2]) << 16;
+}
+
+// the tiff orientation 5 to 8 turns the image by 90 degrees
+static int exifOrientation(const QByteArray &app1)
+{
+    if (app1.size() < 14 || !app1.startsWith(QByteArray("Exif\0\0", 6)))
+        return 1;
+
+    const QByteArray &tiff = app1.mid(6);
+    const bool little = tiff.startsWith("II");
+    if (!little && !tiff.startsWith("MM"))
+        return 1;
+
+    auto u16 = [&](int offset) { return little ? littleEndianAt<quint16>(tiff, offset) : bigEndianAt<quint16>(tiff, offset); };
+    auto u32 = [&](int offset) { return little ? littleEndianAt<quint32>(tiff, offset) : bigEndianAt<quint32>(tiff, offset); };
+
+    // an offset near 4G must not wrap around
+    const quint32 ifd = u32(4);
+    if (qint64(ifd) + 2 > tiff.size())
+        return 1;
+
+    const int count = u16(int(ifd));
+    for (int i = 0; i < count; ++i) {
+        const int entry = int(ifd) + 2 + i * 12;
+        if (entry + 12 > tiff.size())
+            break;
+        if (u16(entry) == 0x0112)
+            return u16(entry + 8);
+    }
+    return 1;
+}
+
+static bool isJpegFrameMarker(uchar marker)
+{
+    // SOF0 - SOF15, but DHT, JPG and DAC
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+struct Mp4Box
+{
+    QByteArray type;
+    qint64 dataStart { 0 };
+    qint64 end { 0 };
+};
+
+static bool readMp4Box(QIODevice *device, qint64 pos, qint64 limit, Mp4Box *box)
+{
+    const QByteArray &head = readAt(device, pos, 16);
+    if (head.size() < 8)
+        return false;
+
+    quint64 size = bigEndianAt<quint32>(head, 0);
+    box->type = head.mid(4, 4);
+    box->dataStart = pos + 8;
+    if (size == 1) {
+        if (head.size() < 16)
+            return false;
+        size = bigEndianAt<quint64>(head, 8);
+        box->dataStart = pos + 16;
+    } else if (size == 0) {
+        // the last box, up to the end
+        size = quint64(limit - pos);
+    }
+
+    if (size < quint64(box->dataStart - pos) || size > quint64(limit - pos))
+        return false;
+    box->end = pos + qint64(size);
+    return true;
+}
+
+static void forEachMp4Box(QIODevice *device, qint64 start, qint64 end, const std::function<bool(const Mp4Box &)> &func)
+{
+    Mp4Box box;
+    qint64 pos = start;
+    for (int i = 0; i < kMaxSegments && pos < end && readMp4Box(device, pos, end, &box); ++i) {
+        if (!func(box))
+            return;
+        pos = box.end;
+    }
+}
+
+struct EbmlElement
+{
+    quint32 id { 0 };
+    qint64 dataStart { 0 };
+    qint64 size { -1 };   // -1 if unknown
+};
+
+static int ebmlVintLength(uchar first)
+{
+    for (int i = 0; i < 8; ++i) {
+        if (first & (0x80 >> i))
+            return i + 1;
+    }
+    return 0;
+}
+
+static bool readEbmlElement(QIODevice *device, qint64 pos, EbmlElement *element)
+{
+    const QByteArray &head = readAt(device, pos, 12);
+    const uchar *u = reinterpret_cast<const uchar *>(head.constData());
+    if (head.isEmpty())
+        return false;
+
+    const int idLength = ebmlVintLength(u[0]);
+    if (idLength == 0 || idLength > 4 || head.size() < idLength + 1)
+        return false;
+
+    const int sizeLength = ebmlVintLength(u[idLength]);
+    if (sizeLength == 0 || head.size() < idLength + sizeLength)
+        return false;
+
+    quint32 id = 0;
+    for (int i = 0; i < idLength; ++i)
+        id = id << 8 | u[i];
+
+    const uchar mask = uchar(0xFF >> sizeLength);
+    quint64 size = u[idLength] & mask;
+    bool unknown = size == mask;
+    for (int i = 1; i < sizeLength; ++i) {
+        size = size << 8 | u[idLength + i];
+        unknown = unknown && u[idLength + i] == 0xFF;
+    }
+
+    element->id = id;
+    element->dataStart = pos + idLength + sizeLength;
+    element->size = unknown ? -1 : qint64(size);
+    return true;
+}
+
+static void forEachEbmlElement(QIODevice *device, qint64 start, qint64 end, const std::function<bool(const EbmlElement &)> &func)
+{
+    EbmlElement element;
+    qint64 pos = start;
+    for (int i = 0; i < kMaxSegments && pos < end && readEbmlElement(device, pos, &element); ++i) {
+        if (element.size < 0 || !func(element))
+            return;
+        pos = element.dataStart + element.size;
+    }
+}
+
+static quint64 ebmlUInt(QIODevice *device, const EbmlElement &element)
+{
+    const QByteArray &data = readAt(device, element.dataStart, qMin<qint64>(element.size, 8));
+    quint64 value = 0;
+    for (char c : data)
+        value = value << 8 | uchar(c);
+    return value;
+}
+
+static double ebmlFloat(QIODevice *device, const EbmlElement &element)
+{
+    if (element.size != 4 && element.size != 8)
+        return -1;
+
+    const QByteArray &data = readAt(device, element.dataStart, element.size);
+    if (element.size == 4 && data.size() == 4) {
+        const quint32 bits = bigEndianAt<quint32>(data, 0);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return double(value);
+    }
+    if (element.size == 8 && data.size() == 8) {
+        const quint64 bits = bigEndianAt<quint64>(data, 0);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    return -1;
+}
+
+MediaMetadata MediaProbe::probe(const QString &filePath)
+{
+    QFile file(filePath);
+    // the reads are small and scattered, a buffer would read more than asked
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+        return MediaMetadata();
+    return probe(&file);
+}
+
+MediaMetadata MediaProbe::probe(QIODevice *device)
+{
+    MediaMetadata meta;
+    if (!device || !device->isReadable() || device->isSequential())
+        return meta;
+
+    const QByteArray &head = readAt(device, 0, 32);
+    if (head.size() < 12)
+        return meta;
+
+    bool ok = false;
+    const QByteArray &boxType = head.mid(4, 4);
+    if (head.startsWith("\xFF\xD8\xFF")) {
+        ok = probeJpeg(device, &meta);
+    } else if (head.startsWith("\x89PNG\r\n\x1A\n")) {
+        ok = probePng(device, &meta);
+    } else if (head.startsWith("GIF87a") || head.startsWith("GIF89a")) {
+        ok = probeGif(device, &meta);
+    } else if (head.startsWith("RIFF") && head.mid(8, 4) == "WEBP") {
+        ok = probeWebp(device, &meta);
+    } else if (head.startsWith("\x1A\x45\xDF\xA3")) {
+        ok = probeMatroska(device, &meta);
+    } else if (head.startsWith("fLaC")) {
+        ok = probeFlac(device, &meta);
+    } else if (head.startsWith("OggS")) {
+        ok = probeOgg(device, &meta);
+    } else if (boxType == "ftyp" || boxType == "moov" || boxType == "mdat" || boxType == "wide" || boxType == "free") {
+        ok = probeMp4(device, &meta);
+    } else if (head.startsWith("ID3") || (uchar(head.at(0)) == 0xFF && (uchar(head.at(1)) & 0xE0) == 0xE0)) {
+        ok = probeMp3(device, &meta);
+    }
+
+    return ok ? meta : MediaMetadata();
+}
+
+bool MediaProbe::probeJpeg(QIODevice *device, MediaMetadata *meta)
+{
+    int orientation = 1;
+    qint64 pos = 2;
+    for (int i = 0; i < kMaxSegments; ++i) {
+        const QByteArray &segment = readAt(device, pos, 4);
+        if (segment.size() < 2 || uchar(segment.at(0)) != 0xFF)
+            return false;
+
+        const uchar marker = uchar(segment.at(1));
+        if (marker == 0xFF) {
+            // fill byte
+            ++pos;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+            // no length
+            pos += 2;
+            continue;
+        }
+        // the scan or the end, no frame header before it
+        if (marker == 0xD9 || marker == 0xDA || segment.size() < 4)
+            return false;
+
+        const quint16 length = bigEndianAt<quint16>(segment, 2);
+        if (length < 2)
+            return false;
+
+        if (isJpegFrameMarker(marker)) {
+            const QByteArray &frame = readAt(device, pos + 4, 5);
+            if (frame.size() < 5)
+                return false;
+            meta->height = bigEndianAt<quint16>(frame, 1);
+            meta->width = bigEndianAt<quint16>(frame, 3);
+            if (orientation >= 5 && orientation <= 8)
+                std::swap(meta->width, meta->height);
+            return meta->hasSize();
+        }
+
+        if (marker == 0xE1 && orientation == 1)
+            orientation = exifOrientation(readAt(device, pos + 4, qMin(length - 2, kExifBytes)));
+
+        pos += 2 + length;
+    }
+    return false;
+}
+
+bool MediaProbe::probePng(QIODevice *device, MediaMetadata *meta)
+{
+    const QByteArray &head = readAt(device, 0, 24);
+    if (head.size() < 24 || head.mid(12, 4) != "IHDR")
+        return false;
+
+    meta->width = int(bigEndianAt<quint32>(head, 16));
+    meta->height = int(bigEndianAt<quint32>(head, 20));
+    return meta->hasSize();
+}
+
+bool MediaProbe::probeGif(QIODevice *device, MediaMetadata *meta)
+{
+    const QByteArray &head = readAt(device, 0, 10);
+    if (head.size() < 10)
+        return false;
+
+    meta->width = littleEndianAt<quint16>(head, 6);
+    meta->height = littleEndianAt<quint16>(head, 8);
+    return meta->hasSize();
+}
+
+bool MediaProbe::probeWebp(QIODevice *device, MediaMetadata *meta)
+{
+    const QByteArray &head = readAt(device, 0, 30);
+    if (head.size() < 30)
+        return false;
+
+    const QByteArray &chunk = head.mid(12, 4);
+    if (chunk == "VP8 ") {
+        // lossy, the key frame starts with 9d 01 2a
+        if (head.mid(23, 3) != "\x9D\x01\x2A")
+            return false;
+        meta->width = littleEndianAt<quint16>(head, 26) & 0x3FFF;
+        meta->height = littleEndianAt<quint16>(head, 28) & 0x3FFF;
+    } else if (chunk == "VP8L") {
+        // lossless, 14 bits of width - 1 and height - 1 after the signature
+        if (uchar(head.at(20)) != 0x2F)
+            return false;
+        const quint32 bits = littleEndianAt<quint32>(head, 21);
+        meta->width = int(bits & 0x3FFF) + 1;
+        meta->height = int((bits >> 14) & 0x3FFF) + 1;
+    } else if (chunk == "VP8X") {
+        // extended, 24 bits of canvas width - 1 and height - 1
+        meta->width = int(uint24At(head, 24)) + 1;
+        meta->height = int(uint24At(head, 27)) + 1;
+    }
+    return meta->hasSize();
+}
+
+bool MediaProbe::probeMp4(QIODevice *device, MediaMetadata *meta)
+{
+    auto parseTrack = [device, meta](const Mp4Box &trak) {
+        forEachMp4Box(device, trak.dataStart, trak.end, [device, meta](const Mp4Box &box) {
+            if (box.type != "tkhd")
+                return true;
+
+            const QByteArray &data = readAt(device, box.dataStart, 96);
+            const int matrix = (!data.isEmpty() && data.at(0) == 1) ? 52 : 40;
+            if (data.size() < matrix + 44)
+                return false;
+
+            // 16.16 fixed point, the audio tracks have none
+            const int width = int(bigEndianAt<quint32>(data, matrix + 36) >> 16);
+            const int height = int(bigEndianAt<quint32>(data, matrix + 40) >> 16);
+            if (width > 0 && height > 0) {
+                meta->width = width;
+                meta->height = height;
+                // turned by 90 or 270 degrees
+                if (bigEndianAt<qint32>(data, matrix) == 0 && bigEndianAt<qint32>(data, matrix + 4) != 0)
+                    std::swap(meta->width, meta->height);
+            }
+            return false;
+        });
+    };
+
+    bool found = false;
+    // the movie box may be after the media data, which is skipped by its size
+    forEachMp4Box(device, 0, device->size(), [&](const Mp4Box &moov) {
+        if (moov.type != "moov")
+            return true;
+
+        found = true;
+        forEachMp4Box(device, moov.dataStart, moov.end, [&](const Mp4Box &box) {
+            if (box.type == "mvhd") {
+                const QByteArray &data = readAt(device, box.dataStart, 32);
+                quint32 timescale = 0;
+                quint64 duration = 0;
+                if (data.size() >= 20 && data.at(0) == 0) {
+                    timescale = bigEndianAt<quint32>(data, 12);
+                    duration = bigEndianAt<quint32>(data, 16);
+                    if (duration == 0xFFFFFFFF)
+                        duration = 0;
+                } else if (data.size() >= 32 && data.at(0) == 1) {
+                    timescale = bigEndianAt<quint32>(data, 20);
+                    duration = bigEndianAt<quint64>(data, 24);
+                }
+                if (timescale > 0 && duration > 0)
+                    meta->duration = qint64(duration * 1000 / timescale);
+            } else if (box.type == "trak" && !meta->hasSize()) {
+                parseTrack(box);
+            }
+            return true;
+        });
+        return false;
+    });
+
+    return found && (meta->hasSize() || meta->hasDuration());
+}
+
+bool MediaProbe::probeMatroska(QIODevice *device, MediaMetadata *meta)
+{
+    static constexpr quint32 kEbml { 0x1A45DFA3 };
+    static constexpr quint32 kSegment { 0x18538067 };
+    static constexpr quint32 kInfo { 0x1549A966 };
+    static constexpr quint32 kTimecodeScale { 0x2AD7B1 };
+    static constexpr quint32 kDuration { 0x4489 };
+    static constexpr quint32 kTracks { 0x1654AE6B };
+    static constexpr quint32 kTrackEntry { 0xAE };
+    static constexpr quint32 kVideo { 0xE0 };
+    static constexpr quint32 kPixelWidth { 0xB0 };
+    static constexpr quint32 kPixelHeight { 0xBA };
+    static constexpr quint32 kCluster { 0x1F43B675 };
+
+    EbmlElement header;
+    if (!readEbmlElement(device, 0, &header) || header.id != kEbml || header.size < 0)
+        return false;
+
+    EbmlElement segment;
+    if (!readEbmlElement(device, header.dataStart + header.size, &segment) || segment.id != kSegment)
+        return false;
+
+    const qint64 segmentEnd = segment.size < 0 ? device->size() : segment.dataStart + segment.size;
+    quint64 timecodeScale = 1000000;
+    double duration = -1;
+    bool hasInfo = false;
+    bool hasTracks = false;
+    forEachEbmlElement(device, segment.dataStart, segmentEnd, [&](const EbmlElement &element) {
+        const qint64 end = element.dataStart + element.size;
+        if (element.id == kInfo) {
+            hasInfo = true;
+            forEachEbmlElement(device, element.dataStart, end, [&](const EbmlElement &child) {
+                if (child.id == kTimecodeScale)
+                    timecodeScale = ebmlUInt(device, child);
+                else if (child.id == kDuration)
+                    duration = ebmlFloat(device, child);
+                return true;
+            });
+        } else if (element.id == kTracks) {
+            hasTracks = true;
+            forEachEbmlElement(device, element.dataStart, end, [&](const EbmlElement &entry) {
+                if (entry.id != kTrackEntry)
+                    return true;
+                forEachEbmlElement(device, entry.dataStart, entry.dataStart + entry.size, [&](const EbmlElement &video) {
+                    if (video.id != kVideo)
+                        return true;
+                    forEachEbmlElement(device, video.dataStart, video.dataStart + video.size, [&](const EbmlElement &pixel) {
+                        if (pixel.id == kPixelWidth)
+                            meta->width = int(ebmlUInt(device, pixel));
+                        else if (pixel.id == kPixelHeight)
+                            meta->height = int(ebmlUInt(device, pixel));
+                        return true;
+                    });
+                    return false;
+                });
+                return !meta->hasSize();
+            });
+        }
+
+        // the headers are before the media data
+        return element.id != kCluster && !(hasInfo && hasTracks);
+    });
+
+    if (duration >= 0 && timecodeScale > 0)
+        meta->duration = qint64(duration * double(timecodeScale) / 1000000);
+    return meta->hasSize() || meta->hasDuration();
+}
+
+bool MediaProbe::probeFlac(QIODevice *device, MediaMetadata *meta)
+{
+    // the first metadata block is the stream info
+    const QByteArray &head = readAt(device, 0, 26);
+    if (head.size() < 26 || (uchar(head.at(4)) & 0x7F) != 0)
+        return false;
+
+    // 20 bits of sample rate, 3 of channels, 5 of bits per sample and 36 of total samples
+    const quint64 bits = bigEndianAt<quint64>(head, 18);
+    const quint64 sampleRate = bits >> 44;
+    const quint64 samples = bits & Q_UINT64_C(0xFFFFFFFFF);
+    if (sampleRate == 0 || samples == 0)
+        return false;
+
+    meta->duration = qint64(samples * 1000 / sampleRate);
+    return true;
+}
+
+bool MediaProbe::probeMp3(QIODevice *device, MediaMetadata *meta)
+{
+    // kbps, [MPEG 1 or not][layer I, II, III][index]
+    static constexpr int kBitrates[2][3][15] {
+        { { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 },
+          { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },
+          { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 } },
+        { { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256 },
+          { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+          { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 } }
+    };
+    // [MPEG 1, 2, 2.5][index]
+    static constexpr int kSampleRates[3][3] { { 44100, 48000, 32000 }, { 22050, 24000, 16000 }, { 11025, 12000, 8000 } };
+
+    qint64 start = 0;
+    const QByteArray &id3 = readAt(device, 0, 10);
+    if (id3.size() == 10 && id3.startsWith("ID3")) {
+        const uchar *u = reinterpret_cast<const uchar *>(id3.constData());
+        start = 10 + (qint64(u[6] & 0x7F) << 21 | qint64(u[7] & 0x7F) << 14 | qint64(u[8] & 0x7F) << 7 | qint64(u[9] & 0x7F));
+        // footer
+        if (u[5] & 0x10)
+            start += 10;
+    }
+
+    const QByteArray &data = readAt(device, start, kMp3SearchBytes + 64);
+    const uchar *u = reinterpret_cast<const uchar *>(data.constData());
+    for (int i = 0; i + 4 <= data.size() && i < kMp3SearchBytes; ++i) {
+        if (u[i] != 0xFF || (u[i + 1] & 0xE0) != 0xE0)
+            continue;
+
+        const quint32 header = bigEndianAt<quint32>(data, i);
+        const int version = (header >> 19) & 3;   // 0: MPEG 2.5, 1: reserved, 2: MPEG 2, 3: MPEG 1
+        const int layer = (header >> 17) & 3;   // 1: layer III, 2: layer II, 3: layer I
+        const int bitrateIndex = (header >> 12) & 0xF;
+        const int rateIndex = (header >> 10) & 3;
+        if (version == 1 || layer == 0 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3)
+            continue;
+
+        const bool mpeg1 = version == 3;
+        const int layerIndex = 3 - layer;
+        const int bitrate = kBitrates[mpeg1 ? 0 : 1][layerIndex][bitrateIndex];
+        const int sampleRate = kSampleRates[mpeg1 ? 0 : (version == 2 ? 1 : 2)][rateIndex];
+        const int samplesPerFrame = layerIndex == 0 ? 384 : ((layerIndex == 1 || mpeg1) ? 1152 : 576);
+        const bool mono = ((header >> 6) & 3) == 3;
+
+        // the frame count of a vbr file is in the Xing or the VBRI header of the first frame
+        quint32 frames = 0;
+        const int xing = i + 4 + (mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17));
+        const int vbri = i + 4 + 32;
+        if (xing + 12 <= data.size() && (data.mid(xing, 4) == "Xing" || data.mid(xing, 4) == "Info")) {
+            if (bigEndianAt<quint32>(data, xing + 4) & 1)
+                frames = bigEndianAt<quint32>(data, xing + 8);
+        } else if (vbri + 18 <= data.size() && data.mid(vbri, 4) == "VBRI") {
+            frames = bigEndianAt<quint32>(data, vbri + 14);
+        }
+
+        if (frames > 0)
+            meta->duration = qint64(frames) * samplesPerFrame * 1000 / sampleRate;
+        else
+            meta->duration = (device->size() - start - i) * 8 / bitrate;
+        return meta->hasDuration();
+    }
+    return false;
+}
+
+bool MediaProbe::probeOgg(QIODevice *device, MediaMetadata *meta)
+{
+    const QByteArray &page = readAt(device, 0, kOggPageBytes);
+    if (page.size() < 28)
+        return false;
+
+    const quint32 serial = littleEndianAt<quint32>(page, 14);
+    const int packet = 27 + uchar(page.at(26));
+    quint32 sampleRate = 0;
+    qint64 preSkip = 0;
+    if (page.size() >= packet + 16 && page.mid(packet, 7) == QByteArray("\x01vorbis", 7)) {
+        sampleRate = littleEndianAt<quint32>(page, packet + 12);
+    } else if (page.size() >= packet + 12 && page.mid(packet, 8) == "OpusHead") {
+        // opus is always decoded at 48 kHz
+        sampleRate = 48000;
+        preSkip = littleEndianAt<quint16>(page, packet + 10);
+    }
+    if (sampleRate == 0)
+        return false;
+
+    // the granule position of the last page of the stream is its sample count,
+    // a page is at most 64 KB, a smaller tail is read first
+    const qint64 size = device->size();
+    for (qint64 tail : { qint64(8 * 1024), qint64(65307) }) {
+        const qint64 from = qMax<qint64>(0, size - tail);
+        const QByteArray &data = readAt(device, from, size - from);
+        for (int i = data.lastIndexOf("OggS"); i >= 0; i = i > 0 ? data.lastIndexOf("OggS", i - 1) : -1) {
+            if (i + 27 > data.size() || littleEndianAt<quint32>(data, i + 14) != serial)
+                continue;
+            // -1 if no packet ends in the page
+            const qint64 granule = littleEndianAt<qint64>(data, i + 6);
+            if (granule <= 0)
+                continue;
+            meta->duration = qMax<qint64>(0, granule - preSkip) * 1000 / sampleRate;
+            return true;
+        }
+        if (from == 0)
+            break;
+    }
+    return false;
+}
@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MEDIAPROBE_H
+#define MEDIAPROBE_H
+
+#include "dfmplugin_detailspace_global.h"
+
+#include <QString>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+namespace dfmplugin_detailspace {
+
+struct MediaMetadata
+{
+    int width { -1 };
+    int height { -1 };
+    qint64 duration { -1 };   // msecs
+
+    bool hasSize() const { return width > 0 && height > 0; }
+    bool hasDuration() const { return duration >= 0; }
+};
+
+/*!
+ * \brief The MediaProbe class reads the dimension and the duration of the common media files
+ * from their headers. The container is told by its magic and only its header boxes, segments or
+ * frames are read, a few KB of the file, never the media data.
+ * JPEG, PNG, GIF, WebP, MP4/MOV, Matroska/WebM, FLAC, MP3 and Ogg (Vorbis, Opus) are known.
+ */
+class MediaProbe
+{
+public:
+    static MediaMetadata probe(const QString &filePath);
+    static MediaMetadata probe(QIODevice *device);
+
+private:
+    static bool probeJpeg(QIODevice *device, MediaMetadata *meta);
+    static bool probePng(QIODevice *device, MediaMetadata *meta);
+    static bool probeGif(QIODevice *device, MediaMetadata *meta);
+    static bool probeWebp(QIODevice *device, MediaMetadata *meta);
+    static bool probeMp4(QIODevice *device, MediaMetadata *meta);
+    static bool probeMatroska(QIODevice *device, MediaMetadata *meta);
+    static bool probeFlac(QIODevice *device, MediaMetadata *meta);
+    static bool probeMp3(QIODevice *device, MediaMetadata *meta);
+    static bool probeOgg(QIODevice *device, MediaMetadata *meta);
+};
+
+}
+
+#endif   // MEDIAPROBE_H
@@ -13,6 +13,8 @@
 #include <QScrollArea>
 #include <QFileSystemModel>
 #include <QTreeView>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 #include <DPushButton>
 #include <dtkwidget_global.h>
@@ -170,15 +172,13 @@ void DetailView::createHeadUI(const QUrl &url, int widgetFilter)
         // get icon from plugin
         QIcon icon;
         ThumbnailHelper helper;
+        bool loadThumbnail = false;
         const QString &iconName = findPluginIcon(info->urlOf(UrlInfoType::kUrl));
         if (!iconName.isEmpty()) {
             icon = QIcon::fromTheme(iconName);
         } else if (helper.checkThumbEnable(url)) {
             icon = info->extendAttributes(ExtInfoType::kFileThumbnail).value<QIcon>();
-            if (icon.isNull()) {
-                const auto &img = helper.thumbnailImage(url, Global::kLarge);
-                icon = QPixmap::fromImage(img);
-            }
+            loadThumbnail = icon.isNull();
         }
         if (icon.isNull())
             icon = info->fileIcon();
@@ -188,6 +188,24 @@ void DetailView::createHeadUI(const QUrl &url, int widgetFilter)
         iconLabel->setPixmap(px);
         iconLabel->setAlignment(Qt::AlignCenter);
         vLayout->insertWidget(0, iconLabel, 0, Qt::AlignHCenter);
+
+        // the thumbnail may have to be generated, the file icon is shown until it is done,
+        // the watcher goes with the label when another file is shown
+        if (loadThumbnail) {
+            DLabel *label = iconLabel;
+            auto watcher = new QFutureWatcher<QImage>(label);
+            connect(watcher, &QFutureWatcherBase::finished, label, [watcher, label, targetSize]() {
+                const QImage &img = watcher->result();
+                watcher->deleteLater();
+                if (img.isNull())
+                    return;
+
+                QPixmap thumbnail = QIcon(QPixmap::fromImage(img)).pixmap(targetSize);
+                thumbnail.setDevicePixelRatio(qApp->devicePixelRatio());
+                label->setPixmap(thumbnail);
+            });
+            watcher->setFuture(QtConcurrent::run(&ThumbnailHelper::thumbnailImage, url, Global::kLarge));
+        }
     }
 }
 
@@ -4,6 +4,7 @@
 
 #include "filebaseinfoview.h"
 #include "utils/detailmanager.h"
+#include "utils/mediainfofetcher.h"
 
 #include <dfm-base/utils/universalutils.h>
 #include <dfm-base/base/schemefactory.h>
@@ -233,29 +234,67 @@ void FileBaseInfoView::basicFill(const QUrl &url)
         const QString &mimeName { localinfo->nameOf(NameInfoType::kMimeTypeName) };
         const FileInfo::FileType type = MimeTypeDisplayManager::instance()->displayNameToEnum(mimeName);
         fileType->setRightValue(localinfo->displayOf(DisPlayInfoType::kMimeTypeDisplayName), Qt::ElideNone, Qt::AlignLeft, true);
-        QList<DFileInfo::AttributeExtendID> extenList;
-        if (type == FileInfo::FileType::kVideos) {
-            extenList << DFileInfo::AttributeExtendID::kExtendMediaWidth << DFileInfo::AttributeExtendID::kExtendMediaHeight << DFileInfo::AttributeExtendID::kExtendMediaDuration;
-            connect(&FileInfoHelper::instance(), &FileInfoHelper::mediaDataFinished, this, &FileBaseInfoView::videoExtenInfo);
-            const QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant> &mediaAttributes = localinfo->mediaInfoAttributes(DFileInfo::MediaType::kVideo, extenList);
-            if (!mediaAttributes.isEmpty())
-                videoExtenInfo(url, mediaAttributes);
-        } else if (type == FileInfo::FileType::kImages) {
-            extenList << DFileInfo::AttributeExtendID::kExtendMediaWidth << DFileInfo::AttributeExtendID::kExtendMediaHeight;
-            connect(&FileInfoHelper::instance(), &FileInfoHelper::mediaDataFinished, this, &FileBaseInfoView::imageExtenInfo);
-            const QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant> &mediaAttributes = localinfo->mediaInfoAttributes(DFileInfo::MediaType::kImage, extenList);
-            if (!mediaAttributes.isEmpty())
-                imageExtenInfo(url, mediaAttributes);
-        } else if (type == FileInfo::FileType::kAudios) {
-            extenList << DFileInfo::AttributeExtendID::kExtendMediaDuration;
-            connect(&FileInfoHelper::instance(), &FileInfoHelper::mediaDataFinished, this, &FileBaseInfoView::audioExtenInfo);
-            const QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant> &mediaAttributes = localinfo->mediaInfoAttributes(DFileInfo::MediaType::kAudio, extenList);
-            if (!mediaAttributes.isEmpty())
-                audioExtenInfo(url, mediaAttributes);
+        if (type == FileInfo::FileType::kVideos || type == FileInfo::FileType::kImages || type == FileInfo::FileType::kAudios) {
+            mediaType = type;
+            mediaInfo = localinfo;
+            // the local files are probed by their headers, the others are read by dfmio
+            const QUrl &mediaUrl = localinfo->urlOf(UrlInfoType::kUrl);
+            if (mediaUrl.isLocalFile()) {
+                connect(MediaInfoFetcher::instance(), &MediaInfoFetcher::mediaInfoFetched, this, &FileBaseInfoView::onMediaInfoFetched, Qt::UniqueConnection);
+                MediaInfoFetcher::instance()->fetch(url, mediaUrl.toLocalFile(), type);
+            } else {
+                mediaExtenInfo(url);
+            }
         }
     }
 }
 
+void FileBaseInfoView::mediaExtenInfo(const QUrl &url)
+{
+    if (!mediaInfo)
+        return;
+
+    QList<DFileInfo::AttributeExtendID> extenList;
+    if (mediaType == FileInfo::FileType::kVideos) {
+        extenList << DFileInfo::AttributeExtendID::kExtendMediaWidth << DFileInfo::AttributeExtendID::kExtendMediaHeight << DFileInfo::AttributeExtendID::kExtendMediaDuration;
+        connect(&FileInfoHelper::instance(), &FileInfoHelper::mediaDataFinished, this, &FileBaseInfoView::videoExtenInfo);
+        const QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant> &mediaAttributes = mediaInfo->mediaInfoAttributes(DFileInfo::MediaType::kVideo, extenList);
+        if (!mediaAttributes.isEmpty())
+            videoExtenInfo(url, mediaAttributes);
+    } else if (mediaType == FileInfo::FileType::kImages) {
+        extenList << DFileInfo::AttributeExtendID::kExtendMediaWidth << DFileInfo::AttributeExtendID::kExtendMediaHeight;
+        connect(&FileInfoHelper::instance(), &FileInfoHelper::mediaDataFinished, this, &FileBaseInfoView::imageExtenInfo);
+        const QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant> &mediaAttributes = mediaInfo->mediaInfoAttributes(DFileInfo::MediaType::kImage, extenList);
+        if (!mediaAttributes.isEmpty())
+            imageExtenInfo(url, mediaAttributes);
+    } else if (mediaType == FileInfo::FileType::kAudios) {
+        extenList << DFileInfo::AttributeExtendID::kExtendMediaDuration;
+        connect(&FileInfoHelper::instance(), &FileInfoHelper::mediaDataFinished, this, &FileBaseInfoView::audioExtenInfo);
+        const QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant> &mediaAttributes = mediaInfo->mediaInfoAttributes(DFileInfo::MediaType::kAudio, extenList);
+        if (!mediaAttributes.isEmpty())
+            audioExtenInfo(url, mediaAttributes);
+    }
+}
+
+void FileBaseInfoView::onMediaInfoFetched(const QUrl &url, bool ok, const QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant> &properties)
+{
+    if (url != currentUrl)
+        return;
+
+    // the headers are not known, the media info is read by dfmio then
+    if (!ok) {
+        mediaExtenInfo(url);
+        return;
+    }
+
+    if (mediaType == FileInfo::FileType::kVideos)
+        videoExtenInfo(url, properties);
+    else if (mediaType == FileInfo::FileType::kImages)
+        imageExtenInfo(url, properties);
+    else if (mediaType == FileInfo::FileType::kAudios)
+        audioExtenInfo(url, properties);
+}
+
 void FileBaseInfoView::clearField()
 {
     QList<BasicFieldExpandEnum> expandEnum = fieldMap.keys();
@@ -389,6 +428,8 @@ void FileBaseInfoView::audioExtenInfo(const QUrl &url, QMap<dfmio::DFileInfo::At
 void FileBaseInfoView::setFileUrl(const QUrl &url)
 {
     currentUrl = url;
+    mediaInfo.reset();
+    mediaType = FileInfo::FileType::kUnknown;
 
     clearField();
 
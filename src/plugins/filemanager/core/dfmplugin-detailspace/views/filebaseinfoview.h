@@ -27,6 +27,7 @@ private:
     void basicExpand(const QUrl &url);
     void basicFieldFilter(const QUrl &url);
     void basicFill(const QUrl &url);
+    void mediaExtenInfo(const QUrl &url);
     void clearField();
     void connectInit();
     void imageExtenInfoReceiver(const QStringList &properties);
@@ -45,6 +46,7 @@ public slots:
     void slotImageExtenInfo(const QStringList &properties);
     void slotVideoExtenInfo(const QStringList &properties);
     void slotAudioExtenInfo(const QStringList &properties);
+    void onMediaInfoFetched(const QUrl &url, bool ok, const QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant> &properties);
 
 public:
     void setFileUrl(const QUrl &url);
@@ -61,6 +63,8 @@ private:
     QMultiMap<BasicFieldExpandEnum, DFMBASE_NAMESPACE::KeyValueLabel *> fieldMap;
 
     QUrl currentUrl;
+    FileInfoPointer mediaInfo;
+    DFMBASE_NAMESPACE::FileInfo::FileType mediaType { DFMBASE_NAMESPACE::FileInfo::FileType::kUnknown };
 };
 
 }
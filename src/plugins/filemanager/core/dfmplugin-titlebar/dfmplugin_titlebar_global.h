@@ -62,7 +62,8 @@ enum DPCErrorCode {
     kPasswordChangeFailed,
     kPasswordWrong,
     kAccessDiskFailed,   // Unable to get the encrypted disk list
-    kPasswordInconsistent   // Passwords of disks are different
+    kPasswordInconsistent,   // Passwords of disks are different
+    kPasswordChanging   // Another change of the disk password is running
 };
 
 using SeprateUrlCallback = std::function<QList<QVariantMap>(const QUrl &)>;
@@ -303,6 +303,15 @@ void DPCConfirmWidget::onPasswordChecked(int result)
         oldPwdEdit->setAlert(true);
         showToolTips(tr("Wrong password"), oldPwdEdit);
         break;
+    case kInitFailed:
+    case kDeviceLoadFailed:
+        setEnabled(true);
+        showToolTips(tr("Initialization failed"), oldPwdEdit);
+        break;
+    case kPasswordChanging:
+        setEnabled(true);
+        showToolTips(tr("The disk password is being changed, please try again later"), oldPwdEdit);
+        break;
     default:
         break;
     }
@@ -4,12 +4,21 @@
 
 #include "completerviewmodel.h"
 
-#include <QAbstractItemView>
-
 using namespace dfmplugin_titlebar;
 
+static QStringList nonEmptyOf(const QStringList &list)
+{
+    QStringList ret;
+    ret.reserve(list.size());
+    for (const auto &str : list) {
+        if (!str.isEmpty())
+            ret.append(str);
+    }
+    return ret;
+}
+
 CompleterViewModel::CompleterViewModel(QObject *parent)
-    : QStandardItemModel(parent)
+    : QAbstractListModel(parent)
 {
 }
 
@@ -17,19 +26,57 @@ CompleterViewModel::~CompleterViewModel()
 {
 }
 
-void CompleterViewModel::setStringList(const QStringList &list)
+int CompleterViewModel::rowCount(const QModelIndex &parent) const
 {
-    removeAll();
-    for (const auto &str : list) {
-        if (str.isEmpty())
-            continue;
+    return parent.isValid() ? 0 : completions.size();
+}
 
-        QStandardItem *item = new QStandardItem(str);
-        appendRow(item);
+QVariant CompleterViewModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= completions.size())
+        return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return completions.at(index.row());
+    case Qt::DecorationRole:
+        return icons.contains(index.row()) ? QVariant(icons.value(index.row())) : QVariant();
+    default:
+        return QVariant();
     }
 }
 
+void CompleterViewModel::setStringList(const QStringList &list)
+{
+    beginResetModel();
+    completions = nonEmptyOf(list);
+    icons.clear();
+    endResetModel();
+}
+
+void CompleterViewModel::appendStringList(const QStringList &list)
+{
+    const QStringList &appended = nonEmptyOf(list);
+    if (appended.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), completions.size(), completions.size() + appended.size() - 1);
+    completions.append(appended);
+    endInsertRows();
+}
+
+void CompleterViewModel::setIcon(int row, const QIcon &icon)
+{
+    if (row < 0 || row >= completions.size())
+        return;
+
+    icons.insert(row, icon);
+    const QModelIndex &idx = index(row);
+    emit dataChanged(idx, idx, { Qt::DecorationRole });
+}
+
 void CompleterViewModel::removeAll()
 {
-    removeRows(0, rowCount());
+    setStringList(QStringList());
 }
@@ -7,23 +7,34 @@
 
 #include "dfmplugin_titlebar_global.h"
 
-#include <DStandardItem>
-
-#include <QStandardItemModel>
-
-DWIDGET_USE_NAMESPACE
+#include <QAbstractListModel>
+#include <QHash>
+#include <QIcon>
 
 namespace dfmplugin_titlebar {
 
-class CompleterViewModel : public QStandardItemModel
+/*!
+ * \brief The CompleterViewModel class holds the completions as a string list,
+ * a directory can have thousands of them and no item is created for each one.
+ */
+class CompleterViewModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
     explicit CompleterViewModel(QObject *parent = nullptr);
     ~CompleterViewModel();
 
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
     void setStringList(const QStringList &list);
+    void appendStringList(const QStringList &list);
+    void setIcon(int row, const QIcon &icon);
     void removeAll();
+
+private:
+    QStringList completions;
+    QHash<int, QIcon> icons;
 };
 }
 
@@ -0,0 +1,325 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "completioncache.h"
+
+#include <dfm-base/base/schemefactory.h>
+#include <dfm-base/base/application/application.h>
+#include <dfm-base/base/application/settings.h>
+
+#include <QCoreApplication>
+#include <QDateTime>
+
+#include <algorithm>
+
+using namespace dfmplugin_titlebar;
+DFMBASE_USE_NAMESPACE
+
+inline constexpr char kConfigGroupName[] { "Cache" };
+inline constexpr char kConfigCompletionVisits[] { "CompletionVisits" };
+
+inline constexpr char kKeyUrl[] { "url" };
+inline constexpr char kKeyCount[] { "count" };
+inline constexpr char kKeyLastVisited[] { "lastVisited" };
+
+static constexpr int kMaxListedDirs { 32 };
+static constexpr int kMaxSavedVisits { 200 };
+static constexpr qint64 kMsecsPerDay { 24 * 3600 * 1000 };
+static constexpr int kSaveDelay { 5000 };   // msecs
+
+inline constexpr char kVaultScheme[] { "dfmvault" };
+inline constexpr char kVaultDecryptDirName[] { "vault_unlocked" };
+
+// the visits lose weight as they get old, as the frecency of the browsers does
+static int frecencyOf(int visitCount, qint64 lastVisited, qint64 now)
+{
+    if (visitCount <= 0)
+        return 0;
+
+    const qint64 days = (now - lastVisited) / kMsecsPerDay;
+    int weight = 10;
+    if (days < 4)
+        weight = 100;
+    else if (days < 14)
+        weight = 70;
+    else if (days < 31)
+        weight = 50;
+    else if (days < 90)
+        weight = 30;
+    return visitCount * weight;
+}
+
+static QStringList segmentsOf(const QUrl &url)
+{
+    QStringList segments { url.scheme() + "://" + url.authority() };
+    for (const QString &name : url.path().split('/')) {
+        if (!name.isEmpty())
+            segments.append(name);
+    }
+    return segments;
+}
+
+CompletionCache *CompletionCache::instance()
+{
+    static CompletionCache instance;
+    return &instance;
+}
+
+CompletionCache::CompletionCache(QObject *parent)
+    : QObject(parent)
+{
+    loadVisits();
+
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(kSaveDelay);
+    connect(&saveTimer, &QTimer::timeout, this, &CompletionCache::saveVisits);
+    // the visits of the last seconds are not lost
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+        if (saveTimer.isActive()) {
+            saveTimer.stop();
+            saveVisits();
+        }
+    });
+}
+
+/*!
+ * \brief CompletionCache::completions the cached sub directories of \a dirUrl
+ * \param names the names, the visited ones first by their frecency and the others in the listed order
+ * \return false if \a dirUrl is not listed or is changed since it was listed
+ */
+bool CompletionCache::completions(const QUrl &dirUrl, QStringList *names)
+{
+    Node *node = find(dirUrl, false);
+    if (!node || !node->listed || !names)
+        return false;
+
+    listedNodes.removeOne(node);
+    listedNodes.append(node);
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<QPair<int, QString>> visited;
+    QStringList others;
+    others.reserve(node->names.size());
+    for (const QString &name : node->names) {
+        const auto &child = node->children.value(name);
+        const int frecency = child ? frecencyOf(child->visitCount, child->lastVisited, now) : 0;
+        if (frecency > 0)
+            visited.append({ frecency, name });
+        else
+            others.append(name);
+    }
+
+    std::stable_sort(visited.begin(), visited.end(), [](const QPair<int, QString> &left, const QPair<int, QString> &right) {
+        return left.first > right.first;
+    });
+
+    names->clear();
+    names->reserve(node->names.size());
+    for (const auto &pair : visited)
+        names->append(pair.second);
+    names->append(others);
+    return true;
+}
+
+/*!
+ * \brief CompletionCache::insert keep the listing of \a dirUrl, it is not kept if the directory
+ * can not be watched, nothing would tell the listing is out of date then
+ */
+void CompletionCache::insert(const QUrl &dirUrl, const QStringList &names)
+{
+    if (isPrivate(dirUrl))
+        return;
+
+    Node *node = find(dirUrl, true);
+    if (node->watcher || watch(node)) {
+        node->listed = true;
+        node->names = names;
+        listedNodes.removeOne(node);
+        listedNodes.append(node);
+
+        while (listedNodes.size() > kMaxListedDirs)
+            unlist(listedNodes.first());
+    }
+    prune(&root);
+}
+
+void CompletionCache::invalidate(const QUrl &dirUrl)
+{
+    Node *node = find(dirUrl, false);
+    if (node && node->listed) {
+        unlist(node);
+        prune(&root);
+    }
+}
+
+/*!
+ * \brief CompletionCache::visit count a visit of \a url, the visits rank the completions
+ */
+void CompletionCache::visit(const QUrl &url)
+{
+    if (!url.isValid() || url.hasQuery() || isPrivate(url))
+        return;
+
+    Node *node = find(url, true);
+    ++node->visitCount;
+    node->lastVisited = QDateTime::currentMSecsSinceEpoch();
+    saveTimer.start();
+}
+
+/*!
+ * \brief CompletionCache::isPrivate the paths of the vault, by its scheme or by its unlocked directory
+ */
+bool CompletionCache::isPrivate(const QUrl &url)
+{
+    if (url.scheme() == kVaultScheme)
+        return true;
+    return url.isLocalFile() && url.path().split('/').contains(kVaultDecryptDirName);
+}
+
+CompletionCache::Node *CompletionCache::find(const QUrl &url, bool create)
+{
+    Node *node = &root;
+    for (const QString &segment : segmentsOf(url)) {
+        auto child = node->children.value(segment);
+        if (!child) {
+            if (!create)
+                return nullptr;
+            child.reset(new Node);
+            node->children.insert(segment, child);
+        }
+        node = child.data();
+    }
+
+    if (create && node->url.isEmpty()) {
+        node->url = url.adjusted(QUrl::StripTrailingSlash);
+        // the root keeps its slash
+        if (node->url.path().isEmpty())
+            node->url.setPath("/");
+    }
+    return node;
+}
+
+/*!
+ * \brief CompletionCache::prune remove the nodes under \a node which are neither listed nor visited
+ * and have no such children, the trie only holds the paths of the listings and the visits
+ */
+void CompletionCache::prune(Node *node)
+{
+    for (auto iter = node->children.begin(); iter != node->children.end();) {
+        Node *child = iter.value().data();
+        prune(child);
+        if (!child->listed && child->visitCount <= 0 && child->children.isEmpty())
+            iter = node->children.erase(iter);
+        else
+            ++iter;
+    }
+}
+
+bool CompletionCache::watch(Node *node)
+{
+    // not the cached watcher, which is shared with the views
+    auto watcher = WatcherFactory::create<AbstractFileWatcher>(node->url, false);
+    if (!watcher) {
+        fmDebug() << "can not watch the completed directory: " << node->url;
+        return false;
+    }
+
+    const QUrl dirUrl = node->url;
+    connect(watcher.data(), &AbstractFileWatcher::subfileCreated, this, [this, dirUrl]() {
+        invalidate(dirUrl);
+    });
+    connect(watcher.data(), &AbstractFileWatcher::fileDeleted, this, &CompletionCache::onFileDeleted);
+    connect(watcher.data(), &AbstractFileWatcher::fileRename, this, &CompletionCache::onFileRename);
+    watcher->startWatcher();
+    node->watcher = watcher;
+    return true;
+}
+
+void CompletionCache::unlist(Node *node)
+{
+    node->listed = false;
+    node->names.clear();
+    listedNodes.removeOne(node);
+
+    if (node->watcher) {
+        auto watcher = node->watcher;
+        node->watcher.reset();
+        watcher->disconnect(this);
+        watcher->stopWatcher();
+        // it may be emitting the signal being handled, it is released after that
+        QTimer::singleShot(0, this, [watcher]() {});
+    }
+}
+
+void CompletionCache::unlistTree(Node *node)
+{
+    if (node->listed)
+        unlist(node);
+    for (const auto &child : node->children)
+        unlistTree(child.data());
+}
+
+void CompletionCache::onFileDeleted(const QUrl &url)
+{
+    // a listed directory or its parent
+    if (Node *node = find(url, false)) {
+        unlistTree(node);
+        prune(&root);
+    }
+
+    Node *parent = find(url.adjusted(QUrl::StripTrailingSlash | QUrl::RemoveFilename), false);
+    if (parent && parent->listed)
+        parent->names.removeOne(url.fileName());
+}
+
+void CompletionCache::onFileRename(const QUrl &oldUrl, const QUrl &newUrl)
+{
+    onFileDeleted(oldUrl);
+    // the new one is listed again, if it is a directory
+    invalidate(newUrl.adjusted(QUrl::StripTrailingSlash | QUrl::RemoveFilename));
+}
+
+void CompletionCache::loadVisits()
+{
+    const auto &list = Application::appObtuselySetting()->value(kConfigGroupName, kConfigCompletionVisits).toList();
+    for (const auto &item : list) {
+        const auto &map = item.toMap();
+        const QUrl url(map.value(kKeyUrl).toString());
+        const int count = map.value(kKeyCount).toInt();
+        if (!url.isValid() || count <= 0 || isPrivate(url))
+            continue;
+
+        Node *node = find(url, true);
+        node->visitCount = count;
+        node->lastVisited = map.value(kKeyLastVisited).toLongLong();
+    }
+}
+
+void CompletionCache::saveVisits() const
+{
+    QList<const Node *> visited;
+    QList<const Node *> pending { &root };
+    while (!pending.isEmpty()) {
+        const Node *node = pending.takeLast();
+        if (node->visitCount > 0)
+            visited.append(node);
+        for (const auto &child : node->children)
+            pending.append(child.data());
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    std::sort(visited.begin(), visited.end(), [now](const Node *left, const Node *right) {
+        return frecencyOf(left->visitCount, left->lastVisited, now) > frecencyOf(right->visitCount, right->lastVisited, now);
+    });
+
+    QVariantList list;
+    for (int i = 0; i < visited.size() && i < kMaxSavedVisits; ++i) {
+        QVariantMap map;
+        map.insert(kKeyUrl, visited.at(i)->url.toString());
+        map.insert(kKeyCount, visited.at(i)->visitCount);
+        map.insert(kKeyLastVisited, visited.at(i)->lastVisited);
+        list.append(map);
+    }
+    Application::appObtuselySetting()->setValue(kConfigGroupName, kConfigCompletionVisits, list);
+}
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef COMPLETIONCACHE_H
+#define COMPLETIONCACHE_H
+
+#include "dfmplugin_titlebar_global.h"
+
+#include <dfm-base/interfaces/abstractfilewatcher.h>
+
+#include <QObject>
+#include <QHash>
+#include <QSharedPointer>
+#include <QTimer>
+
+namespace dfmplugin_titlebar {
+
+/*!
+ * \brief The CompletionCache class keeps the sub directories listed for the address bar completion.
+ * The listings are kept in a trie of the path segments with the visits of the paths, a listing is
+ * dropped once a watcher sees its directory changed, and the names are ranked by the frecency of
+ * the visits, so the directories the user goes to are completed first.
+ * The paths of the vault are neither listed nor visited here, nothing of them is kept or saved.
+ */
+class CompletionCache : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(CompletionCache)
+
+public:
+    static CompletionCache *instance();
+
+    bool completions(const QUrl &dirUrl, QStringList *names);
+    void insert(const QUrl &dirUrl, const QStringList &names);
+    void invalidate(const QUrl &dirUrl);
+    void visit(const QUrl &url);
+
+private:
+    struct Node
+    {
+        QUrl url;
+        QHash<QString, QSharedPointer<Node>> children;
+        bool listed { false };
+        QStringList names;   // the sub directories, valid if listed
+        DFMBASE_NAMESPACE::AbstractFileWatcherPointer watcher;
+        int visitCount { 0 };
+        qint64 lastVisited { 0 };   // msecs since epoch
+    };
+
+    explicit CompletionCache(QObject *parent = nullptr);
+
+    static bool isPrivate(const QUrl &url);
+    Node *find(const QUrl &url, bool create);
+    void prune(Node *node);
+    bool watch(Node *node);
+    void unlist(Node *node);
+    void unlistTree(Node *node);
+    void onFileDeleted(const QUrl &url);
+    void onFileRename(const QUrl &oldUrl, const QUrl &newUrl);
+    void loadVisits();
+    void saveVisits() const;
+
+private:
+    Node root;
+    QList<Node *> listedNodes;   // least recently used first
+    QTimer saveTimer;   // the visits are saved once the user stops browsing
+};
+
+}
+
+#endif   // COMPLETIONCACHE_H
@@ -4,6 +4,7 @@
 
 #include "crumbinterface.h"
 #include "utils/titlebarhelper.h"
+#include "utils/completioncache.h"
 
 #include <dfm-base/base/urlroute.h>
 #include <dfm-base/base/schemefactory.h>
@@ -105,24 +106,40 @@ QList<CrumbData> CrumbInterface::seprateUrl(const QUrl &url)
  * via signal completionFound. When user no longer need current completion list and
  * the transmission isn't completed, you should call cancelCompletionListTransmission.
  * When transmission completed, it will send completionListTransmissionCompleted signal.
+ * The completion list of a directory listed before is sent at once from the CompletionCache,
+ * until a change of the directory is watched.
  *
  * \sa completionFound, completionListTransmissionCompleted, cancelCompletionListTransmission
  */
 void CrumbInterface::requestCompletionList(const QUrl &url)
 {
+    const quint64 serial = ++completionSerial;
+    completionCancelled = false;
     if (folderCompleterJobPointer) {
         folderCompleterJobPointer->disconnect();
         folderCompleterJobPointer->stopAndDeleteLater();
         folderCompleterJobPointer->setParent(nullptr);
     }
+
+    QStringList names;
+    if (CompletionCache::instance()->completions(url, &names)) {
+        emit completionFound(names);
+        emit completionListTransmissionCompleted();
+        return;
+    }
+
     folderCompleterJobPointer = new TraversalDirThread(url, QStringList(),
                                                        QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::NoIteratorFlags);
     folderCompleterJobPointer->setParent(this);
     if (folderCompleterJobPointer.isNull())
         return;
 
-    connect(folderCompleterJobPointer.data(), &TraversalDirThread::updateChildren, this,
-            &CrumbInterface::onUpdateChildren, Qt::DirectConnection);
+    connect(
+            folderCompleterJobPointer.data(), &TraversalDirThread::updateChildren, this,
+            [this, url, serial](QList<QUrl> children) {
+                onUpdateChildren(url, serial, children);
+            },
+            Qt::DirectConnection);
 
     connect(
             folderCompleterJobPointer.data(), &TraversalDirThread::finished, this,
@@ -143,11 +160,13 @@ void CrumbInterface::requestCompletionList(const QUrl &url)
  */
 void CrumbInterface::cancelCompletionListTransmission()
 {
+    completionCancelled = true;
     if (folderCompleterJobPointer)
         folderCompleterJobPointer->stop();
 }
 
-void CrumbInterface::onUpdateChildren(QList<QUrl> children)
+// called in the traversal thread
+void CrumbInterface::onUpdateChildren(const QUrl &dirUrl, quint64 serial, const QList<QUrl> &children)
 {
     QStringList list;
 
@@ -157,4 +176,12 @@ void CrumbInterface::onUpdateChildren(QList<QUrl> children)
             list.append(info->nameOf(NameInfoType::kFileName));
     }
     emit completionFound(list);
+
+    QMetaObject::invokeMethod(
+            this, [this, dirUrl, serial, list]() {
+                // a cancelled or replaced traversal may list a part of the directory
+                if (serial == completionSerial && !completionCancelled)
+                    CompletionCache::instance()->insert(dirUrl, list);
+            },
+            Qt::QueuedConnection);
 }
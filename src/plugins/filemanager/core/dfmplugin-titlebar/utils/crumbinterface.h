@@ -47,12 +47,14 @@ signals:
     void completionFound(const QStringList &completions);   //< emit multiple times with less or equials to 10 items in a group.
     void completionListTransmissionCompleted();   //< emit when all avaliable completions has been sent.
 
-private slots:
-    void onUpdateChildren(QList<QUrl> children);
+private:
+    void onUpdateChildren(const QUrl &dirUrl, quint64 serial, const QList<QUrl> &children);
 
 private:
     QString curScheme;
     bool keepAddr { false };
+    quint64 completionSerial { 0 };   // counts the requests, a finished traversal is cached only if it is the last
+    bool completionCancelled { false };
     QPointer<DFMBASE_NAMESPACE::TraversalDirThread> folderCompleterJobPointer;
 };
 
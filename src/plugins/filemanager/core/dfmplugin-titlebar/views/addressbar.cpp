@@ -285,14 +285,8 @@ void AddressBarPrivate::doComplete()
 
 void AddressBarPrivate::appendToCompleterModel(const QStringList &stringList)
 {
-    for (const QString &str : stringList) {
-        // 防止出现空的补全提示
-        if (str.isEmpty())
-            continue;
-
-        QStandardItem *item = new QStandardItem(str);
-        completerModel.appendRow(item);
-    }
+    // 空的补全提示由model过滤
+    completerModel.appendStringList(stringList);
 }
 
 void AddressBarPrivate::onTravelCompletionListFinished()
@@ -428,23 +422,17 @@ void AddressBarPrivate::completeIpAddress(const QString &text)
     // Set Base String
     this->completerBaseString = text;
 
-    completerModel.setRowCount(3);
-    completerModel.setItem(0, 0, new QStandardItem("smb://" + text));
-    completerModel.setItem(1, 0, new QStandardItem("ftp://" + text));
-    completerModel.setItem(2, 0, new QStandardItem("sftp://" + text));
+    completerModel.setStringList({ "smb://" + text, "ftp://" + text, "sftp://" + text });
 
     QIcon recentIcon = QIcon::fromTheme("document-open-recent-symbolic");
     for (const auto &data : ipHistroyList) {
         if (data.ipData == text && data.isRecentlyAccessed()) {
             if (!data.accessedType.compare("smb", Qt::CaseInsensitive)) {
-                auto item = completerModel.item(0);
-                item->setIcon(recentIcon);
+                completerModel.setIcon(0, recentIcon);
             } else if (!data.accessedType.compare("ftp", Qt::CaseInsensitive)) {
-                auto item = completerModel.item(1);
-                item->setIcon(recentIcon);
+                completerModel.setIcon(1, recentIcon);
             } else if (!data.accessedType.compare("sftp", Qt::CaseInsensitive)) {
-                auto item = completerModel.item(2);
-                item->setIcon(recentIcon);
+                completerModel.setIcon(2, recentIcon);
             }
         }
     }
@@ -6,6 +6,7 @@
 #include "events/titlebareventcaller.h"
 #include "utils/crumbinterface.h"
 #include "utils/crumbmanager.h"
+#include "utils/completioncache.h"
 
 #include <dfm-base/widgets/filemanagerwindow.h>
 #include <dfm-base/utils/fileutils.h>
@@ -36,6 +37,7 @@ TitleBarWidget::TitleBarWidget(QFrame *parent)
 void TitleBarWidget::setCurrentUrl(const QUrl &url)
 {
     titlebarUrl = url;
+    CompletionCache::instance()->visit(url);
     emit currentUrlChanged(url);
 }
 
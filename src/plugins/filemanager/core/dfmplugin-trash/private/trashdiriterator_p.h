@@ -7,6 +7,7 @@
 
 #include "dfmplugin_trash_global.h"
 #include <dfm-base/interfaces/abstractdiriterator.h>
+#include <dfm-base/file/local/localtrashenumerator.h>
 
 #include <dfm-io/denumerator.h>
 
@@ -32,6 +33,12 @@ private:
     QUrl currentUrl;
     QMap<QString, QString> fstabMap;
     FileInfoPointer fileInfo{nullptr};
+
+    // the root is listed from the trash directories, without gio
+    bool isRoot { false };
+    bool itemsLoaded { false };
+    QList<DFMBASE_NAMESPACE::LocalTrashEnumerator::TrashItem> items;
+    int itemIndex { -1 };
 };
 
 }
@@ -9,6 +9,7 @@
 #include <dfm-base/base/schemefactory.h>
 #include <dfm-base/base/standardpaths.h>
 #include <dfm-base/base/device/deviceutils.h>
+#include <dfm-base/utils/universalutils.h>
 
 DFMBASE_USE_NAMESPACE
 using namespace dfmplugin_trash;
@@ -18,6 +19,10 @@ TrashDirIteratorPrivate::TrashDirIteratorPrivate(const QUrl &url, const QStringL
                                                  TrashDirIterator *qq)
     : q(qq)
 {
+    isRoot = UniversalUtils::urlEquals(url, TrashHelper::rootUrl());
+    if (isRoot)
+        return;
+
     fstabMap = DeviceUtils::fstabBindInfo();
     dEnumerator.reset(new DFMIO::DEnumerator(url, nameFilters, filters, flags));
 }
@@ -42,6 +47,13 @@ TrashDirIterator::~TrashDirIterator()
 
 QUrl TrashDirIterator::next()
 {
+    if (d->isRoot) {
+        ++d->itemIndex;
+        d->fileInfo.reset();
+        d->currentUrl = d->itemIndex < d->items.size() ? d->items.at(d->itemIndex).url : QUrl();
+        return d->currentUrl;
+    }
+
     if (d->dEnumerator)
         d->currentUrl = d->dEnumerator->next();
 
@@ -50,6 +62,14 @@ QUrl TrashDirIterator::next()
 
 bool TrashDirIterator::hasNext() const
 {
+    if (d->isRoot) {
+        if (!d->itemsLoaded) {
+            d->items = LocalTrashEnumerator().items();
+            d->itemsLoaded = true;
+        }
+        return d->itemIndex + 1 < d->items.size();
+    }
+
     bool has = false;
     if (d->dEnumerator)
         has = d->dEnumerator->hasNext();
@@ -74,6 +94,12 @@ bool TrashDirIterator::hasNext() const
 
 QString TrashDirIterator::fileName() const
 {
+    if (d->isRoot && d->itemIndex >= 0 && d->itemIndex < d->items.size()) {
+        const auto &item = d->items.at(d->itemIndex);
+        const QString &path = item.originalPath.isEmpty() ? item.filePath : item.originalPath;
+        return path.mid(path.lastIndexOf('/') + 1);
+    }
+
     auto fileinfo = fileInfo();
     if (fileinfo) {
         return fileinfo->displayOf(DisPlayInfoType::kFileDisplayName);
@@ -84,6 +110,9 @@ QString TrashDirIterator::fileName() const
 
 QUrl TrashDirIterator::fileUrl() const
 {
+    if (d->isRoot && d->itemIndex >= 0 && d->itemIndex < d->items.size())
+        return QUrl::fromLocalFile(d->items.at(d->itemIndex).filePath);
+
     auto fileinfo = fileInfo();
     if (fileinfo) {
         return fileinfo->urlOf(UrlInfoType::kRedirectedFileUrl);
@@ -11,12 +11,14 @@ FileSelectionModel::FileSelectionModel(QAbstractItemModel *model)
     : QItemSelectionModel(model),
       d(new FileSelectionModelPrivate(this))
 {
+    d->connectModel(model);
 }
 
 FileSelectionModel::FileSelectionModel(QAbstractItemModel *model, QObject *parent)
     : QItemSelectionModel(model, parent),
       d(new FileSelectionModelPrivate(this))
 {
+    d->connectModel(model);
 }
 
 FileSelectionModel::~FileSelectionModel()
@@ -25,14 +27,17 @@ FileSelectionModel::~FileSelectionModel()
 
 bool FileSelectionModel::isSelected(const QModelIndex &index) const
 {
-    if (d->currentCommand != QItemSelectionModel::SelectionFlags(Current | Rows | ClearAndSelect))
-        return QItemSelectionModel::isSelected(index);
-
-    auto ret = std::any_of(d->selection.begin(), d->selection.end(), [index](const QItemSelectionRange &range) {
-        return range.contains(index);
-    });
+    // the rows only hold the first column of the root's children
+    if (!index.isValid() || index.column() != 0 || index.parent() != rowsParent()) {
+        if (d->currentCommand != QItemSelectionModel::SelectionFlags(Current | Rows | ClearAndSelect))
+            return QItemSelectionModel::isSelected(index);
+
+        return std::any_of(d->selection.begin(), d->selection.end(), [index](const QItemSelectionRange &range) {
+            return range.contains(index);
+        }) && (index.flags() & Qt::ItemIsSelectable);
+    }
 
-    if (ret) {
+    if (selectedRows().contains(index.row())) {
         Qt::ItemFlags flags = index.flags();
         return (flags & Qt::ItemIsSelectable);
     }
@@ -45,34 +50,56 @@ int FileSelectionModel::selectedCount() const
     if (d->currentCommand != QItemSelectionModel::SelectionFlags(Current | Rows | ClearAndSelect))
         return selectedIndexes().count();
 
-    bool selectionValid = d->firstSelectedIndex.isValid() && d->lastSelectedIndex.isValid();
-    return selectionValid ? (d->lastSelectedIndex.row() - d->firstSelectedIndex.row() + 1) : 0;
+    return selectedRows().count();
 }
 
 QModelIndexList FileSelectionModel::selectedIndexes() const
 {
-    if (d->selectedList.isEmpty()) {
-        if (d->currentCommand != QItemSelectionModel::SelectionFlags(Current | Rows | ClearAndSelect)) {
-            d->selectedList = QItemSelectionModel::selectedIndexes();
-        } else {
-            for (const QItemSelectionRange &range : d->selection) {
-                d->selectedList << range.indexes();
-            }
+    if (d->selectedList.isEmpty() && model()) {
+        const RowRangeSet &rows = selectedRows();
+        const QModelIndex &parent = rowsParent();
+        d->selectedList.reserve(rows.count());
+        for (int row : rows) {
+            const QModelIndex &index = model()->index(row, 0, parent);
+            // same as QItemSelectionRange::indexes
+            if ((index.flags() & (Qt::ItemIsSelectable | Qt::ItemIsEnabled)) == (Qt::ItemIsSelectable | Qt::ItemIsEnabled))
+                d->selectedList << index;
         }
-
-        auto isInVaildIndex = [=](const QModelIndex &index) {
-            return index.column() != 0;
-        };
-
-        d->selectedList.erase(std::remove_if(d->selectedList.begin(), d->selectedList.end(), isInVaildIndex),
-                              d->selectedList.end());
     }
     return d->selectedList;
 }
 
+/*!
+ * \brief FileSelectionModel::selectedRows
+ * \return the selected rows of the first column, it's rebuilt from the selection ranges after changes,
+ * so the cost is the count of ranges rather than the count of selected items
+ */
+const RowRangeSet &FileSelectionModel::selectedRows() const
+{
+    if (!d->selectedRowsValid) {
+        if (d->currentCommand != QItemSelectionModel::SelectionFlags(Current | Rows | ClearAndSelect))
+            d->selectedRows.reset(QItemSelectionModel::selection(), rowsParent());
+        else
+            d->selectedRows.reset(d->selection, rowsParent());
+        d->selectedRowsValid = true;
+    }
+
+    return d->selectedRows;
+}
+
+/*!
+ * \brief FileSelectionModel::rowsParent
+ * \return the root index of the model, all the files are its children
+ */
+QModelIndex FileSelectionModel::rowsParent() const
+{
+    return model() ? model()->index(0, 0) : QModelIndex();
+}
+
 void FileSelectionModel::clearSelectList()
 {
     d->selectedList.clear();
+    d->invalidateRows();
 }
 
 void FileSelectionModel::updateSelecteds()
@@ -92,6 +119,7 @@ void FileSelectionModel::select(const QItemSelection &selection, QItemSelectionM
             d->selectedList.clear();
 
         d->currentCommand = command;
+        d->invalidateRows();
 
         QItemSelectionModel::select(selection, command);
 
@@ -115,6 +143,7 @@ void FileSelectionModel::select(const QItemSelection &selection, QItemSelectionM
 
     d->currentCommand = command;
     d->selection = newSelection;
+    d->invalidateRows();
 
     d->timer.start(20);
 }
@@ -126,6 +155,7 @@ void FileSelectionModel::clear()
     d->selection.clear();
     d->firstSelectedIndex = QModelIndex();
     d->lastSelectedIndex = QModelIndex();
+    d->invalidateRows();
 
     QItemSelectionModel::clear();
 }
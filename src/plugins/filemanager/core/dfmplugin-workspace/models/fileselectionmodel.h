@@ -6,6 +6,7 @@
 #define FILESELECTIONMODEL_H
 
 #include "dfmplugin_workspace_global.h"
+#include "models/rowrangeset.h"
 
 #include <QItemSelectionModel>
 
@@ -24,6 +25,7 @@ public:
     bool isSelected(const QModelIndex &index) const;
     int selectedCount() const;
     QModelIndexList selectedIndexes() const;
+    const RowRangeSet &selectedRows() const;
     void clearSelectList();
 
 public slots:
@@ -34,6 +36,8 @@ public:
     void clear() override;
 
 private:
+    QModelIndex rowsParent() const;
+
     QScopedPointer<FileSelectionModelPrivate> d;
     Q_DECLARE_PRIVATE_D(d, FileSelectionModel)
 };
@@ -14,4 +14,29 @@ FileSelectionModelPrivate::FileSelectionModelPrivate(FileSelectionModel *qq)
 {
     timer.setSingleShot(true);
     QObject::connect(&timer, &QTimer::timeout, q, &FileSelectionModel::updateSelecteds);
+
+    QObject::connect(q, &QItemSelectionModel::selectionChanged, this, &FileSelectionModelPrivate::invalidateRows);
+    QObject::connect(q, &QItemSelectionModel::modelChanged, this, &FileSelectionModelPrivate::connectModel);
+}
+
+/*!
+ * \brief FileSelectionModelPrivate::connectModel, the selected rows are moved by the persistent indexes
+ * of the selection while rows are inserted, removed or sorted, so the row ranges are rebuilt then
+ */
+void FileSelectionModelPrivate::connectModel(QAbstractItemModel *model)
+{
+    invalidateRows();
+    if (!model)
+        return;
+
+    QObject::connect(model, &QAbstractItemModel::rowsInserted, this, &FileSelectionModelPrivate::invalidateRows, Qt::UniqueConnection);
+    QObject::connect(model, &QAbstractItemModel::rowsRemoved, this, &FileSelectionModelPrivate::invalidateRows, Qt::UniqueConnection);
+    QObject::connect(model, &QAbstractItemModel::rowsMoved, this, &FileSelectionModelPrivate::invalidateRows, Qt::UniqueConnection);
+    QObject::connect(model, &QAbstractItemModel::layoutChanged, this, &FileSelectionModelPrivate::invalidateRows, Qt::UniqueConnection);
+    QObject::connect(model, &QAbstractItemModel::modelReset, this, &FileSelectionModelPrivate::invalidateRows, Qt::UniqueConnection);
+}
+
+void FileSelectionModelPrivate::invalidateRows()
+{
+    selectedRowsValid = false;
 }
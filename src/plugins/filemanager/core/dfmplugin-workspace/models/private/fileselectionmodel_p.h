@@ -19,7 +19,12 @@ class FileSelectionModelPrivate : public QObject
 
 public:
     explicit FileSelectionModelPrivate(FileSelectionModel *qq);
+    void connectModel(QAbstractItemModel *model);
+    void invalidateRows();
+
     mutable QModelIndexList selectedList;
+    mutable RowRangeSet selectedRows;
+    mutable bool selectedRowsValid { false };
     QItemSelection selection;
     QModelIndex firstSelectedIndex;
     QModelIndex lastSelectedIndex;
@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "rowrangeset.h"
+
+#include <algorithm>
+
+using namespace dfmplugin_workspace;
+
+RowRangeSet::const_iterator::const_iterator(const QVector<Range> *ranges, int rangeIndex)
+    : ranges(ranges), rangeIndex(rangeIndex)
+{
+    if (rangeIndex < ranges->size())
+        row = ranges->at(rangeIndex).first;
+}
+
+RowRangeSet::const_iterator &RowRangeSet::const_iterator::operator++()
+{
+    if (row < ranges->at(rangeIndex).second) {
+        ++row;
+        return *this;
+    }
+
+    ++rangeIndex;
+    row = rangeIndex < ranges->size() ? ranges->at(rangeIndex).first : -1;
+    return *this;
+}
+
+/*!
+ * \brief RowRangeSet::reset, only the ranges which cover the first column of the children of parent are taken,
+ * that's the same as the selected indexes of the views
+ */
+void RowRangeSet::reset(const QItemSelection &selection, const QModelIndex &parent)
+{
+    rangeList.clear();
+    rangeList.reserve(selection.size());
+    for (const QItemSelectionRange &range : selection) {
+        if (!range.isValid() || range.parent() != parent || range.left() > 0)
+            continue;
+        rangeList.append({ range.top(), range.bottom() });
+    }
+
+    mergeRanges();
+}
+
+void RowRangeSet::reset(const QVector<int> &rows)
+{
+    rangeList.clear();
+    rangeList.reserve(rows.size());
+    for (int row : rows) {
+        if (row >= 0)
+            rangeList.append({ row, row });
+    }
+
+    mergeRanges();
+}
+
+void RowRangeSet::clear()
+{
+    rangeList.clear();
+    rowCount = 0;
+    bitmap.clear();
+    bitmapValid = false;
+}
+
+bool RowRangeSet::contains(int row) const
+{
+    if (row < 0 || rangeList.isEmpty() || row > rangeList.last().second)
+        return false;
+
+    if (!bitmapValid) {
+        bitmap.fill(false, rangeList.last().second + 1);
+        for (const Range &range : rangeList)
+            bitmap.fill(true, range.first, range.second + 1);
+        bitmapValid = true;
+    }
+
+    return bitmap.testBit(row);
+}
+
+bool RowRangeSet::intersects(int first, int last) const
+{
+    // the first range which ends at or after `first`
+    auto it = std::lower_bound(rangeList.cbegin(), rangeList.cend(), first, [](const Range &range, int row) {
+        return range.second < row;
+    });
+
+    return it != rangeList.cend() && it->first <= last;
+}
+
+void RowRangeSet::mergeRanges()
+{
+    std::sort(rangeList.begin(), rangeList.end());
+
+    QVector<Range> merged;
+    merged.reserve(rangeList.size());
+    for (const Range &range : rangeList) {
+        if (!merged.isEmpty() && range.first <= merged.last().second + 1)
+            merged.last().second = qMax(merged.last().second, range.second);
+        else
+            merged.append(range);
+    }
+
+    rangeList = merged;
+    rowCount = 0;
+    for (const Range &range : rangeList)
+        rowCount += range.second - range.first + 1;
+
+    bitmap.clear();
+    bitmapValid = false;
+}
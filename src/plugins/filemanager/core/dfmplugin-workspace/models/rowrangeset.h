@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ROWRANGESET_H
+#define ROWRANGESET_H
+
+#include "dfmplugin_workspace_global.h"
+
+#include <QBitArray>
+#include <QItemSelection>
+#include <QVector>
+
+namespace dfmplugin_workspace {
+
+/*!
+ * \brief The RowRangeSet class holds selected rows as sorted and merged intervals.
+ * Counting costs O(ranges), contains is O(1) through a bitmap which is built on first use,
+ * and rows are iterated lazily without creating any QModelIndex.
+ */
+class RowRangeSet
+{
+public:
+    using Range = QPair<int, int>;   // first and last row
+
+    class const_iterator
+    {
+    public:
+        const_iterator(const QVector<Range> *ranges, int rangeIndex);
+        int operator*() const { return row; }
+        const_iterator &operator++();
+        bool operator==(const const_iterator &other) const { return rangeIndex == other.rangeIndex && row == other.row; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+    private:
+        const QVector<Range> *ranges { nullptr };
+        int rangeIndex { 0 };
+        int row { -1 };
+    };
+
+    void reset(const QItemSelection &selection, const QModelIndex &parent);
+    void reset(const QVector<int> &rows);
+    void clear();
+
+    bool isEmpty() const { return rangeList.isEmpty(); }
+    int count() const { return rowCount; }
+    bool contains(int row) const;
+    bool intersects(int first, int last) const;
+    const QVector<Range> &ranges() const { return rangeList; }
+
+    const_iterator begin() const { return const_iterator(&rangeList, 0); }
+    const_iterator end() const { return const_iterator(&rangeList, rangeList.size()); }
+
+private:
+    void mergeRanges();
+
+    QVector<Range> rangeList;
+    int rowCount { 0 };
+    mutable QBitArray bitmap;
+    mutable bool bitmapValid { false };
+};
+
+}
+
+#endif   // ROWRANGESET_H
@@ -10,6 +10,7 @@
 #include <dfm-base/utils/fileinfohelper.h>
 #include <dfm-base/base/standardpaths.h>
 #include <dfm-base/utils/universalutils.h>
+#include <dfm-base/mimetype/dmimedatabase.h>
 #include "workspacehelper.h"
 
 #include <dfm-io/dfmio_utils.h>
@@ -134,7 +135,7 @@ void FileSortWorker::cancel()
 int FileSortWorker::getChildShowIndex(const QUrl &url)
 {
     QReadLocker lk(&locker);
-    return visibleChildren.indexOf(url);
+    return visibleIndexOf(url);
 }
 
 QList<QUrl> FileSortWorker::getChildrenUrls()
@@ -337,9 +338,9 @@ void FileSortWorker::handleWatcherRemoveChildren(const QList<SortInfoPointer> &c
         int showIndex = -1;
         {
             QReadLocker lk(&locker);
-            if (!visibleChildren.contains(sortInfo->fileUrl()))
+            showIndex = visibleIndexOf(sortInfo->fileUrl());
+            if (showIndex < 0)
                 continue;
-            showIndex = visibleChildren.indexOf(sortInfo->fileUrl());
         }
 
         Q_EMIT removeRows(showIndex, 1);
@@ -347,6 +348,7 @@ void FileSortWorker::handleWatcherRemoveChildren(const QList<SortInfoPointer> &c
         {
             QWriteLocker lk(&locker);
             visibleChildren.removeAt(showIndex);
+            visibleChildrenChanged(showIndex);
         }
     }
     if (removed)
@@ -469,8 +471,8 @@ bool FileSortWorker::handleUpdateFile(const QUrl &url)
     int childIndex = -1;
     {
         QReadLocker lk(&locker);
-        childVisible = visibleChildren.contains(url);
-        childIndex = visibleChildren.indexOf(url);
+        childIndex = visibleIndexOf(url);
+        childVisible = childIndex >= 0;
     }
 
     if (childVisible) {
@@ -479,6 +481,7 @@ bool FileSortWorker::handleUpdateFile(const QUrl &url)
             {
                 QWriteLocker lk(&locker);
                 visibleChildren.removeAt(childIndex);
+                visibleChildrenChanged(childIndex);
             }
             Q_EMIT removeFinish();
             return false;
@@ -529,6 +532,7 @@ bool FileSortWorker::handleUpdateFile(const QUrl &url)
         {
             QWriteLocker lk(&locker);
             visibleChildren.insert(showIndex, sortInfo->fileUrl());
+            visibleChildrenChanged(showIndex);
         }
         added = true;
 
@@ -562,6 +566,7 @@ void FileSortWorker::handleRefresh()
     {
         QWriteLocker lk(&locker);
         visibleChildren.clear();
+        visibleChildrenChanged(0);
     }
     children.clear();
     visibleTreeChildren.clear();
@@ -902,6 +907,7 @@ void FileSortWorker::filterTreeDirFiles(const QUrl &parent, const bool byInfo)
             Q_EMIT removeRows(0, visibleChildren.count());
             QWriteLocker lk(&locker);
             visibleChildren.clear();
+            visibleChildrenChanged(0);
             Q_EMIT removeFinish();
         }
         return;
@@ -982,6 +988,7 @@ bool FileSortWorker::addChild(const SortInfoPointer &sortInfo,
     {
         QWriteLocker lk(&locker);
         visibleChildren.insert(showIndex, sortInfo->fileUrl());
+        visibleChildrenChanged(showIndex);
     }
 
     if (sort == AbstractSortFilter::SortScenarios::kSortScenariosWatcherAddFile)
@@ -1120,6 +1127,10 @@ QList<QUrl> FileSortWorker::sortTreeFiles(const QList<QUrl> &children, const boo
         return children;
     }
 
+    // the mimetypes are compared many times while sorting, look them up for the whole directory at once
+    if (orgSortRole == Global::ItemRoles::kItemFileMimeTypeRole && !reverse && children.first().isLocalFile())
+        DMimeDatabase().mimeTypesForFiles(children);
+
     QList<QUrl> sortList;
     int sortIndex = 0;
     QMap<QUrl, SortInfoPointer> sortInfos = reverse && !isMixDirAndFile ? this->children.value(parentUrl)
@@ -1290,6 +1301,7 @@ void FileSortWorker::removeVisibleChildren(const int startPos, const int size)
 
         QWriteLocker lk(&locker);
         visibleChildren = visibleList;
+        visibleChildrenChanged(startPos);
     }
 
     Q_EMIT removeFinish();
@@ -1637,7 +1649,55 @@ int FileSortWorker::findRealShowIndex(const QUrl &preItemUrl)
 int FileSortWorker::indexOfVisibleChild(const QUrl &itemUrl)
 {
     QReadLocker lk(&locker);
-    return visibleChildren.indexOf(itemUrl);
+    return visibleIndexOf(itemUrl);
+}
+
+/*!
+ * \brief FileSortWorker::visibleIndexOf, find the row of url by the index of visible children,
+ * the index is extended from the first changed row on demand, so appending keeps it valid,
+ * and a burst of lookups between two changes costs one pass at most.
+ * The locker must be held by the caller.
+ */
+int FileSortWorker::visibleIndexOf(const QUrl &url)
+{
+    QMutexLocker lk(&visibleIndexesLocker);
+
+    // an entry is trusted only if its row has not been changed since it was indexed
+    auto isIndexed = [this, &url](int row) {
+        return row >= 0 && row < visibleIndexesValidRows && visibleChildren.at(row) == url;
+    };
+
+    int row = visibleIndexes.value(url, -1);
+    if (isIndexed(row))
+        return row;
+
+    if (visibleIndexesValidRows == 0)
+        visibleIndexes.clear();
+
+    const int count = visibleChildren.count();
+    while (visibleIndexesValidRows < count) {
+        const QUrl &child = visibleChildren.at(visibleIndexesValidRows);
+        visibleIndexes.insert(child, visibleIndexesValidRows);
+        ++visibleIndexesValidRows;
+        if (child == url)
+            return visibleIndexesValidRows - 1;
+    }
+
+    return -1;
+}
+
+/*!
+ * \brief FileSortWorker::visibleChildrenChanged, the rows from fromRow on were inserted, removed or moved,
+ * the write lock of locker must be held by the caller
+ */
+void FileSortWorker::visibleChildrenChanged(const int fromRow)
+{
+    visibleIndexesValidRows = qMax(0, qMin(visibleIndexesValidRows, fromRow));
+    // drop the removed urls now and then
+    if (visibleIndexesValidRows == 0 || visibleIndexes.size() > 2 * visibleChildren.count() + 1024) {
+        visibleIndexes.clear();
+        visibleIndexesValidRows = 0;
+    }
 }
 
 int FileSortWorker::setVisibleChildren(const int startPos, const QList<QUrl> &filterUrls, const FileSortWorker::InsertOpt opt, const int endPos)
@@ -1661,6 +1721,7 @@ int FileSortWorker::setVisibleChildren(const int startPos, const QList<QUrl> &fi
 
     QWriteLocker lk(&locker);
     visibleChildren = visibleList;
+    visibleChildrenChanged(opt == InsertOpt::kInsertOptForce ? 0 : startPos);
 
     return visibleList.length();
 }
@@ -19,6 +19,7 @@
 #include <QObject>
 #include <QDirIterator>
 #include <QReadWriteLock>
+#include <QMutex>
 #include <QMultiMap>
 
 using namespace dfmbase;
@@ -199,6 +200,8 @@ private:
     int8_t getDepth(const QUrl &url);
     int findRealShowIndex(const QUrl &preItemUrl);
     int indexOfVisibleChild(const QUrl &itemUrl);
+    int visibleIndexOf(const QUrl &url);
+    void visibleChildrenChanged(const int fromRow);
     int setVisibleChildren(const int startPos, const QList<QUrl> &filterUrls,
                             const InsertOpt opt = InsertOpt::kInsertOptAppend, const int endPos = -1);
 
@@ -213,6 +216,9 @@ private:
     QMap<QUrl, FileItemDataPointer> childrenDataLastMap {};
     QList<QUrl> visibleChildren {};
     QReadWriteLock locker;
+    QHash<QUrl, int> visibleIndexes {};   // url -> row, trusted for the rows before visibleIndexesValidRows
+    int visibleIndexesValidRows { 0 };
+    QMutex visibleIndexesLocker;   // lookups extend the index under the read lock
     AbstractSortFilterPointer sortAndFilter { nullptr };
     FileViewFilterCallback filterCallback { nullptr };
     QVariant filterData;
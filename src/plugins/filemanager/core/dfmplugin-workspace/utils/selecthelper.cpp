@@ -110,8 +110,9 @@ bool SelectHelper::select(const QList<QUrl> &urls)
     QModelIndex lastIndex;
     const QModelIndex &root = view->rootIndex();
     view->selectionModel()->clearSelection();
-    QList<QModelIndex> indexes {};
-    QItemSelection selection;
+    // merge the rows into ranges at once, QItemSelection::merge for each url is quadratic
+    QVector<int> rows;
+    rows.reserve(urls.size());
     for (const QUrl &url : urls) {
         const QModelIndex &index = view->model()->getIndexByUrl(url);
 
@@ -119,7 +120,7 @@ bool SelectHelper::select(const QList<QUrl> &urls)
             continue;
         }
 
-        selection.merge(QItemSelection(index, index), QItemSelectionModel::Select);
+        rows.append(index.row());
 
         if (!firstIndex.isValid())
             firstIndex = index;
@@ -127,7 +128,14 @@ bool SelectHelper::select(const QList<QUrl> &urls)
         lastIndex = index;
     }
 
-    if (selection.indexes().isEmpty())
+    RowRangeSet rowRanges;
+    rowRanges.reset(rows);
+    QItemSelection selection;
+    for (const RowRangeSet::Range &range : rowRanges.ranges())
+        selection.append(QItemSelectionRange(view->model()->index(range.first, 0, root),
+                                             view->model()->index(range.second, 0, root)));
+
+    if (selection.isEmpty())
         return false;
 
     view->selectionModel()->select(selection, QItemSelectionModel::Select);
@@ -1279,7 +1279,7 @@ void FileView::mousePressEvent(QMouseEvent *event)
 
         if (!isEmptyArea) {
             const QModelIndex &index = indexAt(event->pos());
-            if (selectedIndexes().isEmpty() || !selectedIndexes().contains(index)) {
+            if (!isSelected(index)) {
                 setCurrentIndex(index);
             }
         }
@@ -1813,17 +1813,17 @@ void FileView::currentChanged(const QModelIndex &current, const QModelIndex &pre
 
 void FileView::rowsAboutToBeRemoved(const QModelIndex &parent, int start, int end)
 {
-    QModelIndex currentIdx = currentIndex();
-    for (const QModelIndex &index : selectedIndexes()) {
-        if (index.parent() != parent)
-            continue;
+    // the selected rows only hold the root's children
+    const RowRangeSet &selectedRows = static_cast<FileSelectionModel *>(selectionModel())->selectedRows();
+    if (parent == rootIndex() && selectedRows.intersects(start, end)) {
+        const QModelIndex &currentIdx = currentIndex();
+        bool currentRemoved = currentIdx.isValid() && currentIdx.parent() == parent
+                && currentIdx.row() >= start && currentIdx.row() <= end && isSelected(currentIdx);
 
-        if (index.row() >= start && index.row() <= end) {
-            selectionModel()->select(index, QItemSelectionModel::Clear);
-            if (index == currentIdx) {
-                clearSelection();
-                setCurrentIndex(QModelIndex());
-            }
+        selectionModel()->select(model()->index(start, 0, parent), QItemSelectionModel::Clear);
+        if (currentRemoved) {
+            clearSelection();
+            setCurrentIndex(QModelIndex());
         }
     }
 
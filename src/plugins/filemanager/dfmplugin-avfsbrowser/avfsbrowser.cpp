@@ -7,6 +7,7 @@
 #include "files/avfsfilewatcher.h"
 #include "files/avfsfileiterator.h"
 #include "utils/avfsutils.h"
+#include "utils/archiveindex.h"
 #include "menu/avfsmenuscene.h"
 #include "events/avfseventhandler.h"
 
@@ -18,6 +19,8 @@
 #include <dfm-base/base/application/settings.h>
 
 #include <QDebug>
+#include <QTimer>
+#include <QtConcurrent>
 
 Q_DECLARE_METATYPE(QList<QUrl> *)
 Q_DECLARE_METATYPE(QList<QVariantMap> *);
@@ -27,6 +30,8 @@ DFM_LOG_REISGER_CATEGORY(DPAVFSBROWSER_NAMESPACE)
 
 DFMBASE_USE_NAMESPACE
 
+static constexpr int kEvictCacheDelay { 10000 };   // msecs
+
 void AvfsBrowser::initialize()
 {
     UrlRoute::regScheme(AvfsUtils::scheme(), "/", {}, true);
@@ -55,6 +60,9 @@ bool AvfsBrowser::start()
     beMySubScene("SortAndDisplayMenu");   //  yours last second but it's mine now
     beMySubScene("OpenWithMenu");   //  yours last second but it's mine now
 
+    // the archive cache is swept once the window is up
+    QTimer::singleShot(kEvictCacheDelay, this, [] { QtConcurrent::run(&ArchiveIndex::evictCache); });
+
     return true;
 }
 
@@ -8,13 +8,23 @@
 #include <dfm-base/dfm_event_defines.h>
 #include <dfm-base/file/local/localfilehandler.h>
 #include <dfm-base/utils/clipboard.h>
+#include <dfm-base/widgets/filemanagerwindowsmanager.h>
 
 #include <dfm-io/dfileinfo.h>
 
 #include <dfm-framework/event/event.h>
 
+#include <DDialog>
+#include <DProgressBar>
+
+#include <QTimer>
+
 using namespace dfmplugin_avfsbrowser;
 DFMBASE_USE_NAMESPACE
+DWIDGET_USE_NAMESPACE
+
+// the dialog is not shown for the files extracted at once
+static constexpr int kProgressDialogDelay { 500 };   // msecs
 
 AvfsEventHandler *AvfsEventHandler::instance()
 {
@@ -29,11 +39,17 @@ bool AvfsEventHandler::hookOpenFiles(quint64 winId, const QList<QUrl> &urls)
 
     bool takeHandle = false;
     QList<QUrl> archives, others;
+    QList<ArchiveExtractor::Task> extractions;
     for (auto url : urls) {
         if (url.scheme() != Global::Scheme::kFile && url.scheme() != AvfsUtils::scheme())
             return false;
         if (url.scheme() == AvfsUtils::scheme()) {
             takeHandle = true;
+            ArchiveExtractor::Task task;
+            if (ArchiveExtractor::prepare(url, &task)) {
+                extractions << task;
+                continue;
+            }
             url = AvfsUtils::avfsUrlToLocal(url);
         }
 
@@ -55,6 +71,9 @@ bool AvfsEventHandler::hookOpenFiles(quint64 winId, const QList<QUrl> &urls)
     if (archives.count() > 0)
         openArchivesAsDir(winId, archives);
 
+    if (extractions.count() > 0)
+        extractAndOpen(winId, extractions);
+
     if (others.count() > 0) {
         LocalFileHandler handler;
         bool ok = std::all_of(others.cbegin(), others.cend(), [&](const QUrl &u) { return handler.openFile({ u }); });
@@ -95,6 +114,43 @@ void AvfsEventHandler::openArchivesAsDir(quint64 winId, const QList<QUrl> &urls)
     }
 }
 
+/*!
+ * \brief AvfsEventHandler::extractAndOpen extract the files of the indexed archives in a worker
+ * and open them, a compressed archive may be read up to its end, so a dialog shows the progress
+ * and cancels the extraction if it takes long
+ */
+void AvfsEventHandler::extractAndOpen(quint64 winId, const QList<ArchiveExtractor::Task> &tasks)
+{
+    ArchiveExtractor *extractor = new ArchiveExtractor(this);
+
+    DDialog *dialog = new DDialog(FMWindowsIns.findWindowById(winId));
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setTitle(QObject::tr("Extracting files from the archive"));
+    DProgressBar *progressBar = new DProgressBar(dialog);
+    progressBar->setRange(0, 100);
+    progressBar->setValue(0);
+    progressBar->setMaximumHeight(8);
+    dialog->addContent(progressBar);
+    dialog->addButton(QObject::tr("Cancel", "button"));
+
+    connect(extractor, &ArchiveExtractor::progressChanged, progressBar, &DProgressBar::setValue);
+    // the dialog is closed by its button as well
+    connect(dialog, &DDialog::finished, extractor, &ArchiveExtractor::cancel);
+    connect(extractor, &ArchiveExtractor::finished, dialog, &DDialog::close);
+    connect(extractor, &ArchiveExtractor::finished, this, [](const QList<QUrl> &extracted, bool canceled) {
+        if (canceled || extracted.isEmpty())
+            return;
+
+        LocalFileHandler handler;
+        bool ok = std::all_of(extracted.cbegin(), extracted.cend(), [&](const QUrl &u) { return handler.openFile({ u }); });
+        if (!ok)
+            fmWarning() << "open files failed: " << extracted;
+    });
+    QTimer::singleShot(kProgressDialogDelay, dialog, &DDialog::show);
+
+    extractor->start(tasks);
+}
+
 void AvfsEventHandler::writeToClipbord(quint64 winId, const QList<QUrl> &urls)
 {
     dpfSignalDispatcher->publish(GlobalEventType::kWriteUrlsToClipboard, winId, ClipBoard::kCopyAction, urls);
@@ -6,6 +6,7 @@
 #define AVFSEVENTHANDLER_H
 
 #include "dfmplugin_avfsbrowser_global.h"
+#include "utils/archiveextractor.h"
 
 #include <QUrl>
 #include <QList>
@@ -28,6 +29,9 @@ public:
     void openArchivesAsDir(quint64 winId, const QList<QUrl> &urls);
     void writeToClipbord(quint64 winId, const QList<QUrl> &urls);
     void showProperty(const QList<QUrl> &urls);
+
+private:
+    void extractAndOpen(quint64 winId, const QList<ArchiveExtractor::Task> &tasks);
 };
 
 }
@@ -8,6 +8,8 @@
 #include <dfm-base/base/schemefactory.h>
 #include <dfm-base/interfaces/private/fileinfo_p.h>
 
+#include <QDateTime>
+
 using namespace dfmplugin_avfsbrowser;
 DFMBASE_USE_NAMESPACE
 
@@ -15,6 +17,13 @@ AvfsFileInfo::AvfsFileInfo(const QUrl &url)
     : ProxyFileInfo(url)
 {
     setProxy(InfoFactory::create<FileInfo>(AvfsUtils::avfsUrlToLocal(url)));
+
+    QString archivePath;
+    QString innerPath;
+    if (ArchiveIndex::splitAvfsPath(url.path(), &archivePath, &innerPath)) {
+        if (auto index = ArchiveIndex::cached(archivePath))
+            entry = index->entry(innerPath);
+    }
 }
 
 AvfsFileInfo::~AvfsFileInfo()
@@ -42,3 +51,55 @@ bool AvfsFileInfo::canAttributes(const FileInfo::FileCanType type) const
         return ProxyFileInfo::canAttributes(type);
     }
 }
+
+bool AvfsFileInfo::exists() const
+{
+    return entry.isValid() || ProxyFileInfo::exists();
+}
+
+bool AvfsFileInfo::isAttributes(const FileInfo::FileIsType type) const
+{
+    if (!entry.isValid())
+        return ProxyFileInfo::isAttributes(type);
+
+    switch (type) {
+    case FileIsType::kIsDir:
+        return entry.isDir();
+    case FileIsType::kIsFile:
+        return !entry.isDir() && !entry.isSymLink();
+    case FileIsType::kIsSymLink:
+        return entry.isSymLink();
+    case FileIsType::kIsReadable:
+        return true;
+    case FileIsType::kIsWritable:
+        return false;
+    case FileIsType::kIsHidden:
+        return entry.fileName().startsWith('.');
+    default:
+        return ProxyFileInfo::isAttributes(type);
+    }
+}
+
+qint64 AvfsFileInfo::size() const
+{
+    if (!entry.isValid())
+        return ProxyFileInfo::size();
+    return entry.isDir() ? 0 : entry.size;
+}
+
+QVariant AvfsFileInfo::timeOf(const FileInfo::FileTimeType type) const
+{
+    if (!entry.isValid())
+        return ProxyFileInfo::timeOf(type);
+
+    switch (type) {
+    case FileTimeType::kLastModified:
+        return QDateTime::fromSecsSinceEpoch(entry.modifyTime);
+    case FileTimeType::kLastModifiedSecond:
+        return entry.modifyTime;
+    case FileTimeType::kLastModifiedMSecond:
+        return 0;   // the microseconds, the index keeps seconds
+    default:
+        return ProxyFileInfo::timeOf(type);
+    }
+}
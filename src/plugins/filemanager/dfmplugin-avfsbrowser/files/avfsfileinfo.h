@@ -6,6 +6,7 @@
 #define AVFSFILEINFO_H
 
 #include "dfmplugin_avfsbrowser_global.h"
+#include "utils/archiveindex.h"
 
 #include <dfm-base/interfaces/proxyfileinfo.h>
 
@@ -19,6 +20,14 @@ public:
 
     virtual QUrl urlOf(const FileUrlInfoType type) const override;
     virtual bool canAttributes(const FileCanType type) const override;
+    virtual bool exists() const override;
+    virtual bool isAttributes(const FileIsType type) const override;
+    virtual qint64 size() const override;
+    virtual QVariant timeOf(const FileTimeType type) const override;
+
+private:
+    // the entry in the open index of the archive, the metadata is not read through avfs then
+    ArchiveIndex::Entry entry;
 };
 
 }   // namespace dfmplugin_avfsbrowser
@@ -8,13 +8,17 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 using namespace dfmplugin_avfsbrowser;
 DFMBASE_USE_NAMESPACE
 
 AvfsFileIterator::AvfsFileIterator(const QUrl &url, const QStringList &nameFilters, QDir::Filters filters, QDirIterator::IteratorFlags flags)
     : AbstractDirIterator(AvfsUtils::avfsUrlToLocal(url), nameFilters, filters, flags), d(new AvfsFileIteratorPrivate(url, this))
 {
-    d->proxy = new LocalDirIterator(AvfsUtils::avfsUrlToLocal(url), nameFilters, filters, flags);
+    d->nameFilters = nameFilters;
+    d->filters = filters;
+    d->flags = flags;
 }
 
 AvfsFileIterator::~AvfsFileIterator()
@@ -32,24 +36,82 @@ AvfsFileIteratorPrivate::~AvfsFileIteratorPrivate()
         delete proxy;
 }
 
+/*!
+ * \brief AvfsFileIteratorPrivate::init list the archive from its index, the iterator is created
+ * in the main thread but iterated in a worker, so the archive is indexed on the first call
+ */
+void AvfsFileIteratorPrivate::init()
+{
+    if (initialized)
+        return;
+    initialized = true;
+
+    QString innerPath;
+    if (ArchiveIndex::splitAvfsPath(root.path(), &archivePath, &innerPath))
+        index = ArchiveIndex::open(archivePath);
+
+    if (index && index->entry(innerPath).isDir()) {
+        const auto &entries = index->children(innerPath);
+        children.reserve(entries.size());
+        std::copy_if(entries.cbegin(), entries.cend(), std::back_inserter(children),
+                     [this](const ArchiveIndex::Entry &entry) { return accepted(entry); });
+        return;
+    }
+
+    index.reset();
+    proxy = new LocalDirIterator(AvfsUtils::avfsUrlToLocal(root), nameFilters, filters, flags);
+}
+
+bool AvfsFileIteratorPrivate::accepted(const ArchiveIndex::Entry &entry) const
+{
+    const QString &name = entry.fileName();
+    if (filters != QDir::NoFilter) {
+        if (!filters.testFlag(QDir::Hidden) && name.startsWith('.'))
+            return false;
+        if (!filters.testFlag(QDir::Dirs) && !filters.testFlag(QDir::AllDirs) && entry.isDir())
+            return false;
+        if (!filters.testFlag(QDir::Files) && !entry.isDir())
+            return false;
+    }
+    return nameFilters.isEmpty() || QDir::match(nameFilters, name);
+}
+
 QUrl AvfsFileIterator::next()
 {
-    return AvfsUtils::localUrlToAvfsUrl(d->proxy->next());
+    d->init();
+    if (d->proxy)
+        return AvfsUtils::localUrlToAvfsUrl(d->proxy->next());
+
+    if (d->current + 1 >= d->children.size())
+        return QUrl();
+    ++d->current;
+    return fileUrl();
 }
 
 bool AvfsFileIterator::hasNext() const
 {
-    return d->proxy->hasNext();
+    d->init();
+    if (d->proxy)
+        return d->proxy->hasNext();
+    return d->current + 1 < d->children.size();
 }
 
 QString AvfsFileIterator::fileName() const
 {
-    return d->proxy->fileName();
+    if (d->proxy)
+        return d->proxy->fileName();
+    if (d->current < 0 || d->current >= d->children.size())
+        return QString();
+    return d->children.at(d->current).fileName();
 }
 
 QUrl AvfsFileIterator::fileUrl() const
 {
-    return AvfsUtils::localUrlToAvfsUrl(d->proxy->fileUrl());
+    if (d->proxy)
+        return AvfsUtils::localUrlToAvfsUrl(d->proxy->fileUrl());
+    if (d->current < 0 || d->current >= d->children.size())
+        return QUrl();
+    return AvfsUtils::makeAvfsUrl(d->archivePath + "#/" + d->children.at(d->current).path);
 }
 
 const FileInfoPointer AvfsFileIterator::fileInfo() const
@@ -6,6 +6,7 @@
 #define AVFSFILEITERATOR_P_H
 
 #include "dfmplugin_avfsbrowser_global.h"
+#include "utils/archiveindex.h"
 
 #include <dfm-base/file/local/localdiriterator.h>
 
@@ -22,9 +23,25 @@ public:
     explicit AvfsFileIteratorPrivate(const QUrl &root, AvfsFileIterator *qq);
     ~AvfsFileIteratorPrivate();
 
+private:
+    void init();
+    bool accepted(const ArchiveIndex::Entry &entry) const;
+
 private:
     AvfsFileIterator *q { nullptr };
     QUrl root;
+    QStringList nameFilters;
+    QDir::Filters filters { QDir::NoFilter };
+    QDirIterator::IteratorFlags flags { QDirIterator::NoIteratorFlags };
+    bool initialized { false };
+
+    // the archives listed from their index
+    QSharedPointer<ArchiveIndex> index;
+    QString archivePath;
+    QVector<ArchiveIndex::Entry> children;
+    int current { -1 };
+
+    // the others through the avfs mount
     dfmbase::LocalDirIterator *proxy { nullptr };
 };
 
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "archiveextractor.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent>
+
+using namespace dfmplugin_avfsbrowser;
+
+ArchiveExtractor::ArchiveExtractor(QObject *parent)
+    : QObject(parent)
+{
+}
+
+/*!
+ * \brief ArchiveExtractor::prepare find a file of an indexed archive, never reads the archive
+ * \return false if the file is not in an index
+ */
+bool ArchiveExtractor::prepare(const QUrl &avfsUrl, Task *task)
+{
+    Q_ASSERT(task);
+
+    QString archivePath, innerPath;
+    if (!ArchiveIndex::splitAvfsPath(avfsUrl.path(), &archivePath, &innerPath))
+        return false;
+
+    const auto &index = ArchiveIndex::cached(archivePath);
+    if (!index)
+        return false;
+    const ArchiveIndex::Entry &entry = index->entry(innerPath);
+    if (!entry.isValid() || entry.isDir() || entry.isSymLink())
+        return false;
+
+    const QString &targetDir = ArchiveIndex::extractedDirOf(archivePath);
+    const QString &targetFile = QDir::cleanPath(targetDir + "/" + entry.path);
+    if (!targetFile.startsWith(targetDir + "/"))   // a member named with '..'
+        return false;
+
+    task->index = index;
+    task->innerPath = innerPath;
+    task->targetFile = targetFile;
+    return true;
+}
+
+/*!
+ * \brief ArchiveExtractor::start extract the files of \a tasks in the global thread pool,
+ * progressChanged is emitted as the whole of the tasks advances
+ */
+void ArchiveExtractor::start(const QList<Task> &tasks)
+{
+    QtConcurrent::run([this, tasks]() {
+        QList<QUrl> extracted;
+        int lastPercent = -1;
+        for (int i = 0; i < tasks.size() && !canceled; ++i) {
+            const Task &task = tasks.at(i);
+            auto progress = [this, i, &tasks, &lastPercent](qint64 done, qint64 total) {
+                const double part = total > 0 ? qBound(0.0, double(done) / total, 1.0) : 0.0;
+                const int percent = static_cast<int>((i + part) * 100 / tasks.size());
+                if (percent != lastPercent) {
+                    lastPercent = percent;
+                    emit progressChanged(percent);
+                }
+                return !canceled;
+            };
+
+            if (!QDir().mkpath(QFileInfo(task.targetFile).absolutePath())
+                || !task.index->extract(task.innerPath, task.targetFile, progress)) {
+                if (!canceled)
+                    fmWarning() << "extract from archive index failed:" << task.index->archivePath() << task.innerPath;
+                continue;
+            }
+            extracted << QUrl::fromLocalFile(task.targetFile);
+        }
+
+        QMetaObject::invokeMethod(this, [this, extracted]() {
+            emit finished(extracted, canceled);
+            deleteLater();
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ArchiveExtractor::cancel()
+{
+    canceled = true;
+}
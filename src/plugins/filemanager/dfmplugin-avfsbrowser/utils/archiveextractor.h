@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ARCHIVEEXTRACTOR_H
+#define ARCHIVEEXTRACTOR_H
+
+#include "dfmplugin_avfsbrowser_global.h"
+#include "archiveindex.h"
+
+#include <QObject>
+#include <QUrl>
+
+#include <atomic>
+
+namespace dfmplugin_avfsbrowser {
+
+/*!
+ * \brief The ArchiveExtractor class extracts the files of the indexed archives to the cache
+ * in a worker thread, so that they are opened without the archive read through the avfs mount.
+ * It is used once and deletes itself after finished.
+ */
+class ArchiveExtractor : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ArchiveExtractor)
+
+public:
+    struct Task
+    {
+        QSharedPointer<ArchiveIndex> index;
+        QString innerPath;
+        QString targetFile;
+    };
+
+    explicit ArchiveExtractor(QObject *parent = nullptr);
+
+    static bool prepare(const QUrl &avfsUrl, Task *task);
+    void start(const QList<Task> &tasks);
+    void cancel();
+
+Q_SIGNALS:
+    void progressChanged(int percent);
+    void finished(const QList<QUrl> &extracted, bool canceled);
+
+private:
+    std::atomic_bool canceled { false };
+};
+
+}
+
+#endif   // ARCHIVEEXTRACTOR_H
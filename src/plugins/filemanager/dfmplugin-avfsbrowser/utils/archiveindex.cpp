@@ -0,0 +1,582 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "archiveindex.h"
+
+#include <dfm-base/utils/finallyutil.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QWaitCondition>
+
+#include <algorithm>
+
+#include <archive.h>
+#include <archive_entry.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace dfmplugin_avfsbrowser;
+DFMBASE_USE_NAMESPACE
+
+static constexpr quint32 kIndexMagic { 0x44464149 };   // "DFAI"
+static constexpr quint32 kIndexVersion { 1 };
+static constexpr size_t kReadBlockSize { 64 * 1024 };
+static constexpr int kMaxOpenIndexes { 4 };
+static constexpr int kMaxIndexFiles { 256 };
+static constexpr qint64 kIndexFileLifetime { 30 * 24 * 3600 };   // seconds
+static constexpr qint64 kExtractedLifetime { 24 * 3600 };   // seconds
+static constexpr qint64 kMaxExtractedBytes { 1024 * 1024 * 1024 };
+
+namespace {
+
+struct OpenIndexes
+{
+    QMutex mutex;
+    QWaitCondition built;
+    QList<QSharedPointer<ArchiveIndex>> recent;   // the latest used first
+    QSet<QString> building;
+};
+
+Q_GLOBAL_STATIC(OpenIndexes, openIndexes)
+
+bool statArchive(const QString &path, qint64 *size, qint64 *modifyTime)
+{
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+
+    *size = static_cast<qint64>(st.st_size);
+    *modifyTime = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+QString normalizedPath(QString path)
+{
+    while (path.startsWith("./"))
+        path.remove(0, 2);
+    while (path.startsWith('/'))
+        path.remove(0, 1);
+    while (path.endsWith('/'))
+        path.chop(1);
+    return path == "." ? QString() : path;
+}
+
+QString pathOfHeader(archive_entry *header)
+{
+    const char *name = archive_entry_pathname_utf8(header);
+    return normalizedPath(QString::fromUtf8(name ? name : archive_entry_pathname(header)));
+}
+
+QString parentOf(const QString &path)
+{
+    const int slash = path.lastIndexOf('/');
+    return slash < 0 ? QString("") : path.left(slash);
+}
+
+archive *newReader()
+{
+    archive *a = archive_read_new();
+    archive_read_support_filter_all(a);
+    archive_read_support_format_all(a);
+    return a;
+}
+
+bool isUncompressedTar(archive *a)
+{
+    if ((archive_format(a) & ARCHIVE_FORMAT_BASE_MASK) != ARCHIVE_FORMAT_TAR)
+        return false;
+    for (int i = 0; i < archive_filter_count(a); ++i) {
+        if (archive_filter_code(a, i) != ARCHIVE_FILTER_NONE)
+            return false;
+    }
+    return true;
+}
+
+bool isHeaderRead(int ret)
+{
+    return ret == ARCHIVE_OK || ret == ARCHIVE_WARN;
+}
+
+/*!
+ * \brief writeData write the data of the current entry to targetFile
+ * \param written called with the bytes written so far, the extraction is canceled if it returns false
+ */
+bool writeData(archive *a, const QString &targetFile, qint64 size, const std::function<bool(qint64)> &written)
+{
+    QSaveFile file(targetFile);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    const void *buffer = nullptr;
+    size_t length = 0;
+    la_int64_t offset = 0;
+    qint64 total = 0;
+    int ret = ARCHIVE_OK;
+    while (isHeaderRead(ret = archive_read_data_block(a, &buffer, &length, &offset))) {
+        // the holes of a sparse file are skipped
+        if ((offset != file.pos() && !file.seek(offset))
+            || file.write(static_cast<const char *>(buffer), static_cast<qint64>(length)) != static_cast<qint64>(length)) {
+            fmWarning() << "cannot write to" << targetFile << file.errorString();
+            file.cancelWriting();
+            return false;
+        }
+
+        total += static_cast<qint64>(length);
+        if (written && !written(total)) {
+            file.cancelWriting();
+            return false;
+        }
+    }
+
+    if (ret != ARCHIVE_EOF) {
+        fmWarning() << "cannot extract to" << targetFile << archive_error_string(a);
+        file.cancelWriting();
+        return false;
+    }
+    if (file.size() < size && !file.resize(size)) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+qint64 lastModified(const QFileInfo &info)
+{
+    return info.lastModified().toSecsSinceEpoch();
+}
+
+qint64 sizeOfTree(const QString &dirPath)
+{
+    qint64 size = 0;
+    QDirIterator it(dirPath, QDir::Files | QDir::Hidden | QDir::System | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        size += it.fileInfo().size();
+    }
+    return size;
+}
+
+}   // namespace
+
+bool ArchiveIndex::Entry::isDir() const
+{
+    return S_ISDIR(mode);
+}
+
+bool ArchiveIndex::Entry::isSymLink() const
+{
+    return S_ISLNK(mode);
+}
+
+QString ArchiveIndex::Entry::fileName() const
+{
+    return path.mid(path.lastIndexOf('/') + 1);
+}
+
+ArchiveIndex::ArchiveIndex(const QString &archivePath)
+    : archiveFile(archivePath)
+{
+}
+
+/*!
+ * \brief ArchiveIndex::open the index of an archive, read from the cache file or built from the archive.
+ * It may read the whole archive, so it must not be called in the main thread.
+ * \return null if the archive cannot be read
+ */
+QSharedPointer<ArchiveIndex> ArchiveIndex::open(const QString &archivePath)
+{
+    {
+        QMutexLocker locker(&openIndexes->mutex);
+        forever {
+            if (auto index = findRecent(archivePath))
+                return index;
+            // the readers of an archive being indexed wait for that index
+            if (!openIndexes->building.contains(archivePath))
+                break;
+            openIndexes->built.wait(&openIndexes->mutex);
+        }
+        openIndexes->building.insert(archivePath);
+    }
+
+    QSharedPointer<ArchiveIndex> index(new ArchiveIndex(archivePath));
+    bool ok = statArchive(archivePath, &index->archiveSize, &index->archiveModifyTime);
+    if (ok) {
+        const QString &cacheFile = cacheFileOf(archivePath);
+        if (!index->load(cacheFile)) {
+            ok = index->build();
+            if (ok)
+                index->save(cacheFile);
+        }
+    }
+
+    QMutexLocker locker(&openIndexes->mutex);
+    openIndexes->building.remove(archivePath);
+    openIndexes->built.wakeAll();
+    if (!ok)
+        return nullptr;
+
+    openIndexes->recent.prepend(index);
+    while (openIndexes->recent.size() > kMaxOpenIndexes)
+        openIndexes->recent.removeLast();
+    return index;
+}
+
+/*!
+ * \brief ArchiveIndex::cached the index of an archive if it is open and still current, never reads the archive
+ */
+QSharedPointer<ArchiveIndex> ArchiveIndex::cached(const QString &archivePath)
+{
+    QMutexLocker locker(&openIndexes->mutex);
+    return findRecent(archivePath);
+}
+
+/*!
+ * \brief ArchiveIndex::splitAvfsPath split the path of an avfs url like /home/a.tar.gz#/dir/file
+ * The handlers of avfs like 'a.gz#ugz' and the archives in archives are left to avfs.
+ */
+bool ArchiveIndex::splitAvfsPath(const QString &avfsPath, QString *archivePath, QString *innerPath)
+{
+    Q_ASSERT(archivePath && innerPath);
+
+    const int mark = avfsPath.indexOf('#');
+    if (mark <= 0)
+        return false;
+
+    const QString &inner = avfsPath.mid(mark + 1);
+    if ((!inner.isEmpty() && !inner.startsWith('/')) || inner.contains('#'))
+        return false;
+
+    *archivePath = avfsPath.left(mark);
+    *innerPath = normalizedPath(inner);
+    return true;
+}
+
+QString ArchiveIndex::archivePath() const
+{
+    return archiveFile;
+}
+
+bool ArchiveIndex::contains(const QString &path) const
+{
+    return path.isEmpty() || entryOfPath.contains(path);
+}
+
+ArchiveIndex::Entry ArchiveIndex::entry(const QString &path) const
+{
+    if (path.isEmpty()) {
+        Entry root;
+        root.mode = S_IFDIR | 0755;
+        root.modifyTime = archiveModifyTime / 1000000000;
+        return root;
+    }
+
+    auto iter = entryOfPath.constFind(path);
+    return iter == entryOfPath.constEnd() ? Entry() : entries.at(iter.value());
+}
+
+QVector<ArchiveIndex::Entry> ArchiveIndex::children(const QString &dirPath) const
+{
+    QVector<Entry> result;
+    const QVector<int> &indexes = childrenOfDir.value(dirPath.isNull() ? QString("") : dirPath);
+    result.reserve(indexes.size());
+    for (int i : indexes)
+        result.append(entries.at(i));
+    return result;
+}
+
+/*!
+ * \brief ArchiveIndex::extract write one regular file of the archive to targetFile.
+ * The header of an uncompressed tar is read at its offset, the other archives are read
+ * up to the entry with the data of the entries before it skipped.
+ * It may read the whole archive, so it must not be called in the main thread.
+ * \param progress reports the bytes written of the file, or the bytes read of the archive
+ * if it is read up to the entry
+ */
+bool ArchiveIndex::extract(const QString &path, const QString &targetFile, const ProgressCallback &progress) const
+{
+    const Entry &target = entry(path);
+    if (!target.isValid() || target.isDir() || target.isSymLink() || target.ordinal < 0)
+        return false;
+
+    // the directory of the archive is kept while it is used
+    ::utimensat(AT_FDCWD, QFile::encodeName(extractedDirOf(archiveFile)).constData(), nullptr, 0);
+
+    bool canceled = false;
+    const ProgressCallback watched = [&progress, &canceled](qint64 done, qint64 total) {
+        canceled = progress && !progress(done, total);
+        return !canceled;
+    };
+    if (target.headerOffset >= 0 && extractAt(target, targetFile, watched))
+        return true;
+    return !canceled && extractInSequence(target, targetFile, watched);
+}
+
+bool ArchiveIndex::isCurrent() const
+{
+    qint64 size = 0;
+    qint64 modifyTime = 0;
+    return statArchive(archiveFile, &size, &modifyTime) && size == archiveSize && modifyTime == archiveModifyTime;
+}
+
+bool ArchiveIndex::build()
+{
+    archive *a = newReader();
+    FinallyUtil release([a] { archive_read_free(a); });
+    if (archive_read_open_filename(a, QFile::encodeName(archiveFile).constData(), kReadBlockSize) != ARCHIVE_OK) {
+        fmWarning() << "cannot open archive" << archiveFile << archive_error_string(a);
+        return false;
+    }
+
+    archive_entry *header = nullptr;
+    qint32 ordinal = 0;
+    bool seekable = false;
+    int ret = ARCHIVE_OK;
+    while (isHeaderRead(ret = archive_read_next_header(a, &header))) {
+        if (ordinal == 0)
+            seekable = isUncompressedTar(a);
+
+        Entry entry;
+        entry.path = pathOfHeader(header);
+        entry.size = archive_entry_size_is_set(header) ? static_cast<qint64>(archive_entry_size(header)) : 0;
+        entry.modifyTime = static_cast<qint64>(archive_entry_mtime(header));
+        entry.mode = archive_entry_mode(header);
+        if ((entry.mode & S_IFMT) == 0)
+            entry.mode |= S_IFREG;
+        entry.headerOffset = seekable ? static_cast<qint64>(archive_read_header_position(a)) : -1;
+        entry.ordinal = ordinal++;
+
+        if (!entry.path.isEmpty()) {
+            insertParents(entry.path);
+            insert(entry);
+        }
+        archive_read_data_skip(a);
+    }
+
+    if (ret != ARCHIVE_EOF) {
+        fmWarning() << "archive" << archiveFile << "is read up to entry" << ordinal << archive_error_string(a);
+        return !entries.isEmpty();
+    }
+    fmInfo() << "indexed archive" << archiveFile << "with" << entries.size() << "entries";
+    return true;
+}
+
+bool ArchiveIndex::load(const QString &cacheFile)
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString path;
+    qint64 size = -1;
+    qint64 modifyTime = -1;
+    in >> magic >> version >> path >> size >> modifyTime;
+    if (magic != kIndexMagic || version != kIndexVersion || path != archiveFile
+        || size != archiveSize || modifyTime != archiveModifyTime)
+        return false;
+
+    quint32 count = 0;
+    in >> count;
+    QVector<Entry> loaded;
+    loaded.reserve(static_cast<int>(qMin<quint32>(count, 1 << 20)));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Entry entry;
+        in >> entry.path >> entry.size >> entry.modifyTime >> entry.mode >> entry.headerOffset >> entry.ordinal;
+        loaded.append(entry);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        fmWarning() << "broken archive index:" << cacheFile;
+        return false;
+    }
+
+    for (const Entry &entry : loaded)
+        insert(entry);
+
+    // the indexes used lately are kept by the eviction
+    ::utimensat(AT_FDCWD, QFile::encodeName(cacheFile).constData(), nullptr, 0);
+    return true;
+}
+
+bool ArchiveIndex::save(const QString &cacheFile) const
+{
+    QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+
+    // readers must never see a half written index
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        fmWarning() << "failed to write archive index:" << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << kIndexMagic << kIndexVersion << archiveFile << archiveSize << archiveModifyTime;
+    out << static_cast<quint32>(entries.size());
+    for (const Entry &entry : entries)
+        out << entry.path << entry.size << entry.modifyTime << entry.mode << entry.headerOffset << entry.ordinal;
+
+    return file.commit();
+}
+
+void ArchiveIndex::insert(const Entry &entry)
+{
+    // a later header of the same path replaces the earlier one, as on extraction
+    auto iter = entryOfPath.constFind(entry.path);
+    if (iter != entryOfPath.constEnd()) {
+        entries[iter.value()] = entry;
+        return;
+    }
+
+    const int index = entries.size();
+    entries.append(entry);
+    entryOfPath.insert(entry.path, index);
+    childrenOfDir[parentOf(entry.path)].append(index);
+}
+
+// the archives may skip the headers of the directories
+void ArchiveIndex::insertParents(const QString &path)
+{
+    QString parent = parentOf(path);
+    while (!parent.isEmpty() && !entryOfPath.contains(parent)) {
+        Entry dir;
+        dir.path = parent;
+        dir.mode = S_IFDIR | 0755;
+        dir.modifyTime = archiveModifyTime / 1000000000;
+        insert(dir);
+        parent = parentOf(parent);
+    }
+}
+
+bool ArchiveIndex::extractAt(const Entry &entry, const QString &targetFile, const ProgressCallback &progress) const
+{
+    const int fd = ::open(QFile::encodeName(archiveFile).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    archive *a = archive_read_new();
+    FinallyUtil release([a, fd] {
+        archive_read_free(a);
+        ::close(fd);
+    });
+    archive_read_support_filter_none(a);
+    archive_read_support_format_tar(a);
+    if (::lseek(fd, entry.headerOffset, SEEK_SET) < 0 || archive_read_open_fd(a, fd, kReadBlockSize) != ARCHIVE_OK)
+        return false;
+
+    archive_entry *header = nullptr;
+    if (!isHeaderRead(archive_read_next_header(a, &header)) || pathOfHeader(header) != entry.path)
+        return false;
+    return writeData(a, targetFile, entry.size, [&progress, &entry](qint64 written) {
+        return progress(written, entry.size);
+    });
+}
+
+bool ArchiveIndex::extractInSequence(const Entry &entry, const QString &targetFile, const ProgressCallback &progress) const
+{
+    archive *a = newReader();
+    FinallyUtil release([a] { archive_read_free(a); });
+    if (archive_read_open_filename(a, QFile::encodeName(archiveFile).constData(), kReadBlockSize) != ARCHIVE_OK)
+        return false;
+
+    // the entries before are read as well, the progress is the part of the archive read
+    auto readOfArchive = [this, a, &progress](qint64) {
+        return progress(static_cast<qint64>(archive_filter_bytes(a, -1)), archiveSize);
+    };
+
+    archive_entry *header = nullptr;
+    for (qint32 ordinal = 0; isHeaderRead(archive_read_next_header(a, &header)); ++ordinal) {
+        if (ordinal == entry.ordinal)
+            return pathOfHeader(header) == entry.path && writeData(a, targetFile, entry.size, readOfArchive);
+        archive_read_data_skip(a);
+        if (!readOfArchive(0))
+            return false;
+    }
+    return false;
+}
+
+// with the lock of the open indexes held
+QSharedPointer<ArchiveIndex> ArchiveIndex::findRecent(const QString &archivePath)
+{
+    auto &recent = openIndexes->recent;
+    for (int i = 0; i < recent.size(); ++i) {
+        if (recent.at(i)->archiveFile != archivePath)
+            continue;
+
+        const QSharedPointer<ArchiveIndex> index = recent.takeAt(i);
+        // a changed archive is indexed again by the next open
+        if (!index->isCurrent())
+            return nullptr;
+        recent.prepend(index);
+        return index;
+    }
+    return nullptr;
+}
+
+QString ArchiveIndex::cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + "/deepin/dde-file-manager/archives";
+}
+
+QString ArchiveIndex::cacheFileOf(const QString &archivePath)
+{
+    const QByteArray &key = QCryptographicHash::hash(archivePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return cacheDir() + "/" + QString::fromLatin1(key) + ".index";
+}
+
+/*!
+ * \brief ArchiveIndex::extractedDirOf the directory the files of an archive are extracted to
+ */
+QString ArchiveIndex::extractedDirOf(const QString &archivePath)
+{
+    const QByteArray &key = QCryptographicHash::hash(archivePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return cacheDir() + "/extracted/" + QString::fromLatin1(key);
+}
+
+/*!
+ * \brief ArchiveIndex::evictCache remove the index files not used for kIndexFileLifetime and the
+ * oldest ones beyond kMaxIndexFiles, and the files extracted from the archives not opened for
+ * kExtractedLifetime and the oldest ones beyond kMaxExtractedBytes.
+ * It walks the cache, so it must not be called in the main thread.
+ */
+void ArchiveIndex::evictCache()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const auto byAge = [](const QFileInfo &a, const QFileInfo &b) { return lastModified(a) > lastModified(b); };
+
+    QFileInfoList indexes = QDir(cacheDir()).entryInfoList({ "*.index" }, QDir::Files | QDir::Hidden);
+    std::sort(indexes.begin(), indexes.end(), byAge);
+    for (int i = 0; i < indexes.size(); ++i) {
+        if (i >= kMaxIndexFiles || now - lastModified(indexes.at(i)) > kIndexFileLifetime)
+            QFile::remove(indexes.at(i).absoluteFilePath());
+    }
+
+    QFileInfoList extracted = QDir(cacheDir() + "/extracted").entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden);
+    std::sort(extracted.begin(), extracted.end(), byAge);
+    qint64 total = 0;
+    for (const QFileInfo &dir : extracted) {
+        const qint64 size = sizeOfTree(dir.absoluteFilePath());
+        if (now - lastModified(dir) > kExtractedLifetime || total + size > kMaxExtractedBytes) {
+            QDir(dir.absoluteFilePath()).removeRecursively();
+            continue;
+        }
+        total += size;
+    }
+}
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ARCHIVEINDEX_H
+#define ARCHIVEINDEX_H
+
+#include "dfmplugin_avfsbrowser_global.h"
+
+#include <QHash>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+namespace dfmplugin_avfsbrowser {
+
+/*!
+ * \brief The ArchiveIndex class lists an archive through libarchive, without the avfs daemon.
+ * The headers of an archive are read once, the index is kept in a cache file keyed by the path,
+ * size and modify time of the archive, so the listings and the metadata of its entries are
+ * answered from the index until the archive changes.
+ * The index files and the extracted files are evicted from the cache by evictCache.
+ */
+class ArchiveIndex
+{
+public:
+    struct Entry
+    {
+        QString path;   // relative to the archive root, without a leading or trailing '/'
+        qint64 size { 0 };
+        qint64 modifyTime { 0 };   // seconds since epoch
+        quint32 mode { 0 };
+        qint64 headerOffset { -1 };   // offset of the header in an uncompressed tar
+        qint32 ordinal { -1 };   // position among the headers, -1 for the implied directories
+
+        bool isValid() const { return mode != 0; }
+        bool isDir() const;
+        bool isSymLink() const;
+        QString fileName() const;
+    };
+
+    // the bytes done and the bytes of the work, the work is canceled if it returns false
+    using ProgressCallback = std::function<bool(qint64 done, qint64 total)>;
+
+    static QSharedPointer<ArchiveIndex> open(const QString &archivePath);
+    static QSharedPointer<ArchiveIndex> cached(const QString &archivePath);
+    static bool splitAvfsPath(const QString &avfsPath, QString *archivePath, QString *innerPath);
+    static QString extractedDirOf(const QString &archivePath);
+    static void evictCache();
+
+    QString archivePath() const;
+    bool contains(const QString &path) const;
+    Entry entry(const QString &path) const;
+    QVector<Entry> children(const QString &dirPath) const;
+    bool extract(const QString &path, const QString &targetFile, const ProgressCallback &progress = ProgressCallback()) const;
+
+private:
+    explicit ArchiveIndex(const QString &archivePath);
+
+    bool isCurrent() const;
+    bool build();
+    bool load(const QString &cacheFile);
+    bool save(const QString &cacheFile) const;
+    void insert(const Entry &entry);
+    void insertParents(const QString &path);
+    bool extractAt(const Entry &entry, const QString &targetFile, const ProgressCallback &progress) const;
+    bool extractInSequence(const Entry &entry, const QString &targetFile, const ProgressCallback &progress) const;
+
+    static QSharedPointer<ArchiveIndex> findRecent(const QString &archivePath);
+    static QString cacheDir();
+    static QString cacheFileOf(const QString &archivePath);
+
+private:
+    QString archiveFile;
+    qint64 archiveSize { -1 };
+    qint64 archiveModifyTime { -1 };   // nanoseconds
+    QVector<Entry> entries;
+    QHash<QString, int> entryOfPath;
+    QHash<QString, QVector<int>> childrenOfDir;
+};
+
+}
+
+#endif   // ARCHIVEINDEX_H
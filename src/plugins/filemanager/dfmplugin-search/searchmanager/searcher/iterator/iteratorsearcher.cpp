@@ -9,17 +9,74 @@
 #include <dfm-base/base/schemefactory.h>
 
 #include <QDebug>
+#include <QFile>
+#include <QQueue>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrent>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cstring>
 
 static int kEmitInterval = 50;   // 推送时间间隔（ms
 static constexpr char kFilterFolders[] = "^/(dev|proc|sys|run|tmpfs).*$";
+static constexpr int kMaxWalkers = 8;   // 本地遍历的最大线程数
+static constexpr unsigned long kWaitInterval = 50;   // 空闲线程检查中断的间隔（ms
 
 DFMBASE_USE_NAMESPACE
+
+DPSEARCH_BEGIN_NAMESPACE
+
+// 本地遍历的待搜索目录队列，由所有遍历线程共享
+struct LocalWalkQueue
+{
+    QMutex mutex;
+    QWaitCondition condition;
+    QQueue<QByteArray> dirs;
+    QSet<QPair<quint64, quint64>> visited;   // 已遍历目录的 dev/ino，避免绑定挂载导致的重复
+    int busy { 0 };
+    bool filterFolders { false };
+};
+
+DPSEARCH_END_NAMESPACE
+
 DPSEARCH_USE_NAMESPACE
 
+static const QRegularExpression &filterFoldersRegex()
+{
+    static const QRegularExpression reg(kFilterFolders);
+    return reg;
+}
+
+// .hidden 文件中列出的隐藏文件
+static QSet<QByteArray> readHiddenList(int dirFd)
+{
+    QSet<QByteArray> names;
+    const int fd = ::openat(dirFd, ".hidden", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return names;
+
+    QFile file;
+    if (file.open(fd, QIODevice::ReadOnly, QFileDevice::AutoCloseHandle)) {
+        for (const QByteArray &line : file.readAll().split('\n')) {
+            if (!line.isEmpty())
+                names.insert(line);
+        }
+    } else {
+        ::close(fd);
+    }
+    return names;
+}
+
 IteratorSearcher::IteratorSearcher(const QUrl &url, const QString &key, QObject *parent)
-    : AbstractSearcher(url, SearchHelper::instance()->checkWildcardAndToRegularExpression(key), parent)
+    : AbstractSearcher(url, SearchHelper::instance()->checkWildcardAndToRegularExpression(key), parent),
+      matcher(key)
 {
     searchPathList << url;
+    visitedPathSet << url;
     regex = QRegularExpression(keyword, QRegularExpression::CaseInsensitiveOption);
 }
 
@@ -30,8 +87,11 @@ bool IteratorSearcher::search()
         return false;
 
     notifyTimer.start();
-    // 遍历搜索
-    doSearch();
+    // 遍历搜索，本地目录直接读取目录项
+    if (dfmbase::FileUtils::isLocalFile(searchUrl))
+        doLocalSearch();
+    else
+        doSearch();
 
     //检查是否还有数据
     if (status.testAndSetRelease(kRuning, kCompleted)) {
@@ -62,12 +122,16 @@ QList<QUrl> IteratorSearcher::takeAll()
 
 void IteratorSearcher::tryNotify()
 {
-    int cur = notifyTimer.elapsed();
-    if (hasItem() && (cur - lastEmit) > kEmitInterval) {
+    // 多个遍历线程都会推送
+    {
+        QMutexLocker lk(&mutex);
+        int cur = notifyTimer.elapsed();
+        if (allResults.isEmpty() || (cur - lastEmit) <= kEmitInterval)
+            return;
         lastEmit = cur;
         fmDebug() << "IteratorSearcher unearthed, current spend:" << cur;
-        emit unearthed(this);
     }
+    emit unearthed(this);
 }
 
 void IteratorSearcher::doSearch()
@@ -76,17 +140,17 @@ void IteratorSearcher::doSearch()
         if (searchPathList.isEmpty() || status.loadAcquire() != kRuning)
             return;
 
-        const auto &url = searchPathList.takeAt(0);
+        const auto url = searchPathList.takeFirst();
         auto iterator = DirIteratorFactory::create(url, QStringList(), QDir::NoDotAndDotDot | QDir::Dirs | QDir::Files);
         if (!iterator)
             continue;
 
         // 仅在过滤目录下进行搜索时，过滤目录下的内容才能被检索
         if (dfmbase::FileUtils::isLocalFile(url)) {
-            QRegExp reg(kFilterFolders);
+            const auto &reg = filterFoldersRegex();
             const auto &searchRootPath = searchUrl.toLocalFile();
             const auto &filePath = url.toLocalFile();
-            if (!reg.exactMatch(searchRootPath) && reg.exactMatch(filePath))
+            if (!reg.match(searchRootPath).hasMatch() && reg.match(filePath).hasMatch())
                 continue;
         }
 
@@ -103,8 +167,10 @@ void IteratorSearcher::doSearch()
             // 将目录添加到待搜索目录中
             if (info->isAttributes(OptInfoType::kIsDir) && !info->isAttributes(OptInfoType::kIsSymLink)) {
                 const auto &fileUrl = info->urlOf(UrlInfoType::kUrl);
-                if (!searchPathList.contains(fileUrl) || !fileUrl.path().startsWith("/sys/"))
+                if (!visitedPathSet.contains(fileUrl)) {
+                    visitedPathSet.insert(fileUrl);
                     searchPathList << fileUrl;
+                }
             }
 
             QRegularExpressionMatch match = regex.match(info->displayOf(DisPlayInfoType::kFileDisplayName));
@@ -123,3 +189,120 @@ void IteratorSearcher::doSearch()
         iterator.clear();
     }
 }
+
+/*!
+ * \brief IteratorSearcher::doLocalSearch search a local directory tree with a bounded pool of walkers.
+ * The walkers read the directory entries directly and match the raw names, a file info
+ * is only created for the desktop files, whose display name is not their file name.
+ */
+void IteratorSearcher::doLocalSearch()
+{
+    LocalWalkQueue queue;
+    const QString &rootPath = searchUrl.toLocalFile();
+    // 仅在过滤目录下进行搜索时，过滤目录下的内容才能被检索
+    queue.filterFolders = !filterFoldersRegex().match(rootPath).hasMatch();
+    queue.dirs.enqueue(QFile::encodeName(rootPath));
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), kMaxWalkers) - 1);
+    QList<QFuture<void>> walkers;
+    for (int i = 0; i < pool.maxThreadCount(); ++i)
+        walkers << QtConcurrent::run(&pool, [this, &queue] { walkLocalDirectories(&queue); });
+
+    // 当前线程也参与遍历
+    walkLocalDirectories(&queue);
+    for (auto &walker : walkers)
+        walker.waitForFinished();
+}
+
+void IteratorSearcher::walkLocalDirectories(LocalWalkQueue *queue)
+{
+    forever {
+        QByteArray dirPath;
+        {
+            QMutexLocker lk(&queue->mutex);
+            while (queue->dirs.isEmpty() && queue->busy > 0 && status.loadAcquire() == kRuning)
+                queue->condition.wait(&queue->mutex, kWaitInterval);
+            if (queue->dirs.isEmpty() || status.loadAcquire() != kRuning) {
+                queue->condition.wakeAll();
+                return;
+            }
+            dirPath = queue->dirs.dequeue();
+            ++queue->busy;
+        }
+
+        QList<QByteArray> subDirs;
+        QList<QUrl> results;
+        const int dirFd = ::open(dirPath.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        DIR *dir = dirFd >= 0 ? ::fdopendir(dirFd) : nullptr;
+        if (!dir && dirFd >= 0)
+            ::close(dirFd);
+
+        struct stat dirSt;
+        bool visited = !dir || ::fstat(dirFd, &dirSt) != 0;
+        if (!visited) {
+            const auto &inode = qMakePair(static_cast<quint64>(dirSt.st_dev), static_cast<quint64>(dirSt.st_ino));
+            QMutexLocker lk(&queue->mutex);
+            visited = queue->visited.contains(inode);
+            queue->visited.insert(inode);
+        }
+
+        if (!visited) {
+            const QSet<QByteArray> &hiddenList = readHiddenList(dirFd);
+            const QByteArray &prefix = dirPath.endsWith('/') ? dirPath : dirPath + '/';
+            while (struct dirent *entry = ::readdir(dir)) {
+                //中断
+                if (status.loadAcquire() != kRuning)
+                    break;
+
+                const char *name = entry->d_name;
+                // 与之前的遍历一致，不搜索隐藏文件
+                if (name[0] == '.' || (!hiddenList.isEmpty() && hiddenList.contains(QByteArray(name))))
+                    continue;
+
+                bool isDir = entry->d_type == DT_DIR;
+                if (entry->d_type == DT_UNKNOWN) {
+                    struct stat st;
+                    isDir = ::fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+                }
+
+                const int nameLength = static_cast<int>(strlen(name));
+                const QByteArray &path = prefix + QByteArray(name, nameLength);
+                if (isDir && !(queue->filterFolders && filterFoldersRegex().match(QFile::decodeName(path)).hasMatch()))
+                    subDirs << path;
+
+                bool hit = false;
+                if (nameLength > 8 && strcmp(name + nameLength - 8, ".desktop") == 0) {
+                    const auto &info = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(QFile::decodeName(path)));
+                    hit = info && matcher.matches(info->displayOf(DisPlayInfoType::kFileDisplayName));
+                } else {
+                    hit = matcher.matches(name, nameLength);
+                }
+                if (hit)
+                    results << QUrl::fromLocalFile(QFile::decodeName(path));
+            }
+        }
+        if (dir)
+            ::closedir(dir);
+
+        {
+            QMutexLocker lk(&queue->mutex);
+            for (const QByteArray &subDir : subDirs)
+                queue->dirs.enqueue(subDir);
+            --queue->busy;
+            queue->condition.wakeAll();
+        }
+
+        //推送，每个目录的结果作为一批
+        if (!results.isEmpty()) {
+            appendResults(results);
+            tryNotify();
+        }
+    }
+}
+
+void IteratorSearcher::appendResults(const QList<QUrl> &results)
+{
+    QMutexLocker lk(&mutex);
+    allResults += results;
+}
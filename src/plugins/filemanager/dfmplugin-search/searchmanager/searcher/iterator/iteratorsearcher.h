@@ -6,13 +6,17 @@
 #define ITERATORSEARCHER_H
 
 #include "searchmanager/searcher/abstractsearcher.h"
+#include "keywordmatcher.h"
 
 #include <QTime>
 #include <QMutex>
 #include <QRegularExpression>
+#include <QSet>
 
 DPSEARCH_BEGIN_NAMESPACE
 
+struct LocalWalkQueue;
+
 class IteratorSearcher : public AbstractSearcher
 {
     Q_OBJECT
@@ -28,13 +32,18 @@ private:
     QList<QUrl> takeAll() override;
     void tryNotify();
     void doSearch();
+    void doLocalSearch();
+    void walkLocalDirectories(LocalWalkQueue *queue);
+    void appendResults(const QList<QUrl> &results);
 
 private:
     QAtomicInt status = kReady;
     QList<QUrl> allResults;
     mutable QMutex mutex;
     QList<QUrl> searchPathList;
+    QSet<QUrl> visitedPathSet;
     QRegularExpression regex;
+    KeywordMatcher matcher;
 
     //计时
     QTime notifyTimer;
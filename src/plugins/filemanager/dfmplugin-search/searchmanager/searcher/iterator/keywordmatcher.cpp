@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "keywordmatcher.h"
+#include "utils/searchhelper.h"
+
+#include <QFile>
+
+#include <algorithm>
+
+DPSEARCH_USE_NAMESPACE
+
+static bool isAscii(const char *data, int length)
+{
+    for (int i = 0; i < length; ++i) {
+        if (static_cast<unsigned char>(data[i]) >= 0x80)
+            return false;
+    }
+    return true;
+}
+
+static char asciiLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+KeywordMatcher::KeywordMatcher(const QString &key)
+{
+    // the wildcards understood by SearchHelper::checkWildcardAndToRegularExpression
+    literal = !key.contains('*') && !key.contains('?') && !key.contains('[');
+    if (!literal) {
+        regex = QRegularExpression(SearchHelper::instance()->checkWildcardAndToRegularExpression(key),
+                                   QRegularExpression::CaseInsensitiveOption);
+        return;
+    }
+
+    foldedKey = key.toCaseFolded();
+    asciiKey = std::all_of(foldedKey.cbegin(), foldedKey.cend(), [](const QChar &c) { return c.unicode() < 0x80; });
+    if (asciiKey)
+        asciiFoldedKey = foldedKey.toLatin1();
+}
+
+bool KeywordMatcher::isLiteral() const
+{
+    return literal;
+}
+
+/*!
+ * \brief KeywordMatcher::matches match a file name as read from the file system
+ * \param name the bytes of the file name in the local 8 bit encoding
+ */
+bool KeywordMatcher::matches(const char *name, int length) const
+{
+    // a non ascii name may hold characters folding to ascii ones, such as the kelvin sign
+    if (!literal || !asciiKey || !isAscii(name, length))
+        return matches(QFile::decodeName(QByteArray::fromRawData(name, length)));
+
+    const int keyLength = asciiFoldedKey.size();
+    if (keyLength == 0)
+        return true;
+
+    const char *key = asciiFoldedKey.constData();
+    for (int i = 0; i + keyLength <= length; ++i) {
+        if (asciiLower(name[i]) != key[0])
+            continue;
+        int j = 1;
+        while (j < keyLength && asciiLower(name[i + j]) == key[j])
+            ++j;
+        if (j == keyLength)
+            return true;
+    }
+    return false;
+}
+
+bool KeywordMatcher::matches(const QString &name) const
+{
+    if (!literal)
+        return regex.match(name).hasMatch();
+    return name.toCaseFolded().contains(foldedKey);
+}
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef KEYWORDMATCHER_H
+#define KEYWORDMATCHER_H
+
+#include "dfmplugin_search_global.h"
+
+#include <QByteArray>
+#include <QRegularExpression>
+#include <QString>
+
+DPSEARCH_BEGIN_NAMESPACE
+
+/*!
+ * \brief The KeywordMatcher class matches file names against a search keyword.
+ * A keyword without wildcards is matched as a case folded substring, directly on the
+ * file name bytes when both are ascii. Other keywords fall back to the regular expression
+ * built from the wildcards, as the iterator searcher always did.
+ */
+class KeywordMatcher
+{
+public:
+    explicit KeywordMatcher(const QString &key = QString());
+
+    bool isLiteral() const;
+    bool matches(const char *name, int length) const;
+    bool matches(const QString &name) const;
+
+private:
+    bool literal { true };
+    bool asciiKey { false };
+    QString foldedKey;
+    QByteArray asciiFoldedKey;
+    QRegularExpression regex;
+};
+
+DPSEARCH_END_NAMESPACE
+
+#endif   // KEYWORDMATCHER_H
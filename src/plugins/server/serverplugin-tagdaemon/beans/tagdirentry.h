@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TAGDIRENTRY_H
+#define TAGDIRENTRY_H
+
+#include "serverplugin_tagdaemon_global.h"
+
+#include <QObject>
+
+SERVERTAGDAEMON_BEGIN_NAMESPACE
+
+/*!
+ * \brief The TagDirEntry class is a directory node of the tagged file paths,
+ * a path is stored as its parent node and its name, so renaming a directory updates one node.
+ * The root directory is the node 0, which is not stored.
+ */
+class TagDirEntry : public QObject
+{
+    Q_OBJECT
+
+    Q_CLASSINFO("TableName", "tag_dir_entries")
+    Q_PROPERTY(int dirIndex READ getDirIndex WRITE setDirIndex)
+    Q_PROPERTY(int parentIndex READ getParentIndex WRITE setParentIndex)
+    Q_PROPERTY(QString dirName READ getDirName WRITE setDirName)
+
+public:
+    explicit TagDirEntry(QObject *parent = nullptr);
+
+    int getDirIndex() const;
+    void setDirIndex(int value);
+
+    int getParentIndex() const;
+    void setParentIndex(int value);
+
+    QString getDirName() const;
+    void setDirName(const QString &value);
+
+private:
+    int dirIndex {};
+    int parentIndex {};
+    QString dirName {};
+};
+
+SERVERTAGDAEMON_END_NAMESPACE
+
+#endif   // TAGDIRENTRY_H
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TAGFILEENTRY_H
+#define TAGFILEENTRY_H
+
+#include "serverplugin_tagdaemon_global.h"
+
+#include <QObject>
+
+SERVERTAGDAEMON_BEGIN_NAMESPACE
+
+/*!
+ * \brief The TagFileEntry class is a tag of a file, the file is stored as its parent TagDirEntry and its name.
+ * It replaces FileTagInfo, which keeps the full path and is only read to migrate the old databases.
+ */
+class TagFileEntry : public QObject
+{
+    Q_OBJECT
+
+    Q_CLASSINFO("TableName", "tag_file_entries")
+    Q_PROPERTY(int fileIndex READ getFileIndex WRITE setFileIndex)
+    Q_PROPERTY(int dirIndex READ getDirIndex WRITE setDirIndex)
+    Q_PROPERTY(QString fileName READ getFileName WRITE setFileName)
+    Q_PROPERTY(QString tagName READ getTagName WRITE setTagName)
+    Q_PROPERTY(int tagOrder READ getTagOrder WRITE setTagOrder)
+    Q_PROPERTY(QString future READ getFuture WRITE setFuture)
+
+public:
+    explicit TagFileEntry(QObject *parent = nullptr);
+
+    int getFileIndex() const;
+    void setFileIndex(int value);
+
+    int getDirIndex() const;
+    void setDirIndex(int value);
+
+    QString getFileName() const;
+    void setFileName(const QString &value);
+
+    QString getTagName() const;
+    void setTagName(const QString &value);
+
+    int getTagOrder() const;
+    void setTagOrder(int value);
+
+    QString getFuture() const;
+    void setFuture(const QString &value);
+
+private:
+    int fileIndex {};
+    int dirIndex {};
+    QString fileName {};
+    QString tagName {};
+    int tagOrder {};
+    QString future {};
+};
+
+SERVERTAGDAEMON_END_NAMESPACE
+
+#endif   // TAGFILEENTRY_H
@@ -5,6 +5,8 @@
 #include "tagdbhandler.h"
 
 #include "beans/filetaginfo.h"
+#include "beans/tagdirentry.h"
+#include "beans/tagfileentry.h"
 #include "beans/tagproperty.h"
 
 #include <dfm-base/dfm_global_defines.h>
@@ -20,12 +22,19 @@
 #include <QDebug>
 #include <QProcess>
 #include <QVariant>
+#include <QSet>
 
 DFMBASE_USE_NAMESPACE
 SERVERTAGDAEMON_BEGIN_NAMESPACE
 
-static constexpr char kTagTableFileTags[] = "file_tags";
+static constexpr char kTagTableFileEntries[] = "tag_file_entries";
+static constexpr char kTagTableDirEntries[] = "tag_dir_entries";
 static constexpr char kTagTableTagProperty[] = "tag_property";
+static constexpr char kTagTableSchemaVersion[] = "tag_schema_version";
+
+// 1: the tags of files are kept with full paths in file_tags
+// 2: the paths are interned in tag_dir_entries
+static constexpr int kTagSchemaVersion { 2 };
 
 TagDbHandler *TagDbHandler::instance()
 {
@@ -82,10 +91,19 @@ QVariantMap TagDbHandler::getTagsByUrls(const QStringList &urlList)
     }
 
     // query
-    const auto &field = Expression::Field<FileTagInfo>;
+    const auto &field = Expression::Field<TagFileEntry>;
     QVariantMap allFileTags;
     for (auto &path : urlList) {
-        const auto &beanList = handle->query<FileTagInfo>().where(field("filePath") == path).toBeans();
+        QString dir, name;
+        if (!splitPath(path, &dir, &name))
+            continue;
+        int dirIndex = findDir(dir);
+        if (dirIndex < 0)
+            continue;
+
+        const auto &beanList = handle->query<TagFileEntry>()
+                                       .where(field("dirIndex") == dirIndex && field("fileName") == name)
+                                       .toBeans();
 
         QStringList fileTags;
         for (auto oneBean : beanList)
@@ -139,13 +157,13 @@ QVariantMap TagDbHandler::getFilesByTag(const QStringList &tags)
     }
 
     // query
-    const auto &field = Expression::Field<FileTagInfo>;
+    const auto &field = Expression::Field<TagFileEntry>;
     QVariantMap allTagFiles;
     for (auto &tag : tags) {
-        const auto &obj = handle->query<FileTagInfo>().where(field("tagName") == tag).toBeans();
+        const auto &obj = handle->query<TagFileEntry>().where(field("tagName") == tag).toBeans();
         QStringList files;
         for (auto tempBean : obj)
-            files.append(tempBean->getFilePath());
+            files.append(pathOfFile(tempBean->getDirIndex(), tempBean->getFileName()));
 
         allTagFiles.insert(tag, QVariant { files });
     }
@@ -160,11 +178,11 @@ QVariantHash TagDbHandler::getAllFileWithTags()
     finally.dismiss();
 
     // query
-    const auto &beans = handle->query<FileTagInfo>().toBeans();
+    const auto &beans = handle->query<TagFileEntry>().toBeans();
 
     QVariantHash fileTagsMap;
     for (auto &bean : beans) {
-        const auto &path = bean->getFilePath();
+        const auto &path = pathOfFile(bean->getDirIndex(), bean->getFileName());
         if (fileTagsMap.contains(path)) {
             QStringList list { fileTagsMap[path].toStringList() };
             const QString &tagName { bean->getTagName() };
@@ -180,6 +198,39 @@ QVariantHash TagDbHandler::getAllFileWithTags()
     return fileTagsMap;
 }
 
+QVariantHash TagDbHandler::getFilesWithTagsOfDirs(const QStringList &dirs)
+{
+    DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
+
+    if (dirs.isEmpty()) {
+        lastErr = "input parameter is empty!";
+        return {};
+    }
+
+    // the direct children of a dir share its index, the query is served by the path index
+    const auto &field = Expression::Field<TagFileEntry>;
+    QVariantHash fileTagsMap;
+    for (const auto &dir : dirs) {
+        int dirIndex = findDir(dir);
+        if (dirIndex < 0)
+            continue;
+
+        const auto &beans = handle->query<TagFileEntry>().where(field("dirIndex") == dirIndex).toBeans();
+        for (auto &bean : beans) {
+            const auto &path = pathOfFile(dirIndex, bean->getFileName());
+            QStringList list { fileTagsMap.value(path).toStringList() };
+            const QString &tagName { bean->getTagName() };
+            if (list.contains(tagName))
+                continue;
+            list.append(tagName);
+            fileTagsMap.insert(path, list);
+        }
+    }
+
+    finally.dismiss();
+    return fileTagsMap;
+}
+
 bool TagDbHandler::addTagProperty(const QVariantMap &data)
 {
     DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
@@ -236,6 +287,10 @@ bool TagDbHandler::addTagsForFiles(const QVariantMap &data)
         return true;
     });
 
+    // the dirs inserted by the rolled back transaction are dropped
+    if (!ret)
+        loadDirNodes();
+
     emit filesWereTagged(data);
     finally.dismiss();
     return ret;
@@ -259,6 +314,10 @@ bool TagDbHandler::removeTagsOfFiles(const QVariantMap &data)
         return true;
     });
 
+    // the dirs removed by the rolled back transaction are loaded again
+    if (!ret)
+        loadDirNodes();
+
     emit filesUntagged(data);
     finally.dismiss();
     return ret;
@@ -274,18 +333,21 @@ bool TagDbHandler::deleteTags(const QStringList &tags)
     }
 
     const auto &fieldOne = Expression::Field<TagProperty>;
-    const auto &fieldTwo = Expression::Field<FileTagInfo>;
+    const auto &fieldTwo = Expression::Field<TagFileEntry>;
 
     bool ret = true;
     for (const auto &tag : tags) {
         ret = handle->remove<TagProperty>(fieldOne("tagName") == tag);
         if (!ret)
             return ret;
-        ret = handle->remove<FileTagInfo>(fieldTwo("tagName") == tag);
+        ret = handle->remove<TagFileEntry>(fieldTwo("tagName") == tag);
         if (!ret)
             return ret;
     }
 
+    if (!pruneEmptyDirs())
+        fmWarning() << "Remove the dirs without tagged files failed:" << lastErr;
+
     emit tagsDeleted(tags);
     finally.dismiss();
     return ret;
@@ -300,9 +362,19 @@ bool TagDbHandler::deleteFiles(const QStringList &urls)
         return false;
     }
 
-    auto field = Expression::Field<FileTagInfo>;
+    auto field = Expression::Field<TagFileEntry>;
     for (const auto &url : urls) {
-        if (!handle->remove<FileTagInfo>(field("filePath") == url))
+        QString dir, name;
+        if (!splitPath(url, &dir, &name))
+            continue;
+        int dirIndex = findDir(dir);
+        if (dirIndex < 0)
+            continue;
+
+        if (!handle->remove<TagFileEntry>(field("dirIndex") == dirIndex && field("fileName") == name))
+            return false;
+
+        if (!pruneDir(dirIndex))
             return false;
     }
 
@@ -412,24 +484,46 @@ void TagDbHandler::initialize()
     }
     db.close();
 
-    if (!createTable(kTagTableFileTags))
-        fmWarning() << "Create table failed:" << kTagTableFileTags;
+    if (!createTable(kTagTableFileEntries))
+        fmWarning() << "Create table failed:" << kTagTableFileEntries;
+
+    if (!createTable(kTagTableDirEntries))
+        fmWarning() << "Create table failed:" << kTagTableDirEntries;
 
     if (!createTable(kTagTableTagProperty))
-        fmWarning() << "Create table failed:" << kTagTableFileTags;
+        fmWarning() << "Create table failed:" << kTagTableTagProperty;
+
+    if (!createIndexes())
+        fmWarning() << "Create indexes of tag tables failed";
+
+    loadDirNodes();
+    if (schemaVersion() < kTagSchemaVersion) {
+        if (migrateLegacyFileTags())
+            setSchemaVersion(kTagSchemaVersion);
+        else
+            fmWarning() << "Migrate file tags failed, the legacy table is kept";
+    }
 }
 
 bool TagDbHandler::createTable(const QString &tableName)
 {
     bool ret = false;
-    if (SqliteHelper::tableName<FileTagInfo>() == tableName) {
+    if (SqliteHelper::tableName<TagFileEntry>() == tableName) {
 
-        ret = handle->createTable<FileTagInfo>(
+        ret = handle->createTable<TagFileEntry>(
                 SqliteConstraint::primary("fileIndex"),
                 SqliteConstraint::autoIncreament("fileIndex"),
                 SqliteConstraint::unique("fileIndex"));
     }
 
+    if (SqliteHelper::tableName<TagDirEntry>() == tableName) {
+
+        ret = handle->createTable<TagDirEntry>(
+                SqliteConstraint::primary("dirIndex"),
+                SqliteConstraint::autoIncreament("dirIndex"),
+                SqliteConstraint::unique("dirIndex"));
+    }
+
     if (SqliteHelper::tableName<TagProperty>() == tableName) {
 
         ret = handle->createTable<TagProperty>(
@@ -441,6 +535,325 @@ bool TagDbHandler::createTable(const QString &tableName)
     return ret;
 }
 
+bool TagDbHandler::createIndexes()
+{
+    const QString &fileTable = SqliteHelper::tableName<TagFileEntry>();
+    const QString &dirTable = SqliteHelper::tableName<TagDirEntry>();
+    const QString &tagTable = SqliteHelper::tableName<TagProperty>();
+
+    const QStringList sqls {
+        "CREATE INDEX IF NOT EXISTS idx_" + fileTable + "_tag ON " + fileTable + "(tagName);",
+        "CREATE INDEX IF NOT EXISTS idx_" + fileTable + "_path ON " + fileTable + "(dirIndex, fileName);",
+        "CREATE UNIQUE INDEX IF NOT EXISTS idx_" + dirTable + "_path ON " + dirTable + "(parentIndex, dirName);",
+        "CREATE INDEX IF NOT EXISTS idx_" + tagTable + "_name ON " + tagTable + "(tagName);"
+    };
+
+    bool ret = true;
+    for (const auto &sql : sqls)
+        ret = handle->excute(sql) && ret;
+    return ret;
+}
+
+bool TagDbHandler::tableExists(const QString &tableName)
+{
+    bool exists = false;
+    handle->excute("SELECT name FROM sqlite_master WHERE type='table' AND name='" + tableName + "';",
+                   [&exists](QSqlQuery *query) { exists = query->next(); });
+    return exists;
+}
+
+/*!
+ * \brief TagDbHandler::schemaVersion
+ * \return the layout version of the tag tables, 1 if the database has never been upgraded by the daemon
+ */
+int TagDbHandler::schemaVersion()
+{
+    const QString &table { kTagTableSchemaVersion };
+    if (!handle->excute("CREATE TABLE IF NOT EXISTS " + table + " (version INTEGER NOT NULL);"))
+        return 1;
+
+    int version = 1;
+    handle->excute("SELECT version FROM " + table + ";", [&version](QSqlQuery *query) {
+        if (query->next())
+            version = query->value(0).toInt();
+    });
+    return version;
+}
+
+bool TagDbHandler::setSchemaVersion(int version)
+{
+    const QString &table { kTagTableSchemaVersion };
+    return handle->transaction([&table, version, this]() -> bool {
+        return handle->excute("DELETE FROM " + table + ";")
+                && handle->excute("INSERT INTO " + table + " (version) VALUES (" + QString::number(version) + ");");
+    });
+}
+
+void TagDbHandler::loadDirNodes()
+{
+    dirNodes.clear();
+    dirChildren.clear();
+    childDirCount.clear();
+    dirPathCache.clear();
+
+    const auto &beans = handle->query<TagDirEntry>().toBeans();
+    for (auto &bean : beans)
+        setDirNode(bean->getDirIndex(), bean->getParentIndex(), bean->getDirName());
+}
+
+/*!
+ * \brief TagDbHandler::migrateLegacyFileTags, move the rows of file_tags, which keep the full path of files,
+ * into the dir interned tables in one transaction, and drop file_tags then.
+ * It runs once, the schema version is raised after it, the upgrade tool writes the new tables directly.
+ */
+bool TagDbHandler::migrateLegacyFileTags()
+{
+    const QString &legacyTable = SqliteHelper::tableName<FileTagInfo>();
+    if (!tableExists(legacyTable))
+        return true;
+
+    const auto &beans = handle->query<FileTagInfo>().toBeans();
+    fmInfo() << "Migrate" << beans.size() << "rows of" << legacyTable;
+
+    bool ret = handle->transaction([&beans, &legacyTable, this]() -> bool {
+        QSet<QPair<QString, QString>> migrated;
+        for (auto &bean : beans) {
+            const QPair<QString, QString> fileTag { bean->getFilePath(), bean->getTagName() };
+            QString dir, name;
+            if (migrated.contains(fileTag) || !splitPath(fileTag.first, &dir, &name))
+                continue;
+            migrated.insert(fileTag);
+
+            int dirIndex = internDir(dir);
+            if (dirIndex < 0)
+                return false;
+
+            TagFileEntry entry;
+            entry.setDirIndex(dirIndex);
+            entry.setFileName(name);
+            entry.setTagName(fileTag.second);
+            entry.setTagOrder(bean->getTagOrder());
+            entry.setFuture(bean->getFuture());
+            if (-1 == handle->insert<TagFileEntry>(entry))
+                return false;
+        }
+
+        return handle->excute("DROP TABLE " + legacyTable + ";");
+    });
+
+    // the dirs inserted by the rolled back transaction are dropped
+    if (!ret)
+        loadDirNodes();
+
+    return ret;
+}
+
+bool TagDbHandler::splitPath(const QString &path, QString *dir, QString *name)
+{
+    QString filePath { path };
+    while (filePath.length() > 1 && filePath.endsWith('/'))
+        filePath.chop(1);
+
+    if (!filePath.startsWith('/') || filePath.length() == 1)
+        return false;
+
+    int index = filePath.lastIndexOf('/');
+    *dir = index == 0 ? QString("/") : filePath.left(index);
+    *name = filePath.mid(index + 1);
+    return true;
+}
+
+/*!
+ * \brief TagDbHandler::findDir
+ * \param dirPath
+ * \return the index of dir, 0 is the root, -1 means there is no tagged file under the dir
+ */
+int TagDbHandler::findDir(const QString &dirPath) const
+{
+    int dirIndex = 0;
+    const auto &names = dirPath.split('/', QString::SkipEmptyParts);
+    for (const auto &name : names) {
+        auto it = dirChildren.constFind({ dirIndex, name });
+        if (it == dirChildren.constEnd())
+            return -1;
+        dirIndex = it.value();
+    }
+
+    return dirIndex;
+}
+
+int TagDbHandler::internDir(const QString &dirPath)
+{
+    int dirIndex = 0;
+    bool reloaded = false;
+    const auto &names = dirPath.split('/', QString::SkipEmptyParts);
+    for (int i = 0; i < names.size(); ++i) {
+        const QString &name = names.at(i);
+        auto it = dirChildren.constFind({ dirIndex, name });
+        if (it != dirChildren.constEnd()) {
+            dirIndex = it.value();
+            continue;
+        }
+
+        TagDirEntry entry;
+        entry.setParentIndex(dirIndex);
+        entry.setDirName(name);
+        int newIndex = handle->insert<TagDirEntry>(entry);
+        if (-1 == newIndex && !reloaded) {
+            // the node may be inserted by the upgrade tool, look it up again from the top
+            reloaded = true;
+            loadDirNodes();
+            dirIndex = 0;
+            i = -1;
+            continue;
+        }
+        if (-1 == newIndex) {
+            lastErr = QString("Insert dir failed! dir: %1").arg(dirPath);
+            return -1;
+        }
+        setDirNode(newIndex, dirIndex, name);
+        dirIndex = newIndex;
+    }
+
+    return dirIndex;
+}
+
+QString TagDbHandler::pathOfDir(int dirIndex) const
+{
+    if (dirIndex == 0)
+        return "/";
+
+    auto cached = dirPathCache.constFind(dirIndex);
+    if (cached != dirPathCache.constEnd())
+        return cached.value();
+
+    auto it = dirNodes.constFind(dirIndex);
+    if (it == dirNodes.constEnd())
+        return {};
+
+    const QString &path = pathOfFile(it.value().parent, it.value().name);
+    dirPathCache.insert(dirIndex, path);
+    return path;
+}
+
+QString TagDbHandler::pathOfFile(int dirIndex, const QString &name) const
+{
+    return dirIndex == 0 ? "/" + name : pathOfDir(dirIndex) + "/" + name;
+}
+
+void TagDbHandler::setDirNode(int dirIndex, int parent, const QString &name)
+{
+    auto it = dirNodes.find(dirIndex);
+    if (it != dirNodes.end()) {
+        // moved, the cached paths of the sub dirs are out of date
+        dirChildren.remove({ it.value().parent, it.value().name });
+        --childDirCount[it.value().parent];
+        dirPathCache.clear();
+    }
+
+    dirNodes.insert(dirIndex, { parent, name });
+    dirChildren.insert({ parent, name }, dirIndex);
+    ++childDirCount[parent];
+}
+
+void TagDbHandler::removeDirNode(int dirIndex)
+{
+    auto it = dirNodes.find(dirIndex);
+    if (it == dirNodes.end())
+        return;
+
+    dirChildren.remove({ it.value().parent, it.value().name });
+    --childDirCount[it.value().parent];
+    childDirCount.remove(dirIndex);
+    dirNodes.erase(it);
+    dirPathCache.clear();
+}
+
+/*!
+ * \brief TagDbHandler::pruneDir, remove the dir and then its parents up to the root,
+ * as long as they have neither tagged files nor sub dirs
+ */
+bool TagDbHandler::pruneDir(int dirIndex)
+{
+    const auto &field = Expression::Field<TagFileEntry>;
+    const auto &dirField = Expression::Field<TagDirEntry>;
+    while (dirIndex > 0 && dirNodes.contains(dirIndex) && childDirCount.value(dirIndex) <= 0) {
+        if (!handle->query<TagFileEntry>().where(field("dirIndex") == dirIndex).take(1).toBeans().isEmpty())
+            return true;
+
+        if (!handle->remove<TagDirEntry>(dirField("dirIndex") == dirIndex)) {
+            lastErr = QString("Remove dir failed! dir: %1").arg(pathOfDir(dirIndex));
+            return false;
+        }
+        int parent = dirNodes.value(dirIndex).parent;
+        removeDirNode(dirIndex);
+        dirIndex = parent;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief TagDbHandler::pruneEmptyDirs, prune all the dirs without sub dirs, after the rows of many dirs were removed
+ */
+bool TagDbHandler::pruneEmptyDirs()
+{
+    QList<int> leaves;
+    for (auto it = dirNodes.constBegin(); it != dirNodes.constEnd(); ++it) {
+        if (childDirCount.value(it.key()) <= 0)
+            leaves.append(it.key());
+    }
+
+    for (int leaf : leaves) {
+        if (!pruneDir(leaf))
+            return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief TagDbHandler::mergeDir, a dir is moved to a path which was a dir with tagged files,
+ * the files and sub dirs of `from` are moved into `to`, and `from` is removed
+ */
+bool TagDbHandler::mergeDir(int from, int to)
+{
+    const auto &field = Expression::Field<TagFileEntry>;
+    if (!handle->update<TagFileEntry>(field("dirIndex") = to, field("dirIndex") == from)) {
+        lastErr = QString("Move files of dir failed! from: %1, to: %2").arg(pathOfDir(from)).arg(pathOfDir(to));
+        return false;
+    }
+
+    QList<int> children;
+    for (auto it = dirNodes.constBegin(); it != dirNodes.constEnd(); ++it) {
+        if (it.value().parent == from)
+            children.append(it.key());
+    }
+
+    const auto &dirField = Expression::Field<TagDirEntry>;
+    for (int child : children) {
+        const QString name = dirNodes.value(child).name;
+        int existed = dirChildren.value({ to, name }, -1);
+        if (existed >= 0) {
+            if (!mergeDir(child, existed))
+                return false;
+            continue;
+        }
+
+        if (!handle->update<TagDirEntry>(dirField("parentIndex") = to, dirField("dirIndex") == child)) {
+            lastErr = QString("Move dir failed! dir: %1").arg(pathOfDir(child));
+            return false;
+        }
+        setDirNode(child, to, name);
+    }
+
+    if (!handle->remove<TagDirEntry>(dirField("dirIndex") == from)) {
+        lastErr = QString("Remove dir failed! dir: %1").arg(pathOfDir(from));
+        return false;
+    }
+    removeDirNode(from);
+    return true;
+}
+
 bool TagDbHandler::checkTag(const QString &tag)
 {
     return handle->query<TagProperty>().where(Expression::Field<TagProperty>("tagName") == tag).toBeans().size() > 0;
@@ -480,16 +893,27 @@ bool TagDbHandler::tagFile(const QString &file, const QVariant &tags)
         return false;
     }
 
+    QString dir, name;
+    if (!splitPath(file, &dir, &name)) {
+        lastErr = QString("Tag file failed! invalid path: %1").arg(file);
+        return false;
+    }
+
+    int dirIndex = internDir(dir);
+    if (dirIndex < 0)
+        return false;
+
     // insert file--tags
     const QStringList &tempTags = tags.toStringList();
     int suc = tempTags.count();
     for (const auto &tag : tempTags) {
-        FileTagInfo temp;
-        temp.setFilePath(file);
+        TagFileEntry temp;
+        temp.setDirIndex(dirIndex);
+        temp.setFileName(name);
         temp.setTagName(tag);
         temp.setTagOrder(0);
         temp.setFuture("null");
-        if (-1 == handle->insert<FileTagInfo>(temp))
+        if (-1 == handle->insert<TagFileEntry>(temp))
             break;
         suc--;
     }
@@ -512,11 +936,19 @@ bool TagDbHandler::removeSpecifiedTagOfFile(const QString &url, const QVariant &
         return false;
     }
 
-    auto field = Expression::Field<FileTagInfo>;
+    QString dir, name;
+    int dirIndex = splitPath(url, &dir, &name) ? findDir(dir) : -1;
+    if (dirIndex < 0) {
+        // the file has no tag
+        finally.dismiss();
+        return true;
+    }
+
+    auto field = Expression::Field<TagFileEntry>;
     const auto tempTags = val.toStringList();
     int suc = tempTags.count();
     for (const auto &tag : tempTags) {
-        if (!handle->remove<FileTagInfo>((field("filePath") == url) && (field("tagName") == tag)))
+        if (!handle->remove<TagFileEntry>(field("dirIndex") == dirIndex && field("fileName") == name && field("tagName") == tag))
             break;
         suc--;
     }
@@ -526,6 +958,9 @@ bool TagDbHandler::removeSpecifiedTagOfFile(const QString &url, const QVariant &
         return false;
     }
 
+    if (!pruneDir(dirIndex))
+        return false;
+
     finally.dismiss();
     return true;
 }
@@ -565,8 +1000,8 @@ bool TagDbHandler::changeTagNameWithFile(const QString &tagName, const QString &
             lastErr = QString("Change tag name failed! tagName: %1, newName: %2").arg(tagName).arg(newName);
             return false;
         }
-        if (!handle->update<FileTagInfo>(Expression::Field<FileTagInfo>("tagName") = newName,
-                                         Expression::Field<FileTagInfo>("tagName") == tagName)) {
+        if (!handle->update<TagFileEntry>(Expression::Field<TagFileEntry>("tagName") = newName,
+                                          Expression::Field<TagFileEntry>("tagName") == tagName)) {
             lastErr = QString("Change file tag name failed! tagName: %1, newName: %2").arg(tagName).arg(newName);
             return false;
         }
@@ -589,12 +1024,58 @@ bool TagDbHandler::changeFilePath(const QString &oldPath, const QString &newPath
         return false;
     }
 
-    const auto &field = Expression::Field<FileTagInfo>;
-    if (!handle->update<TagProperty>(field("filePath") = newPath, field("filePath") == oldPath)) {
-        lastErr = QString("Change file path failed! oldPath: %1, newPath: %2").arg(oldPath).arg(oldPath);
+    QString oldDir, oldName, newDir, newName;
+    if (!splitPath(oldPath, &oldDir, &oldName) || !splitPath(newPath, &newDir, &newName)) {
+        lastErr = QString("Change file path failed! invalid path, oldPath: %1, newPath: %2").arg(oldPath).arg(newPath);
         return false;
     }
 
+    int oldParent = findDir(oldDir);
+    if (oldParent < 0) {
+        // no tagged file under the old path
+        finally.dismiss();
+        return true;
+    }
+
+    int newParent = internDir(newDir);
+    if (newParent < 0)
+        return false;
+
+    // the tags of the file itself
+    const auto &field = Expression::Field<TagFileEntry>;
+    if (!handle->update<TagFileEntry>((field("dirIndex") = newParent) && (field("fileName") = newName),
+                                      field("dirIndex") == oldParent && field("fileName") == oldName)) {
+        lastErr = QString("Change file path failed! oldPath: %1, newPath: %2").arg(oldPath).arg(newPath);
+        return false;
+    }
+
+    // the tagged files under the dir follow its node, only one row is updated
+    int oldNode = dirChildren.value({ oldParent, oldName }, -1);
+    if (oldNode < 0) {
+        // the new dir is interned for nothing if the file has no tag
+        if (!pruneDir(oldParent) || !pruneDir(newParent))
+            return false;
+        finally.dismiss();
+        return true;
+    }
+
+    int newNode = dirChildren.value({ newParent, newName }, -1);
+    if (newNode >= 0) {
+        if (!mergeDir(oldNode, newNode))
+            return false;
+    } else {
+        const auto &dirField = Expression::Field<TagDirEntry>;
+        if (!handle->update<TagDirEntry>((dirField("parentIndex") = newParent) && (dirField("dirName") = newName),
+                                         dirField("dirIndex") == oldNode)) {
+            lastErr = QString("Change dir path failed! oldPath: %1, newPath: %2").arg(oldPath).arg(newPath);
+            return false;
+        }
+        setDirNode(oldNode, newParent, newName);
+    }
+
+    if (!pruneDir(oldParent))
+        return false;
+
     finally.dismiss();
     return true;
 }
@@ -10,6 +10,7 @@
 #include <dfm-base/base/db/sqlitehandle.h>
 
 #include <QObject>
+#include <QHash>
 
 SERVERTAGDAEMON_BEGIN_NAMESPACE
 
@@ -45,6 +46,7 @@ public:
     QVariant getSameTagsOfDiffUrls(const QStringList &urlList);
     QVariantMap getFilesByTag(const QStringList &tags);
     QVariantHash getAllFileWithTags();
+    QVariantHash getFilesWithTagsOfDirs(const QStringList &dirs);
 
     bool addTagProperty(const QVariantMap &data);
     bool addTagsForFiles(const QVariantMap &data);
@@ -58,9 +60,32 @@ public:
     QString lastError() const;
 
 private:
+    struct DirNode
+    {
+        int parent { 0 };
+        QString name;
+    };
+
     explicit TagDbHandler(QObject *parent = nullptr);
     void initialize();
     bool createTable(const QString &tableName);
+    bool createIndexes();
+    bool tableExists(const QString &tableName);
+    int schemaVersion();
+    bool setSchemaVersion(int version);
+    void loadDirNodes();
+    bool migrateLegacyFileTags();
+
+    static bool splitPath(const QString &path, QString *dir, QString *name);
+    int findDir(const QString &dirPath) const;
+    int internDir(const QString &dirPath);
+    QString pathOfDir(int dirIndex) const;
+    QString pathOfFile(int dirIndex, const QString &name) const;
+    void setDirNode(int dirIndex, int parent, const QString &name);
+    void removeDirNode(int dirIndex);
+    bool pruneDir(int dirIndex);
+    bool pruneEmptyDirs();
+    bool mergeDir(int from, int to);
     bool checkTag(const QString &tag);
     bool insertTagProperty(const QString &name, const QVariant &value);
     bool tagFile(const QString &file, const QVariant &tags);
@@ -80,6 +105,12 @@ Q_SIGNALS:
 private:
     QScopedPointer<DFMBASE_NAMESPACE::SqliteHandle> handle;
     QString lastErr;
+
+    // the whole tag_dir_entries table, it only holds the dirs which have tagged files
+    QHash<int, DirNode> dirNodes;   // dir index -> parent and name
+    QHash<QPair<int, QString>, int> dirChildren;   // parent and name -> dir index
+    QHash<int, int> childDirCount;   // dir index -> count of sub dirs
+    mutable QHash<int, QString> dirPathCache;   // dir index -> absolute path, cleared when a dir is moved
 };
 
 SERVERTAGDAEMON_END_NAMESPACE
@@ -48,6 +48,9 @@ QDBusVariant TagManagerDBus::Query(int opt, const QStringList value)
     case QueryOpts::kTagIntersectionOfFiles:
         dbusVar.setVariant(TagDbHandler::instance()->getSameTagsOfDiffUrls(value));
         break;
+    case QueryOpts::kFilesWithTagsOfDirs:
+        dbusVar.setVariant(TagDbHandler::instance()->getFilesWithTagsOfDirs(value));
+        break;
     }
 
     return dbusVar;
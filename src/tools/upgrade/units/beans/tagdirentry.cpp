@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tagdirentry.h"
+
+using namespace dfm_upgrade;
+
+TagDirEntry::TagDirEntry(QObject *parent)
+    : QObject(parent)
+{
+}
+
+int TagDirEntry::getDirIndex() const
+{
+    return dirIndex;
+}
+
+void TagDirEntry::setDirIndex(int value)
+{
+    dirIndex = value;
+}
+
+int TagDirEntry::getParentIndex() const
+{
+    return parentIndex;
+}
+
+void TagDirEntry::setParentIndex(int value)
+{
+    parentIndex = value;
+}
+
+QString TagDirEntry::getDirName() const
+{
+    return dirName;
+}
+
+void TagDirEntry::setDirName(const QString &value)
+{
+    dirName = value;
+}
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tagfileentry.h"
+
+using namespace dfm_upgrade;
+
+TagFileEntry::TagFileEntry(QObject *parent)
+    : QObject(parent)
+{
+}
+
+int TagFileEntry::getFileIndex() const
+{
+    return fileIndex;
+}
+
+void TagFileEntry::setFileIndex(int value)
+{
+    fileIndex = value;
+}
+
+int TagFileEntry::getDirIndex() const
+{
+    return dirIndex;
+}
+
+void TagFileEntry::setDirIndex(int value)
+{
+    dirIndex = value;
+}
+
+QString TagFileEntry::getFileName() const
+{
+    return fileName;
+}
+
+void TagFileEntry::setFileName(const QString &value)
+{
+    fileName = value;
+}
+
+QString TagFileEntry::getTagName() const
+{
+    return tagName;
+}
+
+void TagFileEntry::setTagName(const QString &value)
+{
+    tagName = value;
+}
+
+int TagFileEntry::getTagOrder() const
+{
+    return tagOrder;
+}
+
+void TagFileEntry::setTagOrder(int value)
+{
+    tagOrder = value;
+}
+
+QString TagFileEntry::getFuture() const
+{
+    return future;
+}
+
+void TagFileEntry::setFuture(const QString &value)
+{
+    future = value;
+}
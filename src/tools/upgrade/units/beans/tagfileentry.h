@@ -1,32 +1,40 @@
-// SPDX-FileCopyrightText: 2022 - 2023 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
-#ifndef FILETAGINFO_H
-#define FILETAGINFO_H
+#ifndef TAGFILEENTRY_H
+#define TAGFILEENTRY_H
 
 #include <QObject>
 
 namespace dfm_upgrade {
-class FileTagInfo : public QObject
+
+/*!
+ * \brief The TagFileEntry class is a tag of a file, the file is stored as its parent TagDirEntry and its name.
+ */
+class TagFileEntry : public QObject
 {
     Q_OBJECT
 
-    Q_CLASSINFO("TableName", "file_tags")
+    Q_CLASSINFO("TableName", "tag_file_entries")
     Q_PROPERTY(int fileIndex READ getFileIndex WRITE setFileIndex)
-    Q_PROPERTY(QString filePath READ getFilePath WRITE setFilePath)
+    Q_PROPERTY(int dirIndex READ getDirIndex WRITE setDirIndex)
+    Q_PROPERTY(QString fileName READ getFileName WRITE setFileName)
     Q_PROPERTY(QString tagName READ getTagName WRITE setTagName)
     Q_PROPERTY(int tagOrder READ getTagOrder WRITE setTagOrder)
     Q_PROPERTY(QString future READ getFuture WRITE setFuture)
 
 public:
-    explicit FileTagInfo(QObject *parent = nullptr);
+    explicit TagFileEntry(QObject *parent = nullptr);
 
     int getFileIndex() const;
     void setFileIndex(int value);
 
-    QString getFilePath() const;
-    void setFilePath(const QString &value);
+    int getDirIndex() const;
+    void setDirIndex(int value);
+
+    QString getFileName() const;
+    void setFileName(const QString &value);
 
     QString getTagName() const;
     void setTagName(const QString &value);
@@ -39,11 +47,13 @@ public:
 
 private:
     int fileIndex {};
-    QString filePath {};
+    int dirIndex {};
+    QString fileName {};
     QString tagName {};
     int tagOrder {};
     QString future {};
 };
+
 } // dfm_upgrade
 
-#endif   // FILETAGINFO_H
+#endif   // TAGFILEENTRY_H
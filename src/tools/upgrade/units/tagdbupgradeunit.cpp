@@ -3,7 +3,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "tagdbupgradeunit.h"
-#include "beans/filetaginfo.h"
+#include "beans/tagdirentry.h"
+#include "beans/tagfileentry.h"
 #include "beans/tagproperty.h"
 #include "beans/oldfileproperty.h"
 #include "beans/oldtagproperty.h"
@@ -28,7 +29,8 @@ static constexpr char kTagOldDb2TableFileProperty[] = "file_property";
 static constexpr char kTagOldDb2TableTagWithFile[] = "tag_with_file";
 
 static constexpr char kTagNewDbName[] = "dfmruntime.db";
-static constexpr char kTagNewTableFileTags[] = "file_tags";
+static constexpr char kTagNewTableFileEntries[] = "tag_file_entries";
+static constexpr char kTagNewTableDirEntries[] = "tag_dir_entries";
 static constexpr char kTagNewTableTagProperty[] = "tag_property";
 
 using namespace dfm_upgrade;
@@ -85,7 +87,7 @@ bool TagDbUpgradeUnit::upgradeTagDb()
     if (!upgradeTagProperty())
         return false;
 
-    // upgrade file_tags
+    // upgrade tag_file_entries
     if (!upgradeFileTag())
         return false;
 
@@ -106,14 +108,22 @@ bool TagDbUpgradeUnit::chechTable(SqliteHandle *handle, const QString &tableName
 bool TagDbUpgradeUnit::createTableForNewDb(const QString &tableName)
 {
     bool ret = false;
-    if (SqliteHelper::tableName<FileTagInfo>() == tableName) {
+    if (SqliteHelper::tableName<TagFileEntry>() == tableName) {
 
-        ret = newTagDbhandle->createTable<FileTagInfo>(
+        ret = newTagDbhandle->createTable<TagFileEntry>(
                 SqliteConstraint::primary("fileIndex"),
                 SqliteConstraint::autoIncreament("fileIndex"),
                 SqliteConstraint::unique("fileIndex"));
     }
 
+    if (SqliteHelper::tableName<TagDirEntry>() == tableName) {
+
+        ret = newTagDbhandle->createTable<TagDirEntry>(
+                SqliteConstraint::primary("dirIndex"),
+                SqliteConstraint::autoIncreament("dirIndex"),
+                SqliteConstraint::unique("dirIndex"));
+    }
+
     if (SqliteHelper::tableName<TagProperty>() == tableName) {
 
         ret = newTagDbhandle->createTable<TagProperty>(
@@ -173,6 +183,10 @@ QString TagDbUpgradeUnit::getColorRGB(const QString &color)
     return colorMap[color];
 }
 
+/*!
+ * \brief TagDbUpgradeUnit::upgradeFileTag, write the tags of the old files in the layout of the tag daemon,
+ * a file is stored as the node of its parent dir in tag_dir_entries and its name
+ */
 bool TagDbUpgradeUnit::upgradeFileTag()
 {
     // read old table
@@ -180,22 +194,61 @@ bool TagDbUpgradeUnit::upgradeFileTag()
     if (filePropertyBean.isEmpty())
         return true;
 
-    for (auto &bean : filePropertyBean) {
-        QString curpath = checkFileUrl(bean->getFilePath());
-        if (curpath.isEmpty())
-            continue;
-
-        FileTagInfo info;
-        info.setFilePath(curpath);
-        info.setTagName(bean->getTag());
-        info.setTagOrder(0);
-        info.setFuture("null");
+    // the dirs may be there already, they are shared with the files tagged by the daemon
+    dirChildren.clear();
+    const auto &dirBeans = newTagDbhandle->query<TagDirEntry>().toBeans();
+    for (auto &bean : dirBeans)
+        dirChildren.insert({ bean->getParentIndex(), bean->getDirName() }, bean->getDirIndex());
+
+    return newTagDbhandle->transaction([&filePropertyBean, this]() -> bool {
+        for (auto &bean : filePropertyBean) {
+            QString curpath = checkFileUrl(bean->getFilePath());
+            if (curpath.isEmpty())
+                continue;
+
+            const int index = curpath.lastIndexOf('/');
+            int dirIndex = internDir(curpath.left(index));
+            if (dirIndex < 0) {
+                qCWarning(logToolUpgrade) << QString("%1 upgrade failed !").arg(bean->getFilePath());
+                continue;
+            }
+
+            TagFileEntry entry;
+            entry.setDirIndex(dirIndex);
+            entry.setFileName(curpath.mid(index + 1));
+            entry.setTagName(bean->getTag());
+            entry.setTagOrder(0);
+            entry.setFuture("null");
+
+            if (-1 == newTagDbhandle->insert<TagFileEntry>(entry))
+                qCWarning(logToolUpgrade) << QString("%1 upgrade failed !").arg(bean->getFilePath());
+        }
+        return true;
+    });
+}
 
-        if (-1 == newTagDbhandle->insert<FileTagInfo>(info))
-            qCWarning(logToolUpgrade) << QString("%1 upgrade failed !").arg(bean->getFilePath());
+int TagDbUpgradeUnit::internDir(const QString &dirPath)
+{
+    int dirIndex = 0;
+    const auto &names = dirPath.split('/', QString::SkipEmptyParts);
+    for (const auto &name : names) {
+        auto it = dirChildren.constFind({ dirIndex, name });
+        if (it != dirChildren.constEnd()) {
+            dirIndex = it.value();
+            continue;
+        }
+
+        TagDirEntry entry;
+        entry.setParentIndex(dirIndex);
+        entry.setDirName(name);
+        int newIndex = newTagDbhandle->insert<TagDirEntry>(entry);
+        if (-1 == newIndex)
+            return -1;
+        dirChildren.insert({ dirIndex, name }, newIndex);
+        dirIndex = newIndex;
     }
 
-    return true;
+    return dirIndex;
 }
 
 bool TagDbUpgradeUnit::checkOldDatabase()
@@ -259,7 +312,10 @@ bool TagDbUpgradeUnit::checkNewDatabase()
     if (!chechTable(newTagDbhandle, kTagNewTableTagProperty, true))
         return false;
 
-    if (!chechTable(newTagDbhandle, kTagNewTableFileTags, true))
+    if (!chechTable(newTagDbhandle, kTagNewTableFileEntries, true))
+        return false;
+
+    if (!chechTable(newTagDbhandle, kTagNewTableDirEntries, true))
         return false;
 
     return true;
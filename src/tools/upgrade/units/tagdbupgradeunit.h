@@ -8,6 +8,8 @@
 #include "core/upgradeunit.h"
 #include <dfm-base/base/db/sqlitehandle.h>
 
+#include <QHash>
+
 DFMBASE_USE_NAMESPACE
 
 class QSqlDatabase;
@@ -37,11 +39,13 @@ private:
     bool upgradeData();
     QString getColorRGB(const QString &color);
     QString checkFileUrl(const QString &filerUrl);
+    int internDir(const QString &dirPath);
 
 private:
     SqliteHandle *mainDbHandle { nullptr };
     SqliteHandle *deepinDbHandle { nullptr };
     SqliteHandle *newTagDbhandle { nullptr };
+    QHash<QPair<int, QString>, int> dirChildren;   // parent dir index and name -> dir index
 };
 }
 
@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BENCHDATA_H
+#define BENCHDATA_H
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <memory>
+#include <random>
+
+/*!
+ * \brief The BenchData class generates the synthetic data of the benchmarks.
+ * The data only depends on the seed and the count, so runs of different commits
+ * measure the same input. DFM_BENCH_SCALE multiplies the counts, a scale of 10
+ * turns the 100000 names of a flat directory into a million.
+ */
+class BenchData
+{
+public:
+    static constexpr unsigned kDefaultSeed { 20230518 };
+
+    static int scaled(int count)
+    {
+        bool ok = false;
+        const int scale = qEnvironmentVariableIntValue("DFM_BENCH_SCALE", &ok);
+        return ok && scale > 0 ? count * scale : count;
+    }
+
+    /*!
+     * \brief names file names mixing scripts, cases, numbers and suffixes as seen in
+     * real home directories, every name is unique
+     */
+    static QStringList names(int count, unsigned seed = kDefaultSeed)
+    {
+        static const QStringList kWords { "report", "Photo", "IMG_", "backup", "notes", "Final", "draft", "music",
+                                          "文档", "新建文件夹", "照片", "会议纪要", "资料",
+                                          "résumé", "Ärger", "façade", "niño",
+                                          "отчёт", "Музыка", "写真", "ファイル", "데이터" };
+        static const QStringList kSuffixes { "", ".txt", ".pdf", ".jpg", ".png", ".tar.gz", ".docx", ".mp3", ".desktop" };
+
+        std::mt19937 engine(seed);
+        std::uniform_int_distribution<int> word(0, kWords.size() - 1);
+        std::uniform_int_distribution<int> suffix(0, kSuffixes.size() - 1);
+        std::uniform_int_distribution<int> number(0, 9999);
+        std::uniform_int_distribution<int> shape(0, 3);
+
+        QStringList result;
+        result.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            QString name;
+            switch (shape(engine)) {
+            case 0:   // file2 and file10
+                name = kWords.at(word(engine)) + QString::number(number(engine));
+                break;
+            case 1:
+                name = kWords.at(word(engine)) + " " + kWords.at(word(engine));
+                break;
+            case 2:
+                name = QString::number(number(engine)) + "_" + kWords.at(word(engine));
+                break;
+            default:
+                name = kWords.at(word(engine)).toUpper() + "-" + kWords.at(word(engine));
+                break;
+            }
+            // the index keeps the names unique
+            result.append(name + "." + QString::number(i, 36) + kSuffixes.at(suffix(engine)));
+        }
+        return result;
+    }
+
+    /*!
+     * \brief temporaryDir a temporary directory on a tmpfs when there is one,
+     * the traversals then measure the code rather than the disk
+     */
+    static std::unique_ptr<QTemporaryDir> temporaryDir()
+    {
+        QStringList bases { QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation), "/dev/shm" };
+        for (const QString &base : bases) {
+            if (base.isEmpty() || !QFileInfo(base).isWritable())
+                continue;
+            std::unique_ptr<QTemporaryDir> dir(new QTemporaryDir(base + "/dfm-bench-XXXXXX"));
+            if (dir->isValid())
+                return dir;
+        }
+        return std::unique_ptr<QTemporaryDir>(new QTemporaryDir);
+    }
+
+    // empty files named by names() in a single directory
+    static bool createFlatDir(const QString &path, int count, unsigned seed = kDefaultSeed)
+    {
+        if (!QDir().mkpath(path))
+            return false;
+        for (const QString &name : names(count, seed)) {
+            if (!touch(path + "/" + name))
+                return false;
+        }
+        return true;
+    }
+
+    // dirCount directories of filesPerDir empty files each
+    static bool createTree(const QString &path, int dirCount, int filesPerDir, unsigned seed = kDefaultSeed)
+    {
+        for (int dir = 0; dir < dirCount; ++dir) {
+            if (!createFlatDir(QString("%1/dir%2").arg(path).arg(dir), filesPerDir, seed + static_cast<unsigned>(dir)))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    static bool touch(const QString &filePath)
+    {
+        const int fd = ::open(QFile::encodeName(filePath).constData(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return false;
+        ::close(fd);
+        return true;
+    }
+};
+
+#endif   // BENCHDATA_H
@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+# coding=utf-8
+
+# SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+
+# Compare the QtTest xml results of two benchmark runs, such as the
+# benchmark-results directories of the builds of two commits:
+#   compare-results.py build-old/benchmark-results build-new/benchmark-results
+# The exit code is 1 if a result is slower than the threshold.
+
+import argparse
+import os
+import sys
+import xml.etree.ElementTree as ET
+
+
+def load_results(result_dir):
+    results = {}
+    for file_name in sorted(os.listdir(result_dir)):
+        if not file_name.endswith(".xml"):
+            continue
+        bench = file_name[:-len(".xml")]
+        root = ET.parse(os.path.join(result_dir, file_name)).getroot()
+        for function in root.iter("TestFunction"):
+            for result in function.iter("BenchmarkResult"):
+                # the xml logger already writes the value of one iteration
+                key = (bench, function.get("name"), result.get("tag", ""), result.get("metric"))
+                results[key] = float(result.get("value"))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="compare two benchmark result directories")
+    parser.add_argument("base", help="results of the reference run")
+    parser.add_argument("current", help="results of the run to check")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="slowdown in percent reported as a regression, 10 by default")
+    args = parser.parse_args()
+
+    base = load_results(args.base)
+    current = load_results(args.current)
+
+    regressions = 0
+    print("%-60s %14s %14s %9s" % ("benchmark", "base", "current", "change"))
+    for key in sorted(set(base) | set(current)):
+        name = "%s::%s(%s) %s" % key
+        if key not in base or key not in current:
+            print("%-60s %s" % (name, "only in current" if key in current else "only in base"))
+            continue
+
+        old, new = base[key], current[key]
+        change = (new - old) * 100.0 / old if old else 0.0
+        mark = ""
+        if change > args.threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        print("%-60s %14.4f %14.4f %+8.1f%%%s" % (name, old, new, change, mark))
+
+    if regressions:
+        print("%d result(s) slower than %.1f%%" % (regressions, args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "benchdata.h"
+
+#include <dfm-base/utils/fileutils.h>
+#include <dfm-base/base/device/deviceutils.h>
+
+#include <QtTest>
+
+#include <algorithm>
+
+DFMBASE_USE_NAMESPACE
+
+static constexpr int kNameCount { 100000 };
+static constexpr int kPathCount { 10000 };
+
+class BenchFileUtils : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void compareByStringEx_data();
+    void compareByStringEx();
+    void classifyPaths_data();
+    void classifyPaths();
+
+private:
+    QStringList names;
+    QList<QUrl> urls;
+};
+
+void BenchFileUtils::initTestCase()
+{
+    names = BenchData::names(BenchData::scaled(kNameCount));
+
+    // local, gvfs and smbmounts paths in a fixed order
+    const QStringList &prefixes { "/home/user/Documents/", "/run/user/1000/gvfs/smb-share:server=host,share=data/",
+                                  "/run/user/1000/gvfs/sftp:host=host/", "/run/user/1000/gvfs/mtp:host=phone/",
+                                  "/media/user/smbmounts/data/", "/media/user/usb/" };
+    const QStringList &pathNames = BenchData::names(kPathCount);
+    for (int i = 0; i < pathNames.size(); ++i)
+        urls.append(QUrl::fromLocalFile(prefixes.at(i % prefixes.size()) + pathNames.at(i)));
+}
+
+void BenchFileUtils::compareByStringEx_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("sort 1000 names") << 1000;
+    QTest::newRow("sort all names") << names.size();
+}
+
+void BenchFileUtils::compareByStringEx()
+{
+    QFETCH(int, count);
+
+    const QStringList &input = names.mid(0, count);
+    QBENCHMARK {
+        QStringList sorted = input;
+        std::sort(sorted.begin(), sorted.end(), &FileUtils::compareByStringEx);
+    }
+}
+
+void BenchFileUtils::classifyPaths_data()
+{
+    QTest::addColumn<QString>("check");
+    QTest::newRow("isSamba") << "isSamba";
+    QTest::newRow("isFtp") << "isFtp";
+    QTest::newRow("isMtpFile") << "isMtpFile";
+    QTest::newRow("isLowSpeedDevice") << "isLowSpeedDevice";
+    QTest::newRow("getLongestMountRootPath") << "getLongestMountRootPath";
+}
+
+void BenchFileUtils::classifyPaths()
+{
+    QFETCH(QString, check);
+
+    // the mount table is parsed for every path, a sample is enough
+    const int count = check == "getLongestMountRootPath" ? 100 : urls.size();
+    int matched = 0;
+    QBENCHMARK {
+        for (int i = 0; i < count; ++i) {
+            const QUrl &url = urls.at(i);
+            if (check == "isSamba")
+                matched += DeviceUtils::isSamba(url);
+            else if (check == "isFtp")
+                matched += DeviceUtils::isFtp(url);
+            else if (check == "isMtpFile")
+                matched += DeviceUtils::isMtpFile(url);
+            else if (check == "isLowSpeedDevice")
+                matched += DeviceUtils::isLowSpeedDevice(url);
+            else
+                matched += DeviceUtils::getLongestMountRootPath(url.path()).size();
+        }
+    }
+    QVERIFY(matched > 0);
+}
+
+QTEST_GUILESS_MAIN(BenchFileUtils)
+
+#include "bench_fileutils.moc"
@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "benchdata.h"
+
+#include <dfm-base/dfm_global_defines.h>
+#include <dfm-base/base/schemefactory.h>
+#include <dfm-base/base/urlroute.h>
+#include <dfm-base/file/local/syncfileinfo.h>
+#include <dfm-base/file/local/localfilewatcher.h>
+#include <dfm-base/utils/infocache.h>
+
+#include <QtTest>
+
+DFMBASE_USE_NAMESPACE
+
+static constexpr int kFileCount { 10000 };
+
+class BenchInfoCache : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void lookupCached();
+    void lookupMissing();
+    void createCached();
+
+private:
+    std::unique_ptr<QTemporaryDir> root;
+    QList<QUrl> urls;
+    QList<QUrl> missingUrls;
+};
+
+void BenchInfoCache::initTestCase()
+{
+    UrlRoute::regScheme(Global::Scheme::kFile, "/", QIcon(), false);
+    InfoFactory::regClass<SyncFileInfo>(Global::Scheme::kFile);
+    WatcherFactory::regClass<LocalFileWatcher>(Global::Scheme::kFile);
+
+    root = BenchData::temporaryDir();
+    QVERIFY(root->isValid());
+    const int count = BenchData::scaled(kFileCount);
+    QVERIFY(BenchData::createFlatDir(root->path(), count));
+
+    for (const QString &name : BenchData::names(count)) {
+        const QUrl &url = QUrl::fromLocalFile(root->filePath(name));
+        InfoCache::instance().cacheInfo(url, FileInfoPointer(new SyncFileInfo(url)));
+        urls.append(url);
+        missingUrls.append(QUrl::fromLocalFile(root->filePath("missing-" + name)));
+    }
+    QVERIFY(InfoCache::instance().getCacheInfo(urls.first()));
+}
+
+void BenchInfoCache::cleanupTestCase()
+{
+    InfoCache::instance().removeCaches(urls);
+}
+
+void BenchInfoCache::lookupCached()
+{
+    int found = 0;
+    QBENCHMARK {
+        for (const QUrl &url : urls)
+            found += !InfoCache::instance().getCacheInfo(url).isNull();
+    }
+    QVERIFY(found > 0);
+}
+
+void BenchInfoCache::lookupMissing()
+{
+    QBENCHMARK {
+        for (const QUrl &url : missingUrls)
+            InfoCache::instance().getCacheInfo(url);
+    }
+}
+
+// the path of the views, through the factory and the cache controller
+void BenchInfoCache::createCached()
+{
+    QBENCHMARK {
+        for (const QUrl &url : urls)
+            InfoFactory::create<FileInfo>(url);
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchInfoCache)
+
+#include "bench_infocache.moc"
@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "benchdata.h"
+
+#include <dfm-base/dfm_global_defines.h>
+#include <dfm-base/base/schemefactory.h>
+#include <dfm-base/base/urlroute.h>
+#include <dfm-base/file/local/localdiriterator.h>
+#include <dfm-base/file/local/syncfileinfo.h>
+
+#include <QDirIterator>
+#include <QtTest>
+
+#include <dirent.h>
+
+DFMBASE_USE_NAMESPACE
+
+static constexpr int kDirCount { 10 };
+static constexpr int kFilesPerDir { 1000 };
+
+class BenchTraversal : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void traverse_data();
+    void traverse();
+
+private:
+    std::unique_ptr<QTemporaryDir> root;
+    QStringList dirs;
+    int fileCount { 0 };
+};
+
+void BenchTraversal::initTestCase()
+{
+    UrlRoute::regScheme(Global::Scheme::kFile, "/", QIcon(), false);
+    InfoFactory::regClass<SyncFileInfo>(Global::Scheme::kFile);
+    DirIteratorFactory::regClass<LocalDirIterator>(Global::Scheme::kFile);
+
+    root = BenchData::temporaryDir();
+    QVERIFY(root->isValid());
+    const int filesPerDir = BenchData::scaled(kFilesPerDir);
+    QVERIFY(BenchData::createTree(root->path(), kDirCount, filesPerDir));
+    for (int i = 0; i < kDirCount; ++i)
+        dirs.append(QString("%1/dir%2").arg(root->path()).arg(i));
+    fileCount = kDirCount * filesPerDir;
+}
+
+void BenchTraversal::traverse_data()
+{
+    QTest::addColumn<QString>("walker");
+    QTest::newRow("readdir") << "readdir";
+    QTest::newRow("QDirIterator") << "QDirIterator";
+    QTest::newRow("LocalDirIterator") << "LocalDirIterator";
+    QTest::newRow("LocalDirIterator with infos") << "LocalDirIterator with infos";
+}
+
+void BenchTraversal::traverse()
+{
+    QFETCH(QString, walker);
+
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        for (const QString &dir : dirs) {
+            if (walker == "readdir") {
+                DIR *d = ::opendir(QFile::encodeName(dir).constData());
+                QVERIFY(d);
+                while (struct dirent *entry = ::readdir(d))
+                    count += entry->d_name[0] != '.';
+                ::closedir(d);
+            } else if (walker == "QDirIterator") {
+                QDirIterator it(dir, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+                while (it.hasNext()) {
+                    it.next();
+                    ++count;
+                }
+            } else {
+                const bool withInfos = walker.endsWith("infos");
+                LocalDirIterator it(QUrl::fromLocalFile(dir), {}, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+                while (it.hasNext()) {
+                    it.next();
+                    if (withInfos)
+                        it.fileInfo();
+                    ++count;
+                }
+            }
+        }
+    }
+    QCOMPARE(count, fileCount);
+}
+
+QTEST_GUILESS_MAIN(BenchTraversal)
+
+#include "bench_traversal.moc"
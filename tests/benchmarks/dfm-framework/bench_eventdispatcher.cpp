@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <dfm-framework/dpf.h>
+
+#include <QUrl>
+#include <QtTest>
+
+DPF_USE_NAMESPACE
+
+// a publish of a view event reaches a handful of plugins, each round publishes kPublishCount times
+static constexpr int kPublishCount { 10000 };
+static constexpr EventType kEventNoArgs { 9001 };
+static constexpr EventType kEventArgs { 9002 };
+
+class BenchReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    int received { 0 };
+
+public Q_SLOTS:
+    void onNoArgs() { ++received; }
+    void onArgs(quint64 winId, const QUrl &url, const QString &name)
+    {
+        received += winId > 0 && url.isValid() && !name.isEmpty();
+    }
+};
+
+class BenchEventDispatcher : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void publish_data();
+    void publish();
+
+private:
+    BenchReceiver receivers[10];
+};
+
+void BenchEventDispatcher::publish_data()
+{
+    QTest::addColumn<int>("subscribers");
+    QTest::addColumn<bool>("withArgs");
+    QTest::newRow("1 subscriber, no args") << 1 << false;
+    QTest::newRow("10 subscribers, no args") << 10 << false;
+    QTest::newRow("1 subscriber, 3 args") << 1 << true;
+    QTest::newRow("10 subscribers, 3 args") << 10 << true;
+}
+
+void BenchEventDispatcher::publish()
+{
+    QFETCH(int, subscribers);
+    QFETCH(bool, withArgs);
+
+    for (int i = 0; i < subscribers; ++i) {
+        QVERIFY(dpfSignalDispatcher->subscribe(kEventNoArgs, &receivers[i], &BenchReceiver::onNoArgs));
+        QVERIFY(dpfSignalDispatcher->subscribe(kEventArgs, &receivers[i], &BenchReceiver::onArgs));
+        receivers[i].received = 0;
+    }
+
+    const QUrl url("file:///home/user/Documents");
+    const QString name("report.pdf");
+    QBENCHMARK {
+        for (int i = 0; i < kPublishCount; ++i) {
+            if (withArgs)
+                dpfSignalDispatcher->publish(kEventArgs, quint64(1), url, name);
+            else
+                dpfSignalDispatcher->publish(kEventNoArgs);
+        }
+    }
+
+    QVERIFY(dpfSignalDispatcher->unsubscribe(kEventNoArgs));
+    QVERIFY(dpfSignalDispatcher->unsubscribe(kEventArgs));
+    QVERIFY(receivers[0].received > 0);
+}
+
+QTEST_GUILESS_MAIN(BenchEventDispatcher)
+
+#include "bench_eventdispatcher.moc"
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <dfm-base/utils/elidetextlayout.h>
+
+#include <QImage>
+#include <QPainter>
+#include <QtTest>
+
+DFMBASE_USE_NAMESPACE
+
+// the names of a dense icon view page, each round paints all of them,
+// so items per second is kItemCount divided by the time of one round
+static constexpr int kItemCount { 200 };
+static constexpr int kItemWidth { 100 };
+static constexpr int kLineHeight { 18 };
+
+class BenchElideTextLayout : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void paintItems_data();
+    void paintItems();
+
+private:
+    QStringList names;
+};
+
+void BenchElideTextLayout::initTestCase()
+{
+    for (int i = 0; i < kItemCount; ++i)
+        names.append(QString("A rather long file name of the item %1 in a dense view.tar.gz").arg(i));
+}
+
+void BenchElideTextLayout::paintItems_data()
+{
+    QTest::addColumn<bool>("cached");
+    QTest::newRow("shaped every paint") << false;
+    QTest::newRow("cached lines") << true;
+}
+
+void BenchElideTextLayout::paintItems()
+{
+    QFETCH(bool, cached);
+
+    QImage image(kItemWidth, kLineHeight * 3, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    const QRectF rect(0, 0, kItemWidth, kLineHeight * 3);
+
+    ElideTextLayout::clearLayoutCache();
+    QBENCHMARK {
+        for (const QString &name : names) {
+            if (!cached)
+                ElideTextLayout::clearLayoutCache();
+
+            ElideTextLayout layout(name);
+            layout.setAttribute(ElideTextLayout::kLineHeight, kLineHeight);
+            layout.setAttribute(ElideTextLayout::kFont, painter.font());
+            layout.layout(rect, Qt::ElideMiddle, &painter, QBrush(Qt::blue));
+        }
+    }
+}
+
+QTEST_MAIN(BenchElideTextLayout)
+
+#include "bench_elidetextlayout.moc"
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tagdbhandler.h"
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+DFM_LOG_REISGER_CATEGORY(SERVERTAGDAEMON_NAMESPACE)
+
+SERVERTAGDAEMON_USE_NAMESPACE
+
+static constexpr int kDirCount { 100 };
+static constexpr int kFilesPerDir { 1000 };
+static constexpr char kRootDir[] = "/bench/root";
+static constexpr char kRenamedRootDir[] = "/bench/renamed";
+
+class BenchTagDbHandler : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void lookupTagsOfFiles();
+    void lookupFilesOfTag();
+    void lookupFilesOfDir();
+    void renameDir();
+
+private:
+    static QString filePath(const QString &root, int dir, int file)
+    {
+        return QString("%1/dir%2/file%3").arg(root).arg(dir).arg(file);
+    }
+
+    QTemporaryDir home;
+    QStringList samplePaths;
+};
+
+void BenchTagDbHandler::initTestCase()
+{
+    // the database is created under $HOME/.config
+    QVERIFY(home.isValid());
+    qputenv("HOME", home.path().toLocal8Bit());
+
+    QVERIFY(TagDbHandler::instance()->addTagProperty({ { "red", "#ff0000" }, { "blue", "#0000ff" } }));
+    for (int dir = 0; dir < kDirCount; ++dir) {
+        QVariantMap fileTags;
+        for (int file = 0; file < kFilesPerDir; ++file)
+            fileTags.insert(filePath(kRootDir, dir, file), QStringList { file % 2 ? "red" : "blue" });
+        QVERIFY(TagDbHandler::instance()->addTagsForFiles(fileTags));
+    }
+
+    // a fixed spread of files over all dirs
+    for (int i = 0; i < 100; ++i)
+        samplePaths.append(filePath(kRootDir, (i * 37) % kDirCount, (i * 7919) % kFilesPerDir));
+}
+
+void BenchTagDbHandler::lookupTagsOfFiles()
+{
+    QVariantMap result;
+    QBENCHMARK {
+        result = TagDbHandler::instance()->getTagsByUrls(samplePaths);
+    }
+    QCOMPARE(result.size(), samplePaths.size());
+}
+
+void BenchTagDbHandler::lookupFilesOfTag()
+{
+    QVariantMap result;
+    QBENCHMARK {
+        result = TagDbHandler::instance()->getFilesByTag({ "red" });
+    }
+    QCOMPARE(result.value("red").toStringList().size(), kDirCount * kFilesPerDir / 2);
+}
+
+void BenchTagDbHandler::lookupFilesOfDir()
+{
+    const QString &dir = QString("%1/dir%2").arg(kRootDir).arg(kDirCount / 2);
+    QVariantHash result;
+    QBENCHMARK {
+        result = TagDbHandler::instance()->getFilesWithTagsOfDirs({ dir });
+    }
+    QCOMPARE(result.size(), kFilesPerDir);
+}
+
+void BenchTagDbHandler::renameDir()
+{
+    // every round renames the parent of all tagged files forth and back
+    QBENCHMARK {
+        QVERIFY(TagDbHandler::instance()->changeFilePaths({ { kRootDir, kRenamedRootDir } }));
+        QVERIFY(TagDbHandler::instance()->changeFilePaths({ { kRenamedRootDir, kRootDir } }));
+    }
+
+    QVERIFY(TagDbHandler::instance()->changeFilePaths({ { kRootDir, kRenamedRootDir } }));
+    const auto &result = TagDbHandler::instance()->getTagsByUrls({ filePath(kRenamedRootDir, 1, 1), filePath(kRootDir, 1, 1) });
+    QCOMPARE(result.size(), 1);
+    QCOMPARE(result.value(filePath(kRenamedRootDir, 1, 1)).toStringList(), QStringList { "red" });
+}
+
+QTEST_GUILESS_MAIN(BenchTagDbHandler)
+
+#include "bench_tagdbhandler.moc"
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "benchdata.h"
+#include "utils/filesortworker.h"
+
+#include <dfm-base/base/application/application.h>
+#include <dfm-base/base/schemefactory.h>
+#include <dfm-base/base/urlroute.h>
+#include <dfm-base/file/local/syncfileinfo.h>
+#include <dfm-base/file/local/localfilewatcher.h>
+
+#include <QtTest>
+
+DFMBASE_USE_NAMESPACE
+DFMGLOBAL_USE_NAMESPACE
+using namespace dfmplugin_workspace;
+
+static constexpr int kFileCount { 10000 };
+static constexpr char kKey[] { "bench" };
+
+class BenchFileSortWorker : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void insertChildren();
+    void resort_data();
+    void resort();
+
+private:
+    std::unique_ptr<QTemporaryDir> root;
+    std::unique_ptr<Application> application;
+    QList<SortInfoPointer> children;
+};
+
+void BenchFileSortWorker::initTestCase()
+{
+    application.reset(new Application);
+    UrlRoute::regScheme(Global::Scheme::kFile, "/", QIcon(), false);
+    InfoFactory::regClass<SyncFileInfo>(Global::Scheme::kFile);
+    WatcherFactory::regClass<LocalFileWatcher>(Global::Scheme::kFile);
+
+    root = BenchData::temporaryDir();
+    QVERIFY(root->isValid());
+    const int count = BenchData::scaled(kFileCount);
+    QVERIFY(BenchData::createFlatDir(root->path(), count));
+
+    // the sizes only depend on the index, as the names
+    int index = 0;
+    for (const QString &name : BenchData::names(count)) {
+        SortInfoPointer sortInfo(new SortFileInfo);
+        sortInfo->setUrl(QUrl::fromLocalFile(root->filePath(name)));
+        sortInfo->setFile(true);
+        sortInfo->setSize((index++ * 7919) % 1000003);
+        sortInfo->setReadable(true);
+        sortInfo->setWriteable(true);
+        children.append(sortInfo);
+    }
+}
+
+void BenchFileSortWorker::cleanupTestCase()
+{
+    children.clear();
+    application.reset();
+}
+
+// the children of a directory coming from the traversal thread
+void BenchFileSortWorker::insertChildren()
+{
+    QBENCHMARK {
+        FileSortWorker worker(QUrl::fromLocalFile(root->path()), kKey);
+        worker.handleSourceChildren(kKey, children, DFMIO::DEnumerator::SortRoleCompareFlag::kSortRoleCompareDefault,
+                                    Qt::AscendingOrder, false, true);
+        QVERIFY(worker.childrenCount() > 0);
+    }
+}
+
+void BenchFileSortWorker::resort_data()
+{
+    QTest::addColumn<int>("from");
+    QTest::addColumn<int>("to");
+    QTest::newRow("name and size") << static_cast<int>(kItemNameRole) << static_cast<int>(kItemFileSizeRole);
+    QTest::newRow("name and last modified") << static_cast<int>(kItemNameRole) << static_cast<int>(kItemFileLastModifiedRole);
+    QTest::newRow("display name and size") << static_cast<int>(kItemFileDisplayNameRole) << static_cast<int>(kItemFileSizeRole);
+}
+
+// every round sorts twice, from one role to the other and back
+void BenchFileSortWorker::resort()
+{
+    QFETCH(int, from);
+    QFETCH(int, to);
+
+    FileSortWorker worker(QUrl::fromLocalFile(root->path()), kKey);
+    worker.handleSourceChildren(kKey, children, DFMIO::DEnumerator::SortRoleCompareFlag::kSortRoleCompareDefault,
+                                Qt::AscendingOrder, false, true);
+    QVERIFY(worker.childrenCount() > 0);
+
+    QBENCHMARK {
+        worker.handleResort(Qt::AscendingOrder, static_cast<ItemRoles>(to), false);
+        worker.handleResort(Qt::AscendingOrder, static_cast<ItemRoles>(from), false);
+    }
+}
+
+QTEST_MAIN(BenchFileSortWorker)
+
+#include "bench_filesortworker.moc"
@@ -169,7 +169,7 @@ TEST_F(UT_DeviceWatcher, OnBlkDevRemoved)
 TEST_F(UT_DeviceWatcher, OnBlkDevMounted)
 {
     bool queryItem_invoked = false;
-    stub.set_lamda(&DeviceWatcherPrivate::queryUsageOfItem, [&] { __DBG_STUB_INVOKE__ queryItem_invoked = true; });
+    stub.set_lamda(&DeviceWatcherPrivate::queryUsageOfItem, [&] { __DBG_STUB_INVOKE__ queryItem_invoked = true; return DevStorage {}; });
 
     // test invalid inputs
     EXPECT_NO_FATAL_FAILURE(watcher->onBlkDevMounted("", ""));
@@ -304,7 +304,9 @@ private:
 TEST_F(UT_DeviceWatcherPrivate, QueryUsageAsync)
 {
     bool query_invoked = false;
-    stub.set_lamda(&DeviceWatcherPrivate::queryUsageOfItem, [&] { __DBG_STUB_INVOKE__ query_invoked = true; });
+    stub.set_lamda(&DeviceWatcherPrivate::queryUsageOfItem, [&] { __DBG_STUB_INVOKE__ query_invoked = true; return DevStorage {}; });
+    // only the mounted devices are polled
+    pd->allBlockInfos["/org/freedesktop/UDisks2/block_devices/loop1"]["MountPoint"] = "/home";
 
     //    typedef QFuture<void> (*RunType)(RunTarget);
     //    auto run = static_cast<RunType>(QtConcurrent::run);
@@ -318,6 +320,39 @@ TEST_F(UT_DeviceWatcherPrivate, QueryUsageAsync)
     EXPECT_TRUE(query_invoked);
 }
 
+TEST_F(UT_DeviceWatcherPrivate, OnUsageQueried)
+{
+    int emitted = 0;
+    QObject context;
+    QObject::connect(DevMngIns, &DeviceManager::devSizeChanged, &context, [&] { emitted++; });
+
+    const QString id { "/org/freedesktop/UDisks2/block_devices/loop1" };
+    pd->usagePollings[id].serial = 1;
+    pd->onUsageQueried(id, 1, { 102400, 51200, 51200 });
+    EXPECT_EQ(1, emitted);
+    EXPECT_EQ(pd->kPollingInterval, pd->usagePollings.value(id).interval);
+    EXPECT_EQ(0, pd->usagePollings.value(id).serial);
+
+    // not changed, polled less
+    pd->usagePollings[id].serial = 2;
+    pd->onUsageQueried(id, 2, { 102400, 51200, 51200 });
+    EXPECT_EQ(1, emitted);
+    EXPECT_EQ(pd->kPollingInterval * 2, pd->usagePollings.value(id).interval);
+
+    // the answer of an old query is dropped
+    pd->onUsageQueried(id, 1, { 102400, 1024, 101376 });
+    EXPECT_EQ(1, emitted);
+
+    // not answered in time
+    pd->usagePollings[id].serial = 3;
+    pd->onUsageQueryTimeout(id, 3);
+    EXPECT_EQ(1, pd->stalledQueryCount());
+    pd->onUsageQueried(id, 3, { 102400, 1024, 101376 });
+    EXPECT_EQ(2, emitted);
+    EXPECT_EQ(0, pd->stalledQueryCount());
+    EXPECT_EQ(pd->kMaxPollingInterval, pd->usagePollings.value(id).interval);
+}
+
 TEST_F(UT_DeviceWatcherPrivate, UpdateStorage)
 {
     EXPECT_NO_FATAL_FAILURE(pd->updateStorage("/org/freedesktop/UDisks2/block_devices/loop1", 100, 50));
@@ -387,7 +422,8 @@ TEST_F(UT_DeviceWatcherPrivate, QueryUsageOfProtocol)
     QVariantMap devInfo {};
     EXPECT_FALSE(pd->queryUsageOfProtocol(devInfo).isValid());
 
-    devInfo["MountPoint"] = "/home";
+    // not mounted, statfs fails and the device is asked
+    devInfo["MountPoint"] = "/nonexistent/mount";
     EXPECT_FALSE(pd->queryUsageOfProtocol(devInfo).isValid());
 
     devInfo["Id"] = "smb://1.2.3.4/hello";
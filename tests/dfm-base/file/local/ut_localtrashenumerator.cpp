@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <dfm-base/file/local/localtrashenumerator.h>
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <unistd.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_LocalTrashEnumerator : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        homeTrash = dir.filePath("home/Trash");
+        mountTrash = dir.filePath("disk/.Trash-" + QString::number(::getuid()));
+        for (const QString &trash : { homeTrash, mountTrash }) {
+            ASSERT_TRUE(QDir().mkpath(trash + "/files"));
+            ASSERT_TRUE(QDir().mkpath(trash + "/info"));
+        }
+
+        addItem(homeTrash, "a.txt", "/home/user/a.txt", "hello", false);
+        addItem(homeTrash, "dir", "/home/user/dir", QByteArray(), true);
+        addItem(mountTrash, "b%20c.txt", "docs/b%20c.txt", "world!", false);
+        LocalTrashEnumerator::clearCache();
+    }
+
+    void addItem(const QString &trash, const QString &name, const QString &path, const QByteArray &content, bool isDir)
+    {
+        const QString &fileName = QByteArray::fromPercentEncoding(name.toUtf8());
+        if (isDir) {
+            ASSERT_TRUE(QDir().mkpath(trash + "/files/" + fileName));
+        } else {
+            QFile file(trash + "/files/" + fileName);
+            ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+            file.write(content);
+        }
+
+        QFile info(trash + "/info/" + fileName + ".trashinfo");
+        ASSERT_TRUE(info.open(QIODevice::WriteOnly));
+        info.write("[Trash Info]\nPath=" + path.toUtf8() + "\nDeletionDate=2023-05-06T07:08:09\n");
+    }
+
+    QTemporaryDir dir;
+    QString homeTrash;
+    QString mountTrash;
+};
+
+TEST_F(UT_LocalTrashEnumerator, items)
+{
+    LocalTrashEnumerator enumerator(homeTrash, { mountTrash });
+    const auto &items = enumerator.items();
+    ASSERT_EQ(3, items.size());
+
+    QHash<QString, LocalTrashEnumerator::TrashItem> byPath;
+    for (const auto &item : items)
+        byPath.insert(item.originalPath, item);
+
+    ASSERT_TRUE(byPath.contains("/home/user/a.txt"));
+    const auto &a = byPath.value("/home/user/a.txt");
+    EXPECT_EQ(QUrl("trash:///a.txt"), a.url);
+    EXPECT_EQ(homeTrash + "/files/a.txt", a.filePath);
+    EXPECT_EQ(5, a.size);
+    EXPECT_FALSE(a.isDir);
+    EXPECT_EQ(QDateTime(QDate(2023, 5, 6), QTime(7, 8, 9)), a.deletionDate);
+
+    ASSERT_TRUE(byPath.contains("/home/user/dir"));
+    EXPECT_TRUE(byPath.value("/home/user/dir").isDir);
+    EXPECT_EQ(-1, byPath.value("/home/user/dir").size);
+
+    // relative to the top directory of the mount
+    const QString &original = dir.filePath("disk/docs/b c.txt");
+    ASSERT_TRUE(byPath.contains(original));
+    EXPECT_EQ(6, byPath.value(original).size);
+    EXPECT_EQ(LocalTrashEnumerator::trashUrl(mountTrash + "/files/b c.txt", false), byPath.value(original).url);
+}
+
+TEST_F(UT_LocalTrashEnumerator, cachedInfo)
+{
+    QFile info(homeTrash + "/info/a.txt.trashinfo");
+    const QDateTime modifyTime(QDate(2023, 5, 6), QTime(7, 8, 9));
+    ASSERT_TRUE(info.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(info.setFileTime(modifyTime, QFileDevice::FileModificationTime));
+    info.close();
+
+    LocalTrashEnumerator enumerator(homeTrash, {});
+    ASSERT_EQ(2, enumerator.items().size());
+
+    // an unchanged info is not parsed again
+    ASSERT_TRUE(info.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    info.write("[Trash Info]\nPath=/other\nDeletionDate=2023-05-06T07:08:09\n");
+    info.flush();
+    ASSERT_TRUE(info.setFileTime(modifyTime, QFileDevice::FileModificationTime));
+    info.close();
+
+    QStringList paths;
+    for (const auto &item : enumerator.items())
+        paths.append(item.originalPath);
+    EXPECT_TRUE(paths.contains("/home/user/a.txt"));
+
+    LocalTrashEnumerator::clearCache();
+    paths.clear();
+    for (const auto &item : enumerator.items())
+        paths.append(item.originalPath);
+    EXPECT_TRUE(paths.contains("/other"));
+}
+
+TEST_F(UT_LocalTrashEnumerator, trashUrl)
+{
+    EXPECT_EQ(QUrl("trash:///a"), LocalTrashEnumerator::trashUrl("/home/u/.local/share/Trash/files/a", true));
+    EXPECT_EQ(QString("/`\\a"), LocalTrashEnumerator::trashUrl("/t/files/\\a", true).path(QUrl::FullyDecoded));
+    EXPECT_EQ(QString("/\\m\\.Trash-1\\files\\a`\\b``"), LocalTrashEnumerator::trashUrl("/m/.Trash-1/files/a\\b`", false).path(QUrl::FullyDecoded));
+}
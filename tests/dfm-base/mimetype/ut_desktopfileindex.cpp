@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <dfm-base/mimetype/desktopfileindex.h>
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+DFMBASE_USE_NAMESPACE
+
+static void writeDesktop(const QString &path, const QString &name, qint64 modifyTime)
+{
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(QString("[Desktop Entry]\nType=Application\nName=%1\nExec=%1 %f\nMimeType=text/plain;\n").arg(name).toUtf8());
+    file.close();
+
+    struct timespec times[2];
+    times[0].tv_sec = times[1].tv_sec = modifyTime;
+    times[0].tv_nsec = times[1].tv_nsec = 0;
+    ASSERT_EQ(0, utimensat(AT_FDCWD, QFile::encodeName(path).constData(), times, 0));
+}
+
+class UT_DesktopFileIndex : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        ASSERT_TRUE(QDir(dir.path()).mkpath("apps/sub"));
+        writeDesktop(dir.filePath("apps/a.desktop"), "a", 1000);
+        writeDesktop(dir.filePath("apps/sub/b.desktop"), "b", 1000);
+        folders = QStringList { dir.filePath("apps") };
+    }
+
+    QTemporaryDir dir;
+    QStringList folders;
+};
+
+TEST_F(UT_DesktopFileIndex, refresh)
+{
+    DesktopFileIndex index(dir.filePath("index"));
+    EXPECT_TRUE(index.refresh(folders));
+    EXPECT_EQ(2, index.paths().size());
+    const DesktopFileIndex::Entry *entry = index.entry(dir.filePath("apps/sub/b.desktop"));
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(QString("b %f"), entry->file.desktopExec());
+    EXPECT_EQ(QStringList { "text/plain" }, entry->file.desktopMimeType().filter("/"));
+
+    // nothing changed
+    EXPECT_FALSE(index.refresh(folders));
+
+    writeDesktop(dir.filePath("apps/a.desktop"), "c", 2000);
+    EXPECT_TRUE(index.refresh(folders));
+    EXPECT_EQ(QString("c %f"), index.entry(dir.filePath("apps/a.desktop"))->file.desktopExec());
+
+    ASSERT_TRUE(QFile::remove(dir.filePath("apps/sub/b.desktop")));
+    EXPECT_TRUE(index.refresh(folders));
+    EXPECT_EQ(1, index.paths().size());
+    EXPECT_FALSE(index.entry(dir.filePath("apps/sub/b.desktop")));
+}
+
+TEST_F(UT_DesktopFileIndex, saveAndLoad)
+{
+    DesktopFileIndex index(dir.filePath("cache/index"));
+    EXPECT_FALSE(index.load());
+    ASSERT_TRUE(index.refresh(folders));
+    ASSERT_TRUE(index.save());
+
+    DesktopFileIndex loaded(dir.filePath("cache/index"));
+    ASSERT_TRUE(loaded.load());
+    EXPECT_EQ(index.paths(), loaded.paths());
+    EXPECT_EQ(QString("a %f"), loaded.entry(dir.filePath("apps/a.desktop"))->file.desktopExec());
+    // the loaded entries are up to date
+    EXPECT_FALSE(loaded.refresh(folders));
+
+    QFile file(dir.filePath("cache/index"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("broken");
+    file.close();
+    EXPECT_FALSE(DesktopFileIndex(dir.filePath("cache/index")).load());
+}
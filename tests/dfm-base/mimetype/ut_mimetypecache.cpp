@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <dfm-base/mimetype/mimetypecache.h>
+#include <dfm-base/mimetype/dmimedatabase.h>
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+DFMBASE_USE_NAMESPACE
+
+TEST(UT_MimeTypeCache, keyOfFile)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString &path = dir.filePath("a.txt");
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("text");
+    file.close();
+
+    MimeTypeCache::Key key;
+    EXPECT_TRUE(MimeTypeCache::makeKey(path, QMimeDatabase::MatchDefault, &key));
+    EXPECT_FALSE(MimeTypeCache::makeKey(dir.path(), QMimeDatabase::MatchDefault, &key));
+    EXPECT_FALSE(MimeTypeCache::makeKey(dir.filePath("none"), QMimeDatabase::MatchDefault, &key));
+
+    MimeTypeCache::Key contentKey;
+    ASSERT_TRUE(MimeTypeCache::makeKey(path, QMimeDatabase::MatchContent, &contentKey));
+    EXPECT_FALSE(key == contentKey);
+}
+
+TEST(UT_MimeTypeCache, findAndInsert)
+{
+    MimeTypeCache::Key key;
+    key.device = 1;
+    key.inode = 42;
+    key.modifyTime = 100;
+
+    QMimeType type;
+    MimeTypeCache::instance()->clear();
+    EXPECT_FALSE(MimeTypeCache::instance()->find(key, &type));
+
+    MimeTypeCache::instance()->insert(key, QMimeDatabase().mimeTypeForName("text/plain"));
+    ASSERT_TRUE(MimeTypeCache::instance()->find(key, &type));
+    EXPECT_EQ(QString("text/plain"), type.name());
+
+    // same inode on another device
+    MimeTypeCache::Key other = key;
+    other.device = 2;
+    EXPECT_FALSE(MimeTypeCache::instance()->find(other, &type));
+
+    MimeTypeCache::instance()->clear();
+    EXPECT_FALSE(MimeTypeCache::instance()->find(key, &type));
+}
+
+TEST(UT_DMimeDatabase, mimeTypesForFiles)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QList<QUrl> urls;
+    for (const QString &name : { QString("a.txt"), QString("b.html") }) {
+        QFile file(dir.filePath(name));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write("<html></html>");
+        urls.append(QUrl::fromLocalFile(file.fileName()));
+    }
+    urls.append(QUrl::fromLocalFile(dir.path()));
+
+    DMimeDatabase db;
+    const auto &types = db.mimeTypesForFiles(urls);
+    ASSERT_EQ(urls.size(), types.size());
+    EXPECT_EQ(QString("inode/directory"), types.at(2).name());
+
+    // filled by the first call
+    MimeTypeCache::Key key;
+    QMimeType cached;
+    ASSERT_TRUE(MimeTypeCache::makeKey(urls.first().toLocalFile(), QMimeDatabase::MatchDefault, &key));
+    ASSERT_TRUE(MimeTypeCache::instance()->find(key, &cached));
+    EXPECT_EQ(types.first(), cached);
+    EXPECT_EQ(types, db.mimeTypesForFiles(urls));
+}
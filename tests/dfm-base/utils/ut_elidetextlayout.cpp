@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <dfm-base/utils/elidetextlayout.h>
+
+#include <gtest/gtest.h>
+
+#include <QTextDocument>
+#include <QImage>
+#include <QPainter>
+
+DFMBASE_USE_NAMESPACE
+
+TEST(UT_ElideTextLayout, cachedLayoutSameAsDocument)
+{
+    const QString name("A rather long file name which is wrapped and elided.txt");
+    const QRectF rect(10, 20, 80, 40);
+
+    ElideTextLayout::clearLayoutCache();
+    ElideTextLayout cached(name);
+    cached.setAttribute(ElideTextLayout::kLineHeight, 18);
+    QStringList cachedLines;
+    const auto &cachedRects = cached.layout(rect, Qt::ElideMiddle, nullptr, Qt::NoBrush, &cachedLines);
+
+    // the second layout is taken from the cache
+    QStringList againLines;
+    const auto &againRects = cached.layout(rect, Qt::ElideMiddle, nullptr, Qt::NoBrush, &againLines);
+    EXPECT_EQ(cachedRects, againRects);
+    EXPECT_EQ(cachedLines, againLines);
+
+    ElideTextLayout detached(name);
+    detached.setAttribute(ElideTextLayout::kLineHeight, 18);
+    EXPECT_NE(detached.documentHandle(), nullptr);
+    QStringList documentLines;
+    const auto &documentRects = detached.layout(rect, Qt::ElideMiddle, nullptr, Qt::NoBrush, &documentLines);
+
+    EXPECT_FALSE(cachedRects.isEmpty());
+    EXPECT_EQ(documentRects, cachedRects);
+    EXPECT_EQ(documentLines, cachedLines);
+    EXPECT_EQ(name, detached.text());
+}
+
+TEST(UT_ElideTextLayout, leadingObject)
+{
+    const QString name("name.txt");
+    const QRectF rect(0, 0, 200, 18);
+
+    ElideTextLayout::clearLayoutCache();
+    ElideTextLayout plain(name);
+    plain.setAttribute(ElideTextLayout::kLineHeight, 18);
+    const auto &plainRects = plain.layout(rect, Qt::ElideRight);
+
+    QImage image(200, 18, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    QRectF objectRect;
+    ElideTextLayout tagged(name);
+    tagged.setAttribute(ElideTextLayout::kLineHeight, 18);
+    tagged.setLeadingObject(QSizeF(20, 10), "red", [&objectRect](QPainter *, const QRectF &rect) {
+        objectRect = rect;
+    });
+    QStringList lines;
+    const auto &taggedRects = tagged.layout(rect, Qt::ElideRight, &painter, Qt::NoBrush, &lines);
+
+    // centered with the object, the text is not changed
+    ASSERT_EQ(1, plainRects.size());
+    ASSERT_EQ(1, taggedRects.size());
+    EXPECT_EQ(QStringList { name }, lines);
+    EXPECT_NEAR(plainRects.first().width() + 20, taggedRects.first().width(), 1);
+    EXPECT_NEAR(plainRects.first().left() - 10, taggedRects.first().left(), 1);
+    EXPECT_EQ(taggedRects.first().left(), objectRect.left());
+    EXPECT_EQ(QSizeF(20, 10), objectRect.size());
+    EXPECT_EQ(nullptr, tagged.document);
+}
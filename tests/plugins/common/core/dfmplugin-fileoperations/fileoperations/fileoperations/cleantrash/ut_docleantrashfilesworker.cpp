@@ -5,12 +5,14 @@
 #include "stubext.h"
 #include "plugins/common/core/dfmplugin-fileoperations/fileoperations/cleantrash/cleantrashfiles.h"
 #include "plugins/common/core/dfmplugin-fileoperations/fileoperations/cleantrash/docleantrashfilesworker.h"
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/cleantrash/trashgraveyard.h"
 
 #include <dfm-base/base/urlroute.h>
 #include <dfm-base/base/schemefactory.h>
 #include <dfm-base/file/local/asyncfileinfo.h>
 #include <dfm-base/file/local/syncfileinfo.h>
 #include <dfm-base/file/local/localfilehandler.h>
+#include <dfm-base/file/local/localtrashenumerator.h>
 #include <dfm-base/utils/clipboard.h>
 
 #include <dfm-framework/event/event.h>
@@ -60,10 +62,32 @@ TEST_F(UT_DoCleanTrashFilesWorker, testDoWork)
     EXPECT_FALSE(worker.statisticsFilesSize());
 
     worker.sourceUrls.append(FileUtils::trashRootUrl());
-    int index = 0;
-    stub.set_lamda(&DEnumerator::hasNext, [&index]{ __DBG_STUB_INVOKE__ index++; return index % 2;});
-    stub.set_lamda(&DEnumerator::next, []{ __DBG_STUB_INVOKE__ return QUrl::fromLocalFile(QDir::currentPath());});
     EXPECT_TRUE(worker.statisticsFilesSize());
+    EXPECT_TRUE(worker.emptyWholeTrash);
+    EXPECT_TRUE(worker.allFilesList.isEmpty());
+}
+
+TEST_F(UT_DoCleanTrashFilesWorker, testEmptyTrashDirectories)
+{
+    DoCleanTrashFilesWorker worker;
+    stub_ext::StubExt stub;
+    stub.set_lamda(&LocalTrashEnumerator::mountTrashDirectories, []{ __DBG_STUB_INVOKE__ return QStringList { "/mnt/.Trash-1000" }; });
+    stub.set_lamda(&TrashReaper::reap, []{ __DBG_STUB_INVOKE__ });
+    stub.set_lamda(&TrashGraveyard::bury, []{ __DBG_STUB_INVOKE__ return true; });
+    EXPECT_TRUE(worker.emptyTrashDirectories());
+    EXPECT_TRUE(worker.allFilesList.isEmpty());
+
+    // the items of the directories which cannot be buried are deleted one by one
+    stub.set_lamda(&TrashGraveyard::bury, [](const QString &dir){ __DBG_STUB_INVOKE__ return !dir.startsWith("/mnt"); });
+    stub.set_lamda(&LocalTrashEnumerator::items, []{
+        __DBG_STUB_INVOKE__
+        LocalTrashEnumerator::TrashItem item;
+        item.url = QUrl("trash:///a");
+        return QList<LocalTrashEnumerator::TrashItem> { item, item };
+    });
+    stub.set_lamda(&DoCleanTrashFilesWorker::cleanAllTrashFiles, []{ __DBG_STUB_INVOKE__ return true; });
+    EXPECT_TRUE(worker.emptyTrashDirectories());
+    EXPECT_EQ(1, worker.allFilesList.size());
 }
 
 TEST_F(UT_DoCleanTrashFilesWorker, testCleanAllTrashFiles)
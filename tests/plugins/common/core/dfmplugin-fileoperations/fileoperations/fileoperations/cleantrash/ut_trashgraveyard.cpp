@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/cleantrash/trashgraveyard.h"
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+class UT_TrashGraveyard : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        trash = dir.filePath("Trash");
+        ASSERT_TRUE(QDir().mkpath(trash + "/files/tree/sub"));
+        ASSERT_TRUE(QDir().mkpath(trash + "/info"));
+        for (const QString &path : { QString("/files/a"), QString("/files/tree/sub/b"), QString("/info/a.trashinfo"), QString("/info/tree.trashinfo") }) {
+            QFile file(trash + path);
+            ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+            file.write(QByteArray(4096, 'x'));
+        }
+    }
+
+    QTemporaryDir dir;
+    QString trash;
+};
+
+TEST_F(UT_TrashGraveyard, buryAndReap)
+{
+    ASSERT_TRUE(TrashGraveyard::bury(trash));
+
+    // the trash looks empty at once
+    EXPECT_TRUE(QDir(trash + "/files").isEmpty());
+    EXPECT_TRUE(QDir(trash + "/info").isEmpty());
+    const QString &graveyard = TrashGraveyard::graveyardOf(trash);
+    EXPECT_EQ(1, QDir(graveyard).entryList(QDir::Dirs | QDir::NoDotAndDotDot).size());
+
+    // a read only directory of the trashed tree
+    const QString &grave = graveyard + "/" + QDir(graveyard).entryList(QDir::Dirs | QDir::NoDotAndDotDot).first();
+    QFile::setPermissions(grave + "/files/tree/sub", QFileDevice::ReadOwner | QFileDevice::ExeOwner);
+
+    TrashReaper reaper;
+    QSignalSpy spy(&reaper, &TrashReaper::reclaimed);
+    reaper.reap({ trash });
+    ASSERT_TRUE(reaper.wait(10000));
+
+    EXPECT_FALSE(QFile::exists(graveyard));
+    ASSERT_EQ(1, spy.count());
+    EXPECT_GT(spy.first().at(1).toLongLong(), 0);
+    EXPECT_TRUE(QFile::exists(trash + "/files"));
+}
+
+TEST_F(UT_TrashGraveyard, buryEmptyTrash)
+{
+    QDir(trash + "/files").removeRecursively();
+    QDir(trash + "/info").removeRecursively();
+    ASSERT_TRUE(QDir().mkpath(trash + "/files"));
+
+    EXPECT_TRUE(TrashGraveyard::bury(trash));
+    EXPECT_FALSE(QFile::exists(TrashGraveyard::graveyardOf(trash)));
+    EXPECT_TRUE(TrashGraveyard::bury(dir.filePath("none")));
+}
+
+TEST_F(UT_TrashGraveyard, restoreSplitItems)
+{
+    // c was trashed between the exchanges: its info is in the trash and its file is buried,
+    // d was moved after its info was buried
+    const QString &grave = TrashGraveyard::graveyardOf(trash) + "/1";
+    ASSERT_TRUE(QDir().mkpath(grave + "/files"));
+    ASSERT_TRUE(QDir().mkpath(grave + "/info"));
+    ASSERT_TRUE(QDir(trash).rename("info/tree.trashinfo", grave + "/info/tree.trashinfo"));
+    ASSERT_TRUE(QDir(trash).rename("files/tree", grave + "/files/tree"));
+    for (const QString &path : { QString("/info/c.trashinfo"), QString("/files/d") })
+        ASSERT_TRUE(QFile(trash + path).open(QIODevice::WriteOnly));
+    for (const QString &path : { QString("/files/c"), QString("/info/d.trashinfo") })
+        ASSERT_TRUE(QFile(grave + path).open(QIODevice::WriteOnly));
+
+    const int trashFd = ::open(QFile::encodeName(trash).constData(), O_RDONLY | O_DIRECTORY);
+    const int graveFd = ::open(QFile::encodeName(grave).constData(), O_RDONLY | O_DIRECTORY);
+    ASSERT_GE(trashFd, 0);
+    ASSERT_GE(graveFd, 0);
+    TrashGraveyard::restoreSplitItems(trashFd, graveFd);
+    ::close(graveFd);
+    ::close(trashFd);
+
+    EXPECT_TRUE(QFile::exists(trash + "/files/c"));
+    EXPECT_TRUE(QFile::exists(trash + "/info/d.trashinfo"));
+    EXPECT_FALSE(QFile::exists(grave + "/files/c"));
+    EXPECT_FALSE(QFile::exists(grave + "/info/d.trashinfo"));
+    // the whole buried items stay
+    EXPECT_TRUE(QFile::exists(grave + "/files/tree"));
+    EXPECT_TRUE(QFile::exists(grave + "/info/tree.trashinfo"));
+    EXPECT_TRUE(QFile::exists(trash + "/files/a"));
+}
+
+TEST_F(UT_TrashGraveyard, reapSkipsLockedGrave)
+{
+    // a grave bury is still filling
+    const int trashFd = ::open(QFile::encodeName(trash).constData(), O_RDONLY | O_DIRECTORY);
+    ASSERT_GE(trashFd, 0);
+    const int graveFd = TrashGraveyard::createGrave(trashFd);
+    ::close(trashFd);
+    ASSERT_GE(graveFd, 0);
+
+    const QString &graveyard = TrashGraveyard::graveyardOf(trash);
+    TrashReaper reaper;
+    reaper.reap({ trash });
+    ASSERT_TRUE(reaper.wait(10000));
+    EXPECT_EQ(1, QDir(graveyard).entryList(QDir::Dirs | QDir::NoDotAndDotDot).size());
+
+    ::close(graveFd);
+    reaper.reap({ trash });
+    ASSERT_TRUE(reaper.wait(10000));
+    EXPECT_FALSE(QFile::exists(graveyard));
+}
+
+TEST_F(UT_TrashGraveyard, createGraveAfterReaped)
+{
+    // the graveyard is reaped between two graves
+    const int trashFd = ::open(QFile::encodeName(trash).constData(), O_RDONLY | O_DIRECTORY);
+    ASSERT_GE(trashFd, 0);
+    const int first = TrashGraveyard::createGrave(trashFd);
+    ASSERT_GE(first, 0);
+    ::close(first);
+    ASSERT_TRUE(QDir(TrashGraveyard::graveyardOf(trash)).removeRecursively());
+
+    const int second = TrashGraveyard::createGrave(trashFd);
+    ::close(trashFd);
+    ASSERT_GE(second, 0);
+
+    // the grave is locked against the other opens of it
+    const QString &graveyard = TrashGraveyard::graveyardOf(trash);
+    const QStringList &graves = QDir(graveyard).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    ASSERT_EQ(1, graves.size());
+    const int other = ::open(QFile::encodeName(graveyard + "/" + graves.first()).constData(), O_RDONLY | O_DIRECTORY);
+    ASSERT_GE(other, 0);
+    EXPECT_NE(0, ::flock(other, LOCK_EX | LOCK_NB));
+    ::close(other);
+    ::close(second);
+}
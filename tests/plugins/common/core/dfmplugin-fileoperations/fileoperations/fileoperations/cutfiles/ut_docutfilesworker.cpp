@@ -19,6 +19,8 @@
 
 #include <gtest/gtest.h>
 
+#include <QTemporaryDir>
+
 typedef QMap<QString,QVariant> * mapValue;
 Q_DECLARE_METATYPE(mapValue);
 
@@ -253,3 +255,67 @@ TEST_F(UT_DoCutFilesWorker, testRenameFileByHandler)
     worker.targetInfo = targetInfo;
     EXPECT_TRUE(worker.doRenameFile(sorceInfo, targetInfo, toInfo, "tests_iiii.txt", &skip));
 }
+
+TEST_F(UT_DoCutFilesWorker, testRenameFilesInBatch)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(QDir(dir.path()).mkpath("source/dir"));
+    ASSERT_TRUE(QDir(dir.path()).mkpath("target"));
+    QFile file(dir.path() + "/source/file.txt");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+    QFile conflict(dir.path() + "/target/conflict.txt");
+    ASSERT_TRUE(conflict.open(QIODevice::WriteOnly));
+    conflict.close();
+    QFile source(dir.path() + "/source/conflict.txt");
+    ASSERT_TRUE(source.open(QIODevice::WriteOnly));
+    source.close();
+
+    DoCutFilesWorker worker;
+    worker.workData.reset(new WorkerData);
+    stub_ext::StubExt stub;
+    stub.set_lamda(VADDR(FileOperateBaseWorker, emitCurrentTaskNotify), []{ __DBG_STUB_INVOKE__ });
+    worker.resume();
+    worker.targetUrl = QUrl::fromLocalFile(dir.path() + "/target");
+    worker.targetOrgUrl = worker.targetUrl;
+    const QUrl &fileUrl = QUrl::fromLocalFile(dir.path() + "/source/file.txt");
+    const QUrl &dirUrl = QUrl::fromLocalFile(dir.path() + "/source/dir");
+    const QUrl &conflictUrl = QUrl::fromLocalFile(dir.path() + "/source/conflict.txt");
+    const QUrl &selfUrl = QUrl::fromLocalFile(dir.path() + "/target/conflict.txt");
+    worker.sourceUrls = { fileUrl, dirUrl, conflictUrl, selfUrl };
+
+    QList<QUrl> restUrls;
+    EXPECT_TRUE(worker.renameFilesInBatch(&restUrls));
+    EXPECT_EQ(QList<QUrl>({ conflictUrl }), restUrls);
+    EXPECT_TRUE(QFile::exists(dir.path() + "/target/file.txt"));
+    EXPECT_TRUE(QFile::exists(dir.path() + "/target/dir"));
+    EXPECT_EQ(QList<QUrl>({ fileUrl, dirUrl }), worker.completeSourceFiles);
+    EXPECT_EQ(2, worker.completeTargetFiles.size());
+
+    worker.stop();
+    EXPECT_FALSE(worker.renameFilesInBatch(&restUrls));
+}
+
+TEST_F(UT_DoCutFilesWorker, testCutFilesToSelfMovesNothing)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(QDir(dir.path()).mkpath("source/target"));
+    QFile file(dir.path() + "/file.txt");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    DoCutFilesWorker worker;
+    worker.workData.reset(new WorkerData);
+    worker.resume();
+    worker.targetUrl = QUrl::fromLocalFile(dir.path() + "/source/target");
+    worker.targetOrgUrl = worker.targetUrl;
+    worker.sourceUrls = { QUrl::fromLocalFile(dir.path() + "/file.txt"), QUrl::fromLocalFile(dir.path() + "/source") };
+
+    // the file before the dir is not moved either
+    EXPECT_FALSE(worker.cutFiles());
+    EXPECT_TRUE(QFile::exists(dir.path() + "/file.txt"));
+    EXPECT_FALSE(QFile::exists(dir.path() + "/source/target/file.txt"));
+    EXPECT_TRUE(worker.completeSourceFiles.isEmpty());
+}
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/deletefiles/localdeleteengine.h"
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <cerrno>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+DFMBASE_USE_NAMESPACE
+
+class UT_LocalDeleteEngine : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        // 3 dirs, 4 files in each dir
+        for (const QString &sub : { QString("tree/a"), QString("tree/a/b"), QString("tree/c") }) {
+            ASSERT_TRUE(QDir(dir.path()).mkpath(sub));
+            for (int i = 0; i < 4; ++i) {
+                QFile file(dir.path() + "/" + sub + "/file" + QString::number(i));
+                ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+            }
+        }
+    }
+    void TearDown() override {}
+
+    QTemporaryDir dir;
+};
+
+TEST_F(UT_LocalDeleteEngine, testDeleteTree)
+{
+    QAtomicInteger<qint64> count { 0 };
+    QAtomicInteger<qint64> found { 0 };
+    const QUrl &url = QUrl::fromLocalFile(dir.path() + "/tree");
+
+    for (int threadCount : { 1, 4 }) {
+        SetUp();
+        count = 0;
+        found = 0;
+        LocalDeleteEngine engine(&count, &found);
+        engine.setThreadCount(threadCount);
+        engine.start({ url });
+        while (!engine.isFinished())
+            EXPECT_FALSE(engine.takeError(10));
+        engine.waitForFinished();
+
+        EXPECT_FALSE(QFile::exists(url.toLocalFile()));
+        EXPECT_TRUE(engine.deletedUrls().contains(url));
+        EXPECT_FALSE(engine.isStopped());
+        // 12 files, 4 dirs
+        EXPECT_EQ(16, count.load());
+        // counted while deleting
+        EXPECT_EQ(16, found.load());
+    }
+}
+
+TEST_F(UT_LocalDeleteEngine, testKeepMountPoint)
+{
+    // tree/a is another file system
+    const QString &mountPoint = dir.path() + "/tree/a";
+    stub_ext::StubExt stub;
+    stub.set_lamda(::fstatat, [&](int fd, const char *name, struct stat *buf, int flag) {
+        __DBG_STUB_INVOKE__
+        const int ret = static_cast<int>(::syscall(SYS_newfstatat, fd, name, buf, flag));
+        if (ret == 0 && QByteArray(name) == "a")
+            buf->st_dev += 1;
+        return ret;
+    });
+
+    QAtomicInteger<qint64> count { 0 };
+    const QUrl &url = QUrl::fromLocalFile(dir.path() + "/tree");
+    LocalDeleteEngine engine(&count);
+    engine.setThreadCount(1);
+    engine.start({ url });
+    while (!engine.isFinished())
+        EXPECT_FALSE(engine.takeError(10));
+    engine.waitForFinished();
+
+    EXPECT_TRUE(QFile::exists(mountPoint + "/file0"));
+    EXPECT_FALSE(QFile::exists(url.toLocalFile() + "/c"));
+    EXPECT_FALSE(engine.deletedUrls().contains(url));
+}
+
+TEST_F(UT_LocalDeleteEngine, testSkipError)
+{
+    stub_ext::StubExt stub;
+    stub.set_lamda(::unlinkat, [](int fd, const char *name, int flag) {
+        __DBG_STUB_INVOKE__
+        if (QByteArray(name) == "file0") {
+            errno = EACCES;
+            return -1;
+        }
+        return static_cast<int>(::syscall(SYS_unlinkat, fd, name, flag));
+    });
+
+    QAtomicInteger<qint64> count { 0 };
+    const QUrl &url = QUrl::fromLocalFile(dir.path() + "/tree");
+    LocalDeleteEngine engine(&count);
+    engine.setThreadCount(1);
+    engine.start({ url });
+
+    int errorCount = 0;
+    while (!engine.isFinished()) {
+        const auto &error = engine.takeError(10);
+        if (!error)
+            continue;
+        ++errorCount;
+        engine.resolveError(error, AbstractJobHandler::SupportAction::kSkipAction);
+    }
+    engine.waitForFinished();
+
+    EXPECT_EQ(3, errorCount);
+    EXPECT_TRUE(QFile::exists(url.toLocalFile()));
+    EXPECT_FALSE(engine.deletedUrls().contains(url));
+}
+
+TEST_F(UT_LocalDeleteEngine, testCancelError)
+{
+    stub_ext::StubExt stub;
+    stub.set_lamda(::unlinkat, [] {
+        __DBG_STUB_INVOKE__
+        errno = EACCES;
+        return -1;
+    });
+
+    QAtomicInteger<qint64> count { 0 };
+    const QUrl &url = QUrl::fromLocalFile(dir.path() + "/tree");
+    LocalDeleteEngine engine(&count);
+    engine.setThreadCount(2);
+    engine.start({ url });
+
+    while (!engine.isFinished()) {
+        const auto &error = engine.takeError(10);
+        if (error)
+            engine.resolveError(error, AbstractJobHandler::SupportAction::kCancelAction);
+    }
+    engine.waitForFinished();
+
+    EXPECT_TRUE(engine.isStopped());
+    EXPECT_EQ(0, count.load());
+}
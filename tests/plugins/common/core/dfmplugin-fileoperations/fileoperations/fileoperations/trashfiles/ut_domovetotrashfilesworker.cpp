@@ -18,6 +18,11 @@
 
 #include <gtest/gtest.h>
 
+#include <QTemporaryDir>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
 #include <dfm-io/dfmio_utils.h>
 
 typedef QMap<QString,QVariant> * mapValue;
@@ -132,3 +137,46 @@ TEST_F(UT_DoMoveToTrashFilesWorker, testDoMoveToTrash)
     EXPECT_TRUE(worker.doMoveToTrash());
 }
 
+
+TEST_F(UT_DoMoveToTrashFilesWorker, testFlushTrashBatch)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(QDir(dir.path()).mkpath("Trash/files"));
+    ASSERT_TRUE(QDir(dir.path()).mkpath("Trash/info"));
+    ASSERT_TRUE(QDir(dir.path()).mkpath("source"));
+
+    QFile file(dir.path() + "/source/batch.txt");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    DoMoveToTrashFilesWorker worker;
+    stub_ext::StubExt stub;
+    stub.set_lamda(VADDR(FileOperateBaseWorker, emitCurrentTaskNotify), []{ __DBG_STUB_INVOKE__ });
+    stub.set_lamda(VADDR(AbstractWorker, emitProgressChangedNotify), []{ __DBG_STUB_INVOKE__ });
+    worker.resume();
+    worker.fstabMap.clear();
+
+    struct stat statBuffer;
+    ASSERT_EQ(0, ::stat(dir.path().toLocal8Bit().constData(), &statBuffer));
+    worker.trashFilesDirFd = ::open((dir.path() + "/Trash/files").toLocal8Bit().constData(), O_RDONLY | O_DIRECTORY);
+    worker.trashInfoDirFd = ::open((dir.path() + "/Trash/info").toLocal8Bit().constData(), O_RDONLY | O_DIRECTORY);
+    worker.trashDevice = static_cast<qint64>(statBuffer.st_dev);
+
+    const QUrl &url = QUrl::fromLocalFile(file.fileName());
+    EXPECT_TRUE(worker.canBatchMoveToTrash(url, url));
+    EXPECT_FALSE(worker.canBatchMoveToTrash(QUrl::fromLocalFile(dir.path() + "/source/none.txt"),
+                                            QUrl::fromLocalFile(dir.path() + "/source/none.txt")));
+
+    worker.trashBatch.append({ url, url, QString() });
+    EXPECT_TRUE(worker.flushTrashBatch());
+    EXPECT_FALSE(QFile::exists(file.fileName()));
+    EXPECT_TRUE(QFile::exists(dir.path() + "/Trash/files/batch.txt"));
+    EXPECT_TRUE(QFile::exists(dir.path() + "/Trash/info/batch.txt.trashinfo"));
+    EXPECT_EQ(1, worker.completeTargetFiles.size());
+    EXPECT_EQ(2, worker.completeTargetFiles.first().userInfo().split("-").size());
+
+    EXPECT_EQ(QString("batch.txt.2"), worker.reserveTrashInfo("batch.txt", "[Trash Info]\n"));
+
+    worker.closeLocalTrashDirs();
+}
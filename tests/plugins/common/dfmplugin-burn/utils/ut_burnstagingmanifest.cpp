@@ -0,0 +1,196 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "plugins/common/dfmplugin-burn/utils/burnstagingmanifest.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+DPBURN_USE_NAMESPACE
+
+static QByteArray readFile(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+static ino_t inodeOf(const QString &path)
+{
+    struct stat st;
+    return ::lstat(path.toLocal8Bit().constData(), &st) == 0 ? st.st_ino : 0;
+}
+
+static void writeFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    file.write(data);
+}
+
+class UT_BurnStagingManifest : public testing::Test
+{
+protected:
+    virtual void SetUp() override
+    {
+        source = tmp.path() + "/src";
+        staging = tmp.path() + "/discburn/_dev_sr0";
+        QDir().mkpath(source + "/dir");
+        QDir().mkpath(staging);
+        writeFile(source + "/dir/a.txt", "aaa");
+        writeFile(source + "/b.txt", "bbb");
+
+        // the temporary directory may share blocks, the sources are linked as on ext4
+        stub.set_lamda(&BurnStagingManifest::cloneFile, [] {
+            __DBG_STUB_INVOKE__
+            return false;
+        });
+    }
+    virtual void TearDown() override { stub.clear(); }
+
+protected:
+    stub_ext::StubExt stub;
+    QTemporaryDir tmp;
+    QString source;
+    QString staging;
+};
+
+TEST_F(UT_BurnStagingManifest, GraftLinksTheSources)
+{
+    BurnStagingManifest manifest(staging);
+    QString staged;
+    EXPECT_TRUE(manifest.graft(source + "/dir", staging, &staged));
+    EXPECT_EQ(staged, staging + "/dir");
+    EXPECT_EQ(readFile(staging + "/dir/a.txt"), QByteArray("aaa"));
+    EXPECT_EQ(inodeOf(staging + "/dir/a.txt"), inodeOf(source + "/dir/a.txt"));
+
+    EXPECT_TRUE(manifest.isGraftedRoot("/dir"));
+    EXPECT_EQ(manifest.discPaths("/dir"), QStringList({ "/dir", "/dir/a.txt" }));
+    EXPECT_TRUE(manifest.entry("/dir/a.txt").isLinked());
+    EXPECT_EQ(manifest.entry("/dir/a.txt").source, source + "/dir/a.txt");
+    EXPECT_EQ(manifest.entry("/dir/a.txt").size, 3);
+    EXPECT_FALSE(manifest.entry("/dir").isLinked());
+
+    // the existing target is left to the copy
+    EXPECT_FALSE(manifest.graft(source + "/dir", staging));
+}
+
+TEST_F(UT_BurnStagingManifest, GraftOutsideStaging)
+{
+    BurnStagingManifest manifest(tmp.path() + "/other");
+    EXPECT_FALSE(manifest.graft(source + "/b.txt", tmp.path() + "/other"));
+}
+
+TEST_F(UT_BurnStagingManifest, GraftCannotLink)
+{
+    stub.set_lamda(::link, [] {
+        __DBG_STUB_INVOKE__
+        errno = EXDEV;
+        return -1;
+    });
+
+    // the source is left to the copy job, nothing is half grafted
+    BurnStagingManifest manifest(staging);
+    EXPECT_FALSE(manifest.graft(source + "/dir", staging));
+    EXPECT_FALSE(QFileInfo::exists(staging + "/dir"));
+    EXPECT_FALSE(manifest.isGraftedRoot("/dir"));
+    EXPECT_TRUE(QFileInfo::exists(source + "/dir/a.txt"));
+}
+
+TEST_F(UT_BurnStagingManifest, DetachUnchanged)
+{
+    BurnStagingManifest manifest(staging);
+    ASSERT_TRUE(manifest.graft(source + "/b.txt", staging));
+
+    EXPECT_EQ(manifest.detachChanged(), 0);
+    EXPECT_TRUE(manifest.entry("/b.txt").isLinked());
+    EXPECT_EQ(inodeOf(staging + "/b.txt"), inodeOf(source + "/b.txt"));
+}
+
+TEST_F(UT_BurnStagingManifest, DetachChangedSource)
+{
+    BurnStagingManifest manifest(staging);
+    ASSERT_TRUE(manifest.graft(source + "/b.txt", staging));
+    ASSERT_TRUE(manifest.graft(source + "/dir", staging));
+
+    // written in place, the link sees it
+    writeFile(source + "/b.txt", "changed");
+    EXPECT_EQ(manifest.detachChanged(), 1);
+    EXPECT_FALSE(manifest.entry("/b.txt").isLinked());
+
+    // the copy does not follow the source any more
+    writeFile(source + "/b.txt", "changed again");
+    EXPECT_EQ(readFile(staging + "/b.txt"), QByteArray("changed"));
+    EXPECT_EQ(manifest.detachChanged(), 0);
+    EXPECT_EQ(manifest.dropChanged(), 0);
+    EXPECT_TRUE(manifest.isGraftedRoot("/b.txt"));
+}
+
+TEST_F(UT_BurnStagingManifest, DetachReplacedSource)
+{
+    BurnStagingManifest manifest(staging);
+    ASSERT_TRUE(manifest.graft(source + "/dir", staging));
+
+    // saved by a rename, the link keeps the old inode
+    writeFile(source + "/dir/a.txt.new", "new content");
+    ASSERT_TRUE(::rename((source + "/dir/a.txt.new").toLocal8Bit().constData(),
+                         (source + "/dir/a.txt").toLocal8Bit().constData())
+                == 0);
+    EXPECT_EQ(manifest.detachChanged(), 1);
+    EXPECT_EQ(readFile(staging + "/dir/a.txt"), QByteArray("new content"));
+
+    // the copy is not a change made in the staging view
+    EXPECT_EQ(manifest.dropChanged(), 0);
+    EXPECT_TRUE(manifest.isGraftedRoot("/dir"));
+}
+
+TEST_F(UT_BurnStagingManifest, DetachKeepsStagingViewEdits)
+{
+    BurnStagingManifest manifest(staging);
+    ASSERT_TRUE(manifest.graft(source + "/b.txt", staging));
+
+    // replaced in the staging view, not through the link
+    ASSERT_TRUE(QFile::remove(staging + "/b.txt"));
+    writeFile(staging + "/b.txt", "mine");
+    EXPECT_EQ(manifest.detachChanged(), 0);
+    EXPECT_FALSE(manifest.entry("/b.txt").isLinked());
+    EXPECT_EQ(readFile(staging + "/b.txt"), QByteArray("mine"));
+    EXPECT_EQ(readFile(source + "/b.txt"), QByteArray("bbb"));
+}
+
+TEST_F(UT_BurnStagingManifest, DropChanged)
+{
+    BurnStagingManifest manifest(staging);
+    ASSERT_TRUE(manifest.graft(source + "/b.txt", staging));
+    ASSERT_TRUE(manifest.graft(source + "/dir", staging));
+    EXPECT_EQ(manifest.dropChanged(), 0);
+
+    // renamed in the staging view, the staged tree is walked again
+    QFile::rename(staging + "/dir/a.txt", staging + "/dir/c.txt");
+    EXPECT_EQ(manifest.dropChanged(), 1);
+    EXPECT_FALSE(manifest.isGraftedRoot("/dir"));
+    EXPECT_TRUE(manifest.isGraftedRoot("/b.txt"));
+}
+
+TEST_F(UT_BurnStagingManifest, Merge)
+{
+    BurnStagingManifest manifest(staging);
+    ASSERT_TRUE(manifest.graft(source + "/b.txt", staging));
+
+    BurnStagingManifest grafted(staging);
+    ASSERT_TRUE(grafted.graft(source + "/dir", staging));
+    manifest.merge(grafted);
+    EXPECT_TRUE(manifest.isGraftedRoot("/b.txt"));
+    EXPECT_TRUE(manifest.isGraftedRoot("/dir"));
+    EXPECT_EQ(manifest.entry("/dir/a.txt").size, 3);
+}
@@ -4,10 +4,13 @@
 
 #include "stubext.h"
 #include "imageview.h"
+#include "imagedecoder.h"
 
 #include <gtest/gtest.h>
 
 #include <QMovie>
+#include <QImageReader>
+#include <QSignalSpy>
 
 PREVIEW_USE_NAMESPACE
 
@@ -66,3 +69,40 @@ TEST(UT_imageView, sourceSize)
 
     EXPECT_TRUE(view.sourceSize() == QSize(0, 0));
 }
+
+TEST(UT_imageView, prefetchedAnimationDecodedForRequest)
+{
+    ImageView view("/UT_TEST", QByteArray("png"));
+    ImageDecoder *decoder = view.decoder;
+
+    stub_ext::StubExt stub;
+    QList<bool> enqueued;
+    stub.set_lamda(&ImageDecoder::enqueue, [&enqueued](ImageDecoder *self, const QString &key, const QString &, const QByteArray &, const QSize &, bool stillOnly) {
+        self->pendingKeys.insert(key, stillOnly);
+        enqueued.append(stillOnly);
+    });
+    stub.set_lamda(&QImageReader::size, [] { return QSize(4000, 4000); });
+
+    const QString fileName("/UT_TEST_ANIMATED.webp");
+    const QSize bound(800, 600);
+    decoder->prefetch({ fileName }, bound);
+    ASSERT_EQ(QList<bool> { true }, enqueued);
+
+    // the request waits for the pending prefetch
+    QImage image;
+    EXPECT_FALSE(decoder->request(fileName, QByteArray(), bound, &image));
+    EXPECT_EQ(1, enqueued.size());
+
+    // the prefetch skipped the animation, it is not shown nor cached, the request decodes it again
+    QSignalSpy spy(decoder, &ImageDecoder::decoded);
+    const QString &key = decoder->cacheKey(fileName, bound);
+    decoder->onDecodeFinished(key, fileName, QByteArray(), bound, true, QImage(), false);
+    EXPECT_EQ(0, spy.count());
+    EXPECT_FALSE(decoder->cache.contains(key));
+    EXPECT_EQ(QList<bool>({ true, false }), enqueued);
+
+    QImage frame(10, 10, QImage::Format_ARGB32);
+    decoder->onDecodeFinished(key, fileName, QByteArray(), bound, false, frame, false);
+    EXPECT_EQ(1, spy.count());
+    EXPECT_TRUE(decoder->cache.contains(key));
+}
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mappedtextfile.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <gtest/gtest.h>
+
+PREVIEW_USE_NAMESPACE
+
+class UT_MappedTextFile : public testing::Test
+{
+protected:
+    bool openText(const QByteArray &text)
+    {
+        const QString &path = dir.filePath("text.log");
+        QFile out(path);
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || out.write(text) != text.size())
+            return false;
+        out.close();
+
+        if (!file.open(path))
+            return false;
+
+        for (int i = 0; i < 500 && !file.isIndexFinished(); ++i)
+            QThread::msleep(10);
+        return file.isIndexFinished();
+    }
+
+    QTemporaryDir dir;
+    MappedTextFile file;
+};
+
+TEST_F(UT_MappedTextFile, CrLfLines)
+{
+    ASSERT_TRUE(openText("first\r\nsecond\r\n\r\nfourth\r\n"));
+
+    EXPECT_EQ(file.lineCount(), 4);
+    EXPECT_EQ(file.lines(0, 4), QStringList({ "first", "second", "", "fourth" }));
+    EXPECT_EQ(file.lines(1, 1), QStringList({ "second" }));
+}
+
+TEST_F(UT_MappedTextFile, NoFinalLineFeed)
+{
+    ASSERT_TRUE(openText("first\nsecond\nlast"));
+
+    EXPECT_EQ(file.lineCount(), 3);
+    EXPECT_EQ(file.lines(2, 5), QStringList({ "last" }));
+}
+
+TEST_F(UT_MappedTextFile, ManyLines)
+{
+    // more lines than a checkpoint
+    QByteArray text;
+    for (int i = 0; i < 3000; ++i)
+        text += QByteArray::number(i) + '\n';
+    ASSERT_TRUE(openText(text));
+
+    EXPECT_EQ(file.lineCount(), 3000);
+    EXPECT_EQ(file.lines(2047, 3), QStringList({ "2047", "2048", "2049" }));
+    EXPECT_EQ(file.lines(2999, 1), QStringList({ "2999" }));
+}
+
+TEST_F(UT_MappedTextFile, EmptyFile)
+{
+    EXPECT_FALSE(openText(QByteArray()));
+    EXPECT_FALSE(file.isOpen());
+    EXPECT_EQ(file.lineCount(), 0);
+    EXPECT_TRUE(file.lines(0, 1).isEmpty());
+}
@@ -45,15 +45,73 @@ TEST_F(FileTagCacheTest, loadFileTagsFromDatabase)
         map["test"] = QColor("red");
         return map;
     });
-    stub.set_lamda(&TagProxyHandle::getAllFileWithTags, []() {
+    bool filesLoaded = false;
+    stub.set_lamda(&TagProxyHandle::getAllFileWithTags, [&filesLoaded]() {
         __DBG_STUB_INVOKE__
-        QVariantHash hash;
-        hash["test"] = QColor("red");
-        return hash;
+        filesLoaded = true;
+        return QVariantHash();
     });
     stub.set_lamda(&TagProxyHandle::isValid, []() { __DBG_STUB_INVOKE__ return true; });
     ins->loadFileTagsFromDatabase();
     EXPECT_TRUE(ins->getTagsColor(QStringList() << QString("test")).value("test") == QColor("red"));
+    EXPECT_FALSE(filesLoaded);
+}
+
+TEST_F(FileTagCacheTest, loadDirOnDemand)
+{
+    QStringList queriedDirs;
+    stub.set_lamda(&TagProxyHandle::getFilesWithTagsOfDirs, [&queriedDirs](TagProxyHandle *, const QStringList &dirs) {
+        __DBG_STUB_INVOKE__
+        queriedDirs.append(dirs);
+        QVariantHash hash;
+        if (dirs.contains("/lazy"))
+            hash["/lazy/a"] = QStringList { "red" };
+        return hash;
+    });
+    stub.set_lamda(&TagProxyHandle::isValid, []() { __DBG_STUB_INVOKE__ return true; });
+
+    EXPECT_EQ(QStringList { "red" }, ins->getTagsByFiles({ "/lazy/a" }));
+    EXPECT_TRUE(ins->getTagsByFiles({ "/lazy/b" }).isEmpty());
+    EXPECT_EQ(QStringList { "/lazy" }, queriedDirs);
+
+    const auto &tagsOfDir = ins->getTagsOfDir("/lazy");
+    EXPECT_EQ(1, tagsOfDir.size());
+    EXPECT_TRUE(tagsOfDir.contains("/lazy/a"));
+
+    // the changes of the loaded dirs are applied, others are ignored
+    QVariantMap map;
+    map["/lazy/b"] = QStringList { "green" };
+    map["/unloaded/c"] = QStringList { "green" };
+    ins->taggeFiles(map);
+    EXPECT_EQ(2, ins->getTagsOfDir("/lazy").size());
+    EXPECT_EQ(1, queriedDirs.size());
+    EXPECT_TRUE(ins->getTagsByFiles({ "/unloaded/c" }).isEmpty());
+}
+
+TEST_F(FileTagCacheTest, evictColdDirs)
+{
+    int queryCount = 0;
+    stub.set_lamda(&TagProxyHandle::getFilesWithTagsOfDirs, [&queryCount](TagProxyHandle *, const QStringList &dirs) {
+        __DBG_STUB_INVOKE__
+        ++queryCount;
+        QVariantHash hash;
+        for (const auto &dir : dirs)
+            hash[dir + "/file"] = QStringList { "red" };
+        return hash;
+    });
+    stub.set_lamda(&TagProxyHandle::isValid, []() { __DBG_STUB_INVOKE__ return true; });
+
+    for (int i = 0; i < 300; ++i) {
+        ins->getTagsByFiles({ QString("/evict/hot/file") });
+        ins->getTagsByFiles({ QString("/evict/%1/file").arg(i) });
+    }
+    EXPECT_EQ(301, queryCount);
+
+    // the hot dir is kept, the first cold dir was evicted
+    ins->getTagsByFiles({ QString("/evict/hot/file") });
+    EXPECT_EQ(301, queryCount);
+    EXPECT_EQ(QStringList { "red" }, ins->getTagsByFiles({ QString("/evict/0/file") }));
+    EXPECT_EQ(302, queryCount);
 }
 
 TEST_F(FileTagCacheTest, addTags)
@@ -84,18 +142,25 @@ TEST_F(FileTagCacheTest, changeTagName)
 
 TEST_F(FileTagCacheTest, taggeFiles)
 {
+    stub.set_lamda(&TagProxyHandle::getFilesWithTagsOfDirs, []() { __DBG_STUB_INVOKE__ return QVariantHash(); });
+    stub.set_lamda(&TagProxyHandle::isValid, []() { __DBG_STUB_INVOKE__ return true; });
+    EXPECT_TRUE(ins->getTagsByFiles({ QString("/tmp/tag") }).isEmpty());
+
     QVariantMap map;
-    map["tag"] = QString("tag1");
+    map["/tmp/tag"] = QString("tag1");
     ins->taggeFiles(map);
-    EXPECT_TRUE(ins->getTagsByFiles({ QString("tag") }).contains(QString("tag1")));
+    EXPECT_TRUE(ins->getTagsByFiles({ QString("/tmp/tag") }).contains(QString("tag1")));
 }
 
 TEST_F(FileTagCacheTest, untaggeFiles)
 {
+    stub.set_lamda(&TagProxyHandle::getFilesWithTagsOfDirs, []() { __DBG_STUB_INVOKE__ return QVariantHash(); });
+    stub.set_lamda(&TagProxyHandle::isValid, []() { __DBG_STUB_INVOKE__ return true; });
+
     QVariantMap map;
-    map["tag"] = QString("tag1");
+    map["/tmp/tag"] = QString("tag1");
     ins->untaggeFiles(map);
-    EXPECT_TRUE(!ins->getTagsByFiles({ QString("tag") }).contains(QString("tag1")));
+    EXPECT_TRUE(!ins->getTagsByFiles({ QString("/tmp/tag") }).contains(QString("tag1")));
 }
 
 TEST_F(FileTagCacheTest, onTagAdded)
@@ -160,3 +225,78 @@ TEST_F(FileTagCacheTest, onFilesUntagged)
     FileTagCacheController::instance().cacheWorker->onFilesUntagged(QVariantMap());
     EXPECT_TRUE(isRun);
 }
+
+TEST_F(FileTagCacheTest, loadPendingFiles)
+{
+    QStringList queriedDirs;
+    QStringList queriedFiles;
+    stub.set_lamda(&TagProxyHandle::getFilesWithTagsOfDirs, [&queriedDirs](TagProxyHandle *, const QStringList &dirs) {
+        __DBG_STUB_INVOKE__
+        queriedDirs.append(dirs);
+        QVariantHash hash;
+        hash["/pending/dir/0"] = QStringList { "red" };
+        return hash;
+    });
+    stub.set_lamda(&TagProxyHandle::getTagsThroughFile, [&queriedFiles](TagProxyHandle *, const QStringList &files) {
+        __DBG_STUB_INVOKE__
+        queriedFiles.append(files);
+        QVariantMap map;
+        map["/pending/search/a"] = QStringList { "green" };
+        return map;
+    });
+    stub.set_lamda(&TagProxyHandle::isValid, []() { __DBG_STUB_INVOKE__ return true; });
+
+    // painting never waits for the service
+    bool needLoad = false;
+    EXPECT_TRUE(ins->getCachedTagsByFile("/pending/search/a", &needLoad).isEmpty());
+    EXPECT_TRUE(needLoad);
+    EXPECT_TRUE(ins->getCachedTagsByFile("/pending/other/b", &needLoad).isEmpty());
+    EXPECT_FALSE(needLoad);
+    for (int i = 0; i < 4; ++i)
+        ins->getCachedTagsByFile(QString("/pending/dir/%1").arg(i), &needLoad);
+    EXPECT_TRUE(queriedDirs.isEmpty());
+    EXPECT_TRUE(queriedFiles.isEmpty());
+
+    bool loadAgain = true;
+    const auto &loaded = ins->loadPendingFiles(&loadAgain);
+    EXPECT_FALSE(loadAgain);
+    EXPECT_EQ(2, loaded.size());
+    EXPECT_EQ(QStringList { "/pending/dir" }, queriedDirs);
+    queriedFiles.sort();
+    EXPECT_EQ(QStringList({ "/pending/other/b", "/pending/search/a" }), queriedFiles);
+
+    // the scattered files are cached alone, their dirs are not loaded
+    EXPECT_EQ(QStringList { "green" }, ins->getCachedTagsByFile("/pending/search/a", &needLoad));
+    EXPECT_FALSE(needLoad);
+    EXPECT_TRUE(ins->getCachedTagsByFile("/pending/other/b", &needLoad).isEmpty());
+    EXPECT_FALSE(needLoad);
+    EXPECT_EQ(QStringList { "red" }, ins->getCachedTagsByFile("/pending/dir/0", &needLoad));
+    EXPECT_TRUE(ins->getCachedTagsByFile("/pending/search/c", &needLoad).isEmpty());
+    EXPECT_TRUE(needLoad);
+    ins->loadPendingFiles(&loadAgain);
+}
+
+TEST_F(FileTagCacheTest, removeCachedPaths)
+{
+    int queryCount = 0;
+    stub.set_lamda(&TagProxyHandle::getFilesWithTagsOfDirs, [&queryCount](TagProxyHandle *, const QStringList &dirs) {
+        __DBG_STUB_INVOKE__
+        ++queryCount;
+        QVariantHash hash;
+        for (const auto &dir : dirs)
+            hash[dir + "/file"] = QStringList { "red" };
+        return hash;
+    });
+    stub.set_lamda(&TagProxyHandle::isValid, []() { __DBG_STUB_INVOKE__ return true; });
+
+    EXPECT_EQ(QStringList { "red" }, ins->getTagsByFiles({ "/renamed/old/file" }));
+    EXPECT_EQ(QStringList { "red" }, ins->getTagsByFiles({ "/renamed/old/sub/file" }));
+    EXPECT_EQ(2, queryCount);
+
+    // the dir and its sub dirs are dropped, the dirs beside are kept
+    ins->removeCachedPaths({ "/renamed/old" });
+    EXPECT_TRUE(ins->getTagsOfDir("/renamed/oldest").size() == 1);
+    EXPECT_EQ(3, queryCount);
+    EXPECT_EQ(QStringList { "red" }, ins->getTagsByFiles({ "/renamed/old/sub/file" }));
+    EXPECT_EQ(4, queryCount);
+}
@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "diskpasswordrotator.h"
+
+#include <QMutex>
+#include <QtConcurrent>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include <libcryptsetup.h>
+
+DAEMONPAC_USE_NAMESPACE
+
+namespace {
+struct KeyslotChange
+{
+    QString device;
+    QByteArray fromPwd;
+    QByteArray toPwd;
+};
+}   // namespace
+
+class UT_DiskPasswordRotator : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        // every disk takes "old" until its keyslot is changed
+        passwords.clear();
+        changes.clear();
+        for (const QString &device : devices)
+            passwords.insert(device, "old");
+
+        stub.set_lamda(crypt_init, [this](crypt_device **cd, const char *device) {
+            __DBG_STUB_INVOKE__
+            const int index = devices.indexOf(QString(device));
+            if (index < 0)
+                return -ENODEV;
+            *cd = reinterpret_cast<crypt_device *>(&fakeDevices[index]);
+            return 0;
+        });
+        stub.set_lamda(crypt_free, [] {
+            __DBG_STUB_INVOKE__
+        });
+        stub.set_lamda(crypt_load, [] {
+            __DBG_STUB_INVOKE__
+            return 0;
+        });
+        stub.set_lamda(crypt_keyslot_max, [] {
+            __DBG_STUB_INVOKE__
+            return 0;
+        });
+        stub.set_lamda(crypt_get_pbkdf_type, []() -> const crypt_pbkdf_type * {
+            __DBG_STUB_INVOKE__
+            return nullptr;
+        });
+        stub.set_lamda(crypt_activate_by_passphrase,
+                       [this](crypt_device *cd, const char *, int, const char *pwd, size_t size, uint32_t) {
+                           __DBG_STUB_INVOKE__
+                           QMutexLocker locker(&mutex);
+                           return passwords.value(deviceOf(cd)) == QByteArray(pwd, static_cast<int>(size)) ? 0 : -EPERM;
+                       });
+        stub.set_lamda(crypt_keyslot_change_by_passphrase,
+                       [this](crypt_device *cd, int, int, const char *from, size_t fromSize, const char *to, size_t toSize) {
+                           __DBG_STUB_INVOKE__
+                           QMutexLocker locker(&mutex);
+                           const QString &device = deviceOf(cd);
+                           const QByteArray fromPwd(from, static_cast<int>(fromSize));
+                           const QByteArray toPwd(to, static_cast<int>(toSize));
+                           changes.append({ device, fromPwd, toPwd });
+                           if (device == brokenDevice || passwords.value(device) != fromPwd)
+                               return -EIO;
+                           passwords.insert(device, toPwd);
+                           return 1;
+                       });
+    }
+    void TearDown() override { stub.clear(); }
+
+    QString deviceOf(crypt_device *cd) const
+    {
+        const char *fake = reinterpret_cast<const char *>(cd);
+        return devices.value(static_cast<int>(fake - fakeDevices));
+    }
+
+    int countChanges(const QByteArray &fromPwd) const
+    {
+        return static_cast<int>(std::count_if(changes.cbegin(), changes.cend(),
+                                              [&](const KeyslotChange &change) { return change.fromPwd == fromPwd; }));
+    }
+
+    stub_ext::StubExt stub;
+    const QStringList devices { "/dev/sda3", "/dev/sdb1", "/dev/nvme0n1p2" };
+    char fakeDevices[3] {};
+    QMutex mutex;
+    QMap<QString, QByteArray> passwords;
+    QVector<KeyslotChange> changes;
+    QString brokenDevice;
+};
+
+TEST_F(UT_DiskPasswordRotator, MemoryBudgetClampsRequests)
+{
+    MemoryBudget empty(0);
+    EXPECT_EQ(1, empty.acquire(64));
+    empty.release(1);
+
+    MemoryBudget budget(1024);
+    // a request larger than the budget runs alone
+    EXPECT_EQ(1024, budget.acquire(4096));
+    budget.release(1024);
+    EXPECT_EQ(0, budget.acquire(-1));
+}
+
+TEST_F(UT_DiskPasswordRotator, MemoryBudgetWaitsForRelease)
+{
+    MemoryBudget budget(1024);
+    const qint64 first = budget.acquire(600);
+
+    QFuture<qint64> second = QtConcurrent::run([&budget] { return budget.acquire(600); });
+    QThread::msleep(50);
+    EXPECT_FALSE(second.isFinished());
+
+    budget.release(first);
+    second.waitForFinished();
+    EXPECT_EQ(600, second.result());
+    budget.release(second.result());
+}
+
+TEST_F(UT_DiskPasswordRotator, RotateAllDisks)
+{
+    DiskPasswordRotator rotator(devices, 1024);
+    QList<int> checkedCodes;
+    QObject::connect(&rotator, &DiskPasswordRotator::checked, [&](int code) { checkedCodes.append(code); });
+    QList<int> finishedCodes;
+    QObject::connect(&rotator, &DiskPasswordRotator::finished, [&](int code) { finishedCodes.append(code); });
+
+    EXPECT_EQ(kNoError, rotator.rotate("old", "new"));
+    EXPECT_TRUE(rotator.isPasswordChecked());
+    ASSERT_EQ(1, checkedCodes.size());
+    EXPECT_EQ(kNoError, checkedCodes.first());
+    ASSERT_EQ(1, finishedCodes.size());
+    EXPECT_EQ(kNoError, finishedCodes.first());
+
+    EXPECT_EQ(3, changes.size());
+    for (const QString &device : devices)
+        EXPECT_EQ("new", passwords.value(device));
+}
+
+TEST_F(UT_DiskPasswordRotator, WrongPasswordWritesNothing)
+{
+    DiskPasswordRotator rotator(devices, 1024);
+    QList<int> checkedCodes;
+    QObject::connect(&rotator, &DiskPasswordRotator::checked, [&](int code) { checkedCodes.append(code); });
+
+    EXPECT_EQ(kPasswordWrong, rotator.rotate("wrong", "new"));
+    EXPECT_FALSE(rotator.isPasswordChecked());
+    ASSERT_EQ(1, checkedCodes.size());
+    EXPECT_EQ(kPasswordWrong, checkedCodes.first());
+    EXPECT_TRUE(changes.isEmpty());
+}
+
+TEST_F(UT_DiskPasswordRotator, InconsistentPasswordWritesNothing)
+{
+    passwords.insert(devices.at(1), "other");
+    DiskPasswordRotator rotator(devices, 1024);
+
+    EXPECT_EQ(kPasswordInconsistent, rotator.rotate("old", "new"));
+    EXPECT_TRUE(rotator.isPasswordChecked());
+    EXPECT_TRUE(changes.isEmpty());
+}
+
+TEST_F(UT_DiskPasswordRotator, PartialFailureRestoresChangedDisks)
+{
+    brokenDevice = devices.at(1);
+    DiskPasswordRotator rotator(devices, 1024);
+    QList<int> finishedCodes;
+    QObject::connect(&rotator, &DiskPasswordRotator::finished, [&](int code) { finishedCodes.append(code); });
+
+    EXPECT_EQ(kPasswordChangeFailed, rotator.rotate("old", "new"));
+    ASSERT_EQ(1, finishedCodes.size());
+    EXPECT_EQ(kPasswordChangeFailed, finishedCodes.first());
+
+    // the broken disk is tried once, the other two are changed and changed back
+    EXPECT_EQ(3, countChanges("old"));
+    EXPECT_EQ(2, countChanges("new"));
+    for (const KeyslotChange &change : changes)
+        EXPECT_FALSE(change.fromPwd == "new" && change.device == brokenDevice);
+    for (const QString &device : devices)
+        EXPECT_EQ("old", passwords.value(device));
+}
+
+TEST_F(UT_DiskPasswordRotator, NoDisks)
+{
+    DiskPasswordRotator rotator({}, 1024);
+    EXPECT_EQ(kAccessDiskFailed, rotator.rotate("old", "new"));
+}
@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "pathjournal.h"
+
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+DAEMONPANYTHING_USE_NAMESPACE
+
+class UT_PathJournal : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        snapshot = dir.filePath("anything.journal");
+
+        home = journal.ensurePath("/home/user");
+        docs = journal.addChild(home, "Documents", true);
+        journal.addChild(docs, "Report.txt", false);
+        journal.addChild(docs, "notes.txt", false);
+        journal.addChild(home, "report-old.txt", false);
+        journal.addChild(journal.ensurePath("/data"), "report.bin", false);
+    }
+
+    QList<QByteArray> search(const QByteArray &path, const QString &keyword, int maxCount,
+                             const PathJournal::PathFilter &filter = PathJournal::PathFilter(), int scanCount = 1024)
+    {
+        QList<QByteArray> result;
+        PathJournal::NodeId next = PathJournal::kFirstNode;
+        while (next != PathJournal::kNoNode)
+            next = journal.search(path, keyword, maxCount, filter, next, scanCount, &result);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    QTemporaryDir dir;
+    QString snapshot;
+    PathJournal journal;
+    PathJournal::NodeId home { PathJournal::kNoNode };
+    PathJournal::NodeId docs { PathJournal::kNoNode };
+};
+
+TEST_F(UT_PathJournal, addAndMove)
+{
+    EXPECT_EQ(journal.fileCount(), 8);
+    EXPECT_EQ(journal.findPath("/home/user/Documents/notes.txt"), journal.findChild(docs, "notes.txt"));
+    EXPECT_EQ(journal.pathOf(docs), QByteArray("/home/user/Documents"));
+
+    journal.moveChild(home, "Documents", journal.findPath("/data"), "Docs");
+    EXPECT_EQ(journal.findPath("/home/user/Documents"), PathJournal::kNoNode);
+    EXPECT_EQ(journal.pathOf(journal.findPath("/data/Docs/Report.txt")), QByteArray("/data/Docs/Report.txt"));
+
+    const quint32 generation = journal.generation(docs);
+    journal.removeChild(journal.findPath("/data"), "Docs");
+    EXPECT_FALSE(journal.isAlive(docs));
+    EXPECT_NE(journal.generation(docs), generation);
+    EXPECT_EQ(journal.fileCount(), 5);
+}
+
+TEST_F(UT_PathJournal, searchInChunks)
+{
+    const QList<QByteArray> expected { "/home/user/Documents/Report.txt", "/home/user/report-old.txt" };
+    EXPECT_EQ(search("/home", "REPORT", 0), expected);
+    // one node a chunk gives the same result
+    EXPECT_EQ(search("/home", "report", 0, PathJournal::PathFilter(), 1), expected);
+    EXPECT_EQ(search("/", "report", 0).size(), 3);
+    EXPECT_EQ(search("/home", "report", 1).size(), 1);
+    EXPECT_TRUE(search("/none", "report", 0).isEmpty());
+}
+
+TEST_F(UT_PathJournal, searchFilteredBeforeCount)
+{
+    int checked = 0;
+    auto filter = [&checked](const QByteArray &path) {
+        ++checked;
+        return !path.contains("Documents");
+    };
+
+    // the rejected files do not take the places of the results
+    const QList<QByteArray> &result = search("/", "report", 2, filter);
+    EXPECT_EQ(result, QList<QByteArray>({ "/data/report.bin", "/home/user/report-old.txt" }));
+    EXPECT_EQ(checked, 3);
+}
+
+TEST_F(UT_PathJournal, saveAndLoad)
+{
+    journal.removeChild(docs, "notes.txt");
+    ASSERT_TRUE(journal.save(snapshot));
+
+    PathJournal loaded;
+    ASSERT_TRUE(loaded.load(snapshot));
+    EXPECT_EQ(loaded.fileCount(), journal.fileCount());
+    EXPECT_NE(loaded.findPath("/home/user/Documents/Report.txt"), PathJournal::kNoNode);
+    EXPECT_EQ(loaded.findPath("/home/user/Documents/notes.txt"), PathJournal::kNoNode);
+
+    // the freed node is reused
+    const PathJournal::NodeId node = loaded.addChild(loaded.findPath("/data"), "new.txt", false);
+    EXPECT_EQ(node, journal.freeNodes.last());
+    loaded.removeChild(loaded.findPath("/home/user"), "Documents");
+    EXPECT_EQ(loaded.fileCount(), 6);
+}
+
+TEST_F(UT_PathJournal, loadRejectsBrokenFreeList)
+{
+    PathJournal loaded;
+
+    // an alive node in the free list
+    journal.freeNodes.append(docs);
+    ASSERT_TRUE(journal.save(snapshot));
+    EXPECT_FALSE(loaded.load(snapshot));
+
+    // a node freed twice
+    journal.freeNodes.clear();
+    journal.removeChild(docs, "notes.txt");
+    journal.freeNodes.append(journal.freeNodes.last());
+    ASSERT_TRUE(journal.save(snapshot));
+    EXPECT_FALSE(loaded.load(snapshot));
+
+    // a dead node missing from the free list
+    journal.freeNodes.clear();
+    ASSERT_TRUE(journal.save(snapshot));
+    EXPECT_FALSE(loaded.load(snapshot));
+    EXPECT_EQ(loaded.fileCount(), 0);
+}
+
+TEST_F(UT_PathJournal, loadRejectsParentCycle)
+{
+    const PathJournal::NodeId user = home;
+    const PathJournal::NodeId homeDir = journal.nodes.at(static_cast<int>(user)).parent;
+    journal.nodes[static_cast<int>(homeDir)].parent = docs;
+    ASSERT_TRUE(journal.save(snapshot));
+
+    PathJournal loaded;
+    EXPECT_FALSE(loaded.load(snapshot));
+}
+
+TEST_F(UT_PathJournal, loadRebuildsSiblings)
+{
+    // the sibling links are not read from the snapshot
+    journal.nodes[static_cast<int>(docs)].firstChild = docs;
+    journal.nodes[static_cast<int>(home)].firstChild = PathJournal::kNoNode;
+    ASSERT_TRUE(journal.save(snapshot));
+
+    PathJournal loaded;
+    ASSERT_TRUE(loaded.load(snapshot));
+    loaded.removeChild(loaded.findPath("/home"), "user");
+    EXPECT_EQ(loaded.fileCount(), 3);
+    EXPECT_EQ(loaded.findPath("/home/user/Documents/Report.txt"), PathJournal::kNoNode);
+}
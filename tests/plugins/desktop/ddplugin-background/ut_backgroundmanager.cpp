@@ -4,6 +4,7 @@
 #include "backgroundmanager.h"
 #include "desktoputils/ddpugin_eventinterface_helper.h"
 #include "backgroundmanager_p.h"
+#include "wallpaperrenderer.h"
 
 #include <dfm-base/dfm_desktop_defines.h>
 #include <dfm-framework/dpf.h>
@@ -407,31 +408,32 @@ TEST_F(UT_backGroundManager, runUpdate)
    req.path = "file:/temp";
    req.screen = "window";
    req.size = QSize(1,1);
-   req.pixmap = QPixmap();
 
    QList<BackgroundBridge::Requestion> reqs;
    reqs.push_back(req);
+   req.screen = "window2";
+   reqs.push_back(req);
 
    BackgroundBridge self(nullptr);
    self.getting = true;
 
-   stub.set_lamda(&QPixmap::width,[&self](){
-       __DBG_STUB_INVOKE__ ;
-       self.getting = false;
-       return 2;
+   int decoded = 0;
+   stub.set_lamda(&WallpaperRenderer::cached, [](){
+       __DBG_STUB_INVOKE__
+       return QImage();
    });
-   stub.set_lamda(&QPixmap::height,[&self](){
+   stub.set_lamda(&WallpaperRenderer::cache, [](){
        __DBG_STUB_INVOKE__
-       self.getting = false;
-       return 2;
    });
-   stub.set_lamda(&BackgroundBridge::getPixmap,[](){
+   stub.set_lamda(&WallpaperRenderer::decode, [&decoded](){
        __DBG_STUB_INVOKE__
-       return QPixmap(2,2);}
-   );
+       decoded++;
+       return QImage(2, 2, QImage::Format_RGB32);
+   });
 
    self.runUpdate(&self,reqs);
 
+   EXPECT_EQ(decoded, 1);
    EXPECT_EQ(self.getting,false);
 }
 
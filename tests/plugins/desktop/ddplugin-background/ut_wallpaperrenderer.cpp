@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "wallpaperrenderer.h"
+
+#include "stubext.h"
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QTemporaryDir>
+
+DDP_BACKGROUND_USE_NAMESPACE
+
+TEST(WallpaperRenderer, decode)
+{
+    QTemporaryDir dir;
+    const QString path = dir.path() + "/wallpaper.png";
+    QImage source(800, 400, QImage::Format_RGB32);
+    source.fill(Qt::red);
+    ASSERT_TRUE(source.save(path, "PNG"));
+
+    EXPECT_TRUE(WallpaperRenderer::decode("").isNull());
+    EXPECT_EQ(WallpaperRenderer::decode(path).size(), QSize(800, 400));
+    EXPECT_EQ(WallpaperRenderer::decode("file://" + path).size(), QSize(800, 400));
+
+    // decoded for the largest screen
+    EXPECT_EQ(WallpaperRenderer::decode(path, { QSize(100, 100), QSize(300, 100) }).size(), QSize(300, 150));
+    EXPECT_EQ(WallpaperRenderer::decode(path, { QSize(1600, 1600) }).size(), QSize(800, 400));
+}
+
+TEST(WallpaperRenderer, decode_wrong_suffix)
+{
+    QTemporaryDir dir;
+    const QString path = dir.path() + "/wallpaper.png";
+    QImage source(40, 20, QImage::Format_RGB32);
+    source.fill(Qt::blue);
+    ASSERT_TRUE(source.save(path, "JPG"));
+
+    EXPECT_EQ(WallpaperRenderer::decode(path).size(), QSize(40, 20));
+}
+
+TEST(WallpaperRenderer, crop)
+{
+    QImage decoded(300, 150, QImage::Format_ARGB32);
+    decoded.fill(Qt::green);
+
+    EXPECT_TRUE(WallpaperRenderer::crop(QImage(), QSize(10, 10)).isNull());
+    EXPECT_TRUE(WallpaperRenderer::crop(decoded, QSize()).isNull());
+
+    QImage image = WallpaperRenderer::crop(decoded, QSize(100, 100));
+    EXPECT_EQ(image.size(), QSize(100, 100));
+    EXPECT_EQ(image.format(), QImage::Format_ARGB32_Premultiplied);
+
+    image = WallpaperRenderer::crop(decoded, QSize(300, 100));
+    EXPECT_EQ(image.size(), QSize(300, 100));
+
+    image = WallpaperRenderer::crop(decoded.convertToFormat(QImage::Format_RGB888), QSize(600, 300));
+    EXPECT_EQ(image.size(), QSize(600, 300));
+    EXPECT_EQ(image.format(), QImage::Format_RGB32);
+}
+
+TEST(WallpaperRenderer, cached_missing)
+{
+    EXPECT_TRUE(WallpaperRenderer::cached("", QSize(10, 10)).isNull());
+    EXPECT_TRUE(WallpaperRenderer::cached("/not/exist/wallpaper.png", QSize(10, 10)).isNull());
+}
+
+TEST(WallpaperRenderer, cache_round_trip)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString &cacheFile = dir.filePath("wallpapers/cached.png");
+    stub_ext::StubExt stub;
+    stub.set_lamda(&WallpaperRenderer::cacheFileOf, [cacheFile]() {
+        __DBG_STUB_INVOKE__
+        return cacheFile;
+    });
+
+    QImage image(40, 20, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    WallpaperRenderer::cache("wallpaper.jpg", QSize(40, 20), image);
+    ASSERT_TRUE(QFile::exists(cacheFile));
+    EXPECT_EQ(QImageReader(cacheFile).format(), QByteArray("png"));
+
+    // a hit keeps the file from the pruning
+    QFile file(cacheFile);
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    file.setFileTime(QDateTime::currentDateTime().addDays(-1), QFileDevice::FileModificationTime);
+    file.close();
+
+    const QImage &cached = WallpaperRenderer::cached("wallpaper.jpg", QSize(40, 20));
+    EXPECT_EQ(cached.format(), QImage::Format_RGB32);
+    EXPECT_EQ(cached, image);
+    EXPECT_GT(QFileInfo(cacheFile).lastModified(), QDateTime::currentDateTime().addSecs(-60));
+
+    EXPECT_TRUE(WallpaperRenderer::cached("wallpaper.jpg", QSize(20, 10)).isNull());
+}
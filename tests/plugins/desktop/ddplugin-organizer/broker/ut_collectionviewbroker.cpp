@@ -33,11 +33,9 @@ protected:
 
         QPointer<CollectionDataProvider> ptr(test_ptr);
         v->d->provider = ptr;
-        typedef QList<QUrl>(*fun_type)(const QString&);
-        stub.set_lamda((fun_type)(&CollectionDataProvider::items),[this](const QString&){
-            QList<QUrl> res ;
-            res.push_back(QUrl("temp_url"));
-            return res;
+        typedef int(*fun_type)(const QString&, const QUrl&);
+        stub.set_lamda((fun_type)(&CollectionDataProvider::indexOf),[this](const QString&, const QUrl &url){
+            return url == QUrl("temp_url") ? 0 : -1;
         });
         v->d->id = QString("temp_id");
     }
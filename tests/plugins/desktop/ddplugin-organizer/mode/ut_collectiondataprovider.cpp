@@ -131,3 +131,33 @@ TEST_F(UT_CollectionDataProvider, takePreItem)
 }
 
 
+
+TEST_F(UT_CollectionDataProvider, indexOf)
+{
+    QUrl one("file:///tmp/one");
+    QUrl two("file:///tmp/two");
+    QUrl three("file:///tmp/three");
+    CollectionBaseDataPtr data(new CollectionBaseData);
+    data->key = "window";
+    data->items = { one, two };
+    prov->collections["window"] = data;
+
+    EXPECT_EQ(prov->indexOf("window", one), 0);
+    EXPECT_EQ(prov->indexOf("window", two), 1);
+    EXPECT_EQ(prov->indexOf("window", three), -1);
+    EXPECT_EQ(prov->indexOf("other", one), -1);
+    EXPECT_EQ(prov->key(two), QString("window"));
+
+    // the index is rebuilt once the items are changed
+    data->items.insert(0, three);
+    EXPECT_EQ(prov->indexOf("window", three), 0);
+    EXPECT_EQ(prov->indexOf("window", two), 2);
+
+    data->items.swap(0, 2);
+    EXPECT_EQ(prov->indexOf("window", two), 0);
+    EXPECT_TRUE(prov->contains("window", three));
+
+    prov->collections.remove("window");
+    EXPECT_EQ(prov->indexOf("window", two), -1);
+    EXPECT_FALSE(prov->itemIndexes.contains("window"));
+}
@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins/filemanager/core/dfmplugin-detailspace/utils/mediainfofetcher.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+DPDETAILSPACE_USE_NAMESPACE
+
+TEST(UT_MediaInfoFetcher, TrimCache)
+{
+    MediaInfoFetcher fetcher;
+    for (int i = 0; i < 10001; ++i) {
+        MediaCacheKey key;
+        key.inode = static_cast<quint64>(i);
+        fetcher.cache.insert(key, { MediaMetadata(), i / 2 });
+    }
+
+    // the entries used least lately are dropped
+    fetcher.trimCache();
+    EXPECT_EQ(fetcher.cache.size(), 9000);
+    const auto &values = fetcher.cache.values();
+    const auto oldest = std::min_element(values.cbegin(), values.cend(), [](const auto &left, const auto &right) {
+        return left.lastUsed < right.lastUsed;
+    });
+    EXPECT_EQ(oldest->lastUsed, 500);
+    EXPECT_TRUE(fetcher.cache.contains([] { MediaCacheKey key; key.inode = 10000; return key; }()));
+}
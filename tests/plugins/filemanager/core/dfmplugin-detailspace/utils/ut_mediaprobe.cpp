@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins/filemanager/core/dfmplugin-detailspace/utils/mediaprobe.h"
+
+#include <QBuffer>
+#include <QtEndian>
+
+#include <gtest/gtest.h>
+
+DPDETAILSPACE_USE_NAMESPACE
+
+template<typename T>
+static QByteArray bigEndian(T value)
+{
+    QByteArray data(sizeof(T), '\0');
+    qToBigEndian<T>(value, data.data());
+    return data;
+}
+
+template<typename T>
+static QByteArray littleEndian(T value)
+{
+    QByteArray data(sizeof(T), '\0');
+    qToLittleEndian<T>(value, data.data());
+    return data;
+}
+
+static QByteArray mp4Box(const QByteArray &type, const QByteArray &data)
+{
+    return bigEndian<quint32>(quint32(8 + data.size())) + type + data;
+}
+
+static QByteArray oggPage(quint64 granule, quint32 serial, const QByteArray &packet)
+{
+    QByteArray page("OggS");
+    page += QByteArray(2, '\0');
+    page += littleEndian<quint64>(granule);
+    page += littleEndian<quint32>(serial);
+    page += QByteArray(8, '\0');
+    page += char(1);
+    page += char(packet.size());
+    return page + packet;
+}
+
+static MediaMetadata probeData(QByteArray data)
+{
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    return MediaProbe::probe(&buffer);
+}
+
+TEST(UT_MediaProbe, Png)
+{
+    QByteArray data("\x89PNG\r\n\x1A\n", 8);
+    data += bigEndian<quint32>(13) + "IHDR" + bigEndian<quint32>(640) + bigEndian<quint32>(480);
+    data += QByteArray(5, '\0');
+
+    const MediaMetadata &meta = probeData(data);
+    EXPECT_EQ(meta.width, 640);
+    EXPECT_EQ(meta.height, 480);
+    EXPECT_FALSE(meta.hasDuration());
+}
+
+TEST(UT_MediaProbe, Gif)
+{
+    QByteArray data("GIF89a");
+    data += littleEndian<quint16>(320) + littleEndian<quint16>(200);
+    data += QByteArray(6, '\0');
+
+    const MediaMetadata &meta = probeData(data);
+    EXPECT_EQ(meta.width, 320);
+    EXPECT_EQ(meta.height, 200);
+}
+
+TEST(UT_MediaProbe, JpegExifOrientation)
+{
+    // a tiff of one entry, the orientation 6 turns the image by 90 degrees
+    QByteArray exif("Exif\0\0MM\0\x2A", 10);
+    exif += bigEndian<quint32>(8) + bigEndian<quint16>(1);
+    exif += bigEndian<quint16>(0x0112) + bigEndian<quint16>(3) + bigEndian<quint32>(1) + bigEndian<quint16>(6) + QByteArray(2, '\0');
+    exif += QByteArray(4, '\0');
+
+    QByteArray data("\xFF\xD8", 2);
+    data += QByteArray("\xFF\xE1", 2) + bigEndian<quint16>(quint16(2 + exif.size())) + exif;
+    data += QByteArray("\xFF\xC0", 2) + bigEndian<quint16>(17) + char(8) + bigEndian<quint16>(480) + bigEndian<quint16>(640);
+    data += QByteArray(10, '\0');
+
+    const MediaMetadata &meta = probeData(data);
+    EXPECT_EQ(meta.width, 480);
+    EXPECT_EQ(meta.height, 640);
+}
+
+TEST(UT_MediaProbe, JpegExifOffsetWraps)
+{
+    // the offset of the ifd plus its count wraps around 32 bits
+    QByteArray exif("Exif\0\0MM\0\x2A", 10);
+    exif += bigEndian<quint32>(0xFFFFFFFF) + QByteArray(8, '\0');
+
+    QByteArray data("\xFF\xD8", 2);
+    data += QByteArray("\xFF\xE1", 2) + bigEndian<quint16>(quint16(2 + exif.size())) + exif;
+    data += QByteArray("\xFF\xC0", 2) + bigEndian<quint16>(17) + char(8) + bigEndian<quint16>(480) + bigEndian<quint16>(640);
+    data += QByteArray(10, '\0');
+
+    const MediaMetadata &meta = probeData(data);
+    EXPECT_EQ(meta.width, 640);
+    EXPECT_EQ(meta.height, 480);
+}
+
+TEST(UT_MediaProbe, Mp4)
+{
+    const QByteArray &ftyp = mp4Box("ftyp", QByteArray("isom") + QByteArray(4, '\0'));
+
+    QByteArray mvhd(4, '\0');
+    mvhd += QByteArray(8, '\0') + bigEndian<quint32>(1000) + bigEndian<quint32>(5000);
+
+    QByteArray tkhd(40, '\0');
+    tkhd += bigEndian<quint32>(0x00010000) + QByteArray(32, '\0');
+    tkhd += bigEndian<quint32>(1920 << 16) + bigEndian<quint32>(1080 << 16);
+
+    const QByteArray &moov = mp4Box("moov", mp4Box("mvhd", mvhd) + mp4Box("trak", mp4Box("tkhd", tkhd)));
+    const QByteArray &mdat = mp4Box("mdat", QByteArray(64, '\0'));
+
+    // the movie box after the media data
+    const MediaMetadata &meta = probeData(ftyp + mdat + moov);
+    EXPECT_EQ(meta.width, 1920);
+    EXPECT_EQ(meta.height, 1080);
+    EXPECT_EQ(meta.duration, 5000);
+}
+
+TEST(UT_MediaProbe, Flac)
+{
+    QByteArray data("fLaC");
+    data += QByteArray("\x00\x00\x00\x22", 4) + QByteArray(10, '\0');
+    data += bigEndian<quint64>(quint64(44100) << 44 | 441000);
+    data += QByteArray(16, '\0');
+
+    const MediaMetadata &meta = probeData(data);
+    EXPECT_EQ(meta.duration, 10000);
+    EXPECT_FALSE(meta.hasSize());
+}
+
+TEST(UT_MediaProbe, Mp3ConstantBitrate)
+{
+    // mpeg 1 layer III, 128 kbps, 44.1 kHz, joint stereo
+    QByteArray data = bigEndian<quint32>(0xFFFB9064);
+    data += QByteArray(16000 - data.size(), '\0');
+
+    const MediaMetadata &meta = probeData(data);
+    EXPECT_EQ(meta.duration, 1000);
+}
+
+TEST(UT_MediaProbe, OggOpus)
+{
+    QByteArray head("OpusHead");
+    head += char(1) + QByteArray(1, char(2)) + littleEndian<quint16>(312) + littleEndian<quint32>(48000);
+    head += QByteArray(3, '\0');
+
+    QByteArray data = oggPage(0, 1234, head);
+    data += oggPage(100, 4321, QByteArray(32, '\0'));
+    data += oggPage(48000 * 3 + 312, 1234, QByteArray(32, '\0'));
+    // another stream ends later
+    data += oggPage(48000 * 9, 4321, QByteArray(32, '\0'));
+
+    const MediaMetadata &meta = probeData(data);
+    EXPECT_EQ(meta.duration, 3000);
+}
+
+TEST(UT_MediaProbe, UnknownOrTruncated)
+{
+    EXPECT_FALSE(probeData(QByteArray(64, 'x')).hasSize());
+    EXPECT_FALSE(probeData(QByteArray(64, 'x')).hasDuration());
+
+    const QByteArray &png = QByteArray("\x89PNG\r\n\x1A\n", 8) + bigEndian<quint32>(13) + "IH";
+    EXPECT_FALSE(probeData(png).hasSize());
+    EXPECT_FALSE(MediaProbe::probe(QString("/nonexistent/file.png")).hasSize());
+}
@@ -17,3 +17,21 @@ TEST(CompleterViewModelTest, ut_setStringList)
                                       << "");
     EXPECT_EQ(1, model.rowCount());
 }
+
+TEST(CompleterViewModelTest, ut_appendStringList)
+{
+    CompleterViewModel model;
+    model.setStringList(QStringList() << "1");
+    model.appendStringList(QStringList() << "2"
+                                         << ""
+                                         << "3");
+    ASSERT_EQ(3, model.rowCount());
+    EXPECT_EQ("3", model.index(2).data().toString());
+
+    model.setIcon(0, QIcon::fromTheme("document-open-recent-symbolic"));
+    EXPECT_TRUE(model.index(0).data(Qt::DecorationRole).isValid());
+    EXPECT_FALSE(model.index(1).data(Qt::DecorationRole).isValid());
+
+    model.removeAll();
+    EXPECT_EQ(0, model.rowCount());
+}
@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "utils/completioncache.h"
+
+#include <dfm-base/base/application/settings.h>
+
+#include "stubext.h"
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+
+DPTITLEBAR_USE_NAMESPACE
+DFMBASE_USE_NAMESPACE
+
+class UT_CompletionCache : public testing::Test
+{
+protected:
+    virtual void SetUp() override
+    {
+        typedef QVariant (Settings::*Value)(const QString &, const QString &, const QVariant &) const;
+        stub.set_lamda(static_cast<Value>(&Settings::value), [] { return QVariant(); });
+        typedef void (Settings::*SetValue)(const QString &, const QString &, const QVariant &);
+        stub.set_lamda(static_cast<SetValue>(&Settings::setValue), [] {});
+        stub.set_lamda(&Settings::setWatchChanges, [] {});
+        stub.set_lamda(&CompletionCache::watch, [] { return true; });
+
+        cache = new CompletionCache;
+    }
+    virtual void TearDown() override
+    {
+        delete cache;
+        stub.clear();
+    }
+
+    stub_ext::StubExt stub;
+    CompletionCache *cache { nullptr };
+    QUrl dir { QUrl::fromLocalFile("/usr/lib") };
+};
+
+TEST_F(UT_CompletionCache, Completions)
+{
+    QStringList names;
+    EXPECT_FALSE(cache->completions(dir, &names));
+
+    cache->insert(dir, { "a", "b", "c" });
+    EXPECT_TRUE(cache->completions(QUrl::fromLocalFile("/usr/lib/"), &names));
+    EXPECT_EQ(names, QStringList({ "a", "b", "c" }));
+
+    // the visited ones first
+    cache->visit(QUrl::fromLocalFile("/usr/lib/c"));
+    cache->visit(QUrl::fromLocalFile("/usr/lib/b"));
+    cache->visit(QUrl::fromLocalFile("/usr/lib/b"));
+    EXPECT_TRUE(cache->completions(dir, &names));
+    EXPECT_EQ(names, QStringList({ "b", "c", "a" }));
+
+    cache->invalidate(dir);
+    EXPECT_FALSE(cache->completions(dir, &names));
+}
+
+TEST_F(UT_CompletionCache, Watched)
+{
+    QStringList names;
+    cache->insert(dir, { "a", "b" });
+    cache->insert(QUrl::fromLocalFile("/usr/lib/a"), { "x" });
+
+    cache->onFileDeleted(QUrl::fromLocalFile("/usr/lib/a"));
+    EXPECT_FALSE(cache->completions(QUrl::fromLocalFile("/usr/lib/a"), &names));
+    EXPECT_TRUE(cache->completions(dir, &names));
+    EXPECT_EQ(names, QStringList({ "b" }));
+
+    cache->onFileRename(QUrl::fromLocalFile("/usr/lib/b"), QUrl::fromLocalFile("/usr/lib/d"));
+    EXPECT_FALSE(cache->completions(dir, &names));
+}
+
+TEST_F(UT_CompletionCache, Evicted)
+{
+    QStringList names;
+    for (int i = 0; i < 40; ++i)
+        cache->insert(QUrl::fromLocalFile(QString("/tmp/%1").arg(i)), {});
+
+    EXPECT_FALSE(cache->completions(QUrl::fromLocalFile("/tmp/0"), &names));
+    EXPECT_TRUE(cache->completions(QUrl::fromLocalFile("/tmp/39"), &names));
+}
+
+TEST_F(UT_CompletionCache, PrivateNotKept)
+{
+    QStringList names;
+    const QUrl vault("dfmvault:///secret");
+    cache->insert(vault, { "a" });
+    cache->visit(vault);
+    EXPECT_FALSE(cache->completions(vault, &names));
+    EXPECT_FALSE(cache->find(vault, false));
+
+    const QUrl unlocked { QUrl::fromLocalFile(QDir::homePath() + "/.config/Vault/vault_unlocked/secret") };
+    cache->insert(unlocked, { "a" });
+    cache->visit(unlocked);
+    EXPECT_FALSE(cache->completions(unlocked, &names));
+    EXPECT_FALSE(cache->find(unlocked, false));
+}
+
+TEST_F(UT_CompletionCache, VisitsSavedLater)
+{
+    int saved = 0;
+    typedef void (Settings::*SetValue)(const QString &, const QString &, const QVariant &);
+    stub.set_lamda(static_cast<SetValue>(&Settings::setValue), [&saved] { ++saved; });
+
+    cache->visit(dir);
+    cache->visit(QUrl::fromLocalFile("/usr"));
+    EXPECT_EQ(saved, 0);
+    EXPECT_TRUE(cache->saveTimer.isActive());
+
+    emit cache->saveTimer.timeout(QTimer::QPrivateSignal());
+    EXPECT_EQ(saved, 1);
+}
+
+TEST_F(UT_CompletionCache, Pruned)
+{
+    cache->insert(QUrl::fromLocalFile("/tmp/a/b"), { "c" });
+    cache->visit(QUrl::fromLocalFile("/tmp/v"));
+    EXPECT_TRUE(cache->find(QUrl::fromLocalFile("/tmp/a"), false));
+
+    // neither listed nor visited
+    cache->invalidate(QUrl::fromLocalFile("/tmp/a/b"));
+    EXPECT_FALSE(cache->find(QUrl::fromLocalFile("/tmp/a"), false));
+    EXPECT_TRUE(cache->find(QUrl::fromLocalFile("/tmp/v"), false));
+
+    stub.set_lamda(&CompletionCache::watch, [] { return false; });
+    cache->insert(QUrl::fromLocalFile("/tmp/unwatched"), { "c" });
+    EXPECT_FALSE(cache->find(QUrl::fromLocalFile("/tmp/unwatched"), false));
+}
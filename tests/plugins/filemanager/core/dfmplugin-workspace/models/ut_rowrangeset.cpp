@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins/filemanager/core/dfmplugin-workspace/models/rowrangeset.h"
+
+#include <gtest/gtest.h>
+
+#include <QStandardItemModel>
+
+using namespace dfmplugin_workspace;
+
+TEST(UT_RowRangeSet, resetRows)
+{
+    RowRangeSet rows;
+    rows.reset(QVector<int> { 7, 1, 2, 3, 5, 2, 6 });
+
+    EXPECT_EQ(6, rows.count());
+    EXPECT_EQ(2, rows.ranges().count());
+    EXPECT_TRUE(rows.contains(1));
+    EXPECT_FALSE(rows.contains(4));
+    EXPECT_FALSE(rows.contains(100));
+    EXPECT_TRUE(rows.intersects(4, 5));
+    EXPECT_FALSE(rows.intersects(4, 4));
+    EXPECT_FALSE(rows.intersects(8, 20));
+
+    QVector<int> iterated;
+    for (int row : rows)
+        iterated.append(row);
+    EXPECT_EQ(QVector<int>({ 1, 2, 3, 5, 6, 7 }), iterated);
+
+    rows.clear();
+    EXPECT_TRUE(rows.isEmpty());
+    EXPECT_EQ(0, rows.count());
+    EXPECT_FALSE(rows.contains(1));
+}
+
+TEST(UT_RowRangeSet, resetSelection)
+{
+    QStandardItemModel model;
+    model.appendRow(new QStandardItem("root"));
+    QStandardItem *root = model.item(0);
+    for (int i = 0; i < 10; ++i)
+        root->appendRow({ new QStandardItem(QString::number(i)), new QStandardItem("size") });
+
+    const QModelIndex &parent = model.index(0, 0);
+    QItemSelection selection;
+    selection.select(model.index(0, 0, parent), model.index(3, 1, parent));
+    selection.select(model.index(4, 0, parent), model.index(4, 0, parent));
+    selection.select(model.index(8, 1, parent), model.index(9, 1, parent));   // not from the first column
+    selection.select(model.index(0, 0), model.index(0, 0));   // other parent
+
+    RowRangeSet rows;
+    rows.reset(selection, parent);
+    EXPECT_EQ(5, rows.count());
+    EXPECT_EQ(1, rows.ranges().count());
+    EXPECT_TRUE(rows.contains(4));
+    EXPECT_FALSE(rows.contains(8));
+}
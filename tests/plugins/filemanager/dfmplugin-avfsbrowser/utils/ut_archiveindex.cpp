@@ -0,0 +1,230 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "utils/archiveindex.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include <archive.h>
+#include <archive_entry.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+using namespace dfmplugin_avfsbrowser;
+
+static bool writeArchive(const QString &path, bool gzip, const QList<QPair<QString, QByteArray>> &files)
+{
+    archive *a = archive_write_new();
+    archive_write_set_format_pax_restricted(a);
+    if (gzip)
+        archive_write_add_filter_gzip(a);
+    if (archive_write_open_filename(a, QFile::encodeName(path).constData()) != ARCHIVE_OK) {
+        archive_write_free(a);
+        return false;
+    }
+
+    for (const auto &file : files) {
+        archive_entry *header = archive_entry_new();
+        archive_entry_set_pathname(header, file.first.toUtf8().constData());
+        archive_entry_set_filetype(header, AE_IFREG);
+        archive_entry_set_perm(header, 0644);
+        archive_entry_set_size(header, file.second.size());
+        archive_write_header(a, header);
+        archive_write_data(a, file.second.constData(), static_cast<size_t>(file.second.size()));
+        archive_entry_free(header);
+    }
+    archive_write_close(a);
+    archive_write_free(a);
+    return true;
+}
+
+static QByteArray readAll(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+// the directories are aged as well
+static void setAge(const QString &path, qint64 secs)
+{
+    struct timespec times[2];
+    times[0].tv_sec = times[1].tv_sec = static_cast<time_t>(QDateTime::currentSecsSinceEpoch() - secs);
+    times[0].tv_nsec = times[1].tv_nsec = 0;
+    ::utimensat(AT_FDCWD, QFile::encodeName(path).constData(), times, 0);
+}
+
+class UT_ArchiveIndex : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        const QString &cache = dir.filePath("cache");
+        stub.set_lamda(&ArchiveIndex::cacheDir, [cache] { return cache; });
+
+        // the data of the first file is skipped to reach the second one
+        files = { { "docs/big.bin", QByteArray(300 * 1024, 'x') },
+                  { "docs/readme.txt", QByteArray("read me\n") },
+                  { "./top.txt", QByteArray("top") } };
+    }
+
+    QTemporaryDir dir;
+    stub_ext::StubExt stub;
+    QList<QPair<QString, QByteArray>> files;
+};
+
+TEST_F(UT_ArchiveIndex, splitAvfsPath)
+{
+    QString archive, inner;
+    EXPECT_TRUE(ArchiveIndex::splitAvfsPath("/home/a.tar.gz#/dir/file", &archive, &inner));
+    EXPECT_EQ(archive, QString("/home/a.tar.gz"));
+    EXPECT_EQ(inner, QString("dir/file"));
+    EXPECT_TRUE(ArchiveIndex::splitAvfsPath("/home/a.tar#", &archive, &inner));
+    EXPECT_TRUE(inner.isEmpty());
+
+    // the handlers of avfs and the nested archives
+    EXPECT_FALSE(ArchiveIndex::splitAvfsPath("/home/a.gz#ugz", &archive, &inner));
+    EXPECT_FALSE(ArchiveIndex::splitAvfsPath("/home/a.tar#/b.tar#/c", &archive, &inner));
+    EXPECT_FALSE(ArchiveIndex::splitAvfsPath("/home/a.tar", &archive, &inner));
+}
+
+TEST_F(UT_ArchiveIndex, listEntries)
+{
+    const QString &path = dir.filePath("list.tar");
+    ASSERT_TRUE(writeArchive(path, false, files));
+
+    const auto &index = ArchiveIndex::open(path);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(ArchiveIndex::cached(path), index);
+
+    // the directory is implied by its files
+    const ArchiveIndex::Entry &docs = index->entry("docs");
+    EXPECT_TRUE(docs.isDir());
+    EXPECT_EQ(docs.ordinal, -1);
+
+    const ArchiveIndex::Entry &readme = index->entry("docs/readme.txt");
+    EXPECT_FALSE(readme.isDir());
+    EXPECT_EQ(readme.size, 8);
+    EXPECT_EQ(readme.fileName(), QString("readme.txt"));
+    EXPECT_GE(readme.headerOffset, 0);
+
+    EXPECT_EQ(index->children("").size(), 2);
+    EXPECT_EQ(index->children("docs").size(), 2);
+    EXPECT_TRUE(index->contains("top.txt"));
+    EXPECT_FALSE(index->contains("none"));
+    EXPECT_FALSE(index->entry("none").isValid());
+}
+
+TEST_F(UT_ArchiveIndex, extractAtOffset)
+{
+    const QString &path = dir.filePath("seek.tar");
+    ASSERT_TRUE(writeArchive(path, false, files));
+    const auto &index = ArchiveIndex::open(path);
+    ASSERT_TRUE(index);
+
+    qint64 lastDone = 0;
+    qint64 lastTotal = 0;
+    const QString &target = dir.filePath("readme.txt");
+    EXPECT_TRUE(index->extract("docs/readme.txt", target, [&](qint64 done, qint64 total) {
+        lastDone = done;
+        lastTotal = total;
+        return true;
+    }));
+    EXPECT_EQ(readAll(target), files.at(1).second);
+    EXPECT_EQ(lastDone, 8);
+    EXPECT_EQ(lastTotal, 8);
+
+    EXPECT_FALSE(index->extract("docs", dir.filePath("docs")));
+    EXPECT_FALSE(index->extract("none", dir.filePath("none")));
+}
+
+TEST_F(UT_ArchiveIndex, extractInSequence)
+{
+    const QString &path = dir.filePath("sequence.tar.gz");
+    ASSERT_TRUE(writeArchive(path, true, files));
+    const auto &index = ArchiveIndex::open(path);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(index->entry("top.txt").headerOffset, -1);
+
+    qint64 lastTotal = 0;
+    const QString &target = dir.filePath("top.txt");
+    EXPECT_TRUE(index->extract("top.txt", target, [&](qint64, qint64 total) {
+        lastTotal = total;
+        return true;
+    }));
+    EXPECT_EQ(readAll(target), QByteArray("top"));
+    // the progress of the archive read up to the file
+    EXPECT_EQ(lastTotal, QFileInfo(path).size());
+}
+
+TEST_F(UT_ArchiveIndex, extractCanceled)
+{
+    const QString &path = dir.filePath("cancel.tar.gz");
+    ASSERT_TRUE(writeArchive(path, true, files));
+    const auto &index = ArchiveIndex::open(path);
+    ASSERT_TRUE(index);
+
+    const QString &target = dir.filePath("canceled.txt");
+    EXPECT_FALSE(index->extract("top.txt", target, [](qint64, qint64) { return false; }));
+    EXPECT_FALSE(QFile::exists(target));
+}
+
+TEST_F(UT_ArchiveIndex, loadFromCache)
+{
+    const QString &path = dir.filePath("cached.tar");
+    ASSERT_TRUE(writeArchive(path, false, files));
+    const auto &index = ArchiveIndex::open(path);
+    ASSERT_TRUE(index);
+
+    const QString &cacheFile = ArchiveIndex::cacheFileOf(path);
+    ASSERT_TRUE(QFile::exists(cacheFile));
+    setAge(cacheFile, 3600);
+
+    ArchiveIndex loaded(path);
+    loaded.archiveSize = index->archiveSize;
+    loaded.archiveModifyTime = index->archiveModifyTime;
+    ASSERT_TRUE(loaded.load(cacheFile));
+    EXPECT_EQ(loaded.children("docs").size(), 2);
+    EXPECT_EQ(loaded.entry("docs/readme.txt").headerOffset, index->entry("docs/readme.txt").headerOffset);
+    // the index used is kept by the eviction
+    EXPECT_GT(QFileInfo(cacheFile).lastModified(), QDateTime::currentDateTime().addSecs(-60));
+
+    // the archive changed
+    ArchiveIndex changed(path);
+    changed.archiveSize = index->archiveSize + 1;
+    changed.archiveModifyTime = index->archiveModifyTime;
+    EXPECT_FALSE(changed.load(cacheFile));
+}
+
+TEST_F(UT_ArchiveIndex, evictCache)
+{
+    const QString &cache = ArchiveIndex::cacheDir();
+    ASSERT_TRUE(QDir().mkpath(cache + "/extracted/old"));
+    ASSERT_TRUE(QDir().mkpath(cache + "/extracted/new"));
+
+    for (const QString &name : { "old.index", "new.index" }) {
+        QFile file(cache + "/" + name);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    }
+    QFile file(cache + "/extracted/new/file");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("data");
+    file.close();
+
+    setAge(cache + "/old.index", 31 * 24 * 3600);
+    setAge(cache + "/extracted/old", 2 * 24 * 3600);
+
+    ArchiveIndex::evictCache();
+    EXPECT_FALSE(QFile::exists(cache + "/old.index"));
+    EXPECT_TRUE(QFile::exists(cache + "/new.index"));
+    EXPECT_FALSE(QFile::exists(cache + "/extracted/old"));
+    EXPECT_TRUE(QFile::exists(cache + "/extracted/new/file"));
+}
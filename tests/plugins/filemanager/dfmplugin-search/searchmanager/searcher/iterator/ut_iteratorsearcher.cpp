@@ -11,6 +11,10 @@
 
 #include <gtest/gtest.h>
 
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
 DPSEARCH_USE_NAMESPACE
 DFMBASE_USE_NAMESPACE
 
@@ -26,6 +30,7 @@ TEST(IteratorSearcherTest, ut_search_2)
 {
     stub_ext::StubExt st;
     st.set_lamda(&IteratorSearcher::doSearch, [] { __DBG_STUB_INVOKE__ });
+    st.set_lamda(&IteratorSearcher::doLocalSearch, [] { __DBG_STUB_INVOKE__ });
 
     IteratorSearcher search(QUrl::fromLocalFile("/home"), "key");
     search.allResults << QUrl::fromLocalFile("/home");
@@ -102,3 +107,40 @@ TEST(IteratorSearcherTest, doSearch_2)
     EXPECT_FALSE(search.allResults.isEmpty());
     EXPECT_TRUE(search.searchPathList.isEmpty());
 }
+
+TEST(IteratorSearcherTest, doLocalSearch)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(QDir().mkpath(dir.filePath("a/b/KeyDir/c")));
+    ASSERT_TRUE(QDir().mkpath(dir.filePath(".hide/key")));
+    for (const QString &name : { QString("a/b/KeyDir/c/my-key.txt"), QString("a/other.txt"), QString("a/hidden-key"), QString("a/.hidden") }) {
+        QFile file(dir.filePath(name));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        if (name.endsWith(".hidden"))
+            file.write("hidden-key\n");
+    }
+
+    IteratorSearcher search(QUrl::fromLocalFile(dir.path()), "KEY");
+    search.status.storeRelease(AbstractSearcher::kRuning);
+    search.doLocalSearch();
+
+    QStringList paths;
+    for (const auto &url : search.takeAll())
+        paths << url.toLocalFile();
+    paths.sort();
+    EXPECT_EQ(QStringList({ dir.filePath("a/b/KeyDir"), dir.filePath("a/b/KeyDir/c/my-key.txt") }), paths);
+}
+
+TEST(IteratorSearcherTest, doLocalSearch_stopped)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(QDir().mkpath(dir.filePath("key")));
+
+    IteratorSearcher search(QUrl::fromLocalFile(dir.path()), "key");
+    search.stop();
+    search.doLocalSearch();
+
+    EXPECT_FALSE(search.hasItem());
+}
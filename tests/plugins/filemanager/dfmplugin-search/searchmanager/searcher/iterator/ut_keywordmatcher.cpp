@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchmanager/searcher/iterator/keywordmatcher.h"
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+
+DPSEARCH_USE_NAMESPACE
+
+TEST(KeywordMatcherTest, literal)
+{
+    KeywordMatcher matcher("Key");
+    EXPECT_TRUE(matcher.isLiteral());
+    EXPECT_TRUE(matcher.matches("my-KEY.txt", 10));
+    EXPECT_TRUE(matcher.matches("key", 3));
+    EXPECT_FALSE(matcher.matches("ke", 2));
+    EXPECT_FALSE(matcher.matches("kkeey", 5));
+    // only the given length is matched
+    EXPECT_FALSE(matcher.matches("keykey", 2));
+}
+
+TEST(KeywordMatcherTest, nonAscii)
+{
+    KeywordMatcher matcher("文件");
+    EXPECT_TRUE(matcher.isLiteral());
+    const QByteArray &name = QFile::encodeName("新建文件.txt");
+    EXPECT_TRUE(matcher.matches(name.constData(), name.size()));
+    EXPECT_FALSE(matcher.matches("file", 4));
+    EXPECT_TRUE(matcher.matches(QString("文件夹")));
+}
+
+TEST(KeywordMatcherTest, wildcard)
+{
+    KeywordMatcher matcher("*.TXT");
+    EXPECT_FALSE(matcher.isLiteral());
+    EXPECT_TRUE(matcher.matches("a.txt", 5));
+    EXPECT_FALSE(matcher.matches("a.txt.bak", 9));
+
+    KeywordMatcher single("a?c");
+    EXPECT_TRUE(single.matches(QString("ABC")));
+    EXPECT_FALSE(single.matches(QString("xabc")));
+}